@@ -0,0 +1,273 @@
+/*!
+ * \file python_support.hpp
+ * \brief Helpers of the Python wrappers: an array view exporting C++ memory through the buffer protocol and a guard releasing the global interpreter lock
+ * \author Benedikt Krüger
+ */
+
+#ifndef GESPINST_DETAILS_PYTHON_SUPPORT_HPP
+#define GESPINST_DETAILS_PYTHON_SUPPORT_HPP
+
+#include <Python.h>
+
+#include <map>
+#include <vector>
+
+namespace Gespinst
+{
+namespace Python
+{
+  //! Maximal number of dimensions of an ArrayViewObject
+  const int array_view_maximal_dimension = 4;
+
+  //! Struct-format character of the buffer protocol for a C++ type
+  template<class T> struct BufferFormat;
+  template<> struct BufferFormat<int> { static const char* format() { return "i"; } };
+  template<> struct BufferFormat<unsigned int> { static const char* format() { return "I"; } };
+  template<> struct BufferFormat<long> { static const char* format() { return "l"; } };
+  template<> struct BufferFormat<unsigned long> { static const char* format() { return "L"; } };
+  template<> struct BufferFormat<long long> { static const char* format() { return "q"; } };
+  template<> struct BufferFormat<unsigned long long> { static const char* format() { return "Q"; } };
+  template<> struct BufferFormat<float> { static const char* format() { return "f"; } };
+  template<> struct BufferFormat<double> { static const char* format() { return "d"; } };
+
+  /*!
+   * \brief Python object exporting a strided block of C++ memory through the buffer protocol
+   * \details numpy.asarray and memoryview create arrays that share the memory with the view. The view holds a reference to the Python object owning the memory (e.g. the wrapped SpinLattice), so the memory stays valid as long as an array uses it. Views of a std::vector are registered with the address of the vector until they are deleted (see vector_view_number), the wrappers refuse to change the size of a vector with views, since the vector could reallocate its memory. Data without contiguous storage (e.g. histograms based on std::map) is copied once into memory owned by the view.
+   */
+  struct ArrayViewObject
+  {
+    PyObject_HEAD
+    //! Python object owning the memory, null if the view owns a copy of the data
+    PyObject* owner;
+    //! Copy of the data owned by the view, null if the memory is owned by another object
+    char* copy;
+    //! Vector the view is registered with, null if the view is not a view of a vector
+    const void* vector;
+    //! Pointer to the first element
+    void* data;
+    //! Struct-format string of the elements
+    const char* format;
+    //! Size of an element in bytes
+    Py_ssize_t itemsize;
+    //! Number of dimensions
+    int dimension;
+    //! Number of elements in every dimension
+    Py_ssize_t shape[array_view_maximal_dimension];
+    //! Distance in bytes between neighbouring elements in every dimension
+    Py_ssize_t strides[array_view_maximal_dimension];
+    //! Flag indicating whether the memory must not be written through the view
+    bool readonly;
+  };
+
+  //! Check whether an array view is C-contiguous
+  inline bool array_view_contiguous(const ArrayViewObject* view)
+  {
+    Py_ssize_t expected_stride = view->itemsize;
+    for (int d = view->dimension - 1; d >= 0; d--)
+    {
+      if (view->shape[d] > 1 && view->strides[d] != expected_stride) return false;
+      expected_stride *= view->shape[d];
+    }
+    return true;
+  }
+
+  //! Fill a Py_buffer for a consumer of the buffer protocol
+  inline int array_view_getbuffer(PyObject* self, Py_buffer* buffer, int flags)
+  {
+    ArrayViewObject* view = reinterpret_cast<ArrayViewObject*>(self);
+    buffer->obj = NULL;
+    if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE && view->readonly)
+    {
+      PyErr_SetString(PyExc_BufferError, "The array view is read-only.");
+      return -1;
+    }
+    const bool contiguous = array_view_contiguous(view);
+    const bool strides_requested = (flags & PyBUF_STRIDES) == PyBUF_STRIDES;
+    const bool contiguity_requested = (flags & PyBUF_C_CONTIGUOUS) == PyBUF_C_CONTIGUOUS
+      || (flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS
+      || (flags & PyBUF_ANY_CONTIGUOUS) == PyBUF_ANY_CONTIGUOUS;
+    if (!contiguous && (!strides_requested || contiguity_requested))
+    {
+      PyErr_SetString(PyExc_BufferError, "The array view is not contiguous, the consumer must accept strides.");
+      return -1;
+    }
+    if ((flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS && view->dimension > 1)
+    {
+      PyErr_SetString(PyExc_BufferError, "The array view is stored in C order.");
+      return -1;
+    }
+
+    Py_ssize_t length = view->itemsize;
+    for (int d = 0; d < view->dimension; d++) length *= view->shape[d];
+
+    buffer->buf = view->data;
+    buffer->obj = self;
+    Py_INCREF(self);
+    buffer->len = length;
+    buffer->readonly = view->readonly ? 1 : 0;
+    buffer->itemsize = view->itemsize;
+    buffer->format = ((flags & PyBUF_FORMAT) == PyBUF_FORMAT) ? const_cast<char*>(view->format) : NULL;
+    buffer->ndim = view->dimension;
+    buffer->shape = ((flags & PyBUF_ND) == PyBUF_ND) ? view->shape : NULL;
+    buffer->strides = strides_requested ? view->strides : NULL;
+    buffer->suboffsets = NULL;
+    buffer->internal = NULL;
+    return 0;
+  }
+
+  //! Get the numbers of the existing views of the vectors with views, indexed by the address of the vector
+  inline std::map<const void*, Py_ssize_t>& vector_view_numbers()
+  {
+    static std::map<const void*, Py_ssize_t> view_numbers;
+    return view_numbers;
+  }
+
+  //! Get the number of existing views of the given vector, the vector must not change its size while this number is not zero
+  inline Py_ssize_t vector_view_number(const void* vector)
+  {
+    std::map<const void*, Py_ssize_t>::const_iterator view_number = vector_view_numbers().find(vector);
+    return (view_number == vector_view_numbers().end()) ? 0 : view_number->second;
+  }
+
+  //! Release the owner and the copy of an array view and unregister it from its vector
+  inline void array_view_dealloc(PyObject* self)
+  {
+    ArrayViewObject* view = reinterpret_cast<ArrayViewObject*>(self);
+    if (view->vector != NULL)
+    {
+      std::map<const void*, Py_ssize_t>::iterator view_number = vector_view_numbers().find(view->vector);
+      if (--view_number->second == 0) vector_view_numbers().erase(view_number);
+    }
+    Py_XDECREF(view->owner);
+    delete[] view->copy;
+    Py_TYPE(self)->tp_free(self);
+  }
+
+  //! Get the Python type of the array views, the type is initialised at the first call
+  inline PyTypeObject* array_view_type()
+  {
+    static PyBufferProcs buffer_procs = { array_view_getbuffer, NULL };
+    // The type is zero-initialised as a static object and filled at the first call, an initialiser of only the head of PyTypeObject warns about all other fields
+    static PyTypeObject type;
+    static bool ready = false;
+    if (!ready)
+    {
+#if PY_VERSION_HEX >= 0x03090000
+      Py_SET_REFCNT(reinterpret_cast<PyObject*>(&type), 1);
+#else
+      Py_REFCNT(&type) = 1;
+#endif
+      type.tp_name = "ArrayView";
+      type.tp_basicsize = sizeof(ArrayViewObject);
+      type.tp_flags = Py_TPFLAGS_DEFAULT;
+      type.tp_dealloc = array_view_dealloc;
+      type.tp_as_buffer = &buffer_procs;
+      type.tp_doc = "View of C++ memory, use numpy.asarray or memoryview to access the data without a copy";
+      if (PyType_Ready(&type) < 0) return NULL;
+      ready = true;
+    }
+    return &type;
+  }
+
+  /*!
+   * \param owner Python object owning the memory, a reference is held by the view
+   * \param data Pointer to the first element
+   * \param format Struct-format string of the elements (see BufferFormat)
+   * \param itemsize Size of an element in bytes
+   * \param dimension Number of dimensions, at most array_view_maximal_dimension
+   * \param shape Number of elements in every dimension
+   * \param strides Distance in bytes between neighbouring elements in every dimension
+   * \param readonly Flag indicating whether the memory must not be written through the view
+   * \returns New reference to the view, or null with a Python exception set
+   */
+  inline PyObject* create_array_view(PyObject* owner, void* data, const char* format, Py_ssize_t itemsize, int dimension, const Py_ssize_t* shape, const Py_ssize_t* strides, bool readonly)
+  {
+    if (dimension < 0 || dimension > array_view_maximal_dimension)
+    {
+      PyErr_SetString(PyExc_ValueError, "Too many dimensions for an array view.");
+      return NULL;
+    }
+    PyTypeObject* type = array_view_type();
+    if (type == NULL) return NULL;
+    ArrayViewObject* view = PyObject_New(ArrayViewObject, type);
+    if (view == NULL) return NULL;
+
+    Py_XINCREF(owner);
+    view->owner = owner;
+    view->copy = NULL;
+    view->vector = NULL;
+    view->data = data;
+    view->format = format;
+    view->itemsize = itemsize;
+    view->dimension = dimension;
+    for (int d = 0; d < dimension; d++)
+    {
+      view->shape[d] = shape[d];
+      view->strides[d] = strides[d];
+    }
+    view->readonly = readonly;
+    return reinterpret_cast<PyObject*>(view);
+  }
+
+  //! Create a one-dimensional view of the elements of a vector owned by the given Python object, the view is registered with the vector until it is deleted
+  template<class T, class Allocator>
+  PyObject* create_vector_view(PyObject* owner, const std::vector<T, Allocator>& values, bool readonly = true)
+  {
+    const Py_ssize_t shape = values.size();
+    const Py_ssize_t stride = sizeof(T);
+    PyObject* result = create_array_view(owner, const_cast<T*>(values.data()), BufferFormat<T>::format(), sizeof(T), 1, &shape, &stride, readonly);
+    if (result == NULL) return NULL;
+    reinterpret_cast<ArrayViewObject*>(result)->vector = &values;
+    ++vector_view_numbers()[&values];
+    return result;
+  }
+
+  //! Raise a BufferError if views of the given vector exist, returns false in this case
+  inline bool check_vector_resizable(const void* vector)
+  {
+    if (vector_view_number(vector) == 0) return true;
+    PyErr_SetString(PyExc_BufferError, "The values are exported to an array view, delete the views (and the arrays using them) before the size of the values is changed.");
+    return false;
+  }
+
+  //! Create a one-dimensional read-only view owning a copy of the elements of a range, used for storage without contiguous memory
+  template<class T, class InputIterator>
+  PyObject* create_array_copy(InputIterator begin, InputIterator end, Py_ssize_t size)
+  {
+    const Py_ssize_t stride = sizeof(T);
+    PyObject* result = create_array_view(NULL, NULL, BufferFormat<T>::format(), sizeof(T), 1, &size, &stride, true);
+    if (result == NULL) return NULL;
+    ArrayViewObject* view = reinterpret_cast<ArrayViewObject*>(result);
+    view->copy = new char[size > 0 ? size*sizeof(T) : 1];
+    view->data = view->copy;
+    T* elements = reinterpret_cast<T*>(view->copy);
+    for (InputIterator it = begin; it != end; ++it) *(elements++) = *it;
+    return result;
+  }
+
+  /*!
+   * \brief Guard releasing the global interpreter lock for its lifetime
+   * \details Long-running C++ calls (e.g. the do_*_steps functions of the simulations) are wrapped in this guard, so other Python threads continue meanwhile. The guarded code must not touch Python objects, and the C++ objects used by the call must not be modified from Python (e.g. through an array view) until the call returns.
+   */
+  class ScopedGILRelease
+  {
+  public:
+    //! Release the lock
+    ScopedGILRelease() : state(PyEval_SaveThread()) {}
+    //! Reacquire the lock
+    ~ScopedGILRelease() { PyEval_RestoreThread(state); }
+
+  private:
+    //! State of the releasing thread
+    PyThreadState* state;
+
+    //! Copy constructor (not copyable)
+    ScopedGILRelease(const ScopedGILRelease&);
+    //! Assignment operator (not assignable)
+    ScopedGILRelease& operator=(const ScopedGILRelease&);
+  };
+
+} // of namespace Python
+} // of namespace Gespinst
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef GESPINST_INTERACTIONS_SITE_BOND_INTERACTION_HPP
+#define GESPINST_INTERACTIONS_SITE_BOND_INTERACTION_HPP
+
+#include <vector>
+
+// Header for the serialization of the class
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/serialization/vector.hpp>
+
+namespace Gespinst
+{
+  namespace Interactions
+  {
+    /*!
+     * \brief Interaction of a spin lattice with an individual coupling for every bond and an individual field at every site (e.g. random-bond and random-field models).
+     * \author Benedikt Krüger
+     * \details The couplings and fields are stored as structure of arrays aligned with the linear site index of the spin array: The fields are a single array with one entry per site, the couplings are one array per direction (stored consecutively), whose entry at a site is the coupling of the bond between the site and its upper neighbour in that direction. After resizing, all couplings are 1 and all fields are 0.
+     */
+    class SiteBondInteraction
+    {
+    private:
+      //! Number of sites of the lattice
+      unsigned int site_number;
+      //! Couplings of the bonds, the coupling of the bond from a site in direction d is stored at d*site_number + site
+      std::vector<double> couplings;
+      //! Fields at the sites
+      std::vector<double> fields;
+
+      //! Member variable for boost serialization
+      friend class boost::serialization::access;
+      //! Method to serialize this class (omitted version name to avoid unused parameter warnings)
+      template<class Archive> void serialize(Archive & ar, const unsigned int)
+      {
+	ar & site_number;
+	ar & couplings;
+	ar & fields;
+      }
+
+    public:
+      //! Default constructor, creates an interaction without sites
+      SiteBondInteraction() : site_number(0) {}
+
+      //! Coupling of the bond between the site and its upper neighbour in direction dim
+      double coupling(unsigned int site, unsigned int dim) const { return couplings[dim*site_number + site]; }
+      //! Set the coupling of the bond between the site and its upper neighbour in direction dim
+      void set_coupling(unsigned int site, unsigned int dim, double value) { couplings[dim*site_number + site] = value; }
+      //! External field at the site
+      double field(unsigned int site) const { return fields[site]; }
+      //! Set the external field at the site
+      void set_field(unsigned int site, double value) { fields[site] = value; }
+      //! Set the external field at all sites to the same value
+      void set_uniform_field(double value) { fields.assign(site_number, value); }
+
+      //! Resize the storage for the given number of sites and dimensions, resets all couplings to 1 and all fields to 0
+      void resize(unsigned int sites, unsigned int dimension)
+      {
+	site_number = sites;
+	couplings.assign(sites*dimension, 1.0);
+	fields.assign(sites, 0.0);
+      }
+
+      //! Operator for testing equality of all couplings and fields
+      bool operator==(const SiteBondInteraction& other) const { return (site_number == other.site_number) && (couplings == other.couplings) && (fields == other.fields); }
+      //! Operator for testing inequality
+      bool operator!=(const SiteBondInteraction& other) const { return !operator==(other); }
+    };
+
+  } // of namespace Interactions
+} // of namespace Gespinst
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef GESPINST_INTERACTIONS_UNIFORM_FIELD_INTERACTION_HPP
+#define GESPINST_INTERACTIONS_UNIFORM_FIELD_INTERACTION_HPP
+
+// Header for the serialization of the class
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/archive/text_iarchive.hpp>
+
+namespace Gespinst
+{
+  namespace Interactions
+  {
+    /*!
+     * \brief Interaction of a spin lattice with unit coupling between all next neighbours and a uniform external field.
+     * \author Benedikt Krüger
+     * \details The couplings are compile-time constants, only the field is stored. The field couples to the value of the spin (SpinType::get_value()).
+     */
+    class UniformFieldInteraction
+    {
+    private:
+      //! Value of the external field
+      double uniform_field;
+
+      //! Member variable for boost serialization
+      friend class boost::serialization::access;
+      //! Method to serialize this class (omitted version name to avoid unused parameter warnings)
+      template<class Archive> void serialize(Archive & ar, const unsigned int)
+      {
+	ar & uniform_field;
+      }
+
+    public:
+      //! Constructor with optional value of the field
+      UniformFieldInteraction(double field_value = 0.0) : uniform_field(field_value) {}
+
+      //! Coupling of all bonds, always 1
+      static double coupling(unsigned int, unsigned int) { return 1.0; }
+      //! External field at all sites
+      double field(unsigned int) const { return uniform_field; }
+      //! Set the external field
+      void set_field(double value) { uniform_field = value; }
+      //! Nothing to resize for uniform couplings and fields
+      void resize(unsigned int, unsigned int) {}
+
+      //! Operator for testing equality of the fields
+      bool operator==(const UniformFieldInteraction& other) const { return uniform_field == other.uniform_field; }
+      //! Operator for testing inequality
+      bool operator!=(const UniformFieldInteraction& other) const { return !operator==(other); }
+    };
+
+  } // of namespace Interactions
+} // of namespace Gespinst
+
+#endif
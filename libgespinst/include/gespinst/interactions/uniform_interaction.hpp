@@ -0,0 +1,63 @@
+#ifndef GESPINST_INTERACTIONS_UNIFORM_INTERACTION_HPP
+#define GESPINST_INTERACTIONS_UNIFORM_INTERACTION_HPP
+
+// Header for the serialization of the class
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/archive/text_iarchive.hpp>
+
+namespace Gespinst
+{
+  namespace Interactions
+  {
+    /*!
+     * \brief Interaction of a spin lattice with unit coupling between all next neighbours and without external field.
+     * \author Benedikt Krüger
+     * \details This is the default interaction of SpinLattice. All couplings are the compile-time constant 1, so the multiplications with them are removed by the compiler, and the field term is skipped through the trait HasField. So the energy calculations are as fast as without any interaction support.
+     *
+     * A class used as interaction template argument of SpinLattice must provide the following functions:
+     * - double coupling(unsigned int site, unsigned int dim) const: Coupling of the bond between the site and its upper neighbour in direction dim
+     * - double field(unsigned int site) const: External field at the site
+     * - void resize(unsigned int site_number, unsigned int dimension): Adapt the internal storage to a lattice with the given number of sites and dimensions
+     * - operator== for comparing the couplings and fields of two lattices
+     */
+    class UniformInteraction
+    {
+    private:
+      //! Member variable for boost serialization
+      friend class boost::serialization::access;
+      //! Method to serialize this class (omitted version name to avoid unused parameter warnings)
+      template<class Archive> void serialize(Archive &, const unsigned int) {}
+
+    public:
+      //! Coupling of all bonds, always 1
+      static double coupling(unsigned int, unsigned int) { return 1.0; }
+      //! External field at all sites, always 0
+      static double field(unsigned int) { return 0.0; }
+      //! Nothing to resize for uniform couplings
+      void resize(unsigned int, unsigned int) {}
+
+      //! Operator for testing equality, all uniform interactions are equal
+      bool operator==(const UniformInteraction&) const { return true; }
+      //! Operator for testing inequality
+      bool operator!=(const UniformInteraction&) const { return false; }
+    };
+
+    /*!
+     * \brief Trait indicating whether an interaction can have a non-zero external field
+     * \details The energy calculations of the lattices skip the field term at compile time if the value is false. A multiplication with a constant field 0 is not removed by the compiler, because 0 * x is not 0 for all floating point values x. Interactions without external field should specialise the trait.
+     */
+    template<class InteractionType>
+    struct HasField
+    {
+      static const bool value = true;
+    };
+    template<>
+    struct HasField<UniformInteraction>
+    {
+      static const bool value = false;
+    };
+
+  } // of namespace Interactions
+} // of namespace Gespinst
+
+#endif
@@ -0,0 +1,183 @@
+/*! \file libgespinst_wrap.cpp
+ * \brief Python module for the spins and spin lattices, the spin storage is exported through the buffer protocol without copies
+ * \details The module is built as shared library libgespinst_wrap.so, e.g. with
+ * g++ -std=c++0x -O2 -shared -fPIC -I.. $(python3-config --includes) libgespinst_wrap.cpp -o libgespinst_wrap.so -lboost_python311 -lboost_serialization
+ *
+ * The spins of a lattice are accessed with numpy.asarray(lattice.spins()), the array has the shape of the lattice and shares the memory with the lattice. Writing to the array changes the lattice, the values must be valid values of the spin type (e.g. -1 or 1 for Ising spins).
+ * \author Benedikt Krüger
+ */
+#include <boost/python.hpp>
+#include <boost/python/stl_iterator.hpp>
+
+#include <stdexcept>
+#include <utility>
+
+#include "spin_lattice.hpp"
+#include "spin_lattice_structure_factor.hpp"
+#include "spins/ising_spin.hpp"
+#include "spins/potts_spin.hpp"
+#include "spins/real_spin.hpp"
+#include "details/python_support.hpp"
+
+using namespace boost::python;
+using namespace Gespinst;
+
+namespace
+{
+  //! Convert a new reference into an object, throws if the reference is null because a Python exception is set
+  object to_object(PyObject* new_reference) { return object(handle<>(new_reference)); }
+
+  //! Create a lattice with the extensions given as Python sequence and the given spin on every site
+  template<unsigned int dimension, class SpinType>
+  SpinLattice<dimension, SpinType>* create_lattice(object extension, const SpinType& default_spin)
+  {
+    std::vector<unsigned int> lattice_extension((stl_input_iterator<unsigned int>(extension)), stl_input_iterator<unsigned int>());
+    if (lattice_extension.size() != dimension)
+      throw std::invalid_argument("The number of extensions does not match the dimension of the lattice.");
+    return new SpinLattice<dimension, SpinType>(lattice_extension, default_spin);
+  }
+  //! Create a lattice with the extensions given as Python sequence and the default spin on every site
+  template<unsigned int dimension, class SpinType>
+  SpinLattice<dimension, SpinType>* create_default_lattice(object extension)
+  {
+    return create_lattice<dimension, SpinType>(extension, SpinType());
+  }
+
+  //! Get the extensions of a lattice as tuple
+  template<unsigned int dimension, class SpinType>
+  tuple lattice_shape(const SpinLattice<dimension, SpinType>& lattice)
+  {
+    list result;
+    for (unsigned int d = 0; d < dimension; d++) result.append(lattice.extension(d));
+    return tuple(result);
+  }
+
+  /*!
+   * \details The values of the spins are the first members of the spin classes, so the view points to the value of the first spin and steps over whole spin objects (e.g. the maximal value of Potts spins is skipped by the strides).
+   * \param self Python object of the lattice, is kept alive by the view
+   */
+  template<unsigned int dimension, class SpinType>
+  object spin_array(object self)
+  {
+    static_assert(dimension <= static_cast<unsigned int>(Python::array_view_maximal_dimension), "Too many dimensions for an array view.");
+    typedef decltype(std::declval<const SpinType&>().get_value()) value_type;
+
+    const SpinLattice<dimension, SpinType>& lattice = extract<const SpinLattice<dimension, SpinType>&>(self);
+    if (lattice.system_size() == 0) throw std::invalid_argument("The lattice has no sites.");
+    const SpinType& first_spin = lattice.site_spin(0);
+    if (*reinterpret_cast<const value_type*>(&first_spin) != first_spin.get_value())
+      throw std::logic_error("The value is not the first member of the spin class.");
+
+    // Sites are stored in C order, the last direction is contiguous
+    Py_ssize_t shape[dimension];
+    Py_ssize_t strides[dimension];
+    Py_ssize_t stride = sizeof(SpinType);
+    for (int d = dimension - 1; d >= 0; d--)
+    {
+      shape[d] = lattice.extension(d);
+      strides[d] = stride;
+      stride *= shape[d];
+    }
+    return to_object(Python::create_array_view(self.ptr(), const_cast<SpinType*>(&first_spin), Python::BufferFormat<value_type>::format(), sizeof(value_type), dimension, shape, strides, false));
+  }
+
+  //! Create a read-only view of values stored in the order of the linear site index with the shape of the lattice
+  template<unsigned int dimension, class SpinType>
+  PyObject* grid_view(object owner, const std::vector<double>& values, const SpinLattice<dimension, SpinType>& lattice)
+  {
+    Py_ssize_t shape[dimension];
+    Py_ssize_t strides[dimension];
+    Py_ssize_t stride = sizeof(double);
+    for (int d = dimension - 1; d >= 0; d--)
+    {
+      shape[d] = lattice.extension(d);
+      strides[d] = stride;
+      stride *= shape[d];
+    }
+    return Python::create_array_view(owner.ptr(), const_cast<double*>(values.data()), Python::BufferFormat<double>::format(), sizeof(double), dimension, shape, strides, true);
+  }
+
+  /*!
+   * \details The view shares the internal buffer of the structure factor object with the shape of the lattice, it is overwritten by the next calculation.
+   */
+  template<unsigned int dimension, class SpinType>
+  object structure_factor_array(object self, const SpinLattice<dimension, SpinType>& lattice)
+  {
+    SpinLatticeStructureFactor<dimension, SpinType>& structure_factor = extract<SpinLatticeStructureFactor<dimension, SpinType>&>(self);
+    const std::vector<double>& values = structure_factor.structure_factor(lattice);
+    return to_object(grid_view(self, values, lattice));
+  }
+  //! Calculate the correlation function, the view shares the internal buffer of the structure factor object
+  template<unsigned int dimension, class SpinType>
+  object correlation_function_array(object self, const SpinLattice<dimension, SpinType>& lattice)
+  {
+    SpinLatticeStructureFactor<dimension, SpinType>& structure_factor = extract<SpinLatticeStructureFactor<dimension, SpinType>&>(self);
+    const std::vector<double>& values = structure_factor.correlation_function(lattice);
+    return to_object(grid_view(self, values, lattice));
+  }
+
+  //! Export a spin lattice and its structure factor with the given spin type and dimension
+  template<unsigned int dimension, class SpinType>
+  void export_spin_lattice(const char* lattice_name, const char* structure_factor_name)
+  {
+    typedef SpinLattice<dimension, SpinType> LatticeType;
+    typedef SpinLatticeStructureFactor<dimension, SpinType> StructureFactorType;
+
+    class_<LatticeType>(lattice_name, init<>())
+      .def("__init__", make_constructor(&create_default_lattice<dimension, SpinType>))
+      .def("__init__", make_constructor(&create_lattice<dimension, SpinType>))
+      .def(init<const LatticeType&>())
+      .def("energy", &LatticeType::energy)
+      .def("magnetization", &LatticeType::magnetization)
+      .def("system_size", &LatticeType::system_size)
+      .def("extension", &LatticeType::extension)
+      .def("shape", &lattice_shape<dimension, SpinType>)
+      .def("get_simulation_time", &LatticeType::get_simulation_time)
+      .def("site_spin", &LatticeType::site_spin, return_value_policy<copy_const_reference>())
+      .def("set_site_spin", &LatticeType::set_site_spin)
+      .def("spins", &spin_array<dimension, SpinType>)
+      .def(self == self)
+      .def(self != self)
+    ;
+
+    class_<StructureFactorType, boost::noncopyable>(structure_factor_name, init<const LatticeType&>())
+      .def("system_size", &StructureFactorType::system_size)
+      .def("extension", &StructureFactorType::extension)
+      .def("structure_factor", &structure_factor_array<dimension, SpinType>)
+      .def("correlation_function", &correlation_function_array<dimension, SpinType>)
+      .def("second_moment_correlation_length", static_cast<double (StructureFactorType::*)(const LatticeType&)>(&StructureFactorType::second_moment_correlation_length))
+    ;
+  }
+}
+
+BOOST_PYTHON_MODULE(libgespinst_wrap)
+{
+    class_<IsingSpin>("SpinIsing")
+      .def(init<int>())
+      .def("get_value", &IsingSpin::get_value)
+      .def("set_value", &IsingSpin::set_value)
+      .def(self * self)
+    ;
+
+    class_<PottsSpin>("SpinPotts")
+      .def(init<unsigned int, unsigned int>())
+      .def("get_value", &PottsSpin::get_value)
+      .def("set_value", &PottsSpin::set_value)
+      .def("get_max_value", &PottsSpin::get_max_value)
+      .def("set_max_value", &PottsSpin::set_max_value)
+      .def(self * self)
+    ;
+
+    class_<RealSpin>("SpinReal")
+      .def(init<double>())
+      .def("get_value", &RealSpin::get_value)
+      .def("set_value", &RealSpin::set_value)
+      .def(self * self)
+    ;
+
+    export_spin_lattice<1, IsingSpin>("SpinLatticeIsing1d", "StructureFactorIsing1d");
+    export_spin_lattice<2, IsingSpin>("SpinLatticeIsing2d", "StructureFactorIsing2d");
+    export_spin_lattice<3, IsingSpin>("SpinLatticeIsing3d", "StructureFactorIsing3d");
+    export_spin_lattice<2, PottsSpin>("SpinLatticePotts2d", "StructureFactorPotts2d");
+    export_spin_lattice<2, RealSpin>("SpinLatticeReal2d", "StructureFactorReal2d");
+}
@@ -2,6 +2,7 @@
 #define GESPINST_SPIN_LATTICE_HPP
 
 #include "spin_lattice_step.hpp"
+#include "interactions/uniform_interaction.hpp"
 
 #include <vector>
 #include "boost/multi_array.hpp"
@@ -9,6 +10,7 @@
 // Header for the serialization of the class
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
+#include <boost/serialization/version.hpp>
 // Serialization of boost multi array
 #include "details/multi_array_serialize.hpp"
 
@@ -22,8 +24,10 @@ namespace Gespinst
  * - operator= for assigning two spins
  * - std::vector<SpinType> all_possible_values() const: Function that returns a vector with all possible values of a spin.
  * - SpinType random_differ(double random_number) const: Function that returns a new spin out of all possible values that is unequal to the actual spin.
+ *
+ * The optional third template argument of SpinLattice specifies the couplings of the bonds and the external fields (see Interactions::UniformInteraction for the requirements). The energy of a configuration is \f$ E = -\sum_{\langle ij \rangle} J_{ij} s_i s_j - \sum_i h_i s_i \f$, where the product of two spins is given by SpinType::operator* and the field couples to SpinType::get_value(). The default interaction has uniform unit couplings and no field, these constants are elided at compile time.
  */
-template<unsigned int dimension, class SpinType, class Derived>
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
 class SpinLatticeBase
 {
 protected:
@@ -31,9 +35,6 @@ protected:
   typedef boost::array<typename lattice_array_type::index, dimension> index_type;
 
 private:
-  //! Integer for the simulation time
-  int _simulation_time;
-
   //! Function to convert a coordinate vector into the right boost::array
   index_type to_boost_array(std::vector<unsigned int> coordinates);
   //! Function to convert a integer (from 0 to num_elements() - 1) to coordinates
@@ -41,16 +42,22 @@ private:
 
   //! Member variable for boost serialization
   friend class boost::serialization::access;
-  //! Method to serialize this class (omitted version name to avoid unused parameter warnings)
-  template<class Archive> void serialize(Archive & ar, const unsigned int)
+  //! Method to serialize this class, the interaction is stored since version 1 (archives of version 0 are loaded with the default couplings and fields)
+  template<class Archive> void serialize(Archive & ar, const unsigned int version)
   {
     ar & spin_lattice;
     ar & _simulation_time;
+    if (version >= 1) ar & interaction;
+    else interaction.resize(spin_lattice.num_elements(), dimension);
   }
 
 protected:
   //! Array with the Spins
   lattice_array_type spin_lattice;
+  //! Integer for the simulation time
+  int _simulation_time;
+  //! Couplings and fields of the lattice, stored aligned with the linear site index
+  InteractionType interaction;
 
 public:
   //! Default constructor
@@ -58,7 +65,7 @@ public:
   //! Constructor with optional default value
   SpinLatticeBase(std::vector<unsigned int> lattice_extension, SpinType default_spin = SpinType());
   //! Copy constructor
-  SpinLatticeBase(const SpinLatticeBase<dimension, SpinType, Derived>& other);
+  SpinLatticeBase(const SpinLatticeBase<dimension, SpinType, Derived, InteractionType>& other);
 
   //! Function to get a spin at the given coordinates
   SpinType get_spin(index_type coordinates) const;
@@ -66,19 +73,25 @@ public:
   void set_spin(index_type coordinates, SpinType value);
   //! Get-accessor for the simulation time
   int get_simulation_time() const { return _simulation_time; }
+  //! Get-accessor for the couplings and fields of the lattice
+  const InteractionType& get_interaction() const { return interaction; }
+  //! Modifying get-accessor for the couplings and fields of the lattice
+  InteractionType& get_interaction() { return interaction; }
 
   //! Assignment Operator
-  SpinLatticeBase<dimension, SpinType, Derived>& operator=(const SpinLatticeBase<dimension, SpinType, Derived>& other);
-  //! Operator for testing equality
-  bool operator==(const SpinLatticeBase<dimension, SpinType, Derived>& other) const;
+  SpinLatticeBase<dimension, SpinType, Derived, InteractionType>& operator=(const SpinLatticeBase<dimension, SpinType, Derived, InteractionType>& other);
+  //! Operator for testing equality of the spins and the interaction
+  bool operator==(const SpinLatticeBase<dimension, SpinType, Derived, InteractionType>& other) const;
   //! Operator for testing inequality
-  bool operator!=(const SpinLatticeBase<dimension, SpinType, Derived>& other) const;
+  bool operator!=(const SpinLatticeBase<dimension, SpinType, Derived, InteractionType>& other) const;
 
   //! Create a vector with all present possible steps
-  std::vector<SpinLatticeStep<dimension, SpinType> > all_steps();
+  std::vector<SpinLatticeStep<dimension, SpinType, InteractionType> > all_steps();
+  //! Create a vector with all present possible steps at the site with the given linear index
+  std::vector<SpinLatticeStep<dimension, SpinType, InteractionType> > all_steps(unsigned int site);
 
   //! Commit and execute a given step
-  void commit(SpinLatticeStep<dimension, SpinType>& step_to_commit);
+  void commit(SpinLatticeStep<dimension, SpinType, InteractionType>& step_to_commit);
 
   //! Calculate the energy of this lattice
   double energy() const;
@@ -92,21 +105,36 @@ public:
   //! Get the neighbours of a coordinate position
   std::vector<SpinType> next_neighbours(index_type coordinates) const; 
 
+  //! Get the spin at the given linear site index (sites are indexed in the storage order of the lattice)
+  const SpinType& site_spin(unsigned int site) const { return spin_lattice.data()[site]; }
+  //! Set the spin at the given linear site index
+  void set_site_spin(unsigned int site, const SpinType& value) { spin_lattice.data()[site] = value; }
+  //! Get the linear site index of the given coordinates
+  unsigned int site_index(index_type coordinates) const;
+  //! Energy of all bonds of a site and of its field term if the site had the given spin
+  double site_energy(unsigned int site, const SpinType& spin) const;
+  //! Get the linear index of the upper neighbour of a site in the given direction
+  unsigned int upper_neighbour_site(unsigned int site, unsigned int dim) const;
+  //! Get the linear index of the lower neighbour of a site in the given direction
+  unsigned int lower_neighbour_site(unsigned int site, unsigned int dim) const;
+  //! Get the linear indices of the neighbours of the site with the given linear index
+  std::vector<unsigned int> neighbour_sites(unsigned int site) const;
+
   //! Propose a step given a random double number
-  SpinLatticeStep<dimension, SpinType> propose_step(double random_double);
+  SpinLatticeStep<dimension, SpinType, InteractionType> propose_step(double random_double);
   //! Propose a step given a random number generator
-  template<class RandomNumberGenerator> SpinLatticeStep<dimension, SpinType> propose_step(RandomNumberGenerator* rng);
+  template<class RandomNumberGenerator> SpinLatticeStep<dimension, SpinType, InteractionType> propose_step(RandomNumberGenerator* rng);
 
   //! Calculate the system size
   unsigned int system_size() const;
 };
 
 //! Derived class for an arbitrary-dimensional spin lattice
-template<unsigned int dimension, class SpinType>
-class SpinLattice : public SpinLatticeBase<dimension, SpinType, SpinLattice<dimension, SpinType> >
+template<unsigned int dimension, class SpinType, class InteractionType = Interactions::UniformInteraction>
+class SpinLattice : public SpinLatticeBase<dimension, SpinType, SpinLattice<dimension, SpinType, InteractionType>, InteractionType>
 {
 private:
-  typedef SpinLatticeBase<dimension, SpinType, SpinLattice<dimension, SpinType> > Base;
+  typedef SpinLatticeBase<dimension, SpinType, SpinLattice<dimension, SpinType, InteractionType>, InteractionType> Base;
 
 public:
   //! Default constructor
@@ -114,15 +142,17 @@ public:
   //! Constructor with optional default value
   SpinLattice(std::vector<unsigned int> lattice_extension, SpinType default_spin = SpinType()) : Base(lattice_extension, default_spin) {}
   //! Copy constructor
-  SpinLattice(const SpinLattice<dimension,SpinType>& other) : Base(other) {}
+  SpinLattice(const SpinLattice<dimension, SpinType, InteractionType>& other) : Base(other) {}
+  //! Assignment operator
+  SpinLattice<dimension, SpinType, InteractionType>& operator=(const SpinLattice<dimension, SpinType, InteractionType>& other) { Base::operator=(other); return *this; }
 };
 
 //! Specialised class for a one dimensional spin lattice
-template<class SpinType>
-class SpinLattice<1, SpinType> : public SpinLatticeBase<1, SpinType, SpinLattice<1, SpinType> >
+template<class SpinType, class InteractionType>
+class SpinLattice<1, SpinType, InteractionType> : public SpinLatticeBase<1, SpinType, SpinLattice<1, SpinType, InteractionType>, InteractionType>
 {
 private:
-  typedef SpinLatticeBase<1, SpinType, SpinLattice<1, SpinType> > Base;
+  typedef SpinLatticeBase<1, SpinType, SpinLattice<1, SpinType, InteractionType>, InteractionType> Base;
   typedef typename Base::lattice_array_type::index subindex_type;
 
   typename Base::index_type create_array_index(subindex_type x1) const
@@ -138,7 +168,9 @@ public:
   //! Constructor with optional default value
   SpinLattice(std::vector<unsigned int> lattice_extension, SpinType default_spin = SpinType()) : Base(lattice_extension, default_spin) {}
   //! Copy constructor
-  SpinLattice(const SpinLattice<1, SpinType>& other) : Base(other) {}
+  SpinLattice(const SpinLattice<1, SpinType, InteractionType>& other) : Base(other) {}
+  //! Assignment operator
+  SpinLattice<1, SpinType, InteractionType>& operator=(const SpinLattice<1, SpinType, InteractionType>& other) { Base::operator=(other); return *this; }
 
   //! Const-Access-Operator for three-dimensional spin
   const SpinType& operator()(subindex_type x1) const
@@ -153,11 +185,11 @@ public:
 };
 
 //! Specialised class for a two-dimensional spin lattice
-template<class SpinType>
-class SpinLattice<2, SpinType> : public SpinLatticeBase<2, SpinType, SpinLattice<2, SpinType> >
+template<class SpinType, class InteractionType>
+class SpinLattice<2, SpinType, InteractionType> : public SpinLatticeBase<2, SpinType, SpinLattice<2, SpinType, InteractionType>, InteractionType>
 {
 private:
-  typedef SpinLatticeBase<2, SpinType, SpinLattice<2, SpinType> > Base;
+  typedef SpinLatticeBase<2, SpinType, SpinLattice<2, SpinType, InteractionType>, InteractionType> Base;
   typedef typename Base::lattice_array_type::index subindex_type;
 
   typename Base::index_type create_array_index(subindex_type x1, subindex_type x2) const
@@ -174,7 +206,9 @@ public:
   //! Constructor with optional default value
   SpinLattice(std::vector<unsigned int> lattice_extension, SpinType default_spin = SpinType()) : Base(lattice_extension, default_spin) {}
   //! Copy constructor
-  SpinLattice(const SpinLattice<2, SpinType>& other) : Base(other) {}
+  SpinLattice(const SpinLattice<2, SpinType, InteractionType>& other) : Base(other) {}
+  //! Assignment operator
+  SpinLattice<2, SpinType, InteractionType>& operator=(const SpinLattice<2, SpinType, InteractionType>& other) { Base::operator=(other); return *this; }
 
   //! Const-Access-Operator for three-dimensional spin
   const SpinType& operator()(subindex_type x1, subindex_type x2) const
@@ -189,11 +223,11 @@ public:
 };
 
 //! Specialied class for a three-dimensional spin lattice
-template<class SpinType>
-class SpinLattice<3, SpinType> : public SpinLatticeBase<3, SpinType, SpinLattice<3, SpinType> >
+template<class SpinType, class InteractionType>
+class SpinLattice<3, SpinType, InteractionType> : public SpinLatticeBase<3, SpinType, SpinLattice<3, SpinType, InteractionType>, InteractionType>
 {
 private:
-  typedef SpinLatticeBase<3, SpinType, SpinLattice<3, SpinType> > Base;
+  typedef SpinLatticeBase<3, SpinType, SpinLattice<3, SpinType, InteractionType>, InteractionType> Base;
   typedef typename Base::lattice_array_type::index subindex_type;
 
   typename Base::index_type create_array_index(subindex_type x1, subindex_type x2, subindex_type x3) const
@@ -211,7 +245,9 @@ public:
   //! Constructor with default value
   SpinLattice(std::vector<unsigned int> lattice_extension, SpinType default_spin = SpinType()) : Base(lattice_extension, default_spin) {}
   //! Copy constructor
-  SpinLattice(const SpinLattice<3, SpinType>& other) : Base(other) {}
+  SpinLattice(const SpinLattice<3, SpinType, InteractionType>& other) : Base(other) {}
+  //! Assignment operator
+  SpinLattice<3, SpinType, InteractionType>& operator=(const SpinLattice<3, SpinType, InteractionType>& other) { Base::operator=(other); return *this; }
 
   //! Const-Access-Operator for three-dimensional spin
   const SpinType& operator()(subindex_type x1, subindex_type x2, subindex_type x3) const
@@ -226,16 +262,16 @@ public:
 };
 
 //! Outstream operator for a 1d spin lattice
-template <class SpinType>
-std::ostream& operator<<(std::ostream& lhs, SpinLattice<1,SpinType> const& rhs)
+template <class SpinType, class InteractionType>
+std::ostream& operator<<(std::ostream& lhs, SpinLattice<1, SpinType, InteractionType> const& rhs)
 {
   for (unsigned int i = 0; i < rhs.extension(0); ++i)
     lhs << rhs(i) << " ";
   return lhs;
 } 
 //! Outstream operator for a 2d spin lattice
-template <class SpinType>
-std::ostream& operator<<(std::ostream& lhs, SpinLattice<2,SpinType> const& rhs)
+template <class SpinType, class InteractionType>
+std::ostream& operator<<(std::ostream& lhs, SpinLattice<2, SpinType, InteractionType> const& rhs)
 {
   for (unsigned int i = 0; i < rhs.extension(0); ++i)
   {
@@ -250,6 +286,21 @@ std::ostream& operator<<(std::ostream& lhs, SpinLattice<2,SpinType> const& rhs)
 
 } // of namespace Ising
 
+namespace boost
+{
+  namespace serialization
+  {
+    //! Version of the serialization of SpinLattice (BOOST_CLASS_VERSION cannot be used for class templates)
+    template<unsigned int dimension, class SpinType, class InteractionType>
+    struct version<Gespinst::SpinLattice<dimension, SpinType, InteractionType> >
+    {
+      typedef mpl::int_<1> type;
+      typedef mpl::integral_c_tag tag;
+      BOOST_STATIC_CONSTANT(int, value = version::type::value);
+    };
+  }
+}
+
 // Include the implementation
 #include "src/spin_lattice.cpp"
 
@@ -0,0 +1,137 @@
+#ifndef GESPINST_SPIN_LATTICE_DOMAIN_DECOMPOSITION_HPP
+#define GESPINST_SPIN_LATTICE_DOMAIN_DECOMPOSITION_HPP
+
+#include "spin_lattice.hpp"
+
+#include <vector>
+#include <stdexcept>
+#include <stdint.h>
+
+namespace Gespinst
+{
+/*!
+ * \brief Class template for Metropolis sweeps of a large SpinLattice split into per-thread subdomains with ghost layers.
+ * \author Benedikt Krüger
+ * \details The lattice is cut along the first direction into slabs of consecutive rows (a row consists of all sites with the same first coordinate). Every slab is owned by one OpenMP thread, that allocates and initialises the spins of the slab, one ghost row below and one ghost row above the slab and its random number generator itself, so that the memory is placed on the NUMA node of the thread (first touch).
+ *
+ * A sweep consists of two half-sweeps with checkerboard colouring: In every half-sweep the owning threads update all sites of one colour of their slab independently, afterwards every thread copies the sites of the just updated colour from the boundary rows of the neighbouring slabs into its ghost rows. The threads do not synchronise with barriers, instead every slab has a counter of completed half-sweeps that is written and read atomically, a thread only waits for its two neighbouring slabs. The checkerboard colouring requires an even extension in every direction.
+ *
+ * The couplings and fields are read from the interaction of the original lattice, which is only read during the sweeps. If less threads than slabs are available (e.g. without OpenMP), the half-sweeps of all slabs are executed one after another by a single thread.
+ *
+ * The class RandomNumberGenerator must be default constructible and provide the functions set_seed(uint32_t) and random_double().
+ */
+template<unsigned int dimension, class SpinType, class RandomNumberGenerator, class InteractionType = Interactions::UniformInteraction>
+class SpinLatticeDomainDecomposition
+{
+public:
+  //! Type of the decomposed lattice
+  typedef SpinLattice<dimension, SpinType, InteractionType> lattice_type;
+
+  //! Exception thrown if the lattice cannot be coloured as a checkerboard
+  class ExceptionOddExtension;
+
+  //! Creates a decomposition of the given lattice into the given number of subdomains (0 means one subdomain per available thread)
+  SpinLatticeDomainDecomposition(const lattice_type& lattice, unsigned int domain_number = 0, uint32_t seed = 0);
+  //! Destructor freeing the subdomains
+  ~SpinLatticeDomainDecomposition();
+
+  //! Get the number of subdomains
+  unsigned int get_domain_number() const { return domains.size(); }
+  //! Get the first row (first coordinate) of the given subdomain
+  unsigned int domain_begin(unsigned int domain) const { return domains[domain]->first_row; }
+  //! Get the number of rows of the given subdomain
+  unsigned int domain_extension(unsigned int domain) const { return domains[domain]->row_number; }
+
+  //! Set the seeds of the random number generators of the subdomains to the given seed plus the number of the subdomain
+  void set_seed(uint32_t seed);
+
+  //! Copy the spins of the given lattice into the subdomains
+  void scatter(const lattice_type& lattice);
+  //! Copy the spins of the subdomains into the given lattice
+  void gather(lattice_type& lattice) const;
+
+  //! Perform the given number of checkerboard Metropolis sweeps at the inverse temperature beta
+  void do_metropolis_sweeps(unsigned int sweep_number, double beta);
+
+  //! Calculate the energy of the decomposed lattice
+  double energy() const;
+  //! Calculate the magnetization of the decomposed lattice
+  double magnetization() const;
+
+private:
+  //! Structure storing the data of one subdomain, allocated by the owning thread
+  struct Domain
+  {
+    //! First row of the lattice belonging to the subdomain
+    unsigned int first_row;
+    //! Number of rows belonging to the subdomain
+    unsigned int row_number;
+    //! Spins of the subdomain, row 0 and row row_number + 1 are the ghost rows
+    std::vector<SpinType> spins;
+    //! Random number generator of the subdomain
+    RandomNumberGenerator rng;
+  };
+
+  //! Number of completed half-sweeps of a subdomain, padded on both sides so that it is alone in its cache line of 64 bytes (the heap does not guarantee an alignment to cache lines)
+  struct PhaseCounter
+  {
+    char padding_before[64];
+    int completed_phases;
+    char padding_after[64 - sizeof(int)];
+  };
+
+  //! Pointer to the original lattice, used for the couplings and fields
+  const lattice_type* lattice;
+  //! Subdomains
+  std::vector<Domain*> domains;
+  //! Counters of the completed half-sweeps of the subdomains, the neighbouring threads poll them while the owner updates its subdomain
+  std::vector<PhaseCounter> phase_counters;
+
+  //! Extensions of the lattice
+  unsigned int extensions[dimension];
+  //! Strides of the linear site index in every direction
+  unsigned int strides[dimension];
+  //! Parity of the coordinates 1 to dimension - 1 for every position in a row
+  std::vector<unsigned char> row_parities;
+
+  //! Copy constructor (not copyable)
+  SpinLatticeDomainDecomposition(const SpinLatticeDomainDecomposition&);
+  //! Assignment operator (not assignable)
+  SpinLatticeDomainDecomposition& operator=(const SpinLatticeDomainDecomposition&);
+
+  //! Number of sites in one row
+  unsigned int row_size() const { return strides[0]; }
+  //! Allocate and initialise the given subdomain
+  void create_domain(unsigned int domain, unsigned int domain_number, uint32_t seed);
+  //! Copy the rows of the subdomain and its ghost rows from the lattice
+  void scatter_domain(unsigned int domain, const lattice_type& lattice);
+  //! Update all sites of the given colour of a subdomain
+  void update_domain(unsigned int domain, unsigned int colour, double beta);
+  //! Copy the sites of the given colour from the neighbouring subdomains into the ghost rows
+  void exchange_halo(unsigned int domain, unsigned int colour);
+  //! Energy of the bonds to the upper neighbours and of the fields of the sites of a subdomain
+  double domain_energy(unsigned int domain) const;
+
+  //! Read the number of completed half-sweeps of a subdomain
+  int completed_phases(unsigned int domain) const;
+  //! Publish the number of completed half-sweeps of a subdomain
+  void set_completed_phases(unsigned int domain, int value);
+  //! Number of rounds a waiting thread polls the counter of a subdomain before it yields the processor
+  static const unsigned int spin_rounds = 64;
+  //! Wait until the subdomain has completed the given number of half-sweeps
+  void wait_for_phase(unsigned int domain, int phase) const;
+};
+
+template<unsigned int dimension, class SpinType, class RandomNumberGenerator, class InteractionType>
+class SpinLatticeDomainDecomposition<dimension, SpinType, RandomNumberGenerator, InteractionType>::ExceptionOddExtension : public std::invalid_argument
+{
+public:
+  ExceptionOddExtension() : std::invalid_argument("Domain decomposition with checkerboard updates needs even lattice extensions.") {}
+};
+
+} // of namespace Ising
+
+// Include the implementation
+#include "src/spin_lattice_domain_decomposition.cpp"
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef GESPINST_SPIN_LATTICE_EXCHANGE_HPP
+#define GESPINST_SPIN_LATTICE_EXCHANGE_HPP
+
+#include "spin_lattice.hpp"
+#include "spin_lattice_exchange_step.hpp"
+
+#include <vector>
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/split_member.hpp>
+
+namespace Gespinst
+{
+/*!
+ * \brief Class template for a spin lattice with conserved order parameter (Kawasaki dynamics).
+ * \author Benedikt Krüger
+ * \details The lattice proposes SpinLatticeExchangeStep objects that swap the spins of two unlike next neighbours instead of flipping single spins. To propose only steps that change the configuration, the lattice keeps a list of all unlike bonds that is updated in constant time whenever a step is commited. Each site has one bond to the upper neighbour in every direction, the bond with index i connects the site i / dimension with its upper neighbour in the direction i % dimension. Sites are indexed linearly in the storage order of the underlying spin array (see SpinLatticeBase::site_spin).
+ *
+ * Single spin flips (e.g. from all_steps()) or changes with set_spin() bypass the bookkeeping of the unlike bonds, after such changes initialise_unlike_bonds() must be called.
+ */
+template<unsigned int dimension, class SpinType>
+class SpinLatticeExchange : public SpinLattice<dimension, SpinType>
+{
+private:
+  typedef SpinLattice<dimension, SpinType> Base;
+
+  //! List of the indices of all bonds connecting unlike spins
+  std::vector<unsigned int> unlike_bonds;
+  //! Position of each bond in the list of unlike bonds, -1 if the bond connects equal spins
+  std::vector<int> unlike_bond_positions;
+
+  //! Insert the bond into or remove the bond from the list of unlike bonds according to the current spins
+  void update_unlike_bond(unsigned int bond);
+  //! Update the unlike bond list for all bonds of the given site
+  void update_unlike_bonds_of_site(unsigned int site);
+
+  //! Member variable for boost serialization
+  friend class boost::serialization::access;
+  //! Save the spin lattice, the unlike bonds are not saved (omitted version name to avoid unused parameter warnings)
+  template<class Archive> void save(Archive & ar, const unsigned int) const
+  {
+    ar & boost::serialization::base_object<Base>(*this);
+  }
+  //! Load the spin lattice and rebuild the unlike bonds from the loaded spins (omitted version name to avoid unused parameter warnings)
+  template<class Archive> void load(Archive & ar, const unsigned int)
+  {
+    ar & boost::serialization::base_object<Base>(*this);
+    initialise_unlike_bonds();
+  }
+  BOOST_SERIALIZATION_SPLIT_MEMBER()
+
+public:
+  //! Default constructor
+  SpinLatticeExchange() : Base() {}
+  //! Constructor with optional default value
+  SpinLatticeExchange(std::vector<unsigned int> lattice_extension, SpinType default_spin = SpinType()) : Base(lattice_extension, default_spin) { initialise_unlike_bonds(); }
+  //! Constructor converting a spin lattice
+  SpinLatticeExchange(const Base& other) : Base(other) { initialise_unlike_bonds(); }
+  //! Copy constructor
+  SpinLatticeExchange(const SpinLatticeExchange<dimension, SpinType>& other) : Base(other), unlike_bonds(other.unlike_bonds), unlike_bond_positions(other.unlike_bond_positions) {}
+
+  //! Assignment operator
+  SpinLatticeExchange<dimension, SpinType>& operator=(const SpinLatticeExchange<dimension, SpinType>& other);
+
+  //! Rebuild the list of unlike bonds from the current spins
+  void initialise_unlike_bonds();
+  //! Get the number of bonds connecting unlike spins
+  unsigned int unlike_bond_number() const { return unlike_bonds.size(); }
+
+  //! Get the linear index of the first site of a bond
+  unsigned int bond_first_site(unsigned int bond) const { return bond / dimension; }
+  //! Get the linear index of the second site of a bond
+  unsigned int bond_second_site(unsigned int bond) const { return this->upper_neighbour_site(bond / dimension, bond % dimension); }
+
+  //! Commit and execute a given exchange step
+  void commit(SpinLatticeExchangeStep<dimension, SpinType>& step_to_commit);
+
+  //! Propose a step given a random double number
+  SpinLatticeExchangeStep<dimension, SpinType> propose_step(double random_double);
+  //! Propose a step given a random number generator
+  template<class RandomNumberGenerator> SpinLatticeExchangeStep<dimension, SpinType> propose_step(RandomNumberGenerator* rng);
+};
+
+} // of namespace Ising
+
+// Include the implementation
+#include "src/spin_lattice_exchange.cpp"
+
+#endif
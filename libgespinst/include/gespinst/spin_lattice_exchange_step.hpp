@@ -0,0 +1,76 @@
+#ifndef GESPINST_SPIN_LATTICE_EXCHANGE_STEP_HPP
+#define GESPINST_SPIN_LATTICE_EXCHANGE_STEP_HPP
+
+namespace Gespinst
+{
+
+template<unsigned int T, class V> class SpinLatticeExchange;
+
+/*!
+ * \brief Class template for a Kawasaki step exchanging two unlike next-neighbour spins of a SpinLatticeExchange.
+ * \author Benedikt Krüger
+ * \details The step is defined by a bond of the lattice, i.e. a site and one of its upper neighbours. Executing the step swaps the spins at the two ends of the bond, so the order parameter (e.g. the magnetization) is conserved. The energy difference and the change of the number of unlike bonds are calculated in a single pass over the neighbours of the two sites and cached, the latter one is needed for the selection probability factor of the step.
+ */
+template<unsigned int dimension, class SpinType>
+class SpinLatticeExchangeStep
+{
+private:
+  //! Pointer to the lattice
+  SpinLatticeExchange<dimension, SpinType>* _lattice;
+  //! Index of the bond whose spins are exchanged
+  unsigned int _bond;
+  //! Linear index of the first site of the bond
+  unsigned int _first_site;
+  //! Linear index of the second site of the bond
+  unsigned int _second_site;
+  //! Creation simulation time of the step
+  int _creation_simulation_time;
+
+  //! Flag indicating whether the energy difference and the unlike bond difference were already calculated
+  bool _differences_calculated;
+  //! Cached energy difference of the step
+  double _delta_E;
+  //! Cached difference of the number of unlike bonds caused by the step
+  int _delta_unlike_bonds;
+
+  //! Calculate the energy difference and the unlike bond difference in one pass over the neighbours
+  void calculate_differences();
+
+public:
+  //! Creates a new step exchanging the spins at the ends of the given bond
+  SpinLatticeExchangeStep(SpinLatticeExchange<dimension, SpinType>* lattice, unsigned int bond);
+
+  //! Get-Accessor for the lattice
+  SpinLatticeExchange<dimension, SpinType>* get_lattice() const { return _lattice; }
+  //! Get-accessor for the index of the exchanged bond
+  unsigned int get_bond() const { return _bond; }
+  //! Get-accessor for the linear index of the first site
+  unsigned int get_first_site() const { return _first_site; }
+  //! Get-accessor for the linear index of the second site
+  unsigned int get_second_site() const { return _second_site; }
+  //! Get-accessor for the creation simulation time of the step
+  int get_creation_simulation_time() const { return _creation_simulation_time; }
+
+  //! Function to calculate the energy difference of the step
+  double delta_E();
+  //! Function to calculate the difference of the number of unlike bonds caused by the step
+  int delta_unlike_bonds();
+
+  //! Specify whether the step is executable, i.e. whether the two spins differ
+  bool is_executable();
+
+  //! Function to execute the step
+  void execute();
+
+  //! Selection probability factor, ratio of the number of unlike bonds after and before the step
+  double selection_probability_factor();
+
+  //! Revert the step after it has been executed
+  void undo();
+};
+
+} // of namespace Ising
+
+#include "src/spin_lattice_exchange_step.cpp"
+
+#endif
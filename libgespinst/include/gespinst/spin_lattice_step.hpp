@@ -4,12 +4,14 @@
 #include <vector>
 #include "boost/multi_array.hpp"
 
+#include "interactions/uniform_interaction.hpp"
+
 namespace Gespinst
 {
 
-template<unsigned int T, class V> class SpinLattice;
+template<unsigned int T, class V, class I> class SpinLattice;
 
-template<unsigned int dimension, class SpinType>
+template<unsigned int dimension, class SpinType, class InteractionType = Interactions::UniformInteraction>
 class SpinLatticeStep
 {
   typedef boost::multi_array<SpinType, dimension> lattice_array_type;
@@ -18,7 +20,7 @@ class SpinLatticeStep
 
 private:
   //! Pointer to the lattice
-  SpinLattice<dimension, SpinType>* _lattice;
+  SpinLattice<dimension, SpinType, InteractionType>* _lattice;
   //! Index of the spin to flip in the ising lattice
   index_type _flip_index;
   //! Creation simulation time of the flip
@@ -31,10 +33,10 @@ private:
 
 public:
   //! Creates a new step
-  SpinLatticeStep(SpinLattice<dimension, SpinType>* lattice, index_type flip_index, SpinType new_spin);
+  SpinLatticeStep(SpinLattice<dimension, SpinType, InteractionType>* lattice, index_type flip_index, SpinType new_spin);
 
   //! Get-Accessor for the lattice
-  SpinLattice<dimension, SpinType>* get_lattice() const { return _lattice; }
+  SpinLattice<dimension, SpinType, InteractionType>* get_lattice() const { return _lattice; }
   //! Get-accessor for the index
   index_type get_flip_index() const { return _flip_index; }
   //! Get-accessor for the old spin value
@@ -0,0 +1,174 @@
+#ifndef GESPINST_SPIN_LATTICE_STRUCTURE_FACTOR_HPP
+#define GESPINST_SPIN_LATTICE_STRUCTURE_FACTOR_HPP
+
+#include "spin_lattice.hpp"
+#include "spins/potts_spin.hpp"
+
+#include <vector>
+#include <complex>
+#include <stdexcept>
+
+namespace Gespinst
+{
+/*!
+ * \brief Traits class giving the components of the spin field used for the structure factor and the Fourier modes.
+ * \author Benedikt Krüger
+ * \details The default is a scalar field with the single component SpinType::get_value(). Spin types whose value is only a label of the state (e.g. Potts spins) specialise the class, so that the correlations do not depend on the numbering of the states.
+ */
+template<class SpinType>
+struct SpinFieldComponents
+{
+  //! Number of components of the field of the given spin
+  static unsigned int component_number(const SpinType&) { return 1; }
+  //! Value of the given component of the field of the spin
+  static double component(const SpinType& spin, unsigned int) { return spin.get_value(); }
+};
+
+/*!
+ * \details A Potts spin with q states is represented by the q components \f$ \delta_{s,a} - 1/q \f$ for \f$ a = 0, \dots, q-1 \f$. The product of the fields of two spins is \f$ \delta_{s,s'} - 1/q \f$, so the correlation function is \f$ G(r) = \frac{1}{N} \sum_x (\delta_{s_x,s_{x+r}} - 1/q) \f$ and vanishes for uncorrelated spins.
+ */
+template<>
+struct SpinFieldComponents<PottsSpin>
+{
+  //! Number of states of the spin
+  static unsigned int component_number(const PottsSpin& spin) { return spin.get_max_value() + 1; }
+  //! Component \f$ \delta_{s,a} - 1/q \f$ of the field of the spin
+  static double component(const PottsSpin& spin, unsigned int a) { return (spin.get_value() == a ? 1.0 : 0.0) - 1.0/(spin.get_max_value() + 1); }
+};
+
+/*!
+ * \brief Class template for the structure factor and the spin-spin correlation function of a SpinLattice calculated with a fast Fourier transform.
+ * \author Benedikt Krüger
+ * \details The spin field \f$ s_x \f$ is given by SpinFieldComponents, which is SpinType::get_value() for scalar spins (as for the field term of the energy). Its Fourier transform is \f$ \hat{s}(k) = \sum_x s_x e^{-i k x} \f$ and the structure factor is \f$ S(k) = |\hat{s}(k)|^2 / N \f$, summed over the components of the field, for all wave vectors \f$ k_d = 2 \pi n_d / L_d \f$ of the lattice. The values are stored in the order of the linear site index, i.e. the value for \f$ (n_0, \dots, n_{d-1}) \f$ is found at the linear index of the site with these coordinates. The correlation function \f$ G(r) = \frac{1}{N} \sum_x s_x \cdot s_{x+r} \f$ follows from the inverse transform of the structure factor.
+ *
+ * The multi-dimensional transform is done line by line in every direction. For every direction a plan with the twiddle factors (and the bit reversal for extensions that are powers of two) is created in the constructor, extensions that are powers of two are transformed with the radix-2 algorithm, other extensions with the direct sum. The plans and the buffers are reused for all measurements, so an object should be kept for the whole simulation. Fields with several components are transformed once per component. The cost of a measurement is \f$ O(N \log N) \f$ for extensions that are powers of two instead of \f$ O(N^2) \f$ for the direct evaluation.
+ */
+template<unsigned int dimension, class SpinType, class InteractionType = Interactions::UniformInteraction>
+class SpinLatticeStructureFactor
+{
+public:
+  //! Type of the lattice
+  typedef SpinLattice<dimension, SpinType, InteractionType> lattice_type;
+
+  //! Create the plans and buffers for lattices with the extensions of the given lattice
+  SpinLatticeStructureFactor(const lattice_type& lattice);
+
+  //! Get the number of sites of the lattices
+  unsigned int system_size() const { return site_number; }
+  //! Get the extension of the lattices in the given direction
+  unsigned int extension(unsigned int dim) const { return plans[dim].length; }
+
+  //! Calculate the structure factor of the given lattice for all wave vectors
+  const std::vector<double>& structure_factor(const lattice_type& lattice);
+  //! Calculate the spin-spin correlation function of the given lattice for all distances
+  const std::vector<double>& correlation_function(const lattice_type& lattice);
+  //! Calculate the second moment correlation length of the given lattice, averaged over the directions
+  double second_moment_correlation_length(const lattice_type& lattice);
+
+  //! Calculate the second moment correlation length from the structure factor at zero and at the smallest non-zero wave vector of a direction with the given extension
+  static double second_moment_correlation_length(double structure_factor_zero, double structure_factor_minimal, unsigned int extension);
+
+private:
+  //! Plan of the Fourier transform in one direction
+  struct Plan
+  {
+    //! Number of sites in the direction
+    unsigned int length;
+    //! Stride of the linear site index in the direction
+    unsigned int stride;
+    //! Whether the length is a power of two and the radix-2 algorithm is used
+    bool power_of_two;
+    //! Twiddle factors \f$ e^{-2 \pi i j / L} \f$
+    std::vector<std::complex<double> > twiddles;
+    //! Bit-reversed indices for the radix-2 algorithm
+    std::vector<unsigned int> bit_reversal;
+  };
+
+  //! Number of sites
+  unsigned int site_number;
+  //! Plans for all directions
+  Plan plans[dimension];
+  //! Buffer for the transformed field
+  std::vector<std::complex<double> > field;
+  //! Buffer for one line of the field
+  std::vector<std::complex<double> > line;
+  //! Buffer for the direct transform of one line
+  std::vector<std::complex<double> > line_result;
+  //! Buffer for the structure factor
+  std::vector<double> structure_factor_values;
+  //! Buffer for the correlation function
+  std::vector<double> correlation_values;
+
+  //! Check that the lattice has the extensions of the plans
+  void check_lattice(const lattice_type& lattice) const;
+  //! Transform the field in all directions, inverse transforms use the positive sign and are not normalised
+  void transform(bool inverse);
+  //! Transform the line buffer with the plan of the given direction
+  void transform_line(const Plan& plan, bool inverse);
+};
+
+/*!
+ * \brief Class template for the incremental tracking of the Fourier modes of a SpinLattice at zero and at the smallest non-zero wave vectors.
+ * \author Benedikt Krüger
+ * \details The modes \f$ \hat{s}(0) \f$ and \f$ \hat{s}(2 \pi e_d / L_d) \f$ for every direction d are calculated once in \f$ O(N) \f$ and updated in \f$ O(d) \f$ for every changed spin with precomputed phase factors. This gives the second moment correlation length after every step without a Fourier transform of the whole lattice. The modes are tracked for every component of the spin field given by SpinFieldComponents. The modes are only valid if every executed step is passed to update (e.g. in the step handler of the simulation), otherwise initialise has to be called again. Rounding errors accumulate slowly, for long simulations the modes should be reinitialised from time to time.
+ */
+template<unsigned int dimension, class SpinType, class InteractionType = Interactions::UniformInteraction>
+class SpinLatticeFourierModes
+{
+public:
+  //! Type of the lattice
+  typedef SpinLattice<dimension, SpinType, InteractionType> lattice_type;
+  //! Type of the steps of the lattice
+  typedef SpinLatticeStep<dimension, SpinType, InteractionType> step_type;
+
+  //! Create the phase factors for the extensions of the given lattice and calculate the modes of the lattice
+  SpinLatticeFourierModes(const lattice_type& lattice);
+
+  //! Calculate the modes of the given lattice
+  void initialise(const lattice_type& lattice);
+  //! Update the modes after the spin value at the given linear site index has changed, only for spin fields with a single component
+  void update(unsigned int site, double old_value, double new_value);
+  //! Update the modes after the spin at the given linear site index has changed
+  void update(unsigned int site, const SpinType& old_spin, const SpinType& new_spin);
+  //! Update the modes after the given step has been executed
+  void update(const step_type& executed_step);
+
+  //! Get the number of components of the spin field
+  unsigned int get_component_number() const { return component_number; }
+  //! Get the Fourier mode of the given component at zero wave vector (the magnetization for scalar spins)
+  std::complex<double> mode_zero(unsigned int component = 0) const { return modes[component*(dimension + 1)]; }
+  //! Get the Fourier mode of the given component at the smallest non-zero wave vector in the given direction
+  std::complex<double> mode_minimal(unsigned int dim, unsigned int component = 0) const { return modes[component*(dimension + 1) + dim + 1]; }
+  //! Get the structure factor at zero wave vector
+  double structure_factor_zero() const { return summed_norm(0) / site_number; }
+  //! Get the structure factor at the smallest non-zero wave vector in the given direction
+  double structure_factor_minimal(unsigned int dim) const { return summed_norm(dim + 1) / site_number; }
+  //! Calculate the second moment correlation length, averaged over the directions
+  double second_moment_correlation_length() const;
+
+private:
+  //! Number of sites
+  unsigned int site_number;
+  //! Extensions of the lattice
+  unsigned int extensions[dimension];
+  //! Strides of the linear site index in every direction
+  unsigned int strides[dimension];
+  //! Phase factors \f$ e^{-2 \pi i x / L_d} \f$ for all coordinates of every direction
+  std::vector<std::complex<double> > phases[dimension];
+  //! Number of components of the spin field
+  unsigned int component_number;
+  //! For every component the mode at zero wave vector followed by the modes at the smallest wave vectors of all directions
+  std::vector<std::complex<double> > modes;
+
+  //! Add the change of a component at the given linear site index to the modes of the component
+  void update_component(unsigned int site, unsigned int component, double difference);
+  //! Sum of the squared absolute values of the given mode over all components
+  double summed_norm(unsigned int mode) const;
+};
+
+} // of namespace Gespinst
+
+// Include the implementation
+#include "src/spin_lattice_structure_factor.cpp"
+
+#endif
@@ -53,6 +53,10 @@ namespace Gespinst
 
     //! Create a vector with all present possible steps
     std::vector<SpinNetworkStep<SpinType, ContainerType> > all_steps();
+    //! Create a vector with all present possible steps at the given index
+    std::vector<SpinNetworkStep<SpinType, ContainerType> > all_steps(index_type index);
+    //! Get the indices of the next neighbours of the spin at the given index
+    std::vector<index_type> neighbour_sites(index_type index) const;
     
     //! Commit and execute a given step
     void commit(SpinNetworkStep<SpinType, ContainerType>& step_to_commit);
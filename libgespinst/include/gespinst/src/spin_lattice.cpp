@@ -7,10 +7,10 @@
 namespace Gespinst
 {
 
-template<unsigned int dimension, class SpinType, class Derived>
-typename SpinLatticeBase<dimension, SpinType, Derived>::index_type SpinLatticeBase<dimension, SpinType, Derived>::to_boost_array(std::vector<unsigned int> coordinates)
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+typename SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::index_type SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::to_boost_array(std::vector<unsigned int> coordinates)
 {
-  SpinLatticeBase<dimension, SpinType, Derived>::index_type result;
+  SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::index_type result;
   for (unsigned int d = 0; d < dimension; d++) result[d] = coordinates[d];
   return result;
 }
@@ -18,8 +18,8 @@ typename SpinLatticeBase<dimension, SpinType, Derived>::index_type SpinLatticeBa
  * \details Converts an integer (between 0 and the the number of lattice sites) to a correct index.
  * \param i Integer to convert
  */
-template<unsigned int dimension, class SpinType, class Derived>
-typename SpinLatticeBase<dimension, SpinType, Derived>::index_type SpinLatticeBase<dimension, SpinType, Derived>::int_to_index(unsigned int i) const
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+typename SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::index_type SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::int_to_index(unsigned int i) const
 {
   // Calculate the coordinates of the point
   index_type coordinates;
@@ -34,10 +34,10 @@ typename SpinLatticeBase<dimension, SpinType, Derived>::index_type SpinLatticeBa
 /*!
  * \details Construct an empty SpinLatticeBase (for reloading serialized stuff)
  */
-template<unsigned int dimension, class SpinType, class Derived>
-SpinLatticeBase<dimension, SpinType, Derived>::SpinLatticeBase()
-  : _simulation_time(0),
-    spin_lattice()
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::SpinLatticeBase()
+  : spin_lattice(),
+    _simulation_time(0)
 {
   // ToDo: Check lattice_extension size with the dimension
 }
@@ -47,11 +47,13 @@ SpinLatticeBase<dimension, SpinType, Derived>::SpinLatticeBase()
  * \param lattice_extension A STL vector of integers giving the extension of the lattice for each dimension. The size of the vector must match the dimension, the integers mustn't be zero or negative.
  * \param default_spin Default value for all spins
  */
-template<unsigned int dimension, class SpinType, class Derived>
-SpinLatticeBase<dimension, SpinType, Derived>::SpinLatticeBase(std::vector<unsigned int> lattice_extension, SpinType default_spin)
-  : _simulation_time(0),
-    spin_lattice(to_boost_array(lattice_extension))
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::SpinLatticeBase(std::vector<unsigned int> lattice_extension, SpinType default_spin)
+  : spin_lattice(to_boost_array(lattice_extension)),
+    _simulation_time(0)
 {
+  interaction.resize(spin_lattice.num_elements(), dimension);
+
   for (SpinType* spin = spin_lattice.data();
        spin != (spin_lattice.data() + spin_lattice.num_elements()); ++spin)
   {
@@ -63,9 +65,10 @@ SpinLatticeBase<dimension, SpinType, Derived>::SpinLatticeBase(std::vector<unsig
  * \details Constructs by copying another SpinLatticeBase with the same dimension and the same SpinType. The dimension and the spin type used is given as a template parameter. 
  * \param other SpinLatticeBase to copy
  */
-template<unsigned int dimension, class SpinType, class Derived>
-SpinLatticeBase<dimension, SpinType, Derived>::SpinLatticeBase(const SpinLatticeBase<dimension, SpinType, Derived>& other)
-  : _simulation_time(0)
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::SpinLatticeBase(const SpinLatticeBase<dimension, SpinType, Derived, InteractionType>& other)
+  : _simulation_time(0),
+    interaction(other.interaction)
 { 
   // Get the extension of the multi array
   std::vector<size_t> ex;
@@ -77,19 +80,19 @@ SpinLatticeBase<dimension, SpinType, Derived>::SpinLatticeBase(const SpinLattice
   spin_lattice = other.spin_lattice;
 }
 
-template<unsigned int dimension, class SpinType, class Derived>
-SpinType SpinLatticeBase<dimension, SpinType, Derived>::get_spin(index_type coordinates) const
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+SpinType SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::get_spin(index_type coordinates) const
 {
   return spin_lattice(coordinates);
 }
-template<unsigned int dimension, class SpinType, class Derived>
-void SpinLatticeBase<dimension, SpinType, Derived>::set_spin(index_type coordinates, SpinType value)
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+void SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::set_spin(index_type coordinates, SpinType value)
 {
   spin_lattice(coordinates) = value;
 }
 
-template<unsigned int dimension, class SpinType, class Derived>
-SpinLatticeBase<dimension, SpinType, Derived>& SpinLatticeBase<dimension, SpinType, Derived>::operator=(const SpinLatticeBase<dimension, SpinType, Derived>& other)
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+SpinLatticeBase<dimension, SpinType, Derived, InteractionType>& SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::operator=(const SpinLatticeBase<dimension, SpinType, Derived, InteractionType>& other)
 {
   // Check for self-assignment
   if (this == &other)
@@ -98,28 +101,29 @@ SpinLatticeBase<dimension, SpinType, Derived>& SpinLatticeBase<dimension, SpinTy
   // Do the copy
   spin_lattice = other.spin_lattice;
   _simulation_time = other._simulation_time;
+  interaction = other.interaction;
 
   // Return the existing object
   return *this;
 }
-template<unsigned int dimension, class SpinType, class Derived>
-bool SpinLatticeBase<dimension, SpinType, Derived>::operator==(const SpinLatticeBase<dimension, SpinType, Derived>& other) const
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+bool SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::operator==(const SpinLatticeBase<dimension, SpinType, Derived, InteractionType>& other) const
 {
-  return spin_lattice == other.spin_lattice;
+  return (spin_lattice == other.spin_lattice) && (interaction == other.interaction);
 }
-template<unsigned int dimension, class SpinType, class Derived>
-bool SpinLatticeBase<dimension, SpinType, Derived>::operator!=(const SpinLatticeBase<dimension, SpinType, Derived>& other) const
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+bool SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::operator!=(const SpinLatticeBase<dimension, SpinType, Derived, InteractionType>& other) const
 {
-  return spin_lattice != other.spin_lattice;
+  return !operator==(other);
 }
 
 /*! 
  * \details Creates a STL vector of SpinLatticeStep objects representing all steps that can be done in the lattice. For each lattice site there are the flips from the present value of the spin to all other values of the spin.
  */
-template<unsigned int dimension, class SpinType, class Derived>
-std::vector<SpinLatticeStep<dimension, SpinType> > SpinLatticeBase<dimension, SpinType, Derived>::all_steps()
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+std::vector<SpinLatticeStep<dimension, SpinType, InteractionType> > SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::all_steps()
 {
-  std::vector<SpinLatticeStep<dimension, SpinType> > result;
+  std::vector<SpinLatticeStep<dimension, SpinType, InteractionType> > result;
   // Go through all lattice sites and through every differing spin
   // Add the resulting step to the result vector
   for (unsigned int i = 0; i < spin_lattice.num_elements(); i++)
@@ -131,7 +135,7 @@ std::vector<SpinLatticeStep<dimension, SpinType> > SpinLatticeBase<dimension, Sp
     {
       if (*new_spin != spin_lattice(step_index))
       {
-	result.push_back(SpinLatticeStep<dimension, SpinType>(static_cast<Derived*>(this), step_index, *new_spin));
+	result.push_back(SpinLatticeStep<dimension, SpinType, InteractionType>(static_cast<Derived*>(this), step_index, *new_spin));
       }
     }
   }
@@ -139,12 +143,34 @@ std::vector<SpinLatticeStep<dimension, SpinType> > SpinLatticeBase<dimension, Sp
   return result;
 }
 
+/*! 
+ * \details Creates a STL vector of SpinLatticeStep objects representing the flips from the present value of the spin at the given site to all other values of the spin.
+ * \param site Linear index of the site (between 0 and the number of lattice sites)
+ */
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+std::vector<SpinLatticeStep<dimension, SpinType, InteractionType> > SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::all_steps(unsigned int site)
+{
+  std::vector<SpinLatticeStep<dimension, SpinType, InteractionType> > result;
+  index_type step_index = int_to_index(site);
+  std::vector<SpinType> new_spins = spin_lattice(step_index).all_possible_values();
+  for (typename std::vector<SpinType>::iterator new_spin = new_spins.begin();
+       new_spin != new_spins.end(); ++new_spin)
+  {
+    if (*new_spin != spin_lattice(step_index))
+    {
+      result.push_back(SpinLatticeStep<dimension, SpinType, InteractionType>(static_cast<Derived*>(this), step_index, *new_spin));
+    }
+  }
+
+  return result;
+}
+
 /*!
  * \details Updates the spin lattice with the given spin. After the update the simulation time is increase by one. If the creation simulation time of the step does not match the actual simulation time of the spin lattice, an exception will be thrown (to be implemented).
  * \param step_to_commit A valid step that should update the spin lattice.
  */
-template<unsigned int dimension, class SpinType, class Derived>
-void SpinLatticeBase<dimension, SpinType, Derived>::commit(SpinLatticeStep<dimension, SpinType>& step_to_commit)
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+void SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::commit(SpinLatticeStep<dimension, SpinType, InteractionType>& step_to_commit)
 {
   // ToDo: Check for the right simulation time
   
@@ -154,36 +180,47 @@ void SpinLatticeBase<dimension, SpinType, Derived>::commit(SpinLatticeStep<dimen
 }
 
 /*! 
- * \details Calculates the energy of the lattice by summing over all next-neighbour pairs and returning the negative value of the product of the pairs.
+ * \details Calculates the energy of the lattice by summing over all next-neighbour pairs and returning the negative value of the product of the pairs weighted with the couplings, minus the sum of the spin values weighted with the fields. Every bond is visited once as the bond between a site and its upper neighbour.
+ *
+ * The bonds are summed direction by direction in storage order without computing the neighbours of the sites: In direction d with stride s and extension L the sites form blocks of L*s consecutive sites. In a block, the upper neighbour of the first (L-1)*s sites is s sites further, the upper neighbour of the last s sites is (L-1)*s sites back (periodic boundary conditions). So both loops read the spins and the couplings of the direction contiguously.
  */
-template<unsigned int dimension, class SpinType, class Derived>
-double SpinLatticeBase<dimension, SpinType, Derived>::energy() const
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+double SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::energy() const
 {
   double result = 0;
 
-  // Go through all points
-  for (unsigned int i = 0; i < spin_lattice.num_elements(); i++)
+  const SpinType* spins = spin_lattice.data();
+  const unsigned int site_number = spin_lattice.num_elements();
+  for (unsigned int d = 0; d < dimension; d++)
   {
-    // Calculate the energy using the next neighbours
-    SpinType this_spin = get_spin(int_to_index(i));
-    std::vector<SpinType> neighbours = next_neighbours(int_to_index(i));
-    for (typename std::vector<SpinType>::iterator neighbour = neighbours.begin();
-	 neighbour != neighbours.end(); ++neighbour)
+    const unsigned int stride = spin_lattice.strides()[d];
+    const unsigned int block_size = spin_lattice.shape()[d]*stride;
+    const unsigned int inner_size = block_size - stride;
+    for (unsigned int block = 0; block < site_number; block += block_size)
     {
-      result += - (this_spin * (*neighbour));
+      // Bonds inside the block
+      for (unsigned int site = block; site < block + inner_size; site++)
+	result -= interaction.coupling(site, d) * (spins[site] * spins[site + stride]);
+      // Bonds across the periodic boundary to the first layer of the block
+      for (unsigned int site = block + inner_size; site < block + block_size; site++)
+	result -= interaction.coupling(site, d) * (spins[site] * spins[site - inner_size]);
     }
   }
+  if (Interactions::HasField<InteractionType>::value)
+  {
+    for (unsigned int site = 0; site < site_number; site++)
+      result -= interaction.field(site) * spins[site].get_value();
+  }
 
-  // Factor of 0.5 because energy is defined over all pairs of next neighbours, we count every pair twice
-  return 0.5*result;
+  return result;
 }
 
 /*! 
  * \param dim Number of the dimension which size should be returned
  * \returns The size of the lattice in the specified direction if dim < dimension, otherwise 0
  */
-template<unsigned int dimension, class SpinType, class Derived>
-unsigned int SpinLatticeBase<dimension, SpinType, Derived>::extension(unsigned int dim) const
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+unsigned int SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::extension(unsigned int dim) const
 {
   if (dim >= dimension) 
     return 0;
@@ -194,8 +231,8 @@ unsigned int SpinLatticeBase<dimension, SpinType, Derived>::extension(unsigned i
 /*! 
  * \details Calculates the magnetization of the lattice by summing over all spins and returning the sum of their values
  */
-template<unsigned int dimension, class SpinType, class Derived>
-double SpinLatticeBase<dimension, SpinType, Derived>::magnetization() const
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+double SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::magnetization() const
 {
   double result = 0;
 
@@ -212,8 +249,8 @@ double SpinLatticeBase<dimension, SpinType, Derived>::magnetization() const
  * \details Returns a STL vector of spins that are the next neighbours of the spin at the given coordinates.
  * \param coordinates Index of the spin of which the next neighbours will be calculated.
  */
-template<unsigned int dimension, class SpinType, class Derived>
-std::vector<SpinType> SpinLatticeBase<dimension, SpinType, Derived>::next_neighbours(index_type coordinates) const
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+std::vector<SpinType> SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::next_neighbours(index_type coordinates) const
 {
   std::vector<SpinType> result;
 
@@ -252,8 +289,8 @@ std::vector<SpinType> SpinLatticeBase<dimension, SpinType, Derived>::next_neighb
  * \details Proposes a step based on a given random number between 0 and 1. The integer part of (random_number * number_of_sites) will be used for determining the index where the step or the spin flip should occur, the non-integer part will be used for determining to which new spin the old spin will be flipped.
  * \param rng Random number generator so that rng() gives a random number between 0 and 1
  */
-template<unsigned int dimension, class SpinType, class Derived>
-SpinLatticeStep<dimension, SpinType> SpinLatticeBase<dimension, SpinType, Derived>::propose_step(double random_double)
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+SpinLatticeStep<dimension, SpinType, InteractionType> SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::propose_step(double random_double)
 {
   // Use a random number for calculating a random int between 0 and the number of spins in the system
   double random_number_index = random_double*spin_lattice.num_elements();
@@ -268,7 +305,7 @@ SpinLatticeStep<dimension, SpinType> SpinLatticeBase<dimension, SpinType, Derive
   }
 
   // Create a step and return the step
-  return SpinLatticeStep<dimension, SpinType>(static_cast<Derived*>(this), // Pointer to the lattice of the step
+  return SpinLatticeStep<dimension, SpinType, InteractionType>(static_cast<Derived*>(this), // Pointer to the lattice of the step
 				   lattice_multiindex, // Index of the place to flip
 				   spin_lattice(lattice_multiindex).random_differ(random_number_index - lattice_index)); // new random spin value differing from the old value
 }
@@ -277,8 +314,8 @@ SpinLatticeStep<dimension, SpinType> SpinLatticeBase<dimension, SpinType, Derive
  * \details Proposes a step based on a given random number between 0 and 1. The integer part of (random_number * number_of_sites) will be used for determining the index where the step or the spin flip should occur, the non-integer part will be used for determining to which new spin the old spin will be flipped.
  * \param rng Random number generator so that rng() gives a random number between 0 and 1
  */
-template<unsigned int dimension, class SpinType, class Derived> template<class RandomNumberGenerator>
-SpinLatticeStep<dimension, SpinType> SpinLatticeBase<dimension, SpinType, Derived>::propose_step(RandomNumberGenerator* rng)
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType> template<class RandomNumberGenerator>
+SpinLatticeStep<dimension, SpinType, InteractionType> SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::propose_step(RandomNumberGenerator* rng)
 {
   // Use a random number for calculating a random int between 0 and the number of spins in the system
   double random_number_index = rng->random_double()*spin_lattice.num_elements();
@@ -293,13 +330,96 @@ SpinLatticeStep<dimension, SpinType> SpinLatticeBase<dimension, SpinType, Derive
   }
 
   // Create a step and return the step
-  return SpinLatticeStep<dimension, SpinType>(static_cast<Derived*>(this), // Pointer to the lattice of the step
+  return SpinLatticeStep<dimension, SpinType, InteractionType>(static_cast<Derived*>(this), // Pointer to the lattice of the step
 				   lattice_multiindex, // Index of the place to flip
 				   spin_lattice(lattice_multiindex).random_differ(rng->random_double())); // new random spin value differing from the old value
 }
 
-template<unsigned int dimension, class SpinType, class Derived>
-unsigned int SpinLatticeBase<dimension, SpinType, Derived>::system_size() const
+/*!
+ * \details Calculates the linear index of the neighbour with the coordinate in the given direction increased by one, using periodic boundary conditions.
+ * \param site Linear index of the site
+ * \param dim Direction of the neighbour
+ */
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+unsigned int SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::upper_neighbour_site(unsigned int site, unsigned int dim) const
+{
+  const unsigned int stride = spin_lattice.strides()[dim];
+  const unsigned int extension = spin_lattice.shape()[dim];
+  if ((site / stride) % extension == extension - 1)
+    return site - (extension - 1)*stride;
+  else
+    return site + stride;
+}
+
+/*!
+ * \details Calculates the linear index of the neighbour with the coordinate in the given direction decreased by one, using periodic boundary conditions.
+ * \param site Linear index of the site
+ * \param dim Direction of the neighbour
+ */
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+unsigned int SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::lower_neighbour_site(unsigned int site, unsigned int dim) const
+{
+  const unsigned int stride = spin_lattice.strides()[dim];
+  const unsigned int extension = spin_lattice.shape()[dim];
+  if ((site / stride) % extension == 0)
+    return site + (extension - 1)*stride;
+  else
+    return site - stride;
+}
+
+/*!
+ * \details Returns the linear indices of the 2*dimension next neighbours of a site, ordered as the spins returned by next_neighbours().
+ * \param site Linear index of the site
+ */
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+std::vector<unsigned int> SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::neighbour_sites(unsigned int site) const
+{
+  std::vector<unsigned int> result;
+  result.reserve(2*dimension);
+  for (unsigned int d = 0; d < dimension; d++)
+  {
+    result.push_back(upper_neighbour_site(site, d));
+    result.push_back(lower_neighbour_site(site, d));
+  }
+  return result;
+}
+
+/*!
+ * \param coordinates Coordinates of the site
+ * \returns Linear index of the site in the storage order of the lattice
+ */
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+unsigned int SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::site_index(index_type coordinates) const
+{
+  unsigned int result = 0;
+  for (unsigned int d = 0; d < dimension; d++)
+    result += coordinates[d]*spin_lattice.strides()[d];
+  return result;
+}
+
+/*!
+ * \details Calculates the part of the energy that depends on the spin at the given site, i.e. the energy of the 2*dimension bonds of the site and the field term of the site, assuming the site had the given spin. The energy difference of a spin flip is the difference of this energy for the new and the old spin.
+ * \param site Linear index of the site
+ * \param spin Spin assumed at the site
+ */
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+double SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::site_energy(unsigned int site, const SpinType& spin) const
+{
+  const SpinType* spins = spin_lattice.data();
+  double result = 0;
+  for (unsigned int d = 0; d < dimension; d++)
+  {
+    const unsigned int lower_site = lower_neighbour_site(site, d);
+    result -= interaction.coupling(site, d) * (spin * spins[upper_neighbour_site(site, d)]);
+    result -= interaction.coupling(lower_site, d) * (spin * spins[lower_site]);
+  }
+  if (Interactions::HasField<InteractionType>::value)
+    result -= interaction.field(site) * spin.get_value();
+  return result;
+}
+
+template<unsigned int dimension, class SpinType, class Derived, class InteractionType>
+unsigned int SpinLatticeBase<dimension, SpinType, Derived, InteractionType>::system_size() const
 {
   unsigned int result = 1;
   for (unsigned int d = 0; d < dimension; d++)
@@ -0,0 +1,369 @@
+#ifdef GESPINST_SPIN_LATTICE_DOMAIN_DECOMPOSITION_HPP
+
+#include <cmath>
+
+#include <sched.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace Gespinst
+{
+
+/*!
+ * \details Checks the extensions of the lattice, distributes the rows as evenly as possible on the subdomains and lets every thread of a parallel region allocate and initialise its own subdomain.
+ * \param lattice Lattice to decompose, must stay alive as long as the decomposition is used, because its couplings and fields are used
+ * \param domain_number Number of subdomains, if 0 the maximal number of OpenMP threads is used. At most one subdomain per row is created.
+ * \param seed Seed of the random number generators, the subdomain d uses the seed + d
+ */
+template<unsigned int dimension, class SpinType, class RandomNumberGenerator, class InteractionType>
+SpinLatticeDomainDecomposition<dimension, SpinType, RandomNumberGenerator, InteractionType>::SpinLatticeDomainDecomposition(const lattice_type& lattice, unsigned int domain_number, uint32_t seed)
+  : lattice(&lattice)
+{
+  // Extensions and strides of the lattice
+  for (unsigned int d = 0; d < dimension; d++)
+  {
+    extensions[d] = lattice.extension(d);
+    if (extensions[d] % 2 != 0) throw ExceptionOddExtension();
+  }
+  strides[dimension - 1] = 1;
+  for (int d = dimension - 2; d >= 0; d--)
+    strides[d] = strides[d + 1]*extensions[d + 1];
+
+  // Parities of the positions in a row
+  row_parities.resize(row_size());
+  for (unsigned int offset = 0; offset < row_size(); offset++)
+  {
+    unsigned int coordinate_sum = 0;
+    for (unsigned int d = 1; d < dimension; d++)
+      coordinate_sum += (offset / strides[d]) % extensions[d];
+    row_parities[offset] = coordinate_sum % 2;
+  }
+
+  // Number of the subdomains
+#ifdef _OPENMP
+  if (domain_number == 0) domain_number = omp_get_max_threads();
+#else
+  if (domain_number == 0) domain_number = 1;
+#endif
+  if (domain_number > extensions[0]) domain_number = extensions[0];
+  domains.assign(domain_number, 0);
+  phase_counters.resize(domain_number);
+
+  // Every thread creates its own subdomain
+#pragma omp parallel num_threads(domain_number)
+  {
+#ifdef _OPENMP
+    const unsigned int thread_number = omp_get_num_threads();
+    const unsigned int thread_id = omp_get_thread_num();
+#else
+    const unsigned int thread_number = 1;
+    const unsigned int thread_id = 0;
+#endif
+    for (unsigned int domain = thread_id; domain < domain_number; domain += thread_number)
+    {
+      create_domain(domain, domain_number, seed);
+      scatter_domain(domain, lattice);
+    }
+  }
+}
+
+template<unsigned int dimension, class SpinType, class RandomNumberGenerator, class InteractionType>
+SpinLatticeDomainDecomposition<dimension, SpinType, RandomNumberGenerator, InteractionType>::~SpinLatticeDomainDecomposition()
+{
+  for (typename std::vector<Domain*>::iterator domain = domains.begin(); domain != domains.end(); ++domain)
+    delete *domain;
+}
+
+template<unsigned int dimension, class SpinType, class RandomNumberGenerator, class InteractionType>
+void SpinLatticeDomainDecomposition<dimension, SpinType, RandomNumberGenerator, InteractionType>::create_domain(unsigned int domain, unsigned int domain_number, uint32_t seed)
+{
+  Domain* new_domain = new Domain;
+  new_domain->first_row = (domain*extensions[0]) / domain_number;
+  new_domain->row_number = ((domain + 1)*extensions[0]) / domain_number - new_domain->first_row;
+  new_domain->spins.resize((new_domain->row_number + 2)*row_size());
+  new_domain->rng.set_seed(seed + domain);
+  domains[domain] = new_domain;
+}
+
+template<unsigned int dimension, class SpinType, class RandomNumberGenerator, class InteractionType>
+void SpinLatticeDomainDecomposition<dimension, SpinType, RandomNumberGenerator, InteractionType>::scatter_domain(unsigned int domain, const lattice_type& lattice)
+{
+  Domain* this_domain = domains[domain];
+  for (unsigned int local_row = 0; local_row < this_domain->row_number + 2; local_row++)
+  {
+    const unsigned int row = (this_domain->first_row + local_row + extensions[0] - 1) % extensions[0];
+    for (unsigned int offset = 0; offset < row_size(); offset++)
+      this_domain->spins[local_row*row_size() + offset] = lattice.site_spin(row*row_size() + offset);
+  }
+}
+
+template<unsigned int dimension, class SpinType, class RandomNumberGenerator, class InteractionType>
+void SpinLatticeDomainDecomposition<dimension, SpinType, RandomNumberGenerator, InteractionType>::set_seed(uint32_t seed)
+{
+  for (unsigned int domain = 0; domain < domains.size(); domain++)
+    domains[domain]->rng.set_seed(seed + domain);
+}
+
+/*!
+ * \details Every subdomain is filled by the thread that owns it, the lattice must have the same extensions as the decomposed lattice.
+ * \param lattice Lattice with the new spins
+ */
+template<unsigned int dimension, class SpinType, class RandomNumberGenerator, class InteractionType>
+void SpinLatticeDomainDecomposition<dimension, SpinType, RandomNumberGenerator, InteractionType>::scatter(const lattice_type& lattice)
+{
+  const int domain_number = domains.size();
+#pragma omp parallel for num_threads(domain_number) schedule(static, 1)
+  for (int domain = 0; domain < domain_number; domain++)
+    scatter_domain(domain, lattice);
+}
+
+/*!
+ * \param lattice Lattice with the same extensions as the decomposed lattice, that gets the spins of the subdomains
+ */
+template<unsigned int dimension, class SpinType, class RandomNumberGenerator, class InteractionType>
+void SpinLatticeDomainDecomposition<dimension, SpinType, RandomNumberGenerator, InteractionType>::gather(lattice_type& lattice) const
+{
+  for (unsigned int domain = 0; domain < domains.size(); domain++)
+  {
+    const Domain* this_domain = domains[domain];
+    for (unsigned int local_row = 1; local_row <= this_domain->row_number; local_row++)
+    {
+      const unsigned int row = this_domain->first_row + local_row - 1;
+      for (unsigned int offset = 0; offset < row_size(); offset++)
+	lattice.set_site_spin(row*row_size() + offset, this_domain->spins[local_row*row_size() + offset]);
+    }
+  }
+}
+
+/*!
+ * \details Goes through all sites of the given colour in the rows of the subdomain and performs a Metropolis update of every site. The neighbours in the first direction are taken from the rows above and below (the ghost rows at the boundaries), the neighbours in the other directions are in the same row. The couplings and fields are addressed by the linear site index of the lattice.
+ */
+template<unsigned int dimension, class SpinType, class RandomNumberGenerator, class InteractionType>
+void SpinLatticeDomainDecomposition<dimension, SpinType, RandomNumberGenerator, InteractionType>::update_domain(unsigned int domain, unsigned int colour, double beta)
+{
+  Domain* this_domain = domains[domain];
+  SpinType* spins = &this_domain->spins[0];
+  const InteractionType& interaction = lattice->get_interaction();
+  const unsigned int size = row_size();
+
+  for (unsigned int local_row = 1; local_row <= this_domain->row_number; local_row++)
+  {
+    const unsigned int row = this_domain->first_row + local_row - 1;
+    const unsigned int lower_row = (row + extensions[0] - 1) % extensions[0];
+    const unsigned int row_parity = row % 2;
+
+    for (unsigned int offset = 0; offset < size; offset++)
+    {
+      if ((row_parities[offset] ^ row_parity) != colour) continue;
+
+      const unsigned int local_site = local_row*size + offset;
+      const unsigned int site = row*size + offset;
+      const SpinType old_spin = spins[local_site];
+      const SpinType new_spin = old_spin.random_differ(this_domain->rng.random_double());
+
+      // Energy difference of the flip, the first direction uses the neighbouring rows
+      double delta_E = -interaction.coupling(site, 0) * (new_spin * spins[local_site + size] - old_spin * spins[local_site + size])
+	- interaction.coupling(lower_row*size + offset, 0) * (new_spin * spins[local_site - size] - old_spin * spins[local_site - size]);
+      for (unsigned int d = 1; d < dimension; d++)
+      {
+	const unsigned int position = (offset / strides[d]) % extensions[d];
+	const unsigned int upper_distance = (position == extensions[d] - 1) ? -(extensions[d] - 1)*strides[d] : strides[d];
+	const unsigned int lower_distance = (position == 0) ? (extensions[d] - 1)*strides[d] : -strides[d];
+	const SpinType& upper_spin = spins[local_site + upper_distance];
+	const SpinType& lower_spin = spins[local_site + lower_distance];
+	delta_E -= interaction.coupling(site, d) * (new_spin * upper_spin - old_spin * upper_spin)
+	  + interaction.coupling(site + lower_distance, d) * (new_spin * lower_spin - old_spin * lower_spin);
+      }
+      if (Interactions::HasField<InteractionType>::value)
+	delta_E -= interaction.field(site) * (new_spin.get_value() - old_spin.get_value());
+
+      // Metropolis acceptance
+      if (delta_E <= 0.0 || this_domain->rng.random_double() < exp(-beta*delta_E))
+	spins[local_site] = new_spin;
+    }
+  }
+}
+
+/*!
+ * \details The lower ghost row is the last row of the previous subdomain, the upper ghost row the first row of the next subdomain (periodic). Only the sites of the given colour are copied, because the neighbouring thread may already update the other colour.
+ */
+template<unsigned int dimension, class SpinType, class RandomNumberGenerator, class InteractionType>
+void SpinLatticeDomainDecomposition<dimension, SpinType, RandomNumberGenerator, InteractionType>::exchange_halo(unsigned int domain, unsigned int colour)
+{
+  Domain* this_domain = domains[domain];
+  const Domain* lower_domain = domains[(domain + domains.size() - 1) % domains.size()];
+  const Domain* upper_domain = domains[(domain + 1) % domains.size()];
+  const unsigned int size = row_size();
+
+  const unsigned int lower_parity = (this_domain->first_row + extensions[0] - 1) % 2;
+  const unsigned int upper_parity = (this_domain->first_row + this_domain->row_number) % 2;
+  SpinType* lower_ghost = &this_domain->spins[0];
+  SpinType* upper_ghost = &this_domain->spins[(this_domain->row_number + 1)*size];
+  const SpinType* lower_source = &lower_domain->spins[lower_domain->row_number*size];
+  const SpinType* upper_source = &upper_domain->spins[size];
+
+  for (unsigned int offset = 0; offset < size; offset++)
+  {
+    if ((row_parities[offset] ^ lower_parity) == colour) lower_ghost[offset] = lower_source[offset];
+    if ((row_parities[offset] ^ upper_parity) == colour) upper_ghost[offset] = upper_source[offset];
+  }
+}
+
+template<unsigned int dimension, class SpinType, class RandomNumberGenerator, class InteractionType>
+int SpinLatticeDomainDecomposition<dimension, SpinType, RandomNumberGenerator, InteractionType>::completed_phases(unsigned int domain) const
+{
+  int result;
+#pragma omp atomic read
+  result = phase_counters[domain].completed_phases;
+#pragma omp flush
+  return result;
+}
+template<unsigned int dimension, class SpinType, class RandomNumberGenerator, class InteractionType>
+void SpinLatticeDomainDecomposition<dimension, SpinType, RandomNumberGenerator, InteractionType>::set_completed_phases(unsigned int domain, int value)
+{
+#pragma omp flush
+#pragma omp atomic write
+  phase_counters[domain].completed_phases = value;
+}
+template<unsigned int dimension, class SpinType, class RandomNumberGenerator, class InteractionType>
+void SpinLatticeDomainDecomposition<dimension, SpinType, RandomNumberGenerator, InteractionType>::wait_for_phase(unsigned int domain, int phase) const
+{
+  // Poll with a pause for spin_rounds rounds, then yield the processor in every round, otherwise a waiting thread keeps the processor from the neighbour it waits for if there are more subdomains than processors
+  for (unsigned int idle_rounds = 0; completed_phases(domain) < phase; )
+  {
+    if (idle_rounds < spin_rounds)
+    {
+      ++idle_rounds;
+#ifdef __SSE2__
+      _mm_pause();
+#endif
+    }
+    else sched_yield();
+  }
+}
+
+/*!
+ * \details Every thread performs the half-sweeps of its subdomain. Before the half-sweep k the thread waits until both neighbouring subdomains have completed the half-sweep k - 1, because then they have copied the sites of the colour of the half-sweep k - 2 (which is the colour that will be changed now) from the boundary rows. After the half-sweep the thread publishes the completed phase, waits until the neighbours have completed the same phase and copies the updated colour into its ghost rows.
+ * \param sweep_number Number of sweeps, every sweep updates every site once
+ * \param beta Inverse temperature
+ */
+template<unsigned int dimension, class SpinType, class RandomNumberGenerator, class InteractionType>
+void SpinLatticeDomainDecomposition<dimension, SpinType, RandomNumberGenerator, InteractionType>::do_metropolis_sweeps(unsigned int sweep_number, double beta)
+{
+  const unsigned int domain_number = domains.size();
+  const int phase_number = 2*sweep_number;
+  for (unsigned int domain = 0; domain < domain_number; domain++)
+    phase_counters[domain].completed_phases = 0;
+
+#pragma omp parallel num_threads(domain_number)
+  {
+#ifdef _OPENMP
+    const unsigned int thread_number = omp_get_num_threads();
+    const unsigned int thread_id = omp_get_thread_num();
+#else
+    const unsigned int thread_number = 1;
+    const unsigned int thread_id = 0;
+#endif
+    if (thread_number == domain_number)
+    {
+      // Every thread updates its own subdomain
+      const unsigned int domain = thread_id;
+      const unsigned int lower_domain = (domain + domain_number - 1) % domain_number;
+      const unsigned int upper_domain = (domain + 1) % domain_number;
+      for (int phase = 0; phase < phase_number; phase++)
+      {
+	const unsigned int colour = phase % 2;
+
+	wait_for_phase(lower_domain, phase - 1);
+	wait_for_phase(upper_domain, phase - 1);
+	update_domain(domain, colour, beta);
+	set_completed_phases(domain, phase + 1);
+
+	wait_for_phase(lower_domain, phase + 1);
+	wait_for_phase(upper_domain, phase + 1);
+	exchange_halo(domain, colour);
+      }
+    }
+    else if (thread_id == 0)
+    {
+      // Not enough threads, perform the half-sweeps one after another
+      for (int phase = 0; phase < phase_number; phase++)
+      {
+	for (unsigned int domain = 0; domain < domain_number; domain++)
+	  update_domain(domain, phase % 2, beta);
+	for (unsigned int domain = 0; domain < domain_number; domain++)
+	  exchange_halo(domain, phase % 2);
+      }
+    }
+  }
+}
+
+template<unsigned int dimension, class SpinType, class RandomNumberGenerator, class InteractionType>
+double SpinLatticeDomainDecomposition<dimension, SpinType, RandomNumberGenerator, InteractionType>::domain_energy(unsigned int domain) const
+{
+  const Domain* this_domain = domains[domain];
+  const SpinType* spins = &this_domain->spins[0];
+  const InteractionType& interaction = lattice->get_interaction();
+  const unsigned int size = row_size();
+
+  double result = 0;
+  for (unsigned int local_row = 1; local_row <= this_domain->row_number; local_row++)
+  {
+    const unsigned int row = this_domain->first_row + local_row - 1;
+    for (unsigned int offset = 0; offset < size; offset++)
+    {
+      const unsigned int local_site = local_row*size + offset;
+      const unsigned int site = row*size + offset;
+      result -= interaction.coupling(site, 0) * (spins[local_site] * spins[local_site + size]);
+      for (unsigned int d = 1; d < dimension; d++)
+      {
+	const unsigned int position = (offset / strides[d]) % extensions[d];
+	const unsigned int upper_distance = (position == extensions[d] - 1) ? -(extensions[d] - 1)*strides[d] : strides[d];
+	result -= interaction.coupling(site, d) * (spins[local_site] * spins[local_site + upper_distance]);
+      }
+      if (Interactions::HasField<InteractionType>::value)
+	result -= interaction.field(site) * spins[local_site].get_value();
+    }
+  }
+  return result;
+}
+
+/*!
+ * \details Sums the energies of the subdomains in parallel, every bond is counted once as the bond of a site to its upper neighbour. Uses the same definition as SpinLatticeBase::energy().
+ */
+template<unsigned int dimension, class SpinType, class RandomNumberGenerator, class InteractionType>
+double SpinLatticeDomainDecomposition<dimension, SpinType, RandomNumberGenerator, InteractionType>::energy() const
+{
+  const int domain_number = domains.size();
+  double result = 0;
+#pragma omp parallel for num_threads(domain_number) schedule(static, 1) reduction(+:result)
+  for (int domain = 0; domain < domain_number; domain++)
+    result += domain_energy(domain);
+  return result;
+}
+
+template<unsigned int dimension, class SpinType, class RandomNumberGenerator, class InteractionType>
+double SpinLatticeDomainDecomposition<dimension, SpinType, RandomNumberGenerator, InteractionType>::magnetization() const
+{
+  const int domain_number = domains.size();
+  const unsigned int size = row_size();
+  double result = 0;
+#pragma omp parallel for num_threads(domain_number) schedule(static, 1) reduction(+:result)
+  for (int domain = 0; domain < domain_number; domain++)
+  {
+    const Domain* this_domain = domains[domain];
+    for (unsigned int local_site = size; local_site < (this_domain->row_number + 1)*size; local_site++)
+      result += this_domain->spins[local_site].get_value();
+  }
+  return result;
+}
+
+} // of namespace Ising
+
+#endif
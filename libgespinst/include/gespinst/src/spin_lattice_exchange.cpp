@@ -0,0 +1,122 @@
+#ifdef GESPINST_SPIN_LATTICE_EXCHANGE_HPP
+
+#include <cmath>
+
+namespace Gespinst
+{
+
+template<unsigned int dimension, class SpinType>
+SpinLatticeExchange<dimension, SpinType>& SpinLatticeExchange<dimension, SpinType>::operator=(const SpinLatticeExchange<dimension, SpinType>& other)
+{
+  // Check for self-assignment
+  if (this == &other)
+    return *this;
+
+  // Do the copy
+  Base::operator=(other);
+  unlike_bonds = other.unlike_bonds;
+  unlike_bond_positions = other.unlike_bond_positions;
+
+  // Return the existing object
+  return *this;
+}
+
+/*!
+ * \details The list of unlike bonds is reconstructed by testing every bond of the lattice, this needs time proportional to the number of sites.
+ */
+template<unsigned int dimension, class SpinType>
+void SpinLatticeExchange<dimension, SpinType>::initialise_unlike_bonds()
+{
+  const unsigned int bond_number = this->spin_lattice.num_elements() * dimension;
+
+  unlike_bonds.clear();
+  unlike_bond_positions.assign(bond_number, -1);
+  for (unsigned int bond = 0; bond < bond_number; ++bond)
+    update_unlike_bond(bond);
+}
+
+template<unsigned int dimension, class SpinType>
+void SpinLatticeExchange<dimension, SpinType>::update_unlike_bond(unsigned int bond)
+{
+  const bool is_unlike = (this->site_spin(bond_first_site(bond)) != this->site_spin(bond_second_site(bond)));
+  const int position = unlike_bond_positions[bond];
+
+  if (is_unlike && position < 0)
+  {
+    unlike_bond_positions[bond] = unlike_bonds.size();
+    unlike_bonds.push_back(bond);
+  }
+  else if (!is_unlike && position >= 0)
+  {
+    // Move the last bond of the list to the place of the removed one
+    const unsigned int last_bond = unlike_bonds.back();
+    unlike_bonds[position] = last_bond;
+    unlike_bond_positions[last_bond] = position;
+    unlike_bonds.pop_back();
+    unlike_bond_positions[bond] = -1;
+  }
+}
+
+/*!
+ * \details Updates the 2*dimension bonds that have the given site as one of their ends.
+ */
+template<unsigned int dimension, class SpinType>
+void SpinLatticeExchange<dimension, SpinType>::update_unlike_bonds_of_site(unsigned int site)
+{
+  for (unsigned int d = 0; d < dimension; ++d)
+  {
+    update_unlike_bond(site*dimension + d);
+    update_unlike_bond(this->lower_neighbour_site(site, d)*dimension + d);
+  }
+}
+
+/*!
+ * \details Exchanges the two spins of the step and updates the bonds that touch one of the two sites in the list of unlike bonds. After the update the simulation time is increased by one.
+ * \param step_to_commit A valid step that should update the spin lattice.
+ */
+template<unsigned int dimension, class SpinType>
+void SpinLatticeExchange<dimension, SpinType>::commit(SpinLatticeExchangeStep<dimension, SpinType>& step_to_commit)
+{
+  SpinType* spins = this->spin_lattice.data();
+  const unsigned int first_site = step_to_commit.get_first_site();
+  const unsigned int second_site = step_to_commit.get_second_site();
+
+  const SpinType first_spin = spins[first_site];
+  spins[first_site] = spins[second_site];
+  spins[second_site] = first_spin;
+
+  update_unlike_bonds_of_site(first_site);
+  update_unlike_bonds_of_site(second_site);
+
+  this->_simulation_time++;
+}
+
+/*!
+ * \details Proposes a step based on a given random number between 0 and 1, the integer part of (random_number * number_of_unlike_bonds) is used to select the unlike bond whose spins will be exchanged. If there are no unlike bonds, a not executable step is returned.
+ * \param random_double Random number between 0 and 1
+ */
+template<unsigned int dimension, class SpinType>
+SpinLatticeExchangeStep<dimension, SpinType> SpinLatticeExchange<dimension, SpinType>::propose_step(double random_double)
+{
+  if (unlike_bonds.empty())
+    return SpinLatticeExchangeStep<dimension, SpinType>(this, 0);
+
+  unsigned int position = static_cast<unsigned int>(floor(random_double*unlike_bonds.size()));
+  if (position >= unlike_bonds.size()) position = unlike_bonds.size() - 1;
+
+  return SpinLatticeExchangeStep<dimension, SpinType>(this, unlike_bonds[position]);
+}
+
+/*!
+ * \details Proposes a step exchanging the spins of a uniformly chosen unlike bond. If there are no unlike bonds, a not executable step is returned.
+ * \param rng Random number generator so that rng->random_double() gives a random number between 0 and 1
+ */
+template<unsigned int dimension, class SpinType> template<class RandomNumberGenerator>
+SpinLatticeExchangeStep<dimension, SpinType> SpinLatticeExchange<dimension, SpinType>::propose_step(RandomNumberGenerator* rng)
+{
+  return propose_step(rng->random_double());
+}
+
+} // of namespace Ising
+
+#endif
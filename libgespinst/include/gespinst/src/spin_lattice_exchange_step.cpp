@@ -0,0 +1,122 @@
+#ifdef GESPINST_SPIN_LATTICE_EXCHANGE_STEP_HPP
+
+#include "../spin_lattice_exchange.hpp"
+
+namespace Gespinst
+{
+
+/*!
+ * \details Contructs a new SpinLatticeExchangeStep object that belongs to the given lattice and exchanges the spins at the two ends of the given bond.
+ * \param lattice SpinLatticeExchange on which the step will be executed.
+ * \param bond Index of the bond, the bond with index i connects the site i / dimension with its upper neighbour in direction i % dimension.
+ */
+template<unsigned int dimension, class SpinType>
+SpinLatticeExchangeStep<dimension, SpinType>::SpinLatticeExchangeStep(SpinLatticeExchange<dimension, SpinType>* lattice, unsigned int bond)
+  : _lattice(lattice),
+    _bond(bond),
+    _first_site(lattice->bond_first_site(bond)),
+    _second_site(lattice->bond_second_site(bond)),
+    _creation_simulation_time(lattice->get_simulation_time()),
+    _differences_calculated(false),
+    _delta_E(0.0),
+    _delta_unlike_bonds(0)
+{ }
+
+/*!
+ * \details Goes once through the neighbours of both sites of the bond and sums up the change of the bond energies and the change of the number of unlike bonds. Bonds between the two exchanged sites are skipped, since they do neither change their energy nor their unlikeness.
+ */
+template<unsigned int dimension, class SpinType>
+void SpinLatticeExchangeStep<dimension, SpinType>::calculate_differences()
+{
+  const SpinType& first_spin = _lattice->site_spin(_first_site);
+  const SpinType& second_spin = _lattice->site_spin(_second_site);
+
+  double delta_energy = 0.0;
+  int delta_unlike = 0;
+
+  for (unsigned int d = 0; d < dimension; d++)
+  {
+    const unsigned int neighbours[4] = { _lattice->upper_neighbour_site(_first_site, d),
+					 _lattice->lower_neighbour_site(_first_site, d),
+					 _lattice->upper_neighbour_site(_second_site, d),
+					 _lattice->lower_neighbour_site(_second_site, d) };
+    for (unsigned int n = 0; n < 4; ++n)
+    {
+      // The first two neighbours belong to the first site, the other two to the second site
+      const SpinType& old_spin = (n < 2) ? first_spin : second_spin;
+      const SpinType& new_spin = (n < 2) ? second_spin : first_spin;
+      const unsigned int partner_site = (n < 2) ? _second_site : _first_site;
+      if (neighbours[n] == partner_site) continue;
+
+      const SpinType& neighbour_spin = _lattice->site_spin(neighbours[n]);
+      delta_energy += (old_spin * neighbour_spin) - (new_spin * neighbour_spin);
+      delta_unlike += static_cast<int>(new_spin != neighbour_spin) - static_cast<int>(old_spin != neighbour_spin);
+    }
+  }
+
+  _delta_E = delta_energy;
+  _delta_unlike_bonds = delta_unlike;
+  _differences_calculated = true;
+}
+
+template<unsigned int dimension, class SpinType>
+double SpinLatticeExchangeStep<dimension, SpinType>::delta_E()
+{
+  if (!_differences_calculated) calculate_differences();
+  return _delta_E;
+}
+
+template<unsigned int dimension, class SpinType>
+int SpinLatticeExchangeStep<dimension, SpinType>::delta_unlike_bonds()
+{
+  if (!_differences_calculated) calculate_differences();
+  return _delta_unlike_bonds;
+}
+
+/*!
+ * \details A step is only executable if the two spins of the bond differ. This is only not the case if the lattice has no unlike bonds at all, in that case the proposed step is not executable.
+ */
+template<unsigned int dimension, class SpinType>
+bool SpinLatticeExchangeStep<dimension, SpinType>::is_executable()
+{
+  return _lattice->site_spin(_first_site) != _lattice->site_spin(_second_site);
+}
+
+/*!
+ * \details Executes a step by commiting it to the corresponding SpinLatticeExchange.
+ */
+template<unsigned int dimension, class SpinType>
+void SpinLatticeExchangeStep<dimension, SpinType>::execute()
+{
+  _lattice->commit(*this);
+}
+
+/*!
+ * \details Since the steps are proposed by chosing uniformly one of the unlike bonds of the lattice, the probability to propose a step depends on the number of unlike bonds. To fulfill detailed balance the acceptance probability must be multiplied with the ratio of the number of unlike bonds before and after the step, the inverse of this ratio is returned.
+ */
+template<unsigned int dimension, class SpinType>
+double SpinLatticeExchangeStep<dimension, SpinType>::selection_probability_factor()
+{
+  const double unlike_bonds_before = static_cast<double>(_lattice->unlike_bond_number());
+  return (unlike_bonds_before + delta_unlike_bonds()) / unlike_bonds_before;
+}
+
+/*!
+ * \details Exchanging the two spins again reverts the step.
+ */
+template<unsigned int dimension, class SpinType>
+void SpinLatticeExchangeStep<dimension, SpinType>::undo()
+{
+  // Create a new step that reverts this one
+  SpinLatticeExchangeStep<dimension, SpinType> inverse_step(_lattice, _bond);
+
+  // Assign the inverse step the creation_simulation time of this step and add one (The reverse step may only be done one after the original step)
+  inverse_step._creation_simulation_time = _creation_simulation_time + 1;
+
+  // Commit the step
+  _lattice->commit(inverse_step);
+}
+
+} // of namespace Ising
+
+#endif
@@ -11,8 +11,8 @@ namespace Gespinst
  * \param flip_index Index of the lattice where the flip will be done.
  * \param new_spin New spin value at the given lattice index.
  */
-template<unsigned int dimension, class SpinType>
-SpinLatticeStep<dimension, SpinType>::SpinLatticeStep(SpinLattice<dimension, SpinType>* lattice, index_type flip_index, SpinType new_spin)
+template<unsigned int dimension, class SpinType, class InteractionType>
+SpinLatticeStep<dimension, SpinType, InteractionType>::SpinLatticeStep(SpinLattice<dimension, SpinType, InteractionType>* lattice, index_type flip_index, SpinType new_spin)
   : _lattice(lattice),
     _flip_index(flip_index),
     _new_spin(new_spin)
@@ -25,38 +25,27 @@ SpinLatticeStep<dimension, SpinType>::SpinLatticeStep(SpinLattice<dimension, Spi
   
 }
 
-template<unsigned int dimension, class SpinType>
-double SpinLatticeStep<dimension, SpinType>::delta_E()
+template<unsigned int dimension, class SpinType, class InteractionType>
+double SpinLatticeStep<dimension, SpinType, InteractionType>::delta_E()
 {
-  std::vector<SpinType> neighbours = _lattice->next_neighbours(_flip_index);
-
-  double old_energy = 0;
-  double new_energy = 0;
-
-  for (typename std::vector<SpinType>::iterator neighbour = neighbours.begin();
-       neighbour != neighbours.end(); ++neighbour)
-  {
-    old_energy += - (_old_spin * (*neighbour));
-    new_energy += - (_new_spin * (*neighbour));
-  }
-
-  return new_energy - old_energy;
+  const unsigned int site = _lattice->site_index(_flip_index);
+  return _lattice->site_energy(site, _new_spin) - _lattice->site_energy(site, _old_spin);
 }
 
 /*!
  * \details Executes a step by commiting it to the corresponding SpinLattice.
  */
-template<unsigned int dimension, class SpinType>
-void SpinLatticeStep<dimension, SpinType>::execute()
+template<unsigned int dimension, class SpinType, class InteractionType>
+void SpinLatticeStep<dimension, SpinType, InteractionType>::execute()
 {
   _lattice->commit(*this);
 }
 
-template<unsigned int dimension, class SpinType>
-void SpinLatticeStep<dimension, SpinType>::undo()
+template<unsigned int dimension, class SpinType, class InteractionType>
+void SpinLatticeStep<dimension, SpinType, InteractionType>::undo()
 {
   // Create a new step that reverts this one
-  SpinLatticeStep<dimension, SpinType> inverse_step(_lattice, _flip_index, _old_spin);
+  SpinLatticeStep<dimension, SpinType, InteractionType> inverse_step(_lattice, _flip_index, _old_spin);
 
   // Assign the inverse spin the creation_simulation time of this step and add one (The reverse step may only be done one after the original step)
   inverse_step._creation_simulation_time = _creation_simulation_time + 1;
@@ -0,0 +1,309 @@
+#ifdef GESPINST_SPIN_LATTICE_STRUCTURE_FACTOR_HPP
+
+#include <cmath>
+#include <algorithm>
+
+namespace Gespinst
+{
+
+/*!
+ * \details Creates the twiddle factors for every direction and, if the extension is a power of two, the bit-reversed indices. The strides follow the storage order of the lattice (the last direction is contiguous).
+ * \param lattice Lattice whose extensions are used, the structure factor can be calculated for all lattices with the same extensions
+ */
+template<unsigned int dimension, class SpinType, class InteractionType>
+SpinLatticeStructureFactor<dimension, SpinType, InteractionType>::SpinLatticeStructureFactor(const lattice_type& lattice)
+  : site_number(lattice.system_size())
+{
+  unsigned int maximal_length = 0;
+  unsigned int stride = 1;
+  for (int d = dimension - 1; d >= 0; d--)
+  {
+    Plan& plan = plans[d];
+    plan.length = lattice.extension(d);
+    plan.stride = stride;
+    stride *= plan.length;
+    maximal_length = std::max(maximal_length, plan.length);
+
+    plan.twiddles.resize(plan.length);
+    for (unsigned int j = 0; j < plan.length; j++)
+      plan.twiddles[j] = std::polar(1.0, -2.0*M_PI*j/plan.length);
+
+    plan.power_of_two = (plan.length > 0) && ((plan.length & (plan.length - 1)) == 0);
+    if (plan.power_of_two)
+    {
+      unsigned int bits = 0;
+      while ((1u << bits) < plan.length) bits++;
+      plan.bit_reversal.resize(plan.length);
+      for (unsigned int j = 0; j < plan.length; j++)
+      {
+	unsigned int reversed = 0;
+	for (unsigned int b = 0; b < bits; b++)
+	  if (j & (1u << b)) reversed |= 1u << (bits - 1 - b);
+	plan.bit_reversal[j] = reversed;
+      }
+    }
+  }
+
+  field.resize(site_number);
+  line.resize(maximal_length);
+  line_result.resize(maximal_length);
+  structure_factor_values.resize(site_number);
+  correlation_values.resize(site_number);
+}
+
+/*!
+ * \param lattice Lattice with the extensions of the lattice used for the construction
+ * \returns Reference to the internal buffer with \f$ S(k) \f$ in the order of the linear site index, it is overwritten by the next calculation
+ */
+template<unsigned int dimension, class SpinType, class InteractionType>
+const std::vector<double>& SpinLatticeStructureFactor<dimension, SpinType, InteractionType>::structure_factor(const lattice_type& lattice)
+{
+  check_lattice(lattice);
+
+  const unsigned int component_number = (site_number > 0) ? SpinFieldComponents<SpinType>::component_number(lattice.site_spin(0)) : 0;
+  const double normalisation = 1.0/site_number;
+  std::fill(structure_factor_values.begin(), structure_factor_values.end(), 0.0);
+  for (unsigned int component = 0; component < component_number; component++)
+  {
+    for (unsigned int site = 0; site < site_number; site++)
+      field[site] = std::complex<double>(SpinFieldComponents<SpinType>::component(lattice.site_spin(site), component), 0.0);
+    transform(false);
+
+    for (unsigned int site = 0; site < site_number; site++)
+      structure_factor_values[site] += std::norm(field[site])*normalisation;
+  }
+  return structure_factor_values;
+}
+
+/*!
+ * \param lattice Lattice with the extensions of the lattice used for the construction
+ * \returns Reference to the internal buffer with \f$ G(r) \f$ in the order of the linear site index, it is overwritten by the next calculation
+ */
+template<unsigned int dimension, class SpinType, class InteractionType>
+const std::vector<double>& SpinLatticeStructureFactor<dimension, SpinType, InteractionType>::correlation_function(const lattice_type& lattice)
+{
+  structure_factor(lattice);
+
+  for (unsigned int site = 0; site < site_number; site++)
+    field[site] = std::complex<double>(structure_factor_values[site], 0.0);
+  transform(true);
+
+  const double normalisation = 1.0/site_number;
+  for (unsigned int site = 0; site < site_number; site++)
+    correlation_values[site] = field[site].real()*normalisation;
+  return correlation_values;
+}
+
+/*!
+ * \details Calculates the structure factor and averages the second moment correlation length of all directions with an extension larger than one.
+ * \param lattice Lattice with the extensions of the lattice used for the construction
+ */
+template<unsigned int dimension, class SpinType, class InteractionType>
+double SpinLatticeStructureFactor<dimension, SpinType, InteractionType>::second_moment_correlation_length(const lattice_type& lattice)
+{
+  structure_factor(lattice);
+
+  double result = 0.0;
+  unsigned int direction_number = 0;
+  for (unsigned int d = 0; d < dimension; d++)
+  {
+    if (plans[d].length < 2) continue;
+    result += second_moment_correlation_length(structure_factor_values[0], structure_factor_values[plans[d].stride], plans[d].length);
+    direction_number++;
+  }
+  return (direction_number > 0) ? result/direction_number : 0.0;
+}
+
+/*!
+ * \details Calculates \f$ \xi = \sqrt{S(0)/S(k_\mathrm{min}) - 1} / (2 \sin(k_\mathrm{min}/2)) \f$ with \f$ k_\mathrm{min} = 2 \pi / L \f$. Returns 0 if the structure factor at the smallest wave vector vanishes or is larger than at zero.
+ * \param structure_factor_zero Structure factor at zero wave vector
+ * \param structure_factor_minimal Structure factor at the smallest non-zero wave vector
+ * \param extension Extension of the lattice in the direction of the wave vector
+ */
+template<unsigned int dimension, class SpinType, class InteractionType>
+double SpinLatticeStructureFactor<dimension, SpinType, InteractionType>::second_moment_correlation_length(double structure_factor_zero, double structure_factor_minimal, unsigned int extension)
+{
+  if (structure_factor_minimal <= 0.0 || structure_factor_zero <= structure_factor_minimal) return 0.0;
+  return sqrt(structure_factor_zero/structure_factor_minimal - 1.0) / (2.0*sin(M_PI/extension));
+}
+
+template<unsigned int dimension, class SpinType, class InteractionType>
+void SpinLatticeStructureFactor<dimension, SpinType, InteractionType>::check_lattice(const lattice_type& lattice) const
+{
+  for (unsigned int d = 0; d < dimension; d++)
+    if (lattice.extension(d) != plans[d].length)
+      throw std::invalid_argument("The extensions of the lattice do not match the structure factor.");
+}
+
+/*!
+ * \details Every line of the field in a direction is copied into the contiguous line buffer, transformed and copied back.
+ * \param inverse If true, the transform uses the positive sign in the exponent
+ */
+template<unsigned int dimension, class SpinType, class InteractionType>
+void SpinLatticeStructureFactor<dimension, SpinType, InteractionType>::transform(bool inverse)
+{
+  for (unsigned int d = 0; d < dimension; d++)
+  {
+    const Plan& plan = plans[d];
+    if (plan.length < 2) continue;
+    const unsigned int block = plan.stride*plan.length;
+    for (unsigned int outer = 0; outer < site_number; outer += block)
+    {
+      for (unsigned int inner = 0; inner < plan.stride; inner++)
+      {
+	std::complex<double>* start = &field[outer + inner];
+	for (unsigned int j = 0; j < plan.length; j++) line[j] = start[j*plan.stride];
+	transform_line(plan, inverse);
+	for (unsigned int j = 0; j < plan.length; j++) start[j*plan.stride] = line[j];
+      }
+    }
+  }
+}
+
+template<unsigned int dimension, class SpinType, class InteractionType>
+void SpinLatticeStructureFactor<dimension, SpinType, InteractionType>::transform_line(const Plan& plan, bool inverse)
+{
+  const unsigned int length = plan.length;
+  if (plan.power_of_two)
+  {
+    // Iterative radix-2 transform
+    for (unsigned int j = 0; j < length; j++)
+      if (j < plan.bit_reversal[j]) std::swap(line[j], line[plan.bit_reversal[j]]);
+    for (unsigned int size = 2; size <= length; size *= 2)
+    {
+      const unsigned int half = size/2;
+      const unsigned int twiddle_step = length/size;
+      for (unsigned int begin = 0; begin < length; begin += size)
+      {
+	for (unsigned int j = 0; j < half; j++)
+	{
+	  const std::complex<double> twiddle = inverse ? std::conj(plan.twiddles[j*twiddle_step]) : plan.twiddles[j*twiddle_step];
+	  const std::complex<double> product = twiddle*line[begin + j + half];
+	  line[begin + j + half] = line[begin + j] - product;
+	  line[begin + j] += product;
+	}
+      }
+    }
+  }
+  else
+  {
+    // Direct sum with the twiddle factors
+    for (unsigned int k = 0; k < length; k++)
+    {
+      std::complex<double> sum(0.0, 0.0);
+      for (unsigned int j = 0; j < length; j++)
+      {
+	const std::complex<double>& twiddle = plan.twiddles[(static_cast<unsigned long>(j)*k) % length];
+	sum += line[j]*(inverse ? std::conj(twiddle) : twiddle);
+      }
+      line_result[k] = sum;
+    }
+    std::copy(line_result.begin(), line_result.begin() + length, line.begin());
+  }
+}
+
+/*!
+ * \param lattice Lattice whose extensions are used, the modes can be tracked for all lattices with the same extensions
+ */
+template<unsigned int dimension, class SpinType, class InteractionType>
+SpinLatticeFourierModes<dimension, SpinType, InteractionType>::SpinLatticeFourierModes(const lattice_type& lattice)
+  : site_number(lattice.system_size())
+{
+  unsigned int stride = 1;
+  for (int d = dimension - 1; d >= 0; d--)
+  {
+    extensions[d] = lattice.extension(d);
+    strides[d] = stride;
+    stride *= extensions[d];
+
+    phases[d].resize(extensions[d]);
+    for (unsigned int x = 0; x < extensions[d]; x++)
+      phases[d][x] = std::polar(1.0, -2.0*M_PI*x/extensions[d]);
+  }
+  initialise(lattice);
+}
+
+/*!
+ * \details The number of components of the spin field is taken from the first site of the lattice.
+ * \param lattice Lattice with the extensions of the lattice used for the construction
+ */
+template<unsigned int dimension, class SpinType, class InteractionType>
+void SpinLatticeFourierModes<dimension, SpinType, InteractionType>::initialise(const lattice_type& lattice)
+{
+  component_number = (site_number > 0) ? SpinFieldComponents<SpinType>::component_number(lattice.site_spin(0)) : 0;
+  modes.assign(component_number*(dimension + 1), 0.0);
+  for (unsigned int site = 0; site < site_number; site++)
+    for (unsigned int component = 0; component < component_number; component++)
+      update_component(site, component, SpinFieldComponents<SpinType>::component(lattice.site_spin(site), component));
+}
+
+/*!
+ * \param site Linear index of the changed site
+ * \param old_value Value of the spin before the change
+ * \param new_value Value of the spin after the change
+ */
+template<unsigned int dimension, class SpinType, class InteractionType>
+void SpinLatticeFourierModes<dimension, SpinType, InteractionType>::update(unsigned int site, double old_value, double new_value)
+{
+  update_component(site, 0, new_value - old_value);
+}
+
+/*!
+ * \param site Linear index of the changed site
+ * \param old_spin Spin before the change
+ * \param new_spin Spin after the change
+ */
+template<unsigned int dimension, class SpinType, class InteractionType>
+void SpinLatticeFourierModes<dimension, SpinType, InteractionType>::update(unsigned int site, const SpinType& old_spin, const SpinType& new_spin)
+{
+  for (unsigned int component = 0; component < component_number; component++)
+  {
+    const double difference = SpinFieldComponents<SpinType>::component(new_spin, component) - SpinFieldComponents<SpinType>::component(old_spin, component);
+    if (difference != 0.0) update_component(site, component, difference);
+  }
+}
+
+template<unsigned int dimension, class SpinType, class InteractionType>
+void SpinLatticeFourierModes<dimension, SpinType, InteractionType>::update(const step_type& executed_step)
+{
+  unsigned int site = 0;
+  for (unsigned int d = 0; d < dimension; d++)
+    site += executed_step.get_flip_index()[d]*strides[d];
+  update(site, executed_step.get_old_spin(), executed_step.get_new_spin());
+}
+
+template<unsigned int dimension, class SpinType, class InteractionType>
+void SpinLatticeFourierModes<dimension, SpinType, InteractionType>::update_component(unsigned int site, unsigned int component, double difference)
+{
+  std::complex<double>* component_modes = &modes[component*(dimension + 1)];
+  component_modes[0] += difference;
+  for (unsigned int d = 0; d < dimension; d++)
+    component_modes[d + 1] += difference*phases[d][(site/strides[d]) % extensions[d]];
+}
+
+template<unsigned int dimension, class SpinType, class InteractionType>
+double SpinLatticeFourierModes<dimension, SpinType, InteractionType>::summed_norm(unsigned int mode) const
+{
+  double result = 0.0;
+  for (unsigned int component = 0; component < component_number; component++)
+    result += std::norm(modes[component*(dimension + 1) + mode]);
+  return result;
+}
+
+template<unsigned int dimension, class SpinType, class InteractionType>
+double SpinLatticeFourierModes<dimension, SpinType, InteractionType>::second_moment_correlation_length() const
+{
+  double result = 0.0;
+  unsigned int direction_number = 0;
+  for (unsigned int d = 0; d < dimension; d++)
+  {
+    if (extensions[d] < 2) continue;
+    result += SpinLatticeStructureFactor<dimension, SpinType, InteractionType>::second_moment_correlation_length(structure_factor_zero(), structure_factor_minimal(d), extensions[d]);
+    direction_number++;
+  }
+  return (direction_number > 0) ? result/direction_number : 0.0;
+}
+
+} // of namespace Gespinst
+
+#endif
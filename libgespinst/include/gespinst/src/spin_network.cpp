@@ -71,6 +71,42 @@ namespace Gespinst
     return result;
   }
   
+  /*! 
+   * \details Creates a STL vector of Step objects representing the flips from the present value of the spin at the given index to all other values of the spin.
+   * \param index Index of the spin to flip
+   */
+  template<class SpinType, class ContainerType>
+  std::vector<SpinNetworkStep<SpinType, ContainerType> > SpinNetwork<SpinType, ContainerType>::all_steps(index_type index)
+  {
+    std::vector<SpinNetworkStep<SpinType, ContainerType> > result;
+
+    std::vector<SpinType> possible_values = spins[index].all_possible_values();
+    for (typename std::vector<SpinType>::const_iterator value = possible_values.begin(); value != possible_values.end(); ++value)
+    {
+      if (*value != spins[index])
+	result.push_back(SpinNetworkStep<SpinType, ContainerType>(this, index, *value));
+    }
+
+    return result;
+  }
+
+  /*!
+   * \details Converts the pointers to the next neighbours of the spin at the given index into indices of the spin container.
+   * \param index Index of the spin
+   */
+  template<class SpinType, class ContainerType>
+  std::vector<typename SpinNetwork<SpinType, ContainerType>::index_type> SpinNetwork<SpinType, ContainerType>::neighbour_sites(index_type index) const
+  {
+    std::vector<index_type> result;
+    for (typename ContainerType::const_iterator neighbour = next_neighbour_spins[index].begin();
+	 neighbour != next_neighbour_spins[index].end(); ++neighbour)
+    {
+      result.push_back(*neighbour - &spins[0]);
+    }
+
+    return result;
+  }
+
   /*!
    * \details Updates the spin lattice with the given spin. After the update the simulation time is increase by one. If the creation simulation time of the step does not match the actual simulation time of the spin lattice, an exception will be thrown (to be implemented).
    * \param step_to_commit A valid step that should update the spin lattice.
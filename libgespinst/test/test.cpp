@@ -8,6 +8,11 @@
 #include "test_spins/test_real_spin.hpp"
 #include "test_spin_lattice.hpp"
 #include "test_spin_lattice_step.hpp"
+#include "test_spin_lattice_interaction.hpp"
+#include "test_spin_lattice_exchange.hpp"
+#include "test_spin_lattice_exchange_step.hpp"
+#include "test_spin_lattice_domain_decomposition.hpp"
+#include "test_spin_lattice_structure_factor.hpp"
 #include "test_spin_network.hpp"
 #include "test_spin_network_step.hpp"
 
@@ -20,6 +25,11 @@ int main()
   runner.addTest(TestRealSpin::suite());
   runner.addTest(TestSpinLattice::suite());
   runner.addTest(TestSpinLatticeStep::suite());
+  runner.addTest(TestSpinLatticeInteraction::suite());
+  runner.addTest(TestSpinLatticeExchange::suite());
+  runner.addTest(TestSpinLatticeExchangeStep::suite());
+  runner.addTest(TestSpinLatticeDomainDecomposition::suite());
+  runner.addTest(TestSpinLatticeStructureFactor::suite());
   runner.addTest(TestSpinNetwork::suite());
   runner.addTest(TestSpinNetworkStep::suite());
 
@@ -279,6 +279,11 @@ void TestSpinLattice::test_all_steps()
   CPPUNIT_ASSERT(possible_steps[4].get_old_spin() == spin_up);
   CPPUNIT_ASSERT(possible_steps[4].get_new_spin() == spin_down);
 
+  // Steps at a single site
+  std::vector<SpinLatticeStep<1, IsingSpin> > site_steps = testlattice_1d->all_steps(2);
+  CPPUNIT_ASSERT(site_steps.size() == 1);
+  CPPUNIT_ASSERT(site_steps[0].get_flip_index() == index_2);
+  CPPUNIT_ASSERT(site_steps[0].get_new_spin() == spin_up);
 }
 void TestSpinLattice::test_commit()
 {
@@ -326,6 +331,12 @@ void TestSpinLattice::test_next_neighbours()
   CPPUNIT_ASSERT(testlattice_2d->next_neighbours(index_20).at(1) == spin_down);
   CPPUNIT_ASSERT(testlattice_2d->next_neighbours(index_20).at(2) == spin_down);
   CPPUNIT_ASSERT(testlattice_2d->next_neighbours(index_20).at(3) == spin_up);
+
+  // Linear indices of the neighbour sites
+  std::vector<unsigned int> neighbour_sites_1d = testlattice_1d->neighbour_sites(0);
+  CPPUNIT_ASSERT(neighbour_sites_1d.size() == 2);
+  CPPUNIT_ASSERT(neighbour_sites_1d[0] == 1);
+  CPPUNIT_ASSERT(neighbour_sites_1d[1] == 4);
 }
 void TestSpinLattice::test_propose_step()
 {
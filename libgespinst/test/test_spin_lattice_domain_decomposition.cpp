@@ -0,0 +1,125 @@
+#include "test_spin_lattice_domain_decomposition.hpp"
+
+#include <cmath>
+
+CppUnit::Test* TestSpinLatticeDomainDecomposition::suite()
+{
+    CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("TestSpinLatticeDomainDecomposition");
+    
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeDomainDecomposition>("TestSpinLatticeDomainDecomposition: test_constructor", &TestSpinLatticeDomainDecomposition::test_constructor ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeDomainDecomposition>("TestSpinLatticeDomainDecomposition: test_scatter_gather", &TestSpinLatticeDomainDecomposition::test_scatter_gather ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeDomainDecomposition>("TestSpinLatticeDomainDecomposition: test_energy", &TestSpinLatticeDomainDecomposition::test_energy ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeDomainDecomposition>("TestSpinLatticeDomainDecomposition: test_do_metropolis_sweeps", &TestSpinLatticeDomainDecomposition::test_do_metropolis_sweeps ) );
+
+    return suiteOfTests;
+}
+
+void TestSpinLatticeDomainDecomposition::setUp()
+{
+  // 2d lattice with some down spins, random couplings and fields
+  std::vector<unsigned int> size_2d;
+  size_2d.push_back(8); size_2d.push_back(6);
+  testlattice_2d = new LatticeType(size_2d);
+  for (unsigned int i = 0; i < 8; ++i)
+    for (unsigned int j = 0; j < 6; ++j)
+    {
+      const unsigned int site = 6*i + j;
+      if ((5*i + 3*j) % 7 < 3) (*testlattice_2d)(i, j) = IsingSpin(-1);
+      testlattice_2d->get_interaction().set_coupling(site, 0, 0.5 + (site % 3)*0.5);
+      testlattice_2d->get_interaction().set_coupling(site, 1, 1.5 - (site % 4)*0.5);
+      testlattice_2d->get_interaction().set_field(site, 0.1*(site % 5) - 0.2);
+    }
+
+  // 3d lattice with isolated down spins
+  std::vector<unsigned int> size_3d(3, 4);
+  testlattice_3d = new SpinLattice<3, IsingSpin>(size_3d);
+  (*testlattice_3d)(1, 1, 1) = IsingSpin(-1);
+  (*testlattice_3d)(3, 2, 0) = IsingSpin(-1);
+  (*testlattice_3d)(0, 3, 2) = IsingSpin(-1);
+}
+void TestSpinLatticeDomainDecomposition::tearDown()
+{
+  delete testlattice_2d;
+  delete testlattice_3d;
+}
+
+void TestSpinLatticeDomainDecomposition::test_constructor()
+{
+  DecompositionType decomposition(*testlattice_2d, 3);
+  CPPUNIT_ASSERT_EQUAL(3u, decomposition.get_domain_number());
+  CPPUNIT_ASSERT_EQUAL(0u, decomposition.domain_begin(0));
+  CPPUNIT_ASSERT_EQUAL(2u, decomposition.domain_extension(0));
+  CPPUNIT_ASSERT_EQUAL(2u, decomposition.domain_begin(1));
+  CPPUNIT_ASSERT_EQUAL(3u, decomposition.domain_extension(1));
+  CPPUNIT_ASSERT_EQUAL(5u, decomposition.domain_begin(2));
+  CPPUNIT_ASSERT_EQUAL(3u, decomposition.domain_extension(2));
+
+  // At most one subdomain per row
+  DecompositionType decomposition_rows(*testlattice_2d, 20);
+  CPPUNIT_ASSERT_EQUAL(8u, decomposition_rows.get_domain_number());
+
+  // Odd extensions are not allowed
+  std::vector<unsigned int> size_odd;
+  size_odd.push_back(4); size_odd.push_back(5);
+  LatticeType lattice_odd(size_odd);
+  CPPUNIT_ASSERT_THROW(DecompositionType decomposition_odd(lattice_odd, 2), DecompositionType::ExceptionOddExtension);
+}
+
+void TestSpinLatticeDomainDecomposition::test_scatter_gather()
+{
+  DecompositionType decomposition(*testlattice_2d, 3);
+  LatticeType gathered_lattice(*testlattice_2d);
+  gathered_lattice(0, 0) = IsingSpin(-1);
+  gathered_lattice(7, 5) = IsingSpin(-1);
+  decomposition.gather(gathered_lattice);
+  CPPUNIT_ASSERT(gathered_lattice == *testlattice_2d);
+
+  // Scatter a changed lattice
+  gathered_lattice(3, 3) = IsingSpin(1);
+  gathered_lattice(4, 4) = IsingSpin(1);
+  decomposition.scatter(gathered_lattice);
+  LatticeType regathered_lattice(*testlattice_2d);
+  decomposition.gather(regathered_lattice);
+  CPPUNIT_ASSERT(regathered_lattice == gathered_lattice);
+}
+
+void TestSpinLatticeDomainDecomposition::test_energy()
+{
+  for (unsigned int domain_number = 1; domain_number <= 4; ++domain_number)
+  {
+    DecompositionType decomposition(*testlattice_2d, domain_number);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(testlattice_2d->energy(), decomposition.energy(), 1e-10);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(testlattice_2d->magnetization(), decomposition.magnetization(), 1e-10);
+
+    SpinLatticeDomainDecomposition<3, IsingSpin, RandomNumberGenerator> decomposition_3d(*testlattice_3d, domain_number);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(testlattice_3d->energy(), decomposition_3d.energy(), 1e-10);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(testlattice_3d->magnetization(), decomposition_3d.magnetization(), 1e-10);
+  }
+}
+
+void TestSpinLatticeDomainDecomposition::test_do_metropolis_sweeps()
+{
+  // After the sweeps the ghost rows must agree with the neighbouring subdomains
+  DecompositionType decomposition(*testlattice_2d, 4, 13);
+  decomposition.do_metropolis_sweeps(50, 0.3);
+  LatticeType gathered_lattice(*testlattice_2d);
+  decomposition.gather(gathered_lattice);
+  CPPUNIT_ASSERT(gathered_lattice != *testlattice_2d);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(gathered_lattice.energy(), decomposition.energy(), 1e-10);
+
+  // At low temperature the 3d lattice must reach the ground state without couplings
+  SpinLatticeDomainDecomposition<3, IsingSpin, RandomNumberGenerator> decomposition_3d(*testlattice_3d, 2, 7);
+  decomposition_3d.do_metropolis_sweeps(20, 5.0);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-192.0, decomposition_3d.energy(), 1e-10);
+
+  // At high temperature the mean energy is given by the leading order of the high temperature expansion
+  double energy_sum = 0;
+  decomposition_3d.do_metropolis_sweeps(100, 0.1);
+  for (unsigned int i = 0; i < 10000; ++i)
+  {
+    decomposition_3d.do_metropolis_sweeps(1, 0.1);
+    energy_sum += decomposition_3d.energy();
+  }
+  const double t = tanh(0.1);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-64.0*(3*t + 12*pow(t, 3)*(1 - t*t)), energy_sum/10000, 1.0);
+}
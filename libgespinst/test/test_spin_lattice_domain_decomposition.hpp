@@ -0,0 +1,51 @@
+#ifndef TEST_SPIN_LATTICE_DOMAIN_DECOMPOSITION_HPP
+#define TEST_SPIN_LATTICE_DOMAIN_DECOMPOSITION_HPP
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/Test.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <gespinst/spin_lattice_domain_decomposition.hpp>
+#include <gespinst/interactions/site_bond_interaction.hpp>
+#include <gespinst/spins/ising_spin.hpp>
+
+using namespace Gespinst;
+
+class TestSpinLatticeDomainDecomposition : public CppUnit::TestFixture
+{
+private:
+  //! Simple linear congruential random number generator for the tests
+  class RandomNumberGenerator
+  {
+  private:
+    uint64_t state;
+  public:
+    RandomNumberGenerator() : state(1) {}
+    void set_seed(uint32_t seed) { state = seed + 1; }
+    double random_double()
+    {
+      state = state*6364136223846793005ULL + 1442695040888963407ULL;
+      return (state >> 11) * (1.0/9007199254740992.0);
+    }
+  };
+
+  typedef SpinLattice<2, IsingSpin, Interactions::SiteBondInteraction> LatticeType;
+  typedef SpinLatticeDomainDecomposition<2, IsingSpin, RandomNumberGenerator, Interactions::SiteBondInteraction> DecompositionType;
+
+  LatticeType* testlattice_2d;
+  SpinLattice<3, IsingSpin>* testlattice_3d;
+
+public:
+  static CppUnit::Test* suite();
+
+  void setUp();
+  void tearDown();
+
+  void test_constructor();
+  void test_scatter_gather();
+  void test_energy();
+  void test_do_metropolis_sweeps();
+};
+
+#endif
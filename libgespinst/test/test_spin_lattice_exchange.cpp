@@ -0,0 +1,167 @@
+#include "test_spin_lattice_exchange.hpp"
+
+#include <cstdlib>
+#include <sstream>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/archive/text_iarchive.hpp>
+
+CppUnit::Test* TestSpinLatticeExchange::suite()
+{
+    CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("TestSpinLatticeExchange");
+    
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeExchange>("TestSpinLatticeExchange: test_constructor", &TestSpinLatticeExchange::test_constructor ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeExchange>("TestSpinLatticeExchange: test_neighbour_sites", &TestSpinLatticeExchange::test_neighbour_sites ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeExchange>("TestSpinLatticeExchange: test_unlike_bond_number", &TestSpinLatticeExchange::test_unlike_bond_number ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeExchange>("TestSpinLatticeExchange: test_propose_step", &TestSpinLatticeExchange::test_propose_step ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeExchange>("TestSpinLatticeExchange: test_commit", &TestSpinLatticeExchange::test_commit ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeExchange>("TestSpinLatticeExchange: test_conserved_magnetization", &TestSpinLatticeExchange::test_conserved_magnetization ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeExchange>("TestSpinLatticeExchange: test_serialize", &TestSpinLatticeExchange::test_serialize ) );
+
+    return suiteOfTests;
+}
+
+void TestSpinLatticeExchange::setUp()
+{
+  // Create the size vectors
+  std::vector<unsigned int> size_1d;
+  size_1d.push_back(5);
+  std::vector<unsigned int> size_2d;
+  size_2d.push_back(4); size_2d.push_back(4);
+
+  // Set up the 1d lattice with the spins + + - - +
+  SpinLattice<1, IsingSpin> lattice_1d(size_1d);
+  lattice_1d(2) = IsingSpin(-1);
+  lattice_1d(3) = IsingSpin(-1);
+  testlattice_1d = new SpinLatticeExchange<1, IsingSpin>(lattice_1d);
+
+  // Set up the 2d lattice with a checkerboard in the first two rows and up spins in the last two rows
+  SpinLattice<2, IsingSpin> lattice_2d(size_2d);
+  for (unsigned int i = 0; i < 2; ++i)
+    for (unsigned int j = 0; j < 4; ++j)
+      lattice_2d(i, j) = IsingSpin((i + j) % 2 == 0 ? 1 : -1);
+  testlattice_2d = new SpinLatticeExchange<2, IsingSpin>(lattice_2d);
+
+  // Set up a random 2d potts lattice
+  SpinLattice<2, PottsSpin> lattice_2d_potts(size_2d, PottsSpin(2, 0));
+  for (unsigned int i = 0; i < 4; ++i)
+    for (unsigned int j = 0; j < 4; ++j)
+      lattice_2d_potts(i, j) = PottsSpin(2, (3*i + j) % 3);
+  testlattice_2d_potts = new SpinLatticeExchange<2, PottsSpin>(lattice_2d_potts);
+}
+void TestSpinLatticeExchange::tearDown()
+{
+  delete testlattice_1d;
+  delete testlattice_2d;
+  delete testlattice_2d_potts;
+}
+
+void TestSpinLatticeExchange::test_constructor()
+{
+  SpinLatticeExchange<1, IsingSpin> testlattice_1d_copy(*testlattice_1d);
+  CPPUNIT_ASSERT(testlattice_1d_copy == *testlattice_1d);
+  CPPUNIT_ASSERT_EQUAL(testlattice_1d->unlike_bond_number(), testlattice_1d_copy.unlike_bond_number());
+}
+
+void TestSpinLatticeExchange::test_neighbour_sites()
+{
+  CPPUNIT_ASSERT_EQUAL(1u, testlattice_1d->upper_neighbour_site(0, 0));
+  CPPUNIT_ASSERT_EQUAL(4u, testlattice_1d->lower_neighbour_site(0, 0));
+  CPPUNIT_ASSERT_EQUAL(0u, testlattice_1d->upper_neighbour_site(4, 0));
+  CPPUNIT_ASSERT_EQUAL(3u, testlattice_1d->lower_neighbour_site(4, 0));
+
+  // Site (1,3) has the linear index 7
+  CPPUNIT_ASSERT_EQUAL(11u, testlattice_2d->upper_neighbour_site(7, 0));
+  CPPUNIT_ASSERT_EQUAL(3u, testlattice_2d->lower_neighbour_site(7, 0));
+  CPPUNIT_ASSERT_EQUAL(4u, testlattice_2d->upper_neighbour_site(7, 1));
+  CPPUNIT_ASSERT_EQUAL(6u, testlattice_2d->lower_neighbour_site(7, 1));
+
+  CPPUNIT_ASSERT_EQUAL(7u, testlattice_2d->bond_first_site(15));
+  CPPUNIT_ASSERT_EQUAL(4u, testlattice_2d->bond_second_site(15));
+}
+
+void TestSpinLatticeExchange::test_unlike_bond_number()
+{
+  CPPUNIT_ASSERT_EQUAL(2u, testlattice_1d->unlike_bond_number());
+  // Checkerboard rows: 8 horizontal and 4 vertical unlike bonds, 4 vertical bonds to the uniform rows
+  CPPUNIT_ASSERT_EQUAL(16u, testlattice_2d->unlike_bond_number());
+  // Columns with the values 0 1 2 0: 3 unlike horizontal bonds per row
+  CPPUNIT_ASSERT_EQUAL(12u, testlattice_2d_potts->unlike_bond_number());
+}
+
+void TestSpinLatticeExchange::test_propose_step()
+{
+  for (unsigned int i = 0; i < 100; ++i)
+  {
+    double random_double = static_cast<double>(rand())/RAND_MAX;
+    SpinLatticeExchangeStep<2, IsingSpin> step = testlattice_2d->propose_step(random_double);
+    CPPUNIT_ASSERT(step.get_lattice() == testlattice_2d);
+    CPPUNIT_ASSERT(step.is_executable());
+    CPPUNIT_ASSERT(testlattice_2d->site_spin(step.get_first_site()) != testlattice_2d->site_spin(step.get_second_site()));
+  }
+
+  // A uniform lattice has no unlike bonds and proposes not executable steps
+  std::vector<unsigned int> size_1d;
+  size_1d.push_back(5);
+  SpinLatticeExchange<1, IsingSpin> uniform_lattice(size_1d);
+  CPPUNIT_ASSERT_EQUAL(0u, uniform_lattice.unlike_bond_number());
+  CPPUNIT_ASSERT(!uniform_lattice.propose_step(0.5).is_executable());
+}
+
+void TestSpinLatticeExchange::test_commit()
+{
+  // Exchange the spins of sites 1 and 2, giving + - + - +
+  SpinLatticeExchangeStep<1, IsingSpin> step(testlattice_1d, 1);
+  step.execute();
+
+  CPPUNIT_ASSERT((*testlattice_1d)(1) == IsingSpin(-1));
+  CPPUNIT_ASSERT((*testlattice_1d)(2) == IsingSpin(1));
+  CPPUNIT_ASSERT_EQUAL(4u, testlattice_1d->unlike_bond_number());
+  CPPUNIT_ASSERT_EQUAL(1, testlattice_1d->get_simulation_time());
+
+  // The bookkeeping must agree with a complete reconstruction after many steps
+  for (unsigned int i = 0; i < 1000; ++i)
+  {
+    double random_double = static_cast<double>(rand())/RAND_MAX;
+    SpinLatticeExchangeStep<2, PottsSpin> step_potts = testlattice_2d_potts->propose_step(random_double);
+    step_potts.execute();
+  }
+  unsigned int unlike_bonds = testlattice_2d_potts->unlike_bond_number();
+  testlattice_2d_potts->initialise_unlike_bonds();
+  CPPUNIT_ASSERT_EQUAL(unlike_bonds, testlattice_2d_potts->unlike_bond_number());
+}
+
+void TestSpinLatticeExchange::test_conserved_magnetization()
+{
+  double magnetization = testlattice_2d->magnetization();
+  for (unsigned int i = 0; i < 1000; ++i)
+  {
+    double random_double = static_cast<double>(rand())/RAND_MAX;
+    SpinLatticeExchangeStep<2, IsingSpin> step = testlattice_2d->propose_step(random_double);
+    step.execute();
+  }
+  CPPUNIT_ASSERT_EQUAL(magnetization, testlattice_2d->magnetization());
+}
+
+void TestSpinLatticeExchange::test_serialize()
+{
+  // Save a const lattice, saving must not change the lattice
+  std::stringstream stream;
+  {
+    const SpinLatticeExchange<2, IsingSpin>& const_lattice = *testlattice_2d;
+    boost::archive::text_oarchive oa(stream);
+    oa << const_lattice;
+  }
+
+  // The unlike bonds are rebuilt from the loaded spins
+  SpinLatticeExchange<2, IsingSpin> testlattice_2d_loaded;
+  {
+    boost::archive::text_iarchive ia(stream);
+    ia >> testlattice_2d_loaded;
+  }
+  CPPUNIT_ASSERT(*testlattice_2d == testlattice_2d_loaded);
+  CPPUNIT_ASSERT_EQUAL(testlattice_2d->unlike_bond_number(), testlattice_2d_loaded.unlike_bond_number());
+  SpinLatticeExchangeStep<2, IsingSpin> step = testlattice_2d_loaded.propose_step(0.5);
+  testlattice_2d_loaded.commit(step);
+  const double magnetization = testlattice_2d->magnetization();
+  CPPUNIT_ASSERT_EQUAL(magnetization, testlattice_2d_loaded.magnetization());
+}
@@ -0,0 +1,37 @@
+#ifndef TEST_SPIN_LATTICE_EXCHANGE_HPP
+#define TEST_SPIN_LATTICE_EXCHANGE_HPP
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/Test.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <gespinst/spin_lattice_exchange.hpp>
+#include <gespinst/spins/ising_spin.hpp>
+#include <gespinst/spins/potts_spin.hpp>
+
+using namespace Gespinst;
+
+class TestSpinLatticeExchange : public CppUnit::TestFixture
+{
+private:
+  SpinLatticeExchange<1, IsingSpin>* testlattice_1d;
+  SpinLatticeExchange<2, IsingSpin>* testlattice_2d;
+  SpinLatticeExchange<2, PottsSpin>* testlattice_2d_potts;
+
+public:
+  static CppUnit::Test* suite();
+
+  void setUp();
+  void tearDown();
+
+  void test_constructor();
+  void test_neighbour_sites();
+  void test_unlike_bond_number();
+  void test_propose_step();
+  void test_commit();
+  void test_conserved_magnetization();
+  void test_serialize();
+};
+
+#endif
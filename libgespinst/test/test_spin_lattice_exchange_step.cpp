@@ -0,0 +1,143 @@
+#include "test_spin_lattice_exchange_step.hpp"
+
+#include <cstdlib>
+
+CppUnit::Test* TestSpinLatticeExchangeStep::suite()
+{
+    CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("TestSpinLatticeExchangeStep");
+    
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeExchangeStep>("TestSpinLatticeExchangeStep: test_constructor", &TestSpinLatticeExchangeStep::test_constructor ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeExchangeStep>("TestSpinLatticeExchangeStep: test_delta_E", &TestSpinLatticeExchangeStep::test_delta_E ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeExchangeStep>("TestSpinLatticeExchangeStep: test_delta_unlike_bonds", &TestSpinLatticeExchangeStep::test_delta_unlike_bonds ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeExchangeStep>("TestSpinLatticeExchangeStep: test_selection_probability_factor", &TestSpinLatticeExchangeStep::test_selection_probability_factor ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeExchangeStep>("TestSpinLatticeExchangeStep: test_execute", &TestSpinLatticeExchangeStep::test_execute ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeExchangeStep>("TestSpinLatticeExchangeStep: test_undo", &TestSpinLatticeExchangeStep::test_undo ) );
+
+    return suiteOfTests;
+}
+
+void TestSpinLatticeExchangeStep::setUp()
+{
+  // Create the size vectors
+  std::vector<unsigned int> size_1d;
+  size_1d.push_back(5);
+  std::vector<unsigned int> size_2d;
+  size_2d.push_back(4); size_2d.push_back(5);
+
+  // Set up the 1d lattice with the spins + + - - +
+  SpinLattice<1, IsingSpin> lattice_1d(size_1d);
+  lattice_1d(2) = IsingSpin(-1);
+  lattice_1d(3) = IsingSpin(-1);
+  testlattice_1d = new SpinLatticeExchange<1, IsingSpin>(lattice_1d);
+
+  // Set up 2d lattices with pseudo-random spins
+  SpinLattice<2, IsingSpin> lattice_2d(size_2d);
+  SpinLattice<2, RealSpin> lattice_2d_real(size_2d);
+  for (unsigned int i = 0; i < 4; ++i)
+  {
+    for (unsigned int j = 0; j < 5; ++j)
+    {
+      lattice_2d(i, j) = IsingSpin((7*i + 3*j) % 5 < 2 ? 1 : -1);
+      lattice_2d_real(i, j) = RealSpin(0.25*((5*i + 2*j) % 7) - 0.75);
+    }
+  }
+  testlattice_2d = new SpinLatticeExchange<2, IsingSpin>(lattice_2d);
+  testlattice_2d_real = new SpinLatticeExchange<2, RealSpin>(lattice_2d_real);
+}
+void TestSpinLatticeExchangeStep::tearDown()
+{
+  delete testlattice_1d;
+  delete testlattice_2d;
+  delete testlattice_2d_real;
+}
+
+void TestSpinLatticeExchangeStep::test_constructor()
+{
+  SpinLatticeExchangeStep<1, IsingSpin> step(testlattice_1d, 3);
+  CPPUNIT_ASSERT(step.get_lattice() == testlattice_1d);
+  CPPUNIT_ASSERT_EQUAL(3u, step.get_bond());
+  CPPUNIT_ASSERT_EQUAL(3u, step.get_first_site());
+  CPPUNIT_ASSERT_EQUAL(4u, step.get_second_site());
+  CPPUNIT_ASSERT_EQUAL(0, step.get_creation_simulation_time());
+  CPPUNIT_ASSERT(step.is_executable());
+
+  SpinLatticeExchangeStep<1, IsingSpin> step_equal(testlattice_1d, 0);
+  CPPUNIT_ASSERT(!step_equal.is_executable());
+}
+
+void TestSpinLatticeExchangeStep::test_delta_E()
+{
+  // Exchange of the sites 1 and 2: + - + - + has energy 5
+  SpinLatticeExchangeStep<1, IsingSpin> step_1d(testlattice_1d, 1);
+  CPPUNIT_ASSERT_EQUAL(4.0, step_1d.delta_E());
+
+  // Compare with the energy difference of the whole lattice for all bonds
+  for (unsigned int bond = 0; bond < 40; ++bond)
+  {
+    SpinLatticeExchangeStep<2, IsingSpin> step_2d(testlattice_2d, bond);
+    double energy_before = testlattice_2d->energy();
+    double delta_E = step_2d.delta_E();
+    step_2d.execute();
+    CPPUNIT_ASSERT_EQUAL(testlattice_2d->energy() - energy_before, delta_E);
+    step_2d.undo();
+
+    SpinLatticeExchangeStep<2, RealSpin> step_2d_real(testlattice_2d_real, bond);
+    energy_before = testlattice_2d_real->energy();
+    delta_E = step_2d_real.delta_E();
+    step_2d_real.execute();
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(testlattice_2d_real->energy() - energy_before, delta_E, 1e-10);
+    step_2d_real.undo();
+  }
+}
+
+void TestSpinLatticeExchangeStep::test_delta_unlike_bonds()
+{
+  for (unsigned int bond = 0; bond < 40; ++bond)
+  {
+    SpinLatticeExchangeStep<2, IsingSpin> step_2d(testlattice_2d, bond);
+    int unlike_bonds_before = testlattice_2d->unlike_bond_number();
+    int delta_unlike_bonds = step_2d.delta_unlike_bonds();
+    step_2d.execute();
+    CPPUNIT_ASSERT_EQUAL(static_cast<int>(testlattice_2d->unlike_bond_number()) - unlike_bonds_before, delta_unlike_bonds);
+    step_2d.undo();
+  }
+}
+
+void TestSpinLatticeExchangeStep::test_selection_probability_factor()
+{
+  // + + - - + has 2 unlike bonds, + - + - + has 4 unlike bonds
+  SpinLatticeExchangeStep<1, IsingSpin> step_1d(testlattice_1d, 1);
+  CPPUNIT_ASSERT_EQUAL(2.0, step_1d.selection_probability_factor());
+  step_1d.execute();
+
+  // The inverse step has the inverse selection probability factor
+  SpinLatticeExchangeStep<1, IsingSpin> inverse_step_1d(testlattice_1d, 1);
+  CPPUNIT_ASSERT_EQUAL(0.5, inverse_step_1d.selection_probability_factor());
+}
+
+void TestSpinLatticeExchangeStep::test_execute()
+{
+  SpinLatticeExchangeStep<1, IsingSpin> step_1d(testlattice_1d, 1);
+  step_1d.execute();
+
+  CPPUNIT_ASSERT((*testlattice_1d)(1) == IsingSpin(-1));
+  CPPUNIT_ASSERT((*testlattice_1d)(2) == IsingSpin(1));
+  CPPUNIT_ASSERT_EQUAL(3.0, testlattice_1d->energy());
+  CPPUNIT_ASSERT_EQUAL(1, testlattice_1d->get_simulation_time());
+}
+
+void TestSpinLatticeExchangeStep::test_undo()
+{
+  SpinLatticeExchange<2, IsingSpin> testlattice_2d_copy(*testlattice_2d);
+  for (unsigned int i = 0; i < 100; ++i)
+  {
+    double random_double = static_cast<double>(rand())/RAND_MAX;
+    SpinLatticeExchangeStep<2, IsingSpin> step = testlattice_2d->propose_step(random_double);
+    step.execute();
+    step.undo();
+  }
+
+  CPPUNIT_ASSERT(*testlattice_2d == testlattice_2d_copy);
+  CPPUNIT_ASSERT_EQUAL(testlattice_2d_copy.unlike_bond_number(), testlattice_2d->unlike_bond_number());
+  CPPUNIT_ASSERT_EQUAL(200, testlattice_2d->get_simulation_time());
+}
@@ -0,0 +1,37 @@
+#ifndef TEST_SPIN_LATTICE_EXCHANGE_STEP_HPP
+#define TEST_SPIN_LATTICE_EXCHANGE_STEP_HPP
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/Test.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <gespinst/spin_lattice_exchange_step.hpp>
+#include <gespinst/spin_lattice_exchange.hpp>
+#include <gespinst/spins/ising_spin.hpp>
+#include <gespinst/spins/real_spin.hpp>
+
+using namespace Gespinst;
+
+class TestSpinLatticeExchangeStep : public CppUnit::TestFixture
+{
+private:
+  SpinLatticeExchange<1, IsingSpin>* testlattice_1d;
+  SpinLatticeExchange<2, IsingSpin>* testlattice_2d;
+  SpinLatticeExchange<2, RealSpin>* testlattice_2d_real;
+
+public:
+  static CppUnit::Test* suite();
+
+  void setUp();
+  void tearDown();
+
+  void test_constructor();
+  void test_delta_E();
+  void test_delta_unlike_bonds();
+  void test_selection_probability_factor();
+  void test_execute();
+  void test_undo();
+};
+
+#endif
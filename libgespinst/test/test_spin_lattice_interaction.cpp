@@ -0,0 +1,185 @@
+#include "test_spin_lattice_interaction.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+//! Helper class writing a lattice in the format of serialization version 0, without the interaction
+struct LatticeVersion0 : public SpinLattice<2, IsingSpin, Interactions::SiteBondInteraction>
+{
+  LatticeVersion0(const SpinLattice<2, IsingSpin, Interactions::SiteBondInteraction>& other) : SpinLattice<2, IsingSpin, Interactions::SiteBondInteraction>(other) {}
+  template<class Archive> void serialize(Archive & ar, const unsigned int)
+  {
+    ar & spin_lattice;
+    ar & _simulation_time;
+  }
+};
+
+CppUnit::Test* TestSpinLatticeInteraction::suite()
+{
+    CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("TestSpinLatticeInteraction");
+    
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeInteraction>("TestSpinLatticeInteraction: test_constructor", &TestSpinLatticeInteraction::test_constructor ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeInteraction>("TestSpinLatticeInteraction: test_energy", &TestSpinLatticeInteraction::test_energy ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeInteraction>("TestSpinLatticeInteraction: test_delta_E", &TestSpinLatticeInteraction::test_delta_E ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeInteraction>("TestSpinLatticeInteraction: test_serialize", &TestSpinLatticeInteraction::test_serialize ) );
+
+    return suiteOfTests;
+}
+
+void TestSpinLatticeInteraction::setUp()
+{
+  // Create the size vectors
+  std::vector<unsigned int> size_1d;
+  size_1d.push_back(5);
+  std::vector<unsigned int> size_2d;
+  size_2d.push_back(3); size_2d.push_back(4);
+
+  // Set up the 1d lattice with the spins + + - - + in a field 0.5
+  testlattice_field = new SpinLattice<1, IsingSpin, Interactions::UniformFieldInteraction>(size_1d);
+  (*testlattice_field)(2) = IsingSpin(-1);
+  (*testlattice_field)(3) = IsingSpin(-1);
+  testlattice_field->get_interaction().set_field(0.5);
+
+  // Set up the 2d lattice with up spins, a down spin at (1,1), two modified couplings and a field at one site
+  testlattice_random = new SpinLattice<2, IsingSpin, Interactions::SiteBondInteraction>(size_2d);
+  (*testlattice_random)(1,1) = IsingSpin(-1);
+  // Bond (1,1) - (2,1)
+  testlattice_random->get_interaction().set_coupling(5, 0, 2.0);
+  // Bond (1,0) - (1,1)
+  testlattice_random->get_interaction().set_coupling(4, 1, -1.0);
+  // Field at (0,0)
+  testlattice_random->get_interaction().set_field(0, 3.0);
+}
+void TestSpinLatticeInteraction::tearDown()
+{
+  delete testlattice_field;
+  delete testlattice_random;
+}
+
+void TestSpinLatticeInteraction::test_constructor()
+{
+  CPPUNIT_ASSERT_EQUAL(0.5, testlattice_field->get_interaction().field(3));
+  CPPUNIT_ASSERT_EQUAL(1.0, testlattice_field->get_interaction().coupling(3, 0));
+
+  CPPUNIT_ASSERT_EQUAL(2.0, testlattice_random->get_interaction().coupling(5, 0));
+  CPPUNIT_ASSERT_EQUAL(1.0, testlattice_random->get_interaction().coupling(5, 1));
+  CPPUNIT_ASSERT_EQUAL(3.0, testlattice_random->get_interaction().field(0));
+  CPPUNIT_ASSERT_EQUAL(0.0, testlattice_random->get_interaction().field(5));
+  CPPUNIT_ASSERT_EQUAL(-1.0, testlattice_random->get_interaction().coupling(4, 1));
+
+  // The copy must contain the interaction
+  SpinLattice<2, IsingSpin, Interactions::SiteBondInteraction> testlattice_random_copy(*testlattice_random);
+  CPPUNIT_ASSERT(testlattice_random_copy == *testlattice_random);
+  CPPUNIT_ASSERT_EQUAL(2.0, testlattice_random_copy.get_interaction().coupling(5, 0));
+  CPPUNIT_ASSERT_EQUAL(3.0, testlattice_random_copy.get_interaction().field(0));
+}
+
+void TestSpinLatticeInteraction::test_energy()
+{
+  // Only the uniform interaction skips the field term
+  CPPUNIT_ASSERT(!Interactions::HasField<Interactions::UniformInteraction>::value);
+  CPPUNIT_ASSERT(Interactions::HasField<Interactions::UniformFieldInteraction>::value);
+  CPPUNIT_ASSERT(Interactions::HasField<Interactions::SiteBondInteraction>::value);
+
+  // Bonds: 3 equal, 2 unlike; field: 0.5 * (3 - 2)
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.0 - 0.5, testlattice_field->energy(), 1e-12);
+
+  // 24 bonds, 4 of them unlike: 20 equal bonds with coupling 1, the unlike bonds have the couplings 2, -1, 1, 1; field 3 at an up spin
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-20.0 + 3.0 - 3.0, testlattice_random->energy(), 1e-12);
+
+  // The energy summed in storage order equals the sum over the bonds of all sites to their upper neighbours, also for an extension of 1
+  for (unsigned int first_extension = 1; first_extension <= 2; ++first_extension)
+  {
+    std::vector<unsigned int> size_3d;
+    size_3d.push_back(first_extension); size_3d.push_back(3); size_3d.push_back(4);
+    SpinLattice<3, IsingSpin, Interactions::SiteBondInteraction> testlattice_3d(size_3d);
+    double reference_energy = 0.0;
+    for (unsigned int site = 0; site < testlattice_3d.system_size(); ++site)
+    {
+      testlattice_3d.set_site_spin(site, IsingSpin((site*7) % 3 == 0 ? -1 : 1));
+      testlattice_3d.get_interaction().set_field(site, 0.1*site);
+      for (unsigned int d = 0; d < 3; ++d)
+	testlattice_3d.get_interaction().set_coupling(site, d, 0.5 + site + 0.25*d);
+    }
+    for (unsigned int site = 0; site < testlattice_3d.system_size(); ++site)
+    {
+      for (unsigned int d = 0; d < 3; ++d)
+	reference_energy -= testlattice_3d.get_interaction().coupling(site, d) * (testlattice_3d.site_spin(site) * testlattice_3d.site_spin(testlattice_3d.upper_neighbour_site(site, d)));
+      reference_energy -= testlattice_3d.get_interaction().field(site) * testlattice_3d.site_spin(site).get_value();
+    }
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(reference_energy, testlattice_3d.energy(), 1e-9);
+  }
+}
+
+void TestSpinLatticeInteraction::test_delta_E()
+{
+  // Compare the energy difference of every possible step with the difference of the total energy
+  std::vector<SpinLatticeStep<1, IsingSpin, Interactions::UniformFieldInteraction> > steps_1d = testlattice_field->all_steps();
+  for (unsigned int i = 0; i < steps_1d.size(); ++i)
+  {
+    const double energy_before = testlattice_field->energy();
+    const double delta_E = steps_1d[i].delta_E();
+    steps_1d[i].execute();
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(testlattice_field->energy() - energy_before, delta_E, 1e-12);
+    steps_1d[i].undo();
+  }
+
+  std::vector<SpinLatticeStep<2, IsingSpin, Interactions::SiteBondInteraction> > steps_2d = testlattice_random->all_steps();
+  for (unsigned int i = 0; i < steps_2d.size(); ++i)
+  {
+    const double energy_before = testlattice_random->energy();
+    const double delta_E = steps_2d[i].delta_E();
+    steps_2d[i].execute();
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(testlattice_random->energy() - energy_before, delta_E, 1e-12);
+    steps_2d[i].undo();
+  }
+}
+
+void TestSpinLatticeInteraction::test_serialize()
+{
+  std::ostringstream filename;
+  filename << "/tmp/gespinst_test_spin_lattice_interaction_" << getpid() << ".dat";
+
+  // Save the lattice
+  std::ofstream output_filestream(filename.str().c_str());
+  {
+    boost::archive::text_oarchive output_archive(output_filestream);
+    output_archive << (*testlattice_random);
+  }
+  output_filestream.close();
+
+  // Load the lattice
+  SpinLattice<2, IsingSpin, Interactions::SiteBondInteraction> loaded_lattice;
+  std::ifstream input_filestream(filename.str().c_str());
+  {
+    boost::archive::text_iarchive input_archive(input_filestream);
+    input_archive >> loaded_lattice;
+  }
+  input_filestream.close();
+  std::remove(filename.str().c_str());
+
+  CPPUNIT_ASSERT(loaded_lattice == *testlattice_random);
+  CPPUNIT_ASSERT_EQUAL(-1.0, loaded_lattice.get_interaction().coupling(4, 1));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(testlattice_random->energy(), loaded_lattice.energy(), 1e-12);
+
+  // Lattices with equal spins but different couplings are not equal
+  loaded_lattice.get_interaction().set_coupling(4, 1, 1.0);
+  CPPUNIT_ASSERT(loaded_lattice != *testlattice_random);
+
+  // Lattices of version 0 are loaded with the default couplings and fields
+  const LatticeVersion0 lattice_version_0(*testlattice_random);
+  std::stringstream version_0_stream;
+  {
+    boost::archive::text_oarchive output_archive(version_0_stream);
+    output_archive << lattice_version_0;
+  }
+  {
+    boost::archive::text_iarchive input_archive(version_0_stream);
+    input_archive >> loaded_lattice;
+  }
+  CPPUNIT_ASSERT_EQUAL(testlattice_random->site_spin(4), loaded_lattice.site_spin(4));
+  CPPUNIT_ASSERT_EQUAL(1.0, loaded_lattice.get_interaction().coupling(4, 1));
+  CPPUNIT_ASSERT_EQUAL(0.0, loaded_lattice.get_interaction().field(0));
+}
@@ -0,0 +1,34 @@
+#ifndef TEST_SPIN_LATTICE_INTERACTION_HPP
+#define TEST_SPIN_LATTICE_INTERACTION_HPP
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/Test.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <gespinst/spin_lattice.hpp>
+#include <gespinst/interactions/uniform_field_interaction.hpp>
+#include <gespinst/interactions/site_bond_interaction.hpp>
+#include <gespinst/spins/ising_spin.hpp>
+
+using namespace Gespinst;
+
+class TestSpinLatticeInteraction : public CppUnit::TestFixture
+{
+private:
+  SpinLattice<1, IsingSpin, Interactions::UniformFieldInteraction>* testlattice_field;
+  SpinLattice<2, IsingSpin, Interactions::SiteBondInteraction>* testlattice_random;
+
+public:
+  static CppUnit::Test* suite();
+
+  void setUp();
+  void tearDown();
+
+  void test_constructor();
+  void test_energy();
+  void test_delta_E();
+  void test_serialize();
+};
+
+#endif
@@ -0,0 +1,180 @@
+#include "test_spin_lattice_structure_factor.hpp"
+
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+
+CppUnit::Test* TestSpinLatticeStructureFactor::suite()
+{
+    CppUnit::TestSuite *suiteOfTests = new CppUnit::TestSuite("TestSpinLatticeStructureFactor");
+    
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeStructureFactor>("TestSpinLatticeStructureFactor: test_structure_factor", &TestSpinLatticeStructureFactor::test_structure_factor ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeStructureFactor>("TestSpinLatticeStructureFactor: test_correlation_function", &TestSpinLatticeStructureFactor::test_correlation_function ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeStructureFactor>("TestSpinLatticeStructureFactor: test_second_moment_correlation_length", &TestSpinLatticeStructureFactor::test_second_moment_correlation_length ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeStructureFactor>("TestSpinLatticeStructureFactor: test_fourier_modes", &TestSpinLatticeStructureFactor::test_fourier_modes ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestSpinLatticeStructureFactor>("TestSpinLatticeStructureFactor: test_potts", &TestSpinLatticeStructureFactor::test_potts ) );
+
+    return suiteOfTests;
+}
+
+void TestSpinLatticeStructureFactor::setUp()
+{
+  // 2d lattice with an extension that is a power of two and one that is not
+  std::vector<unsigned int> size_2d;
+  size_2d.push_back(8); size_2d.push_back(6);
+  testlattice_2d = new SpinLattice<2, IsingSpin>(size_2d);
+  for (unsigned int i = 0; i < 8; ++i)
+    for (unsigned int j = 0; j < 6; ++j)
+      if ((5*i + 3*j) % 7 < 3) (*testlattice_2d)(i, j) = IsingSpin(-1);
+
+  // 1d lattice of real spins
+  std::vector<unsigned int> size_1d(1, 5);
+  testlattice_1d = new SpinLattice<1, RealSpin>(size_1d);
+  for (unsigned int i = 0; i < 5; ++i)
+    (*testlattice_1d)(i) = RealSpin(0.3*i - 0.5);
+}
+void TestSpinLatticeStructureFactor::tearDown()
+{
+  delete testlattice_2d;
+  delete testlattice_1d;
+}
+
+void TestSpinLatticeStructureFactor::test_structure_factor()
+{
+  // Compare with the direct sum over all sites for all wave vectors
+  SpinLatticeStructureFactor<2, IsingSpin> structure_factor_2d(*testlattice_2d);
+  const std::vector<double>& values_2d = structure_factor_2d.structure_factor(*testlattice_2d);
+  CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(48), values_2d.size());
+  for (unsigned int n0 = 0; n0 < 8; ++n0)
+    for (unsigned int n1 = 0; n1 < 6; ++n1)
+    {
+      std::complex<double> mode(0.0, 0.0);
+      for (unsigned int i = 0; i < 8; ++i)
+	for (unsigned int j = 0; j < 6; ++j)
+	  mode += static_cast<double>((*testlattice_2d)(i, j).get_value()) * std::polar(1.0, -2.0*M_PI*(n0*i/8.0 + n1*j/6.0));
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(std::norm(mode)/48.0, values_2d[6*n0 + n1], 1e-10);
+    }
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(pow(testlattice_2d->magnetization(), 2)/48.0, values_2d[0], 1e-10);
+
+  SpinLatticeStructureFactor<1, RealSpin> structure_factor_1d(*testlattice_1d);
+  const std::vector<double>& values_1d = structure_factor_1d.structure_factor(*testlattice_1d);
+  for (unsigned int n = 0; n < 5; ++n)
+  {
+    std::complex<double> mode(0.0, 0.0);
+    for (unsigned int i = 0; i < 5; ++i)
+      mode += (*testlattice_1d)(i).get_value() * std::polar(1.0, -2.0*M_PI*n*i/5.0);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(std::norm(mode)/5.0, values_1d[n], 1e-10);
+  }
+
+  // Lattices with other extensions are rejected
+  std::vector<unsigned int> other_size(2, 8);
+  SpinLattice<2, IsingSpin> other_lattice(other_size);
+  CPPUNIT_ASSERT_THROW(structure_factor_2d.structure_factor(other_lattice), std::invalid_argument);
+}
+
+void TestSpinLatticeStructureFactor::test_correlation_function()
+{
+  SpinLatticeStructureFactor<2, IsingSpin> structure_factor_2d(*testlattice_2d);
+  const std::vector<double>& correlation = structure_factor_2d.correlation_function(*testlattice_2d);
+  for (unsigned int r0 = 0; r0 < 8; ++r0)
+    for (unsigned int r1 = 0; r1 < 6; ++r1)
+    {
+      double sum = 0.0;
+      for (unsigned int i = 0; i < 8; ++i)
+	for (unsigned int j = 0; j < 6; ++j)
+	  sum += (*testlattice_2d)(i, j) * (*testlattice_2d)((i + r0) % 8, (j + r1) % 6);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(sum/48.0, correlation[6*r0 + r1], 1e-10);
+    }
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, correlation[0], 1e-10);
+}
+
+void TestSpinLatticeStructureFactor::test_second_moment_correlation_length()
+{
+  // A single row of flipped spins gives structure only along the first direction
+  std::vector<unsigned int> size(2, 8);
+  SpinLattice<2, IsingSpin> lattice(size);
+  for (unsigned int j = 0; j < 8; ++j)
+    lattice(0, j) = IsingSpin(-1);
+  SpinLatticeStructureFactor<2, IsingSpin> structure_factor(lattice);
+  const std::vector<double>& values = structure_factor.structure_factor(lattice);
+  const double expected = SpinLatticeStructureFactor<2, IsingSpin>::second_moment_correlation_length(values[0], values[8], 8) / 2.0;
+  CPPUNIT_ASSERT(expected > 0.0);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, structure_factor.second_moment_correlation_length(lattice), 1e-10);
+
+  // The fully ordered lattice has no structure at non-zero wave vectors
+  SpinLattice<2, IsingSpin> ordered_lattice(size);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, structure_factor.second_moment_correlation_length(ordered_lattice), 1e-10);
+}
+
+void TestSpinLatticeStructureFactor::test_fourier_modes()
+{
+  SpinLatticeStructureFactor<2, IsingSpin> structure_factor(*testlattice_2d);
+  SpinLatticeFourierModes<2, IsingSpin> modes(*testlattice_2d);
+
+  // Flip some spins and update the modes with the executed steps
+  for (unsigned int flip = 0; flip < 100; ++flip)
+  {
+    SpinLatticeStep<2, IsingSpin> step = testlattice_2d->propose_step(((37*flip) % 100) / 100.0);
+    testlattice_2d->commit(step);
+    modes.update(step);
+  }
+
+  const std::vector<double>& values = structure_factor.structure_factor(*testlattice_2d);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(testlattice_2d->magnetization(), modes.mode_zero().real(), 1e-10);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(values[0], modes.structure_factor_zero(), 1e-10);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(values[6], modes.structure_factor_minimal(0), 1e-10);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(values[1], modes.structure_factor_minimal(1), 1e-10);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(structure_factor.second_moment_correlation_length(*testlattice_2d), modes.second_moment_correlation_length(), 1e-10);
+}
+
+void TestSpinLatticeStructureFactor::test_potts()
+{
+  // 3-state Potts lattice and the same lattice with permuted state labels
+  std::vector<unsigned int> size;
+  size.push_back(4); size.push_back(6);
+  SpinLattice<2, PottsSpin> lattice(size, PottsSpin(2, 0));
+  SpinLattice<2, PottsSpin> relabelled_lattice(size, PottsSpin(2, 0));
+  for (unsigned int i = 0; i < 4; ++i)
+    for (unsigned int j = 0; j < 6; ++j)
+    {
+      const unsigned int state = (i*i + 2*j) % 3;
+      lattice(i, j) = PottsSpin(2, state);
+      relabelled_lattice(i, j) = PottsSpin(2, (state + 1) % 3);
+    }
+
+  // The correlation function is the probability of equal states minus 1/q
+  SpinLatticeStructureFactor<2, PottsSpin> structure_factor(lattice);
+  const std::vector<double> correlation = structure_factor.correlation_function(lattice);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0 - 1.0/3.0, correlation[0], 1e-10);
+  double expected = 0.0;
+  for (unsigned int i = 0; i < 4; ++i)
+    for (unsigned int j = 0; j < 6; ++j)
+      expected += ((lattice(i, j) == lattice((i + 1) % 4, j)) ? 1.0 : 0.0) - 1.0/3.0;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(expected/24.0, correlation[6], 1e-10);
+
+  // The structure factor does not depend on the numbering of the states
+  const std::vector<double> values = structure_factor.structure_factor(lattice);
+  const std::vector<double>& relabelled_values = structure_factor.structure_factor(relabelled_lattice);
+  for (unsigned int site = 0; site < values.size(); ++site)
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(values[site], relabelled_values[site], 1e-10);
+
+  // A lattice with all spins in one state has S(0) = N (1 - 1/q) and no structure at non-zero wave vectors
+  SpinLattice<2, PottsSpin> ordered_lattice(size, PottsSpin(2, 1));
+  const std::vector<double>& ordered_values = structure_factor.structure_factor(ordered_lattice);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(24.0*(1.0 - 1.0/3.0), ordered_values[0], 1e-10);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, ordered_values[1], 1e-10);
+
+  // The tracked modes agree with the structure factor after some steps
+  SpinLatticeFourierModes<2, PottsSpin> modes(lattice);
+  CPPUNIT_ASSERT_EQUAL(3u, modes.get_component_number());
+  for (unsigned int flip = 0; flip < 100; ++flip)
+  {
+    SpinLatticeStep<2, PottsSpin> step = lattice.propose_step(((37*flip) % 100) / 100.0);
+    lattice.commit(step);
+    modes.update(step);
+  }
+  const std::vector<double>& updated_values = structure_factor.structure_factor(lattice);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(updated_values[0], modes.structure_factor_zero(), 1e-10);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(updated_values[6], modes.structure_factor_minimal(0), 1e-10);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(updated_values[1], modes.structure_factor_minimal(1), 1e-10);
+}
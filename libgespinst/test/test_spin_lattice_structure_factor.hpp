@@ -0,0 +1,35 @@
+#ifndef TEST_SPIN_LATTICE_STRUCTURE_FACTOR_HPP
+#define TEST_SPIN_LATTICE_STRUCTURE_FACTOR_HPP
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/Test.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <gespinst/spin_lattice_structure_factor.hpp>
+#include <gespinst/spins/ising_spin.hpp>
+#include <gespinst/spins/potts_spin.hpp>
+#include <gespinst/spins/real_spin.hpp>
+
+using namespace Gespinst;
+
+class TestSpinLatticeStructureFactor : public CppUnit::TestFixture
+{
+private:
+  SpinLattice<2, IsingSpin>* testlattice_2d;
+  SpinLattice<1, RealSpin>* testlattice_1d;
+
+public:
+  static CppUnit::Test* suite();
+
+  void setUp();
+  void tearDown();
+
+  void test_structure_factor();
+  void test_correlation_function();
+  void test_second_moment_correlation_length();
+  void test_fourier_modes();
+  void test_potts();
+};
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef MOCASINNS_ACCUMULATORS_CORRELATOR_ACCUMULATOR_HPP
+#define MOCASINNS_ACCUMULATORS_CORRELATOR_ACCUMULATOR_HPP
+
+#include <vector>
+#include <stdexcept>
+#include <stdint.h>
+
+#include <boost/serialization/vector.hpp>
+
+namespace Mocasinns
+{
+  namespace Accumulators
+  {
+    //! Class template for accumulating the time-displaced correlation function of a scalar observable with the multiple-tau scheme
+    /*!
+      \details The measurements are passed through a hierarchy of levels, every level has a shift register with the last p values of the level and the sums of the products of the newest value with the values in the register. Every m values of a level are averaged and passed to the next level. Thus level 0 correlates the measurements at the lags \f$ 0, \dots, p-1 \f$ and level \f$ l > 0 \f$ correlates block averages of \f$ m^l \f$ measurements at the lags \f$ j m^l \f$ with \f$ j = p/m, \dots, p-1 \f$. This quasi-logarithmic grid of lags reaches up to the length of the time series, while the memory grows with \f$ O(p \log_m T) \f$ for \f$ T \f$ measurements and the cost per measurement is \f$ O(p \, m/(m-1)) \f$ (amortised). The levels are created when they receive their first value. The correlations at lags \f$ t > m^l \f$ are slightly smoothed by the block averages, which is negligible if the correlation function changes slowly on the scale of \f$ t/p \f$ (see Ramírez et al., J. Chem. Phys. 133, 154103, 2010).
+
+      The accumulator satisfies the accumulator concept and can be passed to Metropolis::do_metropolis_simulation, the lags are then given in units of Parameters::steps_between_measurement. Accumulators of independent runs can be merged, the sums of the correlations and the means are added. Values that are waiting in the shift registers or in a block average of the other accumulator are not merged, the correlations they would contribute are missing in both accumulators.
+
+      \tparam Observable Type of the scalar observable, must be convertible to double
+    */
+    template <class Observable>
+    class CorrelatorAccumulator
+    {
+    public:
+      //! Create an empty correlator with the given length of the shift registers and averaging factor, p must be a multiple of m
+      CorrelatorAccumulator(unsigned int p = 16, unsigned int m = 2);
+
+      //! Accumulating operator
+      void operator()(const Observable& observable) { add(static_cast<double>(observable), 0); }
+      //! Merge the correlations of the measurements of another accumulator into this accumulator, the accumulators must have the same p and m
+      void merge(const CorrelatorAccumulator& other);
+
+      //! Get the number of accumulated measurements
+      uint64_t count() const { return measurement_count; }
+      //! Get the mean of the measurements
+      double mean() const { return (measurement_count > 0) ? measurement_sum / static_cast<double>(measurement_count) : 0.0; }
+      //! Get the length of the shift registers
+      unsigned int get_register_length() const { return p; }
+      //! Get the number of values averaged for the next level
+      unsigned int get_averaging_factor() const { return m; }
+      //! Get the number of levels
+      unsigned int level_number() const { return levels; }
+
+      //! Get the lags of the correlation function in units of the measurements
+      std::vector<uint64_t> lags() const;
+      //! Get the correlation function \f$ \langle x(0) x(t) \rangle \f$ at the lags
+      std::vector<double> correlation() const;
+      //! Get the connected correlation function \f$ \langle x(0) x(t) \rangle - \langle x \rangle^2 \f$ at the lags, as Metropolis::autocorrelation_function
+      std::vector<double> connected_correlation() const;
+
+    private:
+      //! Length of the shift registers
+      unsigned int p;
+      //! Number of values averaged for the next level
+      unsigned int m;
+      //! Number of levels
+      unsigned int levels;
+      //! Number of accumulated measurements
+      uint64_t measurement_count;
+      //! Sum of the accumulated measurements
+      double measurement_sum;
+
+      //! Shift registers of all levels (p values per level, the newest value first)
+      std::vector<double> shift_registers;
+      //! Number of values in the shift registers
+      std::vector<unsigned int> register_fill;
+      //! Sums of the products of the newest value with the values in the shift registers (p per level)
+      std::vector<double> correlation_sums;
+      //! Numbers of products in the correlation sums (p per level)
+      std::vector<uint64_t> correlation_counts;
+      //! Sums of the values of the current block of every level
+      std::vector<double> block_sums;
+      //! Numbers of values in the current block of every level
+      std::vector<unsigned int> block_fill;
+
+      //! Add a value to the given level
+      void add(double value, unsigned int level);
+      //! Append a level
+      void add_level();
+      //! Get the first index of the shift register that gives a lag not covered by the lower levels
+      unsigned int first_index(unsigned int level) const { return (level == 0) ? 0 : p / m; }
+
+      //! Member variable for boost serialization
+      friend class boost::serialization::access;
+      //! Method to serialize this class (omitted version name to avoid unused parameter warnings)
+      template<class Archive> void serialize(Archive & ar, const unsigned int)
+      {
+	ar & p;
+	ar & m;
+	ar & levels;
+	ar & measurement_count;
+	ar & measurement_sum;
+	ar & shift_registers;
+	ar & register_fill;
+	ar & correlation_sums;
+	ar & correlation_counts;
+	ar & block_sums;
+	ar & block_fill;
+      }
+    };
+  }
+}
+
+#include "../src/accumulators/correlator_accumulator.cpp"
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef MOCASINNS_ACCUMULATORS_HISTOGRAM_ACCUMULATOR_HPP
 #define MOCASINNS_ACCUMULATORS_HISTOGRAM_ACCUMULATOR_HPP
 
+#include <utility>
+
 namespace Mocasinns
 {
   namespace Accumulators
@@ -22,8 +24,8 @@ namespace Mocasinns
       HistogramAccumulator() : BaseHisto () {}
       //! Constructor taking a base object
       HistogramAccumulator(const BaseHisto& base_histo) : BaseHisto(base_histo) {}
-      //! Copy constructor
-      HistogramAccumulator(const HistogramAccumulator<Histo, Observable>& other) : BaseHisto(static_cast<BaseHisto>(other)) {}
+      //! Constructor taking a temporary base object, the bins are moved into the accumulator
+      HistogramAccumulator(BaseHisto&& base_histo) : BaseHisto(std::move(base_histo)) {}
 
       //! Accumulating operator
       void operator()(const Observable& obs)
@@ -0,0 +1,122 @@
+#ifndef MOCASINNS_ACCUMULATORS_MICROCANONICAL_ACCUMULATOR_HPP
+#define MOCASINNS_ACCUMULATORS_MICROCANONICAL_ACCUMULATOR_HPP
+
+#include <vector>
+#include <stdexcept>
+#include <stdint.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/split_member.hpp>
+
+#include "../details/accumulators/observable_components.hpp"
+
+namespace Mocasinns
+{
+  namespace Accumulators
+  {
+    //! Class template for accumulating the microcanonical averages of an observable per energy bin
+    /*!
+      \details The accumulator stores the sorted energy bins, the number of measurements and the sums of the components of the observable for every bin in contiguous arrays. It is called with the energy bin of the current configuration and the value of the observable, usually by a multicanonical simulation (see WangLandau::attach_microcanonical_accumulator and EntropicSampling::attach_microcanonical_accumulator). Since all configurations of one energy have the same weight in a multicanonical simulation, the averages per bin are the microcanonical averages \f$ \langle O \rangle_E \f$, also while the density of states is still modified. The canonical average at any inverse temperature \f$ \beta \f$ follows from the density of states \f$ g(E) \f$ by reweighting
+      \f[
+      \langle O \rangle_\beta = \frac{\sum_E g(E) e^{-\beta E} \langle O \rangle_E}{\sum_E g(E) e^{-\beta E}}
+      \f]
+      which is a loop over the bins, no time series is stored. The bins can be initialised with the bins of the density of states (initialise_bins), then the arrays are aligned with the histogram. New energy bins are inserted when they are measured first. The averages have the floating-point type result_type (see MomentsAccumulator).
+
+      \tparam EnergyType Type of the energy bins, must be convertible to double
+      \tparam Observable Type of the observable, either a scalar or a container of scalars with size() and operator[] (e.g. ArrayObservable, VectorObservable)
+    */
+    template <class EnergyType, class Observable>
+    class MicrocanonicalAccumulator
+    {
+    public:
+      //! Type of the averages, the observable with floating-point components
+      typedef typename Details::Accumulators::ObservableResult<Observable>::type result_type;
+
+      //! Create an empty accumulator
+      MicrocanonicalAccumulator() : component_number(0), last_bin(0) {}
+
+      //! Initialise the energy bins with the bins of a histogram (e.g. the density of states), the accumulated measurements are removed
+      template <class Histo>
+      void initialise_bins(const Histo& histogram);
+
+      //! Accumulating operator taking the energy bin and the observable
+      void operator()(const EnergyType& energy_bin, const Observable& observable);
+      //! Merge the measurements of another accumulator into this accumulator
+      void merge(const MicrocanonicalAccumulator& other);
+
+      //! Get the number of energy bins
+      std::size_t size() const { return energies.size(); }
+      //! Get the sorted energy bins
+      const std::vector<EnergyType>& get_energies() const { return energies; }
+      //! Get the number of measurements per energy bin
+      const std::vector<uint64_t>& get_counts() const { return counts; }
+
+      //! Get the microcanonical averages of the observable per energy bin, in the order of get_energies() (bins without measurements are zero)
+      std::vector<result_type> microcanonical_averages() const;
+      //! Get the logarithmic density of states at the energy bins of this accumulator, bins missing in the histogram are -infinity
+      template <class Histo>
+      std::vector<double> aligned_log_density_of_states(const Histo& log_density_of_states) const;
+      //! Calculate the canonical average of the observable at the given inverse temperature from the logarithmic density of states
+      template <class Histo>
+      result_type canonical_average(const Histo& log_density_of_states, double beta) const { return canonical_average(aligned_log_density_of_states(log_density_of_states), beta); }
+      //! Calculate the canonical average of the observable at the given inverse temperature from the logarithmic density of states aligned with the energy bins of this accumulator
+      result_type canonical_average(const std::vector<double>& aligned_log_density_of_states, double beta) const;
+
+    private:
+      //! Sorted energy bins
+      std::vector<EnergyType> energies;
+      //! Number of measurements per energy bin
+      std::vector<uint64_t> counts;
+      //! Sums of the components of the observable, component_number values per energy bin
+      std::vector<double> sums;
+      //! Number of components of the observable
+      std::size_t component_number;
+      //! Template for the results created from the first measured observable, empty if there are no measurements
+      boost::shared_ptr<const result_type> prototype;
+      //! Index of the bin of the last measurement, consecutive measurements are usually in the same bin
+      std::size_t last_bin;
+
+      typedef Details::Accumulators::ObservableComponents<Observable> Components;
+      typedef Details::Accumulators::ObservableComponents<result_type> ResultComponents;
+
+      //! Find the index of an energy bin, the bin is inserted if it does not exist
+      std::size_t bin_index(const EnergyType& energy_bin);
+      //! Create a result from the prototype with the given components
+      result_type create_result(const double* values) const;
+
+      //! Member variable for boost serialization
+      friend class boost::serialization::access;
+      //! Save the sums and the prototype (omitted version name to avoid unused parameter warnings)
+      template<class Archive> void save(Archive & ar, const unsigned int) const
+      {
+	ar & energies;
+	ar & counts;
+	ar & sums;
+	ar & component_number;
+	if (component_number > 0) ar & *prototype;
+      }
+      //! Load the sums and the prototype (omitted version name to avoid unused parameter warnings)
+      template<class Archive> void load(Archive & ar, const unsigned int)
+      {
+	ar & energies;
+	ar & counts;
+	ar & sums;
+	ar & component_number;
+	prototype.reset();
+	if (component_number > 0)
+	{
+	  result_type loaded_prototype;
+	  ar & loaded_prototype;
+	  prototype.reset(new result_type(loaded_prototype));
+	}
+	last_bin = 0;
+      }
+      BOOST_SERIALIZATION_SPLIT_MEMBER()
+    };
+  }
+}
+
+#include "../src/accumulators/microcanonical_accumulator.cpp"
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef MOCASINNS_ACCUMULATORS_MOMENTS_ACCUMULATOR_HPP
+#define MOCASINNS_ACCUMULATORS_MOMENTS_ACCUMULATOR_HPP
+
+#include <vector>
+#include <cmath>
+#include <stdexcept>
+
+#include <boost/static_assert.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/align/aligned_allocator.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/split_member.hpp>
+
+#include "../details/accumulators/observable_components.hpp"
+
+namespace Mocasinns
+{
+  namespace Accumulators
+  {
+    //! Exception class for accumulators with different numbers of components
+    class ComponentNumbersDoNotMatchException : public std::range_error
+    {
+    public:
+      ComponentNumbersDoNotMatchException() : std::range_error("The numbers of components of the MomentsAccumulators do not match.") {}
+    };
+
+    //! Class template for accumulating the moments of scalar or container observables component by component
+    /*!
+      \details The accumulator stores the number of measurements, the mean and the sums of the powers of the deviations from the mean \f$ M_k = \sum_i (x_i - \bar{x})^k \f$ of every component in aligned arrays and updates them with the numerically stable formulas of Welford (for the mean and \f$ M_2 \f$) and Pébay (for \f$ M_3 \f$ and \f$ M_4 \f$). A new measurement is copied into an aligned buffer once, afterwards the updates are loops over contiguous arrays without temporary observables, that the compiler can vectorise.
+
+      Two accumulators can be merged with the formulas of Chan et al. in O(components), so every thread (or every run of a parallel simulation) can accumulate into its own accumulator and the accumulators are combined at the end. The result of the merge does not depend on the number of threads apart from rounding.
+
+      The results are returned as observables of the type result_type, which has the shape of the accumulated observables and floating-point components (double for scalar observables, VectorObservable<double> for VectorObservable<int>, see Details::Accumulators::ObservableResult). They are copies of a result prototype created from the first accumulated measurement with replaced components. Thus also observables with additional data (e.g. the x-axis of a DenseHistogramObservable) can be accumulated. The prototype is immutable and shared by merged accumulators.
+
+      \tparam Observable Type of the accumulated observables, either a scalar or a container of scalars with size() and operator[] (e.g. ArrayObservable, VectorObservable, DenseHistogramObservable), other containers must have floating-point components
+      \tparam moment_order Highest accumulated moment, 2 for mean and variance, 3 for the skewness and 4 for the kurtosis
+    */
+    template <class Observable, unsigned int moment_order = 2>
+    class MomentsAccumulator
+    {
+      BOOST_STATIC_ASSERT(moment_order >= 2 && moment_order <= 4);
+
+    public:
+      //! Type of the arrays storing the moments of the components, aligned for vector instructions
+      typedef std::vector<double, boost::alignment::aligned_allocator<double, 64> > ComponentArray;
+      //! Type of the results, the accumulated observable with floating-point components
+      typedef typename Details::Accumulators::ObservableResult<Observable>::type result_type;
+
+      //! Default constructor
+      MomentsAccumulator() : measurement_count(0) {}
+
+      //! Accumulating operator
+      void operator()(const Observable& observable);
+      //! Merge the measurements of another accumulator into this accumulator
+      void merge(const MomentsAccumulator& other);
+      //! Remove all measurements
+      void reset();
+
+      //! Get the number of accumulated measurements
+      unsigned long count() const { return measurement_count; }
+      //! Get the number of components of the accumulated observables
+      std::size_t component_number() const { return means.size(); }
+
+      //! Get the mean of the measurements
+      result_type mean() const { return create_result(means); }
+      //! Get the variance of the measurements (normalised by the number of measurements, as boost::accumulators::variance)
+      result_type variance() const;
+      //! Get the statistical error of the mean of uncorrelated measurements (as boost::accumulators::error_of<mean>)
+      result_type error_of_mean() const;
+      //! Get the skewness of the measurements, requires moment_order of at least 3
+      result_type skewness() const;
+      //! Get the excess kurtosis of the measurements, requires moment_order of 4
+      result_type kurtosis() const;
+
+      //! Get the means of the components
+      const ComponentArray& get_means() const { return means; }
+      //! Get the sums of the squared deviations of the components
+      const ComponentArray& get_m2() const { return m2; }
+
+    private:
+      //! Number of accumulated measurements
+      unsigned long measurement_count;
+      //! Means of the components
+      ComponentArray means;
+      //! Sums of the squared deviations from the mean of the components
+      ComponentArray m2;
+      //! Sums of the cubed deviations from the mean of the components (empty if moment_order < 3)
+      ComponentArray m3;
+      //! Sums of the fourth powers of the deviations from the mean of the components (empty if moment_order < 4)
+      ComponentArray m4;
+      //! Buffer for the components of a new measurement
+      ComponentArray sample;
+      //! Template for the results created from the first accumulated measurement, empty if there are no measurements
+      boost::shared_ptr<const result_type> prototype;
+
+      typedef Details::Accumulators::ObservableComponents<Observable> Components;
+      typedef Details::Accumulators::ObservableComponents<result_type> ResultComponents;
+
+      //! Resize the arrays to the given number of components
+      void initialise(std::size_t components);
+      //! Create a result from the prototype with the given components
+      result_type create_result(const ComponentArray& values) const;
+
+      //! Member variable for boost serialization
+      friend class boost::serialization::access;
+      //! Save the moments and the prototype (omitted version name to avoid unused parameter warnings)
+      template<class Archive> void save(Archive & ar, const unsigned int) const
+      {
+	ar & measurement_count;
+	ar & means;
+	ar & m2;
+	ar & m3;
+	ar & m4;
+	if (measurement_count > 0) ar & *prototype;
+      }
+      //! Load the moments and the prototype (omitted version name to avoid unused parameter warnings)
+      template<class Archive> void load(Archive & ar, const unsigned int)
+      {
+	ar & measurement_count;
+	ar & means;
+	ar & m2;
+	ar & m3;
+	ar & m4;
+	prototype.reset();
+	if (measurement_count > 0)
+	{
+	  result_type loaded_prototype;
+	  ar & loaded_prototype;
+	  prototype.reset(new result_type(loaded_prototype));
+	}
+	// The buffer for new measurements is not saved
+	sample.assign(means.size(), 0.0);
+      }
+      BOOST_SERIALIZATION_SPLIT_MEMBER()
+    };
+  }
+}
+
+#include "../src/accumulators/moments_accumulator.cpp"
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef MOCASINNS_ACCUMULATORS_QUANTILE_ACCUMULATOR_HPP
+#define MOCASINNS_ACCUMULATORS_QUANTILE_ACCUMULATOR_HPP
+
+#include <vector>
+#include <stdexcept>
+#include <stdint.h>
+
+#include <boost/serialization/vector.hpp>
+
+namespace Mocasinns
+{
+  namespace Accumulators
+  {
+    //! Class template for estimating quantiles of a scalar observable with bounded memory
+    /*!
+      \details The accumulator is a KLL sketch (Karnin, Lang and Liberty, 2016). The measurements are collected in a hierarchy of compactors, an item in the compactor of level \f$ h \f$ represents \f$ 2^h \f$ measurements. If a compactor is full, it is sorted and every second item (starting randomly at the first or second item) is moved to the next level, the others are discarded. The capacity of the compactor of level \f$ h \f$ is \f$ \lceil k c^{H-h-1} \rceil + 1 \f$ with \f$ c = 2/3 \f$ and the number of levels \f$ H \f$, so at most about \f$ 3k + \log_2(n/k) \f$ items are retained for \f$ n \f$ measurements. With the default \f$ k = 200 \f$ this is about 5 kilobytes for any number of measurements.
+
+      Error bound: the estimated normalised rank of a value (and thus the quantile) differs from the exact one by \f$ \epsilon \f$ with \f$ \epsilon \approx 3.3/k \f$ with a probability of 99% (1.65% for k = 200), independent of the number of measurements and of the distribution of the observable. The minimum and the maximum are exact. See rank_error_bound().
+
+      Two accumulators with the same k can be merged, the result has the same error bound as an accumulator that has seen all measurements. The random offsets of the compactions are drawn from an internal generator with a fixed seed, so the results are reproducible.
+
+      \tparam Observable Type of the scalar observable, must be convertible to and from double
+    */
+    template <class Observable>
+    class QuantileAccumulator
+    {
+    public:
+      //! Create an empty accumulator with the given accuracy parameter k and seed of the compaction offsets
+      QuantileAccumulator(unsigned int k = 200, uint64_t seed = 88172645463325252ull);
+
+      //! Accumulating operator
+      void operator()(const Observable& observable);
+      //! Merge the measurements of another accumulator into this accumulator, the accumulators must have the same accuracy parameter
+      void merge(const QuantileAccumulator& other);
+
+      //! Get the number of accumulated measurements
+      uint64_t count() const { return measurement_count; }
+      //! Get the accuracy parameter k
+      unsigned int get_k() const { return k; }
+      //! Get the number of items retained in the sketch
+      unsigned int retained_item_number() const { return retained_size; }
+      //! Get the normalised rank error that is not exceeded with a probability of 99%
+      double rank_error_bound() const { return 3.3 / static_cast<double>(k); }
+
+      //! Get the smallest measurement
+      Observable min() const { return static_cast<Observable>(minimum); }
+      //! Get the largest measurement
+      Observable max() const { return static_cast<Observable>(maximum); }
+      //! Estimate the fraction of the measurements that are smaller or equal than the given value
+      double rank(const Observable& value) const;
+      //! Estimate the quantile, i.e. the smallest measurement with at least the given fraction of measurements smaller or equal
+      Observable quantile(double fraction) const;
+      //! Estimate the median
+      Observable median() const { return quantile(0.5); }
+
+    private:
+      //! Accuracy parameter
+      unsigned int k;
+      //! Number of accumulated measurements
+      uint64_t measurement_count;
+      //! Compactors, an item of level h represents 2^h measurements
+      std::vector<std::vector<double> > compactors;
+      //! Number of items in all compactors
+      unsigned int retained_size;
+      //! Number of items that trigger a compaction
+      unsigned int maximal_size;
+      //! Smallest measurement
+      double minimum;
+      //! Largest measurement
+      double maximum;
+      //! State of the generator of the compaction offsets (xorshift64*)
+      uint64_t random_state;
+
+      //! Capacity of the compactor of the given level
+      unsigned int capacity(unsigned int level) const;
+      //! Add a level to the compactors
+      void grow();
+      //! Compact the compactors until the sketch has less than maximal_size items
+      void compress();
+      //! Draw a random bit for the offset of a compaction
+      unsigned int random_bit();
+      //! Collect the retained items with their weights sorted by value
+      void weighted_items(std::vector<std::pair<double, uint64_t> >& items) const;
+
+      //! Member variable for boost serialization
+      friend class boost::serialization::access;
+      //! Method to serialize this class (omitted version name to avoid unused parameter warnings)
+      template<class Archive> void serialize(Archive & ar, const unsigned int)
+      {
+	ar & k;
+	ar & measurement_count;
+	ar & compactors;
+	ar & retained_size;
+	ar & maximal_size;
+	ar & minimum;
+	ar & maximum;
+	ar & random_state;
+      }
+    };
+  }
+}
+
+#include "../src/accumulators/quantile_accumulator.cpp"
+
+#endif
@@ -0,0 +1,204 @@
+#ifndef MOCASINNS_ANALYSIS_BATCHED_JACKKNIFE_ANALYSIS_HPP
+#define MOCASINNS_ANALYSIS_BATCHED_JACKKNIFE_ANALYSIS_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <exception>
+
+namespace Mocasinns
+{
+  namespace Analysis
+  {
+    //! Class for the jackknife analysis of many observables measured on the same configurations, including the covariance of the estimates
+    /*!
+      \details The measurements are given as column-major matrix, the measurements of observable j are stored contiguously at measurements[j*measurement_number + i]. In the constructor the sums of the jackknife bins are calculated for all observables in one pass over the matrix, afterwards the measurements are not needed anymore. The leave-one-out means of all bins are stored bin-major, so the loops over the observables run over contiguous memory and are vectorised by the compiler, the loops over the bins are parallelised with OpenMP.
+
+      The jackknife estimate of a vector of derived quantities \f$ f \f$ is the mean of the leave-one-out values \f$ f_b \f$ and the covariance of the estimates is
+      \f[
+      C_{kl} = \frac{n-1}{n} \sum_{b=1}^{n} (f_{b,k} - \bar{f}_k)(f_{b,l} - \bar{f}_l)
+      \f]
+      for \f$ n \f$ bins. The errors are the square roots of the diagonal, as for JackknifeAnalysis.
+    */
+    class BatchedJackknifeAnalysis
+    {
+    public:
+      //! Result of the analysis of a vector of quantities
+      struct Result
+      {
+	//! Jackknife estimates of the quantities
+	std::vector<double> value;
+	//! Errors of the estimates
+	std::vector<double> error;
+	//! Covariance matrix of the estimates, stored row-major
+	std::vector<double> covariance;
+
+	//! Get the number of quantities
+	std::size_t size() const { return value.size(); }
+	//! Get an element of the covariance matrix
+	double covariance_element(std::size_t k, std::size_t l) const { return covariance[k*value.size() + l]; }
+	//! Get an element of the correlation matrix
+	double correlation_element(std::size_t k, std::size_t l) const { return covariance_element(k, l) / (error[k]*error[l]); }
+      };
+
+      //! Calculate the jackknife bins of a column-major matrix of measurements
+      BatchedJackknifeAnalysis(const double* measurements, std::size_t measurement_number, std::size_t observable_number, std::size_t bin_size = 1)
+      {
+	initialise(measurements, measurement_number, observable_number, bin_size);
+      }
+      //! Calculate the jackknife bins of a column-major matrix of measurements stored in a vector
+      BatchedJackknifeAnalysis(const std::vector<double>& measurements, std::size_t observable_number, std::size_t bin_size = 1)
+      {
+	if (observable_number == 0 || measurements.size() % observable_number != 0)
+	  throw std::invalid_argument("The size of the measurement matrix is not a multiple of the number of observables.");
+	initialise(measurements.data(), measurements.size() / observable_number, observable_number, bin_size);
+      }
+
+      //! Get the number of observables
+      std::size_t get_observable_number() const { return observable_number; }
+      //! Get the number of jackknife bins
+      std::size_t get_bin_number() const { return bin_number; }
+      //! Get the leave-one-out means of the observables, observable_number values per bin
+      const std::vector<double>& get_jackknife_means() const { return jackknife_means; }
+
+      //! Analyse the means of all observables
+      Result analyse() const { return summarise(jackknife_means, observable_number); }
+
+      //! Analyse derived quantities of the means of the observables
+      /*!
+	\tparam FunctionOfMeans Functor with an operator() taking a const std::vector<double>& of the means of all observables and returning a std::vector<double> of the derived quantities, it is called concurrently for different bins and must not modify shared state. It must return the same number of values for all bins, otherwise std::invalid_argument is thrown. Exceptions thrown by the functor are rethrown after all bins have been processed.
+	\param function Functor calculating the derived quantities
+	\returns Jackknife estimates, errors and covariance of the derived quantities
+      */
+      template <class FunctionOfMeans>
+      Result analyse(FunctionOfMeans function) const
+      {
+	// Determine the number of derived quantities from the first bin
+	std::vector<double> means(jackknife_means.begin(), jackknife_means.begin() + observable_number);
+	std::vector<double> first_values = function(means);
+	const std::size_t function_number = first_values.size();
+	std::vector<double> values(bin_number*function_number);
+	std::copy(first_values.begin(), first_values.end(), values.begin());
+
+	// Exceptions must not leave the parallel region, the first one is rethrown afterwards
+	std::exception_ptr bin_exception;
+	const long bins = static_cast<long>(bin_number);
+#pragma omp parallel for firstprivate(means) shared(bin_exception)
+	for (long bin = 1; bin < bins; ++bin)
+	{
+	  try
+	  {
+	    std::copy(jackknife_means.begin() + bin*observable_number, jackknife_means.begin() + (bin + 1)*observable_number, means.begin());
+	    std::vector<double> bin_values = function(means);
+	    if (bin_values.size() != function_number)
+	      throw std::invalid_argument("The function of the means returned a different number of values for different bins.");
+	    std::copy(bin_values.begin(), bin_values.end(), values.begin() + bin*function_number);
+	  }
+	  catch (...)
+	  {
+#pragma omp critical(batched_jackknife_exception)
+	    if (!bin_exception) bin_exception = std::current_exception();
+	  }
+	}
+	if (bin_exception) std::rethrow_exception(bin_exception);
+
+	return summarise(values, function_number);
+      }
+
+    private:
+      //! Number of observables
+      std::size_t observable_number;
+      //! Number of jackknife bins
+      std::size_t bin_number;
+      //! Leave-one-out means of all observables, observable_number values per bin
+      std::vector<double> jackknife_means;
+
+      //! Calculate the block sums and the leave-one-out means
+      void initialise(const double* measurements, std::size_t measurement_number, std::size_t observables, std::size_t bin_size)
+      {
+	if (bin_size == 0) throw std::invalid_argument("The bin size of the jackknife analysis must be positive.");
+	observable_number = observables;
+	bin_number = measurement_number / bin_size;
+	if (bin_number < 2) throw std::invalid_argument("The jackknife analysis needs at least two bins.");
+
+	// Sum the blocks of every column, the sums are stored bin-major
+	const long bins = static_cast<long>(bin_number);
+	jackknife_means.assign(bin_number*observable_number, 0.0);
+#pragma omp parallel for
+	for (long bin = 0; bin < bins; ++bin)
+	{
+	  double* block_sums = &jackknife_means[bin*observable_number];
+	  for (std::size_t j = 0; j < observable_number; ++j)
+	  {
+	    const double* column = measurements + j*measurement_number + bin*bin_size;
+	    double sum = 0.0;
+	    for (std::size_t i = 0; i < bin_size; ++i) sum += column[i];
+	    block_sums[j] = sum;
+	  }
+	}
+
+	// Total sums of the used measurements
+	std::vector<double> total_sums(observable_number, 0.0);
+	for (std::size_t bin = 0; bin < bin_number; ++bin)
+	{
+	  const double* block_sums = &jackknife_means[bin*observable_number];
+	  for (std::size_t j = 0; j < observable_number; ++j) total_sums[j] += block_sums[j];
+	}
+
+	// Replace the block sums by the means of the remaining measurements
+	const double inverse_remaining = 1.0 / static_cast<double>((bin_number - 1)*bin_size);
+	const double* totals = total_sums.data();
+#pragma omp parallel for
+	for (long bin = 0; bin < bins; ++bin)
+	{
+	  double* means = &jackknife_means[bin*observable_number];
+	  for (std::size_t j = 0; j < observable_number; ++j) means[j] = (totals[j] - means[j]) * inverse_remaining;
+	}
+      }
+
+      //! Calculate the estimates, errors and covariance from the leave-one-out values of the bins (dimension values per bin)
+      Result summarise(const std::vector<double>& values, std::size_t dimension) const
+      {
+	Result result;
+	result.value.assign(dimension, 0.0);
+	for (std::size_t bin = 0; bin < bin_number; ++bin)
+	{
+	  const double* bin_values = &values[bin*dimension];
+	  for (std::size_t k = 0; k < dimension; ++k) result.value[k] += bin_values[k];
+	}
+	for (std::size_t k = 0; k < dimension; ++k) result.value[k] /= static_cast<double>(bin_number);
+
+	// Deviations of the bins from the estimates
+	std::vector<double> deviations(values.size());
+	for (std::size_t bin = 0; bin < bin_number; ++bin)
+	  for (std::size_t k = 0; k < dimension; ++k)
+	    deviations[bin*dimension + k] = values[bin*dimension + k] - result.value[k];
+
+	// Every row of the covariance matrix is summed over the bins, the inner loop runs over contiguous memory
+	const double factor = static_cast<double>(bin_number - 1) / static_cast<double>(bin_number);
+	const long rows = static_cast<long>(dimension);
+	result.covariance.assign(dimension*dimension, 0.0);
+#pragma omp parallel for
+	for (long k = 0; k < rows; ++k)
+	{
+	  double* row = &result.covariance[k*dimension];
+	  for (std::size_t bin = 0; bin < bin_number; ++bin)
+	  {
+	    const double* deviation = &deviations[bin*dimension];
+	    const double deviation_k = deviation[k];
+	    for (std::size_t l = 0; l < dimension; ++l) row[l] += deviation_k * deviation[l];
+	  }
+	  for (std::size_t l = 0; l < dimension; ++l) row[l] *= factor;
+	}
+
+	result.error.resize(dimension);
+	for (std::size_t k = 0; k < dimension; ++k) result.error[k] = sqrt(result.covariance_element(k, k));
+	return result;
+      }
+    };
+  }
+}
+
+#endif
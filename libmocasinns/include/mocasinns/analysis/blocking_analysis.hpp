@@ -0,0 +1,146 @@
+#ifndef MOCASINNS_ANALYSIS_BLOCKING_ANALYSIS_HPP
+#define MOCASINNS_ANALYSIS_BLOCKING_ANALYSIS_HPP
+
+#include <vector>
+#include <cmath>
+
+namespace Mocasinns
+{
+  namespace Analysis
+  {
+    //! Class for the streaming blocking analysis (Flyvbjerg-Petersen) of a correlated time series
+    /*!
+      \details The values are added one by one with operator(). On blocking level k the series is gathered in blocks of 2^k successive values, for every level the number, the sum and the sum of squares of the completed blocks are stored, together with the first half of the block that is currently built. Therefore the memory is logarithmic in the length of the series and every value costs amortised constant time.
+
+      For every level the error of the mean is estimated from the variance of the block means. For correlated data the estimate grows with the level until the blocks are longer than the correlation time and stays constant afterwards. The error of the mean is taken as the largest estimate of the levels that have at least minimal_block_number blocks, the integrated autocorrelation time (in units of the distance of the values) follows as
+      \f[
+      \tau_\mathrm{int} = \frac{N \sigma^2_{\bar{x}}}{2 \sigma^2}
+      \f]
+      which is 1/2 for uncorrelated values.
+    */
+    class BlockingAnalysis
+    {
+    public:
+      //! Create an empty analysis, only levels with at least the given number of blocks are used for the error estimate
+      BlockingAnalysis(unsigned int minimal_block_number = 32) : minimal_block_number(minimal_block_number) {}
+
+      //! Add the next value of the time series
+      void operator()(double value)
+      {
+	for (unsigned int level = 0; ; ++level)
+	{
+	  if (level == levels.size()) levels.push_back(Level());
+	  Level& current = levels[level];
+	  ++current.count;
+	  current.sum += value;
+	  current.square_sum += value*value;
+
+	  // Store the first half of the next block or complete the block on the next level
+	  if (!current.pending_full)
+	  {
+	    current.pending = value;
+	    current.pending_full = true;
+	    return;
+	  }
+	  value = 0.5*(current.pending + value);
+	  current.pending_full = false;
+	}
+      }
+
+      //! Get the number of values added
+      unsigned long get_count() const { return levels.empty() ? 0 : levels[0].count; }
+      //! Get the number of blocking levels
+      unsigned int get_level_number() const { return levels.size(); }
+      //! Get the number of completed blocks of the given level
+      unsigned long get_block_number(unsigned int level) const { return levels[level].count; }
+      //! Get the minimal number of blocks of the levels used for the error estimate
+      unsigned int get_minimal_block_number() const { return minimal_block_number; }
+
+      //! Get the mean of all values
+      double mean() const { return levels.empty() ? 0.0 : levels[0].sum / levels[0].count; }
+      //! Get the variance of the values
+      double variance() const { return levels.empty() ? 0.0 : levels[0].variance(); }
+
+      //! Get the estimate of the squared error of the mean from the given level
+      double variance_of_mean(unsigned int level) const
+      {
+	const Level& current = levels[level];
+	return (current.count < 2) ? 0.0 : current.variance() / (current.count - 1);
+      }
+
+      //! Get the squared error of the mean, the maximum of the estimates of the levels with enough blocks
+      double variance_of_mean() const
+      {
+	double result = 0.0;
+	for (unsigned int level = 0; level < levels.size() && (level == 0 || levels[level].count >= minimal_block_number); ++level)
+	{
+	  const double level_result = variance_of_mean(level);
+	  if (level_result > result) result = level_result;
+	}
+	return result;
+      }
+      //! Get the error of the mean
+      double error_of_mean() const { return std::sqrt(variance_of_mean()); }
+
+      //! Get the integrated autocorrelation time in units of the distance of the values (1/2 for uncorrelated values)
+      double integrated_autocorrelation_time() const
+      {
+	if (get_count() < 2 || variance_of_mean(0) <= 0.0) return 0.5;
+	return 0.5 * variance_of_mean() / variance_of_mean(0);
+      }
+
+      //! Check whether the time series is long enough to resolve the correlations, i.e. the estimate of the last used level agrees with the previous one within the given relative tolerance
+      bool is_converged(double tolerance = 0.2) const
+      {
+	const unsigned int used_levels = used_level_number();
+	if (used_levels < 3) return false;
+	const double last = variance_of_mean(used_levels - 1);
+	const double previous = variance_of_mean(used_levels - 2);
+	return std::fabs(last - previous) <= tolerance * previous;
+      }
+
+      //! Remove all values
+      void clear() { levels.clear(); }
+
+    private:
+      //! Structure storing the completed blocks of one level and the first half of the next block
+      struct Level
+      {
+	Level() : count(0), sum(0.0), square_sum(0.0), pending(0.0), pending_full(false) {}
+	//! Number of completed blocks
+	unsigned long count;
+	//! Sum of the block means
+	double sum;
+	//! Sum of the squares of the block means
+	double square_sum;
+	//! Mean of the first half of the block that is currently built
+	double pending;
+	//! Flag indicating whether pending contains a value
+	bool pending_full;
+
+	//! Calculate the (biased) variance of the block means
+	double variance() const
+	{
+	  const double block_mean = sum / count;
+	  const double result = square_sum / count - block_mean*block_mean;
+	  return (result > 0.0) ? result : 0.0;
+	}
+      };
+
+      //! Minimal number of blocks of the levels used for the error estimate
+      unsigned int minimal_block_number;
+      //! Blocking levels, level k contains blocks of 2^k values
+      std::vector<Level> levels;
+
+      //! Number of levels with enough blocks for the error estimate
+      unsigned int used_level_number() const
+      {
+	unsigned int result = 0;
+	while (result < levels.size() && levels[result].count >= minimal_block_number) ++result;
+	return result;
+      }
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef MOCASINNS_ANALYSIS_MSER_EQUILIBRATION_HPP
+#define MOCASINNS_ANALYSIS_MSER_EQUILIBRATION_HPP
+
+#include <vector>
+#include <iterator>
+
+namespace Mocasinns
+{
+  namespace Analysis
+  {
+    //! Class for detecting the end of the equilibration of a time series with the marginal standard error rule (MSER)
+    /*!
+      \details The values are gathered in batches of batch_size consecutive values (MSER-5 for the default batch size). For every truncation point d (in batches) the marginal standard error
+      \f[
+      \mathrm{MSER}(d) = \frac{1}{(B-d)^2} \sum_{i=d}^{B-1} \left(\bar{x}_i - \bar{x}_{d}\right)^2
+      \f]
+      of the remaining B - d batch means is calculated for all d that leave at least two batch means, the truncation point is the d with the minimal MSER. The series is considered equilibrated if the truncation point lies in the first half of the series (and a minimal number of batches was observed), otherwise the series is still drifting at its end.
+
+      The values can be added one by one with operator() during a simulation, or a complete series can be analysed with analyse().
+    */
+    class MserEquilibration
+    {
+    public:
+      //! Create an empty detector with the given batch size
+      MserEquilibration(unsigned int batch_size = 5) : batch_size(batch_size), batch_sum(0.0), batch_fill(0) {}
+
+      //! Add the next value of the time series
+      void operator()(double value)
+      {
+	batch_sum += value;
+	if (++batch_fill == batch_size)
+	{
+	  batch_means.push_back(batch_sum / batch_size);
+	  batch_sum = 0.0;
+	  batch_fill = 0;
+	}
+      }
+
+      //! Get the number of completed batches
+      unsigned int get_batch_number() const { return batch_means.size(); }
+      //! Get the batch size
+      unsigned int get_batch_size() const { return batch_size; }
+
+      //! Calculate the truncation point in units of values (not batches)
+      unsigned int truncation_point() const { return truncation_batch() * batch_size; }
+
+      //! Check whether the series is equilibrated, i.e. at least the given number of batches is complete and the truncation point lies in the first half
+      bool is_equilibrated(unsigned int minimal_batch_number = 10) const
+      {
+	if (batch_means.size() < minimal_batch_number || batch_means.size() < 2) return false;
+	return 2*truncation_batch() < batch_means.size();
+      }
+
+      /*!
+	\brief Calculate the truncation point of a complete time series
+
+	\tparam InputIterator Type of the iterator that is used to iterate through the values, the values must be convertible to double.
+	\param value_begin Iterator to the first value of the series
+	\param value_end Iterator to the end of the series
+	\param batch_size Number of successive values gathered in one batch (default value 5)
+
+	\returns Number of values at the begin of the series that should be discarded
+      */
+      template <class InputIterator>
+      static unsigned int analyse(InputIterator value_begin, InputIterator value_end, unsigned int batch_size = 5)
+      {
+	MserEquilibration detector(batch_size);
+	for (InputIterator value = value_begin; value != value_end; ++value)
+	  detector(*value);
+	return detector.truncation_point();
+      }
+
+    private:
+      //! Number of values per batch
+      unsigned int batch_size;
+      //! Means of the completed batches
+      std::vector<double> batch_means;
+      //! Sum of the values of the current batch
+      double batch_sum;
+      //! Number of values in the current batch
+      unsigned int batch_fill;
+
+      //! Calculate the truncation point in batches with one backward pass over the batch means
+      unsigned int truncation_batch() const
+      {
+	const unsigned int batch_number = batch_means.size();
+	if (batch_number < 2) return 0;
+
+	double suffix_sum = 0.0;
+	double suffix_square_sum = 0.0;
+	unsigned int best_truncation = 0;
+	double best_mser = 0.0;
+	bool best_found = false;
+	for (unsigned int d = batch_number; d-- > 0;)
+	{
+	  suffix_sum += batch_means[d];
+	  suffix_square_sum += batch_means[d]*batch_means[d];
+	  if (d + 2 > batch_number) continue;
+
+	  const double remaining = batch_number - d;
+	  const double mser = (suffix_square_sum - suffix_sum*suffix_sum/remaining) / (remaining*remaining);
+	  if (!best_found || mser <= best_mser)
+	  {
+	    best_mser = mser;
+	    best_truncation = d;
+	    best_found = true;
+	  }
+	}
+	return best_truncation;
+      }
+    };
+  }
+}
+
+#endif
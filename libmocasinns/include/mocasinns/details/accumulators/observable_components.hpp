@@ -0,0 +1,103 @@
+/*!
+  \file observable_components.hpp
+
+  \brief File containing the access to the components of scalar and container observables
+
+  \author Benedikt Krüger
+*/
+
+#ifndef MOCASINNS_DETAILS_ACCUMULATORS_OBSERVABLE_COMPONENTS
+#define MOCASINNS_DETAILS_ACCUMULATORS_OBSERVABLE_COMPONENTS
+
+#include <cstddef>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_arithmetic.hpp>
+#include <boost/type_traits/is_floating_point.hpp>
+// The observables specialise the functionals of boost accumulators, which must be declared before the observables are included
+#include <boost/accumulators/numeric/functional.hpp>
+
+#include "../../observables/vector_observable.hpp"
+#include "../../observables/array_observable.hpp"
+#include "../../observables/dense_histogram_observable.hpp"
+
+namespace Mocasinns
+{
+  namespace Details
+  {
+    namespace Accumulators
+    {
+      //! Class giving access to the components of a container observable (e.g. ArrayObservable, VectorObservable) as doubles
+      template<class Observable, bool is_scalar = boost::is_arithmetic<Observable>::value> struct ObservableComponents
+      {
+	//! Get the number of components of the observable
+	static std::size_t size(const Observable& observable) { return observable.size(); }
+	//! Get a component of the observable
+	static double get(const Observable& observable, std::size_t index) { return static_cast<double>(observable[index]); }
+	//! Set a component of the observable
+	static void set(Observable& observable, std::size_t index, double value) { observable[index] = static_cast<typename Observable::value_type>(value); }
+      };
+
+      //! Specialisation for scalar observables, that have exactly one component
+      template<class Observable> struct ObservableComponents<Observable, true>
+      {
+	//! Get the number of components of the observable
+	static std::size_t size(const Observable&) { return 1; }
+	//! Get the observable
+	static double get(const Observable& observable, std::size_t) { return static_cast<double>(observable); }
+	//! Set the observable
+	static void set(Observable& observable, std::size_t, double value) { observable = static_cast<Observable>(value); }
+      };
+
+      //! Class giving the type of the results of an accumulator (e.g. means and variances), which has the shape of the observable and floating-point components
+      /*!
+	\details The results of container observables with integral components cannot be stored in the observable type itself, therefore the known observables are rebound to double components. Other container observables must already have floating-point components.
+      */
+      template<class Observable, bool is_scalar = boost::is_arithmetic<Observable>::value> struct ObservableResult
+      {
+	BOOST_STATIC_ASSERT_MSG(boost::is_floating_point<typename Observable::value_type>::value, "The components of the observable must be floating-point numbers.");
+	//! Type of the results
+	typedef Observable type;
+	//! Create a result with the shape of the given observable
+	static type create(const Observable& observable) { return observable; }
+      };
+
+      //! Specialisation for scalar observables, the results are doubles
+      template<class Observable> struct ObservableResult<Observable, true>
+      {
+	//! Type of the results
+	typedef double type;
+	//! Create a result
+	static type create(const Observable&) { return 0.0; }
+      };
+
+      //! Specialisation for VectorObservable
+      template<class T> struct ObservableResult<Observables::VectorObservable<T>, false>
+      {
+	//! Type of the results
+	typedef Observables::VectorObservable<double> type;
+	//! Create a result with the size of the given observable
+	static type create(const Observables::VectorObservable<T>& observable) { return type(observable.size(), 0.0); }
+      };
+
+      //! Specialisation for ArrayObservable
+      template<class T, size_t N> struct ObservableResult<Observables::ArrayObservable<T,N>, false>
+      {
+	//! Type of the results
+	typedef Observables::ArrayObservable<double,N> type;
+	//! Create a result
+	static type create(const Observables::ArrayObservable<T,N>&) { return type(0.0); }
+      };
+
+      //! Specialisation for DenseHistogramObservable
+      template<class x_value_type, class y_value_type> struct ObservableResult<Observables::DenseHistogramObservable<x_value_type, y_value_type>, false>
+      {
+	//! Type of the results
+	typedef Observables::DenseHistogramObservable<x_value_type, double> type;
+	//! Create a result sharing the x-axis of the given observable
+	static type create(const Observables::DenseHistogramObservable<x_value_type, y_value_type>& observable) { return observable.get_x_axis() ? type(observable.get_x_axis()) : type(); }
+      };
+    }
+  }
+}
+
+#endif
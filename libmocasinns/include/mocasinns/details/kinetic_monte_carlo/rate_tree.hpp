@@ -0,0 +1,87 @@
+/*!
+  \file rate_tree.hpp
+
+  \brief File containing a binary sum tree for the rates of the kinetic Monte-Carlo algorithm
+
+  \author Benedikt Krüger
+*/
+
+#ifndef MOCASINNS_DETAILS_KINETIC_MONTE_CARLO_RATE_TREE
+#define MOCASINNS_DETAILS_KINETIC_MONTE_CARLO_RATE_TREE
+
+#include <vector>
+
+namespace Mocasinns
+{
+  namespace Details
+  {
+    namespace KineticMonteCarlo
+    {
+      /*!
+	\brief Binary sum tree (segment tree) storing non-negative rates
+	\details The leaves of the tree store the rates of the single sites, each inner node stores the sum of its two children, so the root stores the total rate. Changing a rate and selecting a site with probability proportional to its rate both need O(log N) operations. The tree is stored contiguously in a vector, node i has the children 2i and 2i+1.
+      */
+      class RateTree
+      {
+      public:
+	//! Standard constructor, creates an empty tree
+	RateTree() : leaf_number(0), leaf_offset(1), nodes(2, 0.0) {}
+	//! Constructor creating a tree with the given number of leaves with zero rate
+	RateTree(unsigned int size) { resize(size); }
+
+	//! Resize the tree to the given number of leaves and set all rates to zero
+	void resize(unsigned int size)
+	{
+	  leaf_number = size;
+	  leaf_offset = 1;
+	  while (leaf_offset < size) leaf_offset *= 2;
+	  nodes.assign(2*leaf_offset, 0.0);
+	}
+	//! Number of leaves of the tree
+	unsigned int size() const { return leaf_number; }
+
+	//! Get the rate of the given leaf
+	double get_rate(unsigned int leaf) const { return nodes[leaf_offset + leaf]; }
+	//! Set the rate of the given leaf and update the sums on the path to the root
+	void set_rate(unsigned int leaf, double rate)
+	{
+	  unsigned int node = leaf_offset + leaf;
+	  nodes[node] = rate;
+	  for (node /= 2; node > 0; node /= 2)
+	    nodes[node] = nodes[2*node] + nodes[2*node + 1];
+	}
+	//! Get the sum of all rates
+	double total_rate() const { return nodes[1]; }
+
+	//! Find the leaf i such that the sum of the rates of the leaves before i is smaller or equal than value and the sum including leaf i is larger than value
+	unsigned int find(double value) const
+	{
+	  unsigned int node = 1;
+	  while (node < leaf_offset)
+	  {
+	    const unsigned int left = 2*node;
+	    // Descend to the right child only if it has a rate, this protects against rounding errors for values close to the total rate
+	    if (value < nodes[left] || nodes[left + 1] <= 0.0)
+	      node = left;
+	    else
+	    {
+	      value -= nodes[left];
+	      node = left + 1;
+	    }
+	  }
+	  return node - leaf_offset;
+	}
+
+      private:
+	//! Number of leaves in use
+	unsigned int leaf_number;
+	//! Index of the first leaf in the node vector (smallest power of two not smaller than the number of leaves)
+	unsigned int leaf_offset;
+	//! Contiguous storage of the tree nodes, the node 0 is not used
+	std::vector<double> nodes;
+      };
+    }
+  }
+}
+
+#endif
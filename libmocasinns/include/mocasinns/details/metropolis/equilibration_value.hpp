@@ -0,0 +1,54 @@
+/*!
+  \file equilibration_value.hpp
+
+  \brief File containing the conversion of observables to the values monitored by the equilibration detection
+
+  \author Benedikt Krüger
+*/
+
+#ifndef MOCASINNS_DETAILS_METROPOLIS_EQUILIBRATION_VALUE
+#define MOCASINNS_DETAILS_METROPOLIS_EQUILIBRATION_VALUE
+
+#include <boost/type_traits/is_arithmetic.hpp>
+
+namespace Mocasinns
+{
+  namespace Details
+  {
+    namespace Metropolis
+    {
+      //! Class converting a scalar observable to the double monitored by the equilibration detection
+      template<class Observable, bool is_scalar = boost::is_arithmetic<Observable>::value> struct EquilibrationValue
+      {
+	//! Flag indicating whether the observable can be monitored
+	static const bool supported = true;
+	//! Convert the observable
+	static double value(const Observable& observable) { return static_cast<double>(observable); }
+      };
+
+      //! Specialisation for non-scalar observables (e.g. vector energies), that cannot be monitored
+      template<class Observable> struct EquilibrationValue<Observable, false>
+      {
+	//! Flag indicating whether the observable can be monitored
+	static const bool supported = false;
+	//! Return zero, the value is never used
+	static double value(const Observable&) { return 0.0; }
+      };
+
+      //! Get the value monitored for a measurement, the measurement itself if it is a scalar and the energy of the configuration otherwise, returns false if neither is a scalar
+      template<class EnergyObservator, class Observable, class ConfigurationType>
+      bool monitored_value(const Observable& measurement, ConfigurationType* configuration, double& value)
+      {
+	if (EquilibrationValue<Observable>::supported)
+	  value = EquilibrationValue<Observable>::value(measurement);
+	else if (EquilibrationValue<typename EnergyObservator::observable_type>::supported)
+	  value = EquilibrationValue<typename EnergyObservator::observable_type>::value(EnergyObservator::observe(configuration));
+	else
+	  return false;
+	return true;
+      }
+    }
+  }
+}
+
+#endif
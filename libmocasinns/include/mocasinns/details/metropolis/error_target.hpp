@@ -0,0 +1,95 @@
+/*!
+  \file error_target.hpp
+
+  \brief File containing the stopping rule of the measurements of a Metropolis run
+
+  \author Benedikt Krüger
+*/
+
+#ifndef MOCASINNS_DETAILS_METROPOLIS_ERROR_TARGET
+#define MOCASINNS_DETAILS_METROPOLIS_ERROR_TARGET
+
+#include "equilibration_value.hpp"
+#include "../../analysis/blocking_analysis.hpp"
+
+#include <cmath>
+
+namespace Mocasinns
+{
+  namespace Details
+  {
+    namespace Metropolis
+    {
+      //! Class deciding when the measurements of a Metropolis run are finished
+      /*!
+	\details Without Parameters::target_error exactly Parameters::measurement_number measurements are taken. Otherwise the monitored value of every measurement is passed to a streaming Analysis::BlockingAnalysis and the measurements stop as soon as at least Parameters::minimal_measurement_number measurements are taken, the blocking analysis has reached its plateau (see Analysis::BlockingAnalysis::is_converged) and the error of the mean is not larger than the target error, or if the steps performed for the measurements exceed the step budget. The step budget is Parameters::measurement_step_budget, or Parameters::measurement_number times Parameters::steps_between_measurement if the budget is zero. If neither the observable nor the energy is a scalar, the target error is ignored.
+
+	\tparam StepNumberType Integer type of the step numbers
+      */
+      template<class StepNumberType> class ErrorTarget
+      {
+      public:
+	//! Initialise the stopping rule with the measurement parameters of a Metropolis simulation, the target error is multiplied with the given scale
+	template<class Parameters>
+	ErrorTarget(const Parameters& parameters, double target_scale = 1.0)
+	  : active(parameters.target_error > 0.0),
+	    target_error(parameters.target_error * target_scale),
+	    measurement_number(parameters.measurement_number),
+	    minimal_measurement_number(parameters.minimal_measurement_number),
+	    step_budget(parameters.measurement_step_budget > 0 ? parameters.measurement_step_budget : parameters.measurement_number * parameters.steps_between_measurement),
+	    performed_steps(0) {}
+
+	//! Get whether the measurements stop at the target error
+	bool is_active() const { return active; }
+	//! Get the blocking analysis of the monitored values
+	const Analysis::BlockingAnalysis& get_blocking() const { return blocking; }
+
+	//! Count steps performed for the measurements
+	void add_steps(StepNumberType steps) { performed_steps += steps; }
+
+	//! Add the monitored value of a measurement, the measurement itself if it is a scalar and the energy of the configuration otherwise
+	template<class EnergyObservator, class Observable, class ConfigurationType>
+	void observe(const Observable& measurement, ConfigurationType* configuration)
+	{
+	  double value;
+	  if (active && monitored_value<EnergyObservator>(measurement, configuration, value))
+	    blocking(value);
+	}
+
+	//! Check whether the measurements are finished using the error of the mean of this run
+	bool is_finished(unsigned long performed_measurements) const
+	{
+	  return is_finished(performed_measurements, blocking.variance_of_mean());
+	}
+	//! Check whether the measurements are finished using the given squared error of the mean (e.g. combined from several runs)
+	bool is_finished(unsigned long performed_measurements, double variance_of_mean) const
+	{
+	  if (!active || blocking.get_count() == 0) return performed_measurements >= measurement_number || (active && performed_steps >= step_budget);
+	  if (performed_steps >= step_budget) return true;
+	  if (performed_measurements < minimal_measurement_number) return false;
+	  // As long as the blocks are shorter than the correlation time the error of the mean is underestimated
+	  if (!blocking.is_converged()) return false;
+	  return std::sqrt(variance_of_mean) <= target_error;
+	}
+
+      private:
+	//! Flag indicating whether the measurements stop at the target error
+	bool active;
+	//! Target error of the mean
+	double target_error;
+	//! Number of measurements without target error
+	unsigned long measurement_number;
+	//! Minimal number of measurements before the error is checked
+	unsigned long minimal_measurement_number;
+	//! Maximal number of steps performed for the measurements
+	StepNumberType step_budget;
+	//! Number of steps performed for the measurements
+	StepNumberType performed_steps;
+	//! Blocking analysis of the monitored values
+	Analysis::BlockingAnalysis blocking;
+      };
+    }
+  }
+}
+
+#endif
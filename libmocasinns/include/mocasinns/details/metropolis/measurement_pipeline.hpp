@@ -0,0 +1,225 @@
+/*!
+  \file measurement_pipeline.hpp
+
+  \brief File containing the ring buffer of configuration snapshots for measurements on worker threads
+
+  \author Benedikt Krüger
+*/
+
+#ifndef MOCASINNS_DETAILS_METROPOLIS_MEASUREMENT_PIPELINE
+#define MOCASINNS_DETAILS_METROPOLIS_MEASUREMENT_PIPELINE
+
+#include <vector>
+#include <exception>
+#include <omp.h>
+#include <sched.h>
+
+namespace Mocasinns
+{
+  namespace Details
+  {
+    namespace Metropolis
+    {
+      //! Class passing snapshots of the configuration from the stepping thread to worker threads that evaluate the observable and feed the accumulator
+      /*!
+	\details The pipeline owns a ring of snapshot slots that are copied from the configuration once in the constructor, so a submission only assigns the configuration to a preallocated snapshot. The stepping thread calls submit for every measurement and finish after the last one, the worker threads call work, which evaluates the observable of the snapshots and returns when the pipeline is finished and all snapshots are evaluated. The results are passed to the accumulator in the order of the submissions, so accumulators that depend on the order (e.g. Accumulators::CorrelatorAccumulator) get the same series as without the pipeline.
+
+	If all slots are occupied, submit waits until the oldest slot is free (back-pressure) and evaluates pending snapshots itself in the meantime. Therefore the pipeline also works without worker threads, then every snapshot is evaluated by the stepping thread when its slot is needed again or when finish is called.
+
+	If the observator or the accumulator throws, the exception is stored and the pipeline fails: No further snapshots are evaluated or submitted, the waiting threads return and the exception can be rethrown with get_exception after the threads have left the parallel region.
+
+	\tparam ConfigurationType Type of the configuration, must be copy constructible and assignable
+	\tparam Observator Class with static function Observator::observe(ConfigurationType*) and typedef observable_type
+	\tparam Accumulator Class that accepts the observable in operator()
+      */
+      template<class ConfigurationType, class Observator, class Accumulator> class MeasurementPipeline
+      {
+      public:
+	//! Create a pipeline with the given number of slots (at least one), the snapshots are copies of the given configuration
+	MeasurementPipeline(const ConfigurationType& configuration, unsigned int slot_number, Accumulator& measurement_accumulator)
+	  : snapshots(slot_number > 0 ? slot_number : 1, configuration),
+	    states(snapshots.size(), free_slot),
+	    accumulator(measurement_accumulator),
+	    submitted_number(0), claimed_number(0), fed_number(0), waiting_number(0), finished(false), failed(false)
+	{
+	  omp_init_lock(&lock);
+	}
+	//! Destructor destroying the lock
+	~MeasurementPipeline() { omp_destroy_lock(&lock); }
+
+	//! Get the number of slots
+	unsigned int get_slot_number() const { return snapshots.size(); }
+	//! Get the number of submissions that had to wait for a free slot
+	unsigned long get_waiting_number() const { return waiting_number; }
+	//! Get the exception that failed the pipeline, a null pointer if neither the observator nor the accumulator has thrown
+	std::exception_ptr get_exception() const { return observator_exception; }
+
+	//! Check whether the observator or the accumulator has thrown, then submit does not take further snapshots
+	bool is_failed()
+	{
+	  omp_set_lock(&lock);
+	  const bool result = failed;
+	  omp_unset_lock(&lock);
+	  return result;
+	}
+
+	//! Copy the configuration into the next slot, waits until the slot is free (called by the stepping thread), the configuration is dropped if the pipeline has failed
+	void submit(const ConfigurationType& configuration)
+	{
+	  const unsigned int slot = submitted_number % snapshots.size();
+	  if (slot_state(slot) != free_slot)
+	  {
+	    ++waiting_number;
+	    unsigned int idle_rounds = 0;
+	    while (slot_state(slot) != free_slot)
+	    {
+	      if (is_failed()) return;
+	      if (process()) idle_rounds = 0;
+	      else back_off(idle_rounds);
+	    }
+	  }
+
+	  snapshots[slot] = configuration;
+	  omp_set_lock(&lock);
+	  states[slot] = filled_slot;
+	  ++submitted_number;
+	  omp_unset_lock(&lock);
+	}
+
+	//! Mark that no further snapshots are submitted and evaluate the remaining snapshots (called by the stepping thread)
+	void finish()
+	{
+	  omp_set_lock(&lock);
+	  finished = true;
+	  omp_unset_lock(&lock);
+	  work();
+	}
+
+	//! Evaluate snapshots until the pipeline is finished and all submitted snapshots are fed to the accumulator or the pipeline has failed (called by the worker threads)
+	void work()
+	{
+	  unsigned int idle_rounds = 0;
+	  while (true)
+	  {
+	    if (process())
+	    {
+	      idle_rounds = 0;
+	      continue;
+	    }
+	    omp_set_lock(&lock);
+	    const bool done = (finished && (fed_number == submitted_number)) || failed;
+	    omp_unset_lock(&lock);
+	    if (done) return;
+	    back_off(idle_rounds);
+	  }
+	}
+
+      private:
+	//! States of the slots
+	enum SlotState { free_slot, filled_slot, busy_slot };
+	//! Number of rounds an idle thread polls without pause before it yields the processor
+	static const unsigned int spin_rounds = 64;
+
+	//! Snapshots of the configuration
+	std::vector<ConfigurationType> snapshots;
+	//! States of the snapshot slots
+	std::vector<SlotState> states;
+	//! Accumulator fed with the observables
+	Accumulator& accumulator;
+	//! Lock protecting the states and the counters
+	omp_lock_t lock;
+	//! Number of submitted snapshots
+	unsigned long submitted_number;
+	//! Number of snapshots claimed for evaluation
+	unsigned long claimed_number;
+	//! Number of observables passed to the accumulator
+	unsigned long fed_number;
+	//! Number of submissions that had to wait for a free slot
+	unsigned long waiting_number;
+	//! Flag indicating that no further snapshots are submitted
+	bool finished;
+	//! Flag indicating that the observator or the accumulator has thrown
+	bool failed;
+	//! First exception of the observator or the accumulator
+	std::exception_ptr observator_exception;
+
+	//! Copy constructor (not copyable)
+	MeasurementPipeline(const MeasurementPipeline&);
+	//! Assignment operator (not assignable)
+	MeasurementPipeline& operator=(const MeasurementPipeline&);
+
+	//! Read the state of a slot
+	SlotState slot_state(unsigned int slot)
+	{
+	  omp_set_lock(&lock);
+	  const SlotState result = states[slot];
+	  omp_unset_lock(&lock);
+	  return result;
+	}
+
+	//! Pause in an idle loop, the thread polls for spin_rounds rounds and then yields the processor in every round, so idle workers do not take the processor from the stepping thread if there are more threads than processors
+	static void back_off(unsigned int& idle_rounds)
+	{
+	  if (idle_rounds < spin_rounds) ++idle_rounds;
+	  else sched_yield();
+	}
+
+	//! Evaluate the oldest unclaimed snapshot and feed the observable to the accumulator in the order of the submissions, returns false if there was no snapshot to evaluate or the pipeline has failed
+	bool process()
+	{
+	  omp_set_lock(&lock);
+	  if (failed || claimed_number == submitted_number)
+	  {
+	    omp_unset_lock(&lock);
+	    return false;
+	  }
+	  const unsigned long sequence = claimed_number++;
+	  const unsigned int slot = sequence % snapshots.size();
+	  states[slot] = busy_slot;
+	  omp_unset_lock(&lock);
+
+	  try
+	  {
+	    const typename Observator::observable_type observable = Observator::observe(&snapshots[slot]);
+
+	    // Wait for the observables of the older snapshots, or drop the observable if an older snapshot has failed
+	    unsigned int idle_rounds = 0;
+	    while (true)
+	    {
+	      omp_set_lock(&lock);
+	      if (failed)
+	      {
+		states[slot] = free_slot;
+		omp_unset_lock(&lock);
+		return false;
+	      }
+	      const bool turn = (fed_number == sequence);
+	      omp_unset_lock(&lock);
+	      if (turn) break;
+	      back_off(idle_rounds);
+	    }
+
+	    // Only the thread of the next sequence number feeds the accumulator, so the lock is not held during the call
+	    accumulator(observable);
+	    omp_set_lock(&lock);
+	    ++fed_number;
+	    states[slot] = free_slot;
+	    omp_unset_lock(&lock);
+	    return true;
+	  }
+	  catch (...)
+	  {
+	    omp_set_lock(&lock);
+	    if (!failed) observator_exception = std::current_exception();
+	    failed = true;
+	    states[slot] = free_slot;
+	    omp_unset_lock(&lock);
+	    return false;
+	  }
+	}
+      };
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,99 @@
+/*!
+  \file measurement_spacing.hpp
+
+  \brief File containing the controller of the number of steps between two measurements of a Metropolis run
+
+  \author Benedikt Krüger
+*/
+
+#ifndef MOCASINNS_DETAILS_METROPOLIS_MEASUREMENT_SPACING
+#define MOCASINNS_DETAILS_METROPOLIS_MEASUREMENT_SPACING
+
+#include "equilibration_value.hpp"
+#include "../../analysis/blocking_analysis.hpp"
+
+#include <cmath>
+
+namespace Mocasinns
+{
+  namespace Details
+  {
+    namespace Metropolis
+    {
+      //! Class controlling the number of steps between two measurements of a Metropolis run
+      /*!
+	\details Without adaptation the spacing is Parameters::steps_between_measurement. With Parameters::adapt_measurement_spacing the monitored value of every measurement is passed to a streaming Analysis::BlockingAnalysis. After every Parameters::measurement_spacing_window measurements the integrated autocorrelation time is converted to steps and the spacing is set to Parameters::measurement_spacing_tau_fraction times this time, afterwards the blocking analysis starts again. The spacing changes at most by a factor of four per window and stays between Parameters::minimal_steps_between_measurement and Parameters::maximal_steps_between_measurement.
+
+	\tparam StepNumberType Integer type of the step numbers
+      */
+      template<class StepNumberType> class MeasurementSpacing
+      {
+      public:
+	//! Initialise the controller with the measurement parameters of a Metropolis simulation
+	template<class Parameters>
+	MeasurementSpacing(const Parameters& parameters)
+	  : adaptive(parameters.adapt_measurement_spacing && parameters.measurement_spacing_window > 1),
+	    tau_fraction(parameters.measurement_spacing_tau_fraction),
+	    window(parameters.measurement_spacing_window),
+	    minimal_spacing(parameters.minimal_steps_between_measurement > 0 ? parameters.minimal_steps_between_measurement : 1),
+	    maximal_spacing(parameters.maximal_steps_between_measurement),
+	    spacing(parameters.steps_between_measurement),
+	    autocorrelation_time(0.0),
+	    blocking(8) {}
+
+	//! Get the number of steps to perform before the next measurement
+	StepNumberType get_steps_between_measurement() const { return spacing; }
+	//! Get the last estimate of the integrated autocorrelation time in steps, 0 if there is no estimate yet
+	double get_autocorrelation_time() const { return autocorrelation_time; }
+
+	//! Add the monitored value of a measurement, the measurement itself if it is a scalar and the energy of the configuration otherwise
+	template<class EnergyObservator, class Observable, class ConfigurationType>
+	void observe(const Observable& measurement, ConfigurationType* configuration)
+	{
+	  double value;
+	  if (adaptive && monitored_value<EnergyObservator>(measurement, configuration, value))
+	    (*this)(value);
+	}
+
+	//! Add the monitored value of a measurement and retune the spacing at the end of a window
+	void operator()(double value)
+	{
+	  if (!adaptive) return;
+	  blocking(value);
+	  if (blocking.get_count() < window) return;
+
+	  autocorrelation_time = blocking.integrated_autocorrelation_time() * spacing;
+	  double target = tau_fraction * autocorrelation_time;
+	  if (target < 0.25 * spacing) target = 0.25 * spacing;
+	  if (target > 4.0 * spacing) target = 4.0 * spacing;
+
+	  StepNumberType new_spacing = static_cast<StepNumberType>(std::floor(target + 0.5));
+	  if (new_spacing < minimal_spacing) new_spacing = minimal_spacing;
+	  if (maximal_spacing > 0 && new_spacing > maximal_spacing) new_spacing = maximal_spacing;
+	  spacing = new_spacing;
+	  blocking.clear();
+	}
+
+      private:
+	//! Flag indicating whether the spacing is adapted
+	bool adaptive;
+	//! Target spacing in units of the integrated autocorrelation time
+	double tau_fraction;
+	//! Number of measurements between two adaptations
+	unsigned int window;
+	//! Minimal spacing
+	StepNumberType minimal_spacing;
+	//! Maximal spacing, 0 for no limit
+	StepNumberType maximal_spacing;
+	//! Current spacing
+	StepNumberType spacing;
+	//! Last estimate of the integrated autocorrelation time in steps
+	double autocorrelation_time;
+	//! Blocking analysis of the monitored values of the current window
+	Analysis::BlockingAnalysis blocking;
+      };
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,89 @@
+/*!
+  \file run_buffer.hpp
+
+  \brief File containing the selection of the buffer storing the measurements of a single run of a parallel Metropolis simulation
+
+  \author Benedikt Krüger
+*/
+
+#ifndef MOCASINNS_DETAILS_METROPOLIS_RUN_BUFFER
+#define MOCASINNS_DETAILS_METROPOLIS_RUN_BUFFER
+
+#include "vector_accumulator.hpp"
+#include "../../accumulators/moments_accumulator.hpp"
+#include "../../accumulators/quantile_accumulator.hpp"
+#include "../../accumulators/correlator_accumulator.hpp"
+
+namespace Mocasinns
+{
+  namespace Details
+  {
+    namespace Metropolis
+    {
+      //! Class selecting the buffer of a run, by default the measurements are stored in a vector and given to the accumulator one by one
+      template<class Observable, class Accumulator> struct RunBuffer
+      {
+	//! Flag indicating whether the run buffer is merged into the accumulator as a whole
+	static const bool mergeable = false;
+	//! Type of the buffer
+	typedef VectorAccumulator<Observable> type;
+	//! Create an empty buffer for the given accumulator and the run with the given index
+	static type create(const Accumulator&, unsigned long) { return type(); }
+	//! Give the measurements of the buffer to the accumulator in the order they were taken, the buffer is deleted afterwards so the measurements are moved
+	static void merge(type& run_buffer, Accumulator& measurement_accumulator)
+	{
+	  for (typename std::vector<Observable>::iterator measurement = run_buffer.internal_vector.begin(); measurement != run_buffer.internal_vector.end(); ++measurement)
+	    measurement_accumulator(std::move(*measurement));
+	}
+      };
+
+      //! Specialisation for accumulators that can be merged (Accumulators::MomentsAccumulator), every run accumulates into its own accumulator
+      template<class Observable, unsigned int moment_order> struct RunBuffer<Observable, Mocasinns::Accumulators::MomentsAccumulator<Observable, moment_order> >
+      {
+	//! Flag indicating whether the run buffer is merged into the accumulator as a whole
+	static const bool mergeable = true;
+	//! Type of the buffer
+	typedef Mocasinns::Accumulators::MomentsAccumulator<Observable, moment_order> type;
+	//! Create an empty accumulator
+	static type create(const type&, unsigned long) { return type(); }
+	//! Merge the accumulator of the run into the accumulator
+	static void merge(type& run_buffer, type& measurement_accumulator) { measurement_accumulator.merge(run_buffer); }
+      };
+
+      //! Specialisation for the mergeable Accumulators::QuantileAccumulator, every run accumulates into its own sketch
+      template<class Observable> struct RunBuffer<Observable, Mocasinns::Accumulators::QuantileAccumulator<Observable> >
+      {
+	//! Flag indicating whether the run buffer is merged into the accumulator as a whole
+	static const bool mergeable = true;
+	//! Type of the buffer
+	typedef Mocasinns::Accumulators::QuantileAccumulator<Observable> type;
+	//! Create an empty sketch with the accuracy parameter of the given accumulator and a seed derived from the index of the run, so that the compactions of different runs are independent
+	static type create(const type& measurement_accumulator, unsigned long run_index)
+	{
+	  // SplitMix64 of the run index, neighbouring indices give unrelated seeds
+	  uint64_t seed = 88172645463325252ull + (run_index + 1)*0x9E3779B97F4A7C15ull;
+	  seed = (seed ^ (seed >> 30))*0xBF58476D1CE4E5B9ull;
+	  seed = (seed ^ (seed >> 27))*0x94D049BB133111EBull;
+	  return type(measurement_accumulator.get_k(), seed ^ (seed >> 31));
+	}
+	//! Merge the sketch of the run into the accumulator
+	static void merge(type& run_buffer, type& measurement_accumulator) { measurement_accumulator.merge(run_buffer); }
+      };
+
+      //! Specialisation for the mergeable Accumulators::CorrelatorAccumulator, every run correlates its own time series
+      template<class Observable> struct RunBuffer<Observable, Mocasinns::Accumulators::CorrelatorAccumulator<Observable> >
+      {
+	//! Flag indicating whether the run buffer is merged into the accumulator as a whole
+	static const bool mergeable = true;
+	//! Type of the buffer
+	typedef Mocasinns::Accumulators::CorrelatorAccumulator<Observable> type;
+	//! Create an empty correlator with the parameters of the given accumulator
+	static type create(const type& measurement_accumulator, unsigned long) { return type(measurement_accumulator.get_register_length(), measurement_accumulator.get_averaging_factor()); }
+	//! Merge the correlations of the run into the accumulator
+	static void merge(type& run_buffer, type& measurement_accumulator) { measurement_accumulator.merge(run_buffer); }
+      };
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,100 @@
+/*!
+  \file run_statistics.hpp
+
+  \brief File containing the shared statistics of the parallel runs at one temperature
+
+  \author Benedikt Krüger
+*/
+
+#ifndef MOCASINNS_DETAILS_METROPOLIS_RUN_STATISTICS
+#define MOCASINNS_DETAILS_METROPOLIS_RUN_STATISTICS
+
+#include <vector>
+#include <limits>
+#include <omp.h>
+
+namespace Mocasinns
+{
+  namespace Details
+  {
+    namespace Metropolis
+    {
+      //! Class storing the number of measurements and the squared error of the mean of every run at one temperature
+      /*!
+	\details The runs publish their statistics after every measurement. Since the runs are independent, the error of the mean of all measurements of the \f$ k \f$ runs that have published is
+	\f[
+	\sigma^2_{\bar{x}} = \frac{1}{N^2} \sum_r n_r^2 \sigma^2_{\bar{x}_r}
+	\f]
+	with \f$ N = \sum_r n_r \f$. The runs that have not published yet (e.g. because they are not scheduled yet) are missing, not runs without fluctuations. Therefore the combined error of all \f$ R \f$ runs is estimated by assuming that the missing runs will reach the same statistics, which scales the squared error by \f$ k/R \f$. Otherwise the first scheduled run could reach the target error on its own and the later runs would stop after a few measurements. All functions can be called concurrently.
+      */
+      class RunStatistics
+      {
+      public:
+	//! Create the statistics for the given number of runs
+	RunStatistics(unsigned int run_number) : counts(run_number, 0), variances_of_mean(run_number, 0.0) { omp_init_lock(&lock); }
+	//! Destructor
+	~RunStatistics() { omp_destroy_lock(&lock); }
+
+	//! Publish the statistics of a run and return the combined squared error of the mean
+	double publish(unsigned int run, unsigned long count, double variance_of_mean)
+	{
+	  omp_set_lock(&lock);
+	  counts[run] = count;
+	  variances_of_mean[run] = variance_of_mean;
+	  const double result = combined_variance_of_mean();
+	  omp_unset_lock(&lock);
+	  return result;
+	}
+
+	//! Get the number of measurements of a run
+	unsigned long get_count(unsigned int run)
+	{
+	  omp_set_lock(&lock);
+	  const unsigned long result = counts[run];
+	  omp_unset_lock(&lock);
+	  return result;
+	}
+	//! Get the estimated combined squared error of the mean of all runs, infinity if no run has published
+	double variance_of_mean()
+	{
+	  omp_set_lock(&lock);
+	  const double result = combined_variance_of_mean();
+	  omp_unset_lock(&lock);
+	  return result;
+	}
+
+      private:
+	//! Number of measurements of the runs
+	std::vector<unsigned long> counts;
+	//! Squared errors of the mean of the runs
+	std::vector<double> variances_of_mean;
+	//! Lock protecting the statistics
+	omp_lock_t lock;
+
+	//! Calculate the estimated combined squared error of the mean of all runs, the lock must be held
+	double combined_variance_of_mean() const
+	{
+	  double total_count = 0.0;
+	  double result = 0.0;
+	  unsigned int published_runs = 0;
+	  for (unsigned int run = 0; run < counts.size(); ++run)
+	  {
+	    if (counts[run] == 0) continue;
+	    ++published_runs;
+	    total_count += counts[run];
+	    result += static_cast<double>(counts[run])*counts[run]*variances_of_mean[run];
+	  }
+	  if (published_runs == 0) return std::numeric_limits<double>::infinity();
+	  return result / (total_count*total_count) * published_runs / counts.size();
+	}
+
+	//! Copy constructor (not copyable)
+	RunStatistics(const RunStatistics&);
+	//! Assignment operator (not assignable)
+	RunStatistics& operator=(const RunStatistics&);
+      };
+    }
+  }
+}
+
+#endif
@@ -10,6 +10,10 @@
 #define MOCASINNS_DETAILS_METROPOLIS_VECTOR_ACCUMULATOR
 
 #include <vector>
+#include <utility>
+
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/vector.hpp>
 
 namespace Mocasinns
 {
@@ -26,11 +30,20 @@ namespace Mocasinns
 	
 	//! Standard constructor
 	VectorAccumulator() : internal_vector() {}
-	//! Copy constructor
-	VectorAccumulator(const VectorAccumulator<Observable>& copy) : internal_vector(copy.internal_vector) {}
 	
 	//! Accumulating operator, refers to push-back
 	void operator()(const Observable& new_value) { internal_vector.push_back(new_value); }
+	//! Accumulating operator for temporary values, the value is moved into the vector
+	void operator()(Observable&& new_value) { internal_vector.push_back(std::move(new_value)); }
+
+      private:
+	//! Member variable for boost serialization
+	friend class boost::serialization::access;
+	//! Method to serialize this class (omitted version name to avoid unused parameter warnings)
+	template<class Archive> void serialize(Archive & ar, const unsigned int)
+	{
+	  ar & internal_vector;
+	}
       };
     }
   }
@@ -0,0 +1,113 @@
+/*!
+  \file bin_refinement.hpp
+
+  \brief File containing the refinement of the adaptive binning of the density of states of a multicanonical simulation
+
+  \author Benedikt Krüger
+*/
+
+#ifndef MOCASINNS_DETAILS_MULTICANONICAL_BIN_REFINEMENT
+#define MOCASINNS_DETAILS_MULTICANONICAL_BIN_REFINEMENT
+
+#include "../../histograms/histogram.hpp"
+
+#include <vector>
+#include <cmath>
+
+namespace Mocasinns
+{
+  namespace Details
+  {
+    namespace Multicanonical
+    {
+      //! Refine the binning of the density of states, histograms with a fixed binning are never refined
+      template<class LogDensityHistoType, class IncidenceHistoType, class IncidenceYValueType>
+      bool refine_bins(LogDensityHistoType&, IncidenceHistoType&, double, IncidenceYValueType, unsigned int)
+      {
+	return false;
+      }
+
+      //! Split the steep and well sampled bins of an adaptive binning of the density of states
+      /*!
+	\details The logarithmic density of states per energy \f$ s_i = \ln G_i - \ln w_i \f$ of the bins with the width \f$ w_i \f$ is assigned to the bin centres and its slope \f$ s'_i \f$ is estimated from the neighbouring bins. A bin is split into two halves if it was visited at least minimal_incidence times, was split less than maximal_level times and the logarithmic density of states changes by more than threshold across the bin, i.e. \f$ |s'_i| w_i > \f$ threshold. The states of the bin are distributed to the halves according to the linear interpolation of \f$ s \f$, so that
+	\f[
+	\ln G_{i,\pm} = \ln G_i \pm a - \ln(2 \cosh a), \qquad a = \frac{s'_i w_i}{4}
+	\f]
+	and the sum of the two halves is the density of states of the original bin. The incidence counter gets the refined binning and is set to zero, it contains only the bins that it contained before (a split bin is replaced by its two halves).
+
+	\param log_density_of_states Logarithmic density of states with adaptive binning
+	\param incidence_counter Incidence counter with the same binning as the density of states
+	\param threshold Maximal change of the logarithmic density of states across a bin
+	\param minimal_incidence Minimal number of visits of a bin before it is split
+	\param maximal_level Maximal number of times a bin of the regular binning is split
+	\returns True if at least one bin was split
+      */
+      template<class EnergyType, class IncidenceYValueType>
+      bool refine_bins(Histograms::HistogramAdaptive<EnergyType, double>& log_density_of_states, Histograms::HistogramAdaptive<EnergyType, IncidenceYValueType>& incidence_counter, double threshold, IncidenceYValueType minimal_incidence, unsigned int maximal_level)
+      {
+	typedef typename Histograms::HistogramAdaptive<EnergyType, double>::const_iterator const_iterator;
+	if (log_density_of_states.size() < 2) return false;
+
+	// Calculate the centres and the logarithmic density of states per energy of the bins
+	std::vector<EnergyType> edges;
+	std::vector<double> widths;
+	std::vector<double> centres;
+	std::vector<double> log_densities;
+	for (const_iterator bin = log_density_of_states.begin(); bin != log_density_of_states.end(); ++bin)
+	{
+	  const double width = static_cast<double>(log_density_of_states.bin_width(bin->first));
+	  edges.push_back(bin->first);
+	  widths.push_back(width);
+	  centres.push_back(static_cast<double>(bin->first) + 0.5*width);
+	  log_densities.push_back(bin->second - std::log(width));
+	}
+
+	// Find the bins to split and the slope of the density of states at these bins
+	const double minimal_width = static_cast<double>(log_density_of_states.get_binning_width()) / std::pow(2.0, static_cast<double>(maximal_level));
+	std::vector<unsigned int> split_bins;
+	std::vector<double> split_slopes;
+	for (unsigned int i = 0; i < edges.size(); ++i)
+	{
+	  if (widths[i] < 1.5*minimal_width) continue;
+	  typename Histograms::HistogramAdaptive<EnergyType, IncidenceYValueType>::const_iterator incidence = incidence_counter.find(edges[i]);
+	  if (incidence == incidence_counter.end() || incidence->second < minimal_incidence) continue;
+
+	  const unsigned int left = (i > 0) ? i - 1 : i;
+	  const unsigned int right = (i + 1 < edges.size()) ? i + 1 : i;
+	  const double slope = (log_densities[right] - log_densities[left]) / (centres[right] - centres[left]);
+	  if (std::fabs(slope) * widths[i] > threshold)
+	  {
+	    split_bins.push_back(i);
+	    split_slopes.push_back(slope);
+	  }
+	}
+	if (split_bins.empty()) return false;
+
+	// Split the bins and interpolate the density of states
+	for (unsigned int s = 0; s < split_bins.size(); ++s)
+	{
+	  const unsigned int i = split_bins[s];
+	  const double log_density = log_density_of_states[edges[i]];
+	  const double a = 0.25 * split_slopes[s] * widths[i];
+	  const double log_normalisation = std::fabs(a) + std::log(1.0 + std::exp(-2.0*std::fabs(a)));
+
+	  log_density_of_states.split_bin(edges[i]);
+	  log_density_of_states[edges[i]] = log_density - a - log_normalisation;
+	  log_density_of_states[edges[i] + static_cast<EnergyType>(0.5*widths[i])] = log_density + a - log_normalisation;
+	}
+	// The incidence counter gets the refined binning, but keeps only the bins it held before with a split bin replaced by its halves, the bins the walker never reached (e.g. of a warm start) would keep the flatness at zero
+	const Histograms::HistogramAdaptive<EnergyType, IncidenceYValueType> previous_incidence_counter(incidence_counter);
+	incidence_counter.initialise_empty(log_density_of_states);
+	for (typename Histograms::HistogramAdaptive<EnergyType, IncidenceYValueType>::iterator bin = incidence_counter.begin(); bin != incidence_counter.end();)
+	{
+	  if (previous_incidence_counter.exists_value(bin->first)) ++bin;
+	  else incidence_counter.erase(bin++);
+	}
+
+	return true;
+      }
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*!
+  \file microcanonical_measurement.hpp
+
+  \brief File containing the measurement of an observable per energy bin during a multicanonical simulation
+
+  \author Benedikt Krüger
+*/
+
+#ifndef MOCASINNS_DETAILS_MULTICANONICAL_MICROCANONICAL_MEASUREMENT
+#define MOCASINNS_DETAILS_MULTICANONICAL_MICROCANONICAL_MEASUREMENT
+
+namespace Mocasinns
+{
+  namespace Details
+  {
+    namespace Multicanonical
+    {
+      //! Base class of the measurements that a multicanonical simulation performs after its steps, independent of the observable and the accumulator
+      template<class EnergyType, class ConfigurationType> class MicrocanonicalMeasurement
+      {
+      public:
+	//! Create a measurement that is performed after every given number of steps
+	MicrocanonicalMeasurement(unsigned long spacing) : measurement_spacing(spacing > 0 ? spacing : 1), steps_since_measurement(0) {}
+	//! Destructor
+	virtual ~MicrocanonicalMeasurement() {}
+
+	//! Count a step and measure if the spacing is reached
+	void step(const EnergyType& energy_bin, ConfigurationType* configuration)
+	{
+	  if (++steps_since_measurement < measurement_spacing) return;
+	  steps_since_measurement = 0;
+	  measure(energy_bin, configuration);
+	}
+
+      protected:
+	//! Measure the observable of the configuration and pass it to the accumulator with the energy bin
+	virtual void measure(const EnergyType& energy_bin, ConfigurationType* configuration) = 0;
+
+      private:
+	//! Number of steps between two measurements
+	unsigned long measurement_spacing;
+	//! Number of steps since the last measurement
+	unsigned long steps_since_measurement;
+      };
+
+      //! Measurement of the observable of an Observator that is passed to an accumulator taking the energy bin and the observable (e.g. Accumulators::MicrocanonicalAccumulator)
+      template<class EnergyType, class ConfigurationType, class Observator, class Accumulator> class ObservatorMicrocanonicalMeasurement : public MicrocanonicalMeasurement<EnergyType, ConfigurationType>
+      {
+      public:
+	//! Create the measurement with a reference to the accumulator, that must live as long as the measurement is attached to the simulation
+	ObservatorMicrocanonicalMeasurement(Accumulator& microcanonical_accumulator, unsigned long spacing)
+	  : MicrocanonicalMeasurement<EnergyType, ConfigurationType>(spacing), accumulator(microcanonical_accumulator) {}
+
+      protected:
+	//! Measure the observable of the configuration and pass it to the accumulator with the energy bin
+	virtual void measure(const EnergyType& energy_bin, ConfigurationType* configuration) { accumulator(energy_bin, Observator::observe(configuration)); }
+
+      private:
+	//! Accumulator of the measurements
+	Accumulator& accumulator;
+      };
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef MOCASINNS_DETAILS_OPTIONAL_CONCEPT_CHECKS_SIMULATION_HAS_LOG_ACCEPTANCE_PROBABILITY
+#define MOCASINNS_DETAILS_OPTIONAL_CONCEPT_CHECKS_SIMULATION_HAS_LOG_ACCEPTANCE_PROBABILITY
+
+namespace Mocasinns
+{
+  namespace Details
+  {
+    namespace OptionalConceptChecks
+    {
+      //! Class for checking whether the given simulation type provides a function log_acceptance_probability
+      /*!
+	\tparam SimulationType Type that should be checked for the existance of the function
+	\details The address of the member function can only be formed in the template argument of SizeCheck if the function exists, otherwise the overload with the ellipsis is chosen. Usage: SimulationHasLogAcceptanceProbability<SimulationType>::value is true if SimulationType::log_acceptance_probability exists, otherwise it is false.
+       */
+      template <class SimulationType>
+      class SimulationHasLogAcceptanceProbability
+      {
+      private:
+	// Define two types that have guaranteed different sizes
+	typedef char Small;
+	struct Big { char dummy[2]; };
+	
+	// Type that can only be formed if the expression in the size is valid
+	template <unsigned long> struct SizeCheck {};
+
+	template <typename C>
+	static Small test(SizeCheck<sizeof(&C::log_acceptance_probability)>*);
+	template <typename C>
+	static Big test(...);
+	
+      public:
+	enum {
+	  value = (sizeof(test<SimulationType>(0)) == sizeof(Small))
+	};
+      };
+    }
+  }
+}
+
+#endif
@@ -20,14 +20,17 @@ namespace Mocasinns
 	typedef char Small;
 	struct Big { char dummy[2]; };
 	
+	// Type that can only be formed if the expression in the size is valid (the size of an array parameter is dropped from the function type and does not exclude the overload)
+	template <unsigned long> struct SizeCheck {};
+
 	template <typename C>
-	static Small test(char[sizeof(&C::selection_probability_factor)]);
+	static Small test(SizeCheck<sizeof(&C::selection_probability_factor)>*);
 	template <typename C>
 	static Big test(...);
 	
       public:
 	enum {
-	  value = (sizeof(test<StepType>(0) == sizeof(Small)))
+	  value = (sizeof(test<StepType>(0)) == sizeof(Small))
 	};
       };
     }
@@ -0,0 +1,86 @@
+/*!
+  \file acceptance_test.hpp
+
+  \brief File containing the acceptance tests of the generic steps for simulations providing a linear or a logarithmic acceptance probability
+
+  \author Benedikt Krüger
+*/
+
+#ifndef MOCASINNS_DETAILS_SIMULATION_ACCEPTANCE_TEST
+#define MOCASINNS_DETAILS_SIMULATION_ACCEPTANCE_TEST
+
+#include <cmath>
+#include <limits>
+
+namespace Mocasinns
+{
+  namespace Details
+  {
+    namespace Simulation
+    {
+      //! Class checking whether a step is executable, steps without StepType::is_executable are always executable
+      template <bool step_has_is_executable> struct StepExecutable
+      {
+	template <class StepType> static bool check(StepType& step) { return step.is_executable(); }
+      };
+      template <> struct StepExecutable<false>
+      {
+	template <class StepType> static bool check(StepType&) { return true; }
+      };
+
+      //! Class returning the selection probability factor of a step, steps without StepType::selection_probability_factor have the factor one
+      template <bool step_has_selection_probability_factor> struct SelectionProbabilityFactor
+      {
+	template <class StepType> static double get(StepType& step) { return step.selection_probability_factor(); }
+      };
+      template <> struct SelectionProbabilityFactor<false>
+      {
+	template <class StepType> static double get(StepType&) { return 1.0; }
+      };
+
+      //! Class deciding whether a proposed step is accepted, specialised for simulations with linear and with logarithmic acceptance probabilities
+      template <bool use_log_acceptance_probability> struct AcceptanceTest;
+
+      //! Acceptance test using Derived::acceptance_probability
+      template <> struct AcceptanceTest<false>
+      {
+	//! Accept the step with the probability acceptance_probability / selection_probability_factor
+	template <bool use_selection_probability_factor, class Derived, class StepType, class AcceptanceProbabilityParameterType, class RandomNumberGenerator>
+	static bool accept(Derived* simulation, StepType& step, AcceptanceProbabilityParameterType& acceptance_probability_parameter, RandomNumberGenerator* rng)
+	{
+	  double step_probability(simulation->acceptance_probability(step, acceptance_probability_parameter));
+	  if (use_selection_probability_factor)
+	    step_probability /= SelectionProbabilityFactor<use_selection_probability_factor>::get(step);
+
+	  return step_probability > 0.0 && (step_probability >= 1.0 || rng->random_double() < step_probability);
+	}
+      };
+
+      //! Acceptance test using Derived::log_acceptance_probability
+      /*!
+	\details Steps with a non-negative logarithm of the acceptance probability are accepted without drawing a random number, otherwise the logarithm is compared with the logarithm of a uniform random number. This replaces the exponential function of the linear acceptance probability by a logarithm that is only evaluated for steps that are not accepted for sure. A forbidden step is indicated by -infinity and is rejected without drawing a random number, so the random numbers are drawn exactly as in the linear test. The logarithm of the selection probability factor is only calculated if the factor differs from one.
+      */
+      template <> struct AcceptanceTest<true>
+      {
+	//! Accept the step with the probability exp(log_acceptance_probability) / selection_probability_factor
+	template <bool use_selection_probability_factor, class Derived, class StepType, class AcceptanceProbabilityParameterType, class RandomNumberGenerator>
+	static bool accept(Derived* simulation, StepType& step, AcceptanceProbabilityParameterType& acceptance_probability_parameter, RandomNumberGenerator* rng)
+	{
+	  double log_step_probability(simulation->log_acceptance_probability(step, acceptance_probability_parameter));
+	  if (use_selection_probability_factor)
+	  {
+	    const double selection_probability_factor = SelectionProbabilityFactor<use_selection_probability_factor>::get(step);
+	    if (selection_probability_factor != 1.0)
+	      log_step_probability -= log(selection_probability_factor);
+	  }
+
+	  // Forbidden steps are rejected without drawing a random number, as in the linear test
+	  if (log_step_probability == -std::numeric_limits<double>::infinity()) return false;
+	  return log_step_probability >= 0.0 || log(rng->random_double()) < log_step_probability;
+	}
+      };
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,86 @@
+/*!
+  \file wall_clock_budget.hpp
+
+  \brief File containing the wall clock budget of a simulation and the prediction of the duration of the next unit of work
+
+  \author Benedikt Krüger
+*/
+
+#ifndef MOCASINNS_DETAILS_SIMULATION_WALL_CLOCK_BUDGET
+#define MOCASINNS_DETAILS_SIMULATION_WALL_CLOCK_BUDGET
+
+#include <time.h>
+
+namespace Mocasinns
+{
+  namespace Details
+  {
+    namespace Simulation
+    {
+      //! Class storing the deadline of a simulation and the measured duration per unit of work
+      /*!
+	\details The engines time their units of work (sweeps, measurements, iterations) with begin_work() and end_work(), where the amount of work is measured in an engine specific unit (usually steps). The duration per unit of work is an exponential moving average of the measured rates, so that the prediction follows changes of the rate (e.g. a Wang-Landau simulation reaching new energy ranges) but is not disturbed by single outliers. The time is measured with the monotonic clock, so changes of the system time do not affect the budget.
+      */
+      class WallClockBudget
+      {
+      public:
+	//! Create an inactive budget
+	WallClockBudget() : active(false), deadline(0.0), safety_margin(0.0), seconds_per_work(0.0), work_start(0.0) {}
+
+	//! Set the budget to the given number of seconds from now, the next unit of work must finish the given safety margin (e.g. the time for writing a checkpoint) before the deadline
+	void set(double seconds, double margin)
+	{
+	  active = true;
+	  deadline = now() + seconds;
+	  safety_margin = margin;
+	}
+	//! Remove the budget
+	void clear() { active = false; }
+
+	//! Get whether a budget is set
+	bool is_active() const { return active; }
+	//! Get the remaining time in seconds
+	double remaining() const { return deadline - now(); }
+
+	//! Start the timing of a unit of work
+	void begin_work() { work_start = now(); }
+	//! Finish the timing of a unit of work with the given amount of work
+	void end_work(double work) { add_timing(work, now() - work_start); }
+	//! Add the duration of a unit of work that was timed elsewhere (e.g. by a thread)
+	void add_timing(double work, double seconds)
+	{
+	  if (work <= 0.0) return;
+	  const double rate = seconds / work;
+	  seconds_per_work = (seconds_per_work > 0.0) ? 0.5*(seconds_per_work + rate) : rate;
+	}
+
+	//! Predict the duration of the given amount of work in seconds, 0 if no work was timed yet
+	double predict(double work) const { return seconds_per_work * work; }
+	//! Check whether the given amount of work can be finished before the deadline
+	bool allows(double work) const { return !active || remaining() - safety_margin >= predict(work); }
+
+	//! Get the current time of the monotonic clock in seconds
+	static double now()
+	{
+	  struct timespec current_time;
+	  clock_gettime(CLOCK_MONOTONIC, &current_time);
+	  return current_time.tv_sec + 1e-9*current_time.tv_nsec;
+	}
+
+      private:
+	//! Flag indicating whether a budget is set
+	bool active;
+	//! Deadline in seconds of the monotonic clock
+	double deadline;
+	//! Time in seconds that must be left after the next unit of work
+	double safety_margin;
+	//! Average duration of one unit of work in seconds
+	double seconds_per_work;
+	//! Start time of the current unit of work
+	double work_start;
+      };
+    }
+  }
+}
+
+#endif
@@ -13,9 +13,11 @@
 #include "simulation.hpp"
 #include "concepts/concepts.hpp"
 #include "details/multicanonical/step_parameter.hpp"
+#include "details/multicanonical/microcanonical_measurement.hpp"
 
 // Boost serialization for derived classes
 #include <boost/serialization/base_object.hpp>
+#include <boost/shared_ptr.hpp>
 
 namespace Mocasinns
 {
@@ -69,10 +71,21 @@ namespace Mocasinns
 
     //! Calculate the acceptance probability of a step
     double acceptance_probability(StepType& step_to_execute, Details::Multicanonical::StepParameter<EnergyType>& step_parameters);
+    //! Calculate the logarithm of the acceptance probability of a step (-infinity if the step is forbidden)
+    double log_acceptance_probability(StepType& step_to_execute, Details::Multicanonical::StepParameter<EnergyType>& step_parameters);
     //! Handle an accepted step
     void handle_executed_step(StepType& executed_step, Details::Multicanonical::StepParameter<EnergyType>& step_parameters);
     //! Handle a rejected step
     void handle_rejected_step(StepType& rejected_step, Details::Multicanonical::StepParameter<EnergyType>& step_parameters);
+
+    //! Attach an accumulator that is called with the energy bin and the observable of the Observator after every measurement_spacing steps (e.g. Accumulators::MicrocanonicalAccumulator), the accumulator must live as long as it is attached
+    template <class Observator, class Accumulator>
+    void attach_microcanonical_accumulator(Accumulator& accumulator, StepNumberType measurement_spacing = 1)
+    {
+      microcanonical_measurement.reset(new Details::Multicanonical::ObservatorMicrocanonicalMeasurement<EnergyType, ConfigurationType, Observator, Accumulator>(accumulator, measurement_spacing));
+    }
+    //! Detach the microcanonical accumulator
+    void detach_microcanonical_accumulator() { microcanonical_measurement.reset(); }
     
     //! Do a certain number of entropic sampling steps updating the incidence_counter
     void do_entropic_sampling_steps(const StepNumberType& number);
@@ -96,6 +109,8 @@ namespace Mocasinns
     HistoType<EnergyType, double> log_density_of_states;
     //! Histogram for the incidence counter
     HistoType<EnergyType, IncidenceCounterYValueType> incidence_counter;
+    //! Measurement of the microcanonical accumulator, null if no accumulator is attached
+    boost::shared_ptr<Details::Multicanonical::MicrocanonicalMeasurement<EnergyType, ConfigurationType> > microcanonical_measurement;
 
     //! Current value of the flatness of the incidence counter
     double flatness_current;
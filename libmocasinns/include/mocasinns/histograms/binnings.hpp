@@ -15,6 +15,10 @@
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/serialization/vector.hpp>
 
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
 namespace Mocasinns
 {
 namespace Histograms
@@ -57,7 +61,7 @@ public:
   void set_binning_reference(T value) { binning_reference = value; }
 
   //! Functor for binning
-  T operator()(const T& value)
+  T operator()(const T& value) const
   {
     return binning_reference + binning_width*(T)(floor((value - binning_reference) / static_cast<double>(binning_width)));
   }
@@ -107,7 +111,7 @@ public:
   void set_binning_reference(T value) { binning_reference = value; }
 
   //! Functor for binning
-  std::vector<T> operator()(const std::vector<T>& value)
+  std::vector<T> operator()(const std::vector<T>& value) const
   {
     std::vector<T> result(binning_width.size(), 0);
     for (unsigned int i = 0; i < result.size(); i++)
@@ -116,6 +120,96 @@ public:
   }
 };
 
+//! Class for binning a single numerical value with bins that can be split
+/*!
+  \details Outside of the refined range the binning is the same as for BinningNumber. Inside of the refined range [refined_edges.front(), refined_edges.back()) the bins are given by the sorted lower edges in refined_edges, so a value is binned with a binary search in a contiguous vector. A bin is split into two halves with split(), the refined range is extended by the bins of the regular binning between the old refined range and the split bin, so that it stays contiguous. The bins are identified by their lower edge, as for BinningNumber.
+*/
+template<class T> class BinningAdaptive
+{
+private:
+  //! Bin-width of the regular binning
+  T binning_width;
+  //! Zero value of the regular binning
+  T binning_reference;
+  //! Sorted lower edges of the bins in the refined range, the last element is the upper edge of the refined range
+  std::vector<T> refined_edges;
+
+  // Serialization stuff
+  //! Member variable for boost serialization
+  friend class boost::serialization::access;
+  //! Method to serialize this class (omitted version name to avoid unused parameter warnings)
+  template<class Archive> void serialize(Archive & ar, const unsigned int)
+  {
+    ar & binning_width;
+    ar & binning_reference;
+    ar & refined_edges;
+  }
+
+  //! Get the lower edge of the bin of the regular binning containing the value
+  T regular_bin(const T& value) const
+  {
+    return binning_reference + binning_width*(T)(floor((value - binning_reference) / static_cast<double>(binning_width)));
+  }
+  //! Check whether a value is in the refined range
+  bool is_refined(const T& value) const
+  {
+    return !refined_edges.empty() && !(value < refined_edges.front()) && value < refined_edges.back();
+  }
+
+public:
+  //! Standard constructor
+  BinningAdaptive() : binning_width(1), binning_reference(0) {}
+  //! Constructor giving the bin width
+  BinningAdaptive(T new_binning_width) : binning_width(new_binning_width), binning_reference(0) { }
+  //! Constructor giving the bin width and the base value
+  BinningAdaptive(T new_binning_width, T new_binning_reference) : binning_width(new_binning_width), binning_reference(new_binning_reference) { }
+
+  //! Get-accessor for the bin width of the regular binning
+  T get_binning_width() const {return binning_width;}
+  //! Set-accessor for the bin width of the regular binning, removes the refinement
+  void set_binning_width(T value) { binning_width = value; refined_edges.clear(); }
+  //! Get-accessor for the reference point of the regular binning
+  T get_binning_reference() const {return binning_reference;}
+  //! Set-accessor for the reference point of the regular binning, removes the refinement
+  void set_binning_reference(T value) { binning_reference = value; refined_edges.clear(); }
+  //! Get-accessor for the edges of the refined range
+  const std::vector<T>& get_refined_edges() const { return refined_edges; }
+
+  //! Get the width of the bin with the given lower edge
+  T bin_width(const T& bin) const
+  {
+    if (!is_refined(bin)) return binning_width;
+    typename std::vector<T>::const_iterator upper = std::upper_bound(refined_edges.begin(), refined_edges.end(), bin);
+    return *upper - *(upper - 1);
+  }
+
+  //! Split the bin with the given lower edge into two halves
+  void split(const T& bin)
+  {
+    // Extend the refined range with the regular bins up to the given bin, the edges are calculated with the regular binning to avoid rounding differences
+    if (refined_edges.empty())
+    {
+      refined_edges.push_back(bin);
+      refined_edges.push_back(regular_bin(bin + 3*binning_width/2));
+    }
+    std::vector<T> lower_extension;
+    for (T edge = refined_edges.front(); bin < edge; ) lower_extension.push_back(edge = regular_bin(edge - binning_width/2));
+    refined_edges.insert(refined_edges.begin(), lower_extension.rbegin(), lower_extension.rend());
+    while (!(bin < refined_edges.back())) refined_edges.push_back(regular_bin(refined_edges.back() + 3*binning_width/2));
+
+    // Insert the middle of the bin
+    typename std::vector<T>::iterator upper = std::upper_bound(refined_edges.begin(), refined_edges.end(), bin);
+    refined_edges.insert(upper, *(upper - 1) + (*upper - *(upper - 1)) / 2);
+  }
+
+  //! Functor for binning
+  T operator()(const T& value) const
+  {
+    if (!is_refined(value)) return regular_bin(value);
+    return *(std::upper_bound(refined_edges.begin(), refined_edges.end(), value) - 1);
+  }
+};
+
 } // of namespace Histograms
 } // of namespace Mocasinns
 
@@ -167,6 +167,14 @@ public:
   iterator find(const x_value_type& bin) { return values.find(bin); }
   //! Get iterator to element
   const_iterator find(const x_value_type& bin) const { return values.find(bin); }
+  //! Get the bin of a value, the values of histograms without binning are the bins
+  x_value_type bin_of(const x_value_type& value) const { return value; }
+  //! Check whether the bin of a value exists, the values of histograms without binning are the bins
+  bool exists_value(const x_value_type& value) const { return exists(value); }
+  //! Get iterator to the bin of a value, the values of histograms without binning are the bins
+  iterator find_value(const x_value_type& value) { return find(value); }
+  //! Get iterator to the bin of a value, the values of histograms without binning are the bins
+  const_iterator find_value(const x_value_type& value) const { return find(value); }
 
   //! Calculates the flatness of the histogram
   double flatness() const;
@@ -239,35 +247,35 @@ public:
 
   //! Adds a scalar and a HistoBase
   template<class x_value_type, class y_value_type, class Derived>
-  const Derived operator+(const Derived& lhs, const y_value_type& scalar);
+  Derived operator+(const Derived& lhs, const y_value_type& scalar);
   //! Adds a HistoBase and a scalar
   template<class x_value_type, class y_value_type, class Derived>
-  const Derived operator+(const y_value_type& scalar, const Derived& rhs);
+  Derived operator+(const y_value_type& scalar, const Derived& rhs);
   //! Substract a scalar from a HistoBase
   template<class x_value_type, class y_value_type, class Derived>
-  const Derived operator-(const Derived& lhs, const y_value_type& scalar);
+  Derived operator-(const Derived& lhs, const y_value_type& scalar);
   //! Multipliess a scalar and a HistoBase
   template<class x_value_type, class y_value_type, class Derived>
-  const Derived operator*(const Derived& lhs, const y_value_type& scalar);
+  Derived operator*(const Derived& lhs, const y_value_type& scalar);
   //! Multiplies a HistoBase and a scalar
   template<class x_value_type, class y_value_type, class Derived>
-  const Derived operator*(const y_value_type& scalar, const Derived& rhs);
+  Derived operator*(const y_value_type& scalar, const Derived& rhs);
   //! Divides a HistoBase through a scalar
   template<class x_value_type, class y_value_type, class Derived>
-  const Derived operator/(const Derived& lhs, const y_value_type& scalar);
+  Derived operator/(const Derived& lhs, const y_value_type& scalar);
 
   //! Adds two histograms (the type of the left hand side determines the type of the result)
   template<class x_value_type, class y_value_type, class DerivedLeft, class DerivedRight>
-  const DerivedLeft operator+(const HistoBase<x_value_type, y_value_type, DerivedLeft>& lhs, const HistoBase<x_value_type, y_value_type, DerivedRight>& rhs);
+  DerivedLeft operator+(const HistoBase<x_value_type, y_value_type, DerivedLeft>& lhs, const HistoBase<x_value_type, y_value_type, DerivedRight>& rhs);
   //! Substracts two histograms (the type of the left hand side determines the type of the result)
   template<class x_value_type, class y_value_type, class DerivedLeft, class DerivedRight>
-  const DerivedLeft operator-(const HistoBase<x_value_type, y_value_type, DerivedLeft>& lhs, const HistoBase<x_value_type, y_value_type, DerivedRight>& rhs);
+  DerivedLeft operator-(const HistoBase<x_value_type, y_value_type, DerivedLeft>& lhs, const HistoBase<x_value_type, y_value_type, DerivedRight>& rhs);
   //! Multiplies two histograms
   template<class x_value_type, class y_value_type, class Derived>
-  const Derived operator*(const HistoBase<x_value_type, y_value_type, Derived>& lhs, const HistoBase<x_value_type, y_value_type, Derived>& rhs);
+  Derived operator*(const HistoBase<x_value_type, y_value_type, Derived>& lhs, const HistoBase<x_value_type, y_value_type, Derived>& rhs);
   //! Divides two histograms
   template<class x_value_type, class y_value_type, class Derived>
-  const Derived operator/(const HistoBase<x_value_type, y_value_type, Derived>& lhs, const HistoBase<x_value_type, y_value_type, Derived>& rhs);
+  Derived operator/(const HistoBase<x_value_type, y_value_type, Derived>& lhs, const HistoBase<x_value_type, y_value_type, Derived>& rhs);
 
   //! Writes a histogram to an output stream with format "x_value\ty_value\n"
   template<class x_value_type, class y_value_type, class Derived>
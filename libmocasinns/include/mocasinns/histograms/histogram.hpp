@@ -77,9 +77,9 @@ public:
   explicit Histogram(const HistoBase<other_x_value_type, y_value_type, Histogram<other_x_value_type, y_value_type, BinningFunctor> >& other) : Base(other) {}
 
   //! Get-accessor for the binning functor
-  BinningFunctor get_binning() const { return binning; }
+  const BinningFunctor& get_binning() const { return binning; }
   //! Set-accessor for the binning functor
-  void set_binning(BinningFunctor value) { binning = value; }
+  void set_binning(const BinningFunctor& value) { binning = value; }
   //! Get-accessor for the width of the binning
   x_value_type get_binning_width() const { return binning.get_binning_width(); }
   //! Set-accessor for the width of the binning
@@ -124,6 +124,15 @@ public:
   //! Bin a calue
   virtual x_value_type bin_value(x_value_type value) { return binning(value); }
 
+  //! Get the bin of a value
+  x_value_type bin_of(const x_value_type& value) const { return binning(value); }
+  //! Check whether the bin of a value exists, take binning into account (exists() takes a bin)
+  bool exists_value(const x_value_type& value) const { return this->values.find(binning(value)) != this->values.end(); }
+  //! Get iterator to the bin of a value, take binning into account (find() takes a bin)
+  iterator find_value(const x_value_type& value) { return this->values.find(binning(value)); }
+  //! Get iterator to the bin of a value, take binning into account (find() takes a bin)
+  const_iterator find_value(const x_value_type& value) const { return this->values.find(binning(value)); }
+
   //! Initialise the Histogram with all necessary data of another Histogram, but sets all y-values to 0
   template <class other_y_value_type>
   void initialise_empty(const Histogram<x_value_type, other_y_value_type, BinningFunctor>& other);
@@ -163,6 +172,40 @@ public:
   explicit HistogramNumber(const HistoBase<other_x_value_type, y_value_type, HistogramNumber<other_x_value_type, y_value_type> >& other) : Base(other) {}
 };
 
+/*!
+  \brief Class implementing a histogram for number x_value_types with bins that can be split
+
+  \details The histogram starts with the regular binning given by the binning width and reference. Bins are split with split_bin(), the y-value of the split bin is removed and the two halves have to be filled by the caller (e.g. by interpolation). Since the width of the bins differs, it can be queried with bin_width().
+  \tparam x_value_type Type of the x-values of the histogram, should be a floating point type
+  \tparam y_value_type Type of the y-values of the histogram
+*/
+template<class x_value_type, class y_value_type>
+class HistogramAdaptive : public Histogram<x_value_type, y_value_type, BinningAdaptive<x_value_type> >
+{
+public:
+  typedef Histogram<x_value_type, y_value_type, BinningAdaptive<x_value_type> > Base;
+
+  //! Standard constructor
+  HistogramAdaptive() : Base() {}
+  //! Constructor taking a binning functor
+  HistogramAdaptive(BinningAdaptive<x_value_type> binning_functor) : Base(binning_functor) {}
+  //! Constructor taking the binning width and the binning reference
+  HistogramAdaptive(x_value_type binning_width, x_value_type binning_reference) : Base(binning_width, binning_reference) {}
+  //! Copy constructor
+  HistogramAdaptive(const Base& other) : Base(other) {}
+
+  //! Get the width of the bin with the given lower edge
+  x_value_type bin_width(const x_value_type& bin) const { return this->get_binning().bin_width(bin); }
+  //! Split the bin with the given lower edge into two halves and remove its y-value
+  void split_bin(const x_value_type& bin)
+  {
+    BinningAdaptive<x_value_type> new_binning = this->get_binning();
+    new_binning.split(bin);
+    this->set_binning(new_binning);
+    this->values.erase(bin);
+  }
+};
+
 /*!
   \brief Class implementing a histogram for vector of numbers as x_value_types
 
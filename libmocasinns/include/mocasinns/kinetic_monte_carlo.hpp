@@ -0,0 +1,174 @@
+/**
+ * \file kinetic_monte_carlo.hpp
+ * \brief Class for continuous-time kinetic Monte-Carlo simulations with MoCaSinns
+ * 
+ * Does rejection-free kinetic Monte-Carlo steps (n-fold way / BKL algorithm) with an exponential clock and determines statistical averages of observables at fixed intervals of physical time. Usage examples are found in the test cases.
+ * 
+ * \author Benedikt Krüger
+ */
+
+#ifndef MOCASINNS_KINETIC_MONTE_CARLO_HPP
+#define MOCASINNS_KINETIC_MONTE_CARLO_HPP
+
+#include "simulation.hpp"
+#include "concepts/concepts.hpp"
+#include "details/kinetic_monte_carlo/rate_tree.hpp"
+
+// Boost serialization for derived classes
+#include <boost/serialization/base_object.hpp>
+
+// Boost function types for the standard observable
+#include <boost/function_types/result_type.hpp>
+#include <boost/typeof/std/utility.hpp>
+#include <boost/type_traits.hpp>
+
+namespace Mocasinns
+{
+
+/*!
+  \brief Class for continuous-time kinetic Monte-Carlo simulations
+  \details Every site of the configuration carries the sum of the rates of all steps that can be done at this site. The site rates are stored in a binary sum tree, so that a site can be chosen with probability proportional to its rate in O(log N) operations. After a step has been executed, only the rates of the changed site and of its neighbours are recalculated. The physical time is advanced by an exponentially distributed waiting time with the total rate as parameter.
+
+  Additionally to the ConfigurationConcept, the configuration must provide the following functions (they are implemented by the spin lattices and spin networks of libgespinst):
+  - std::vector<StepType> all_steps(unsigned int site): All steps that can be done at the given site (between 0 and system_size() - 1)
+  - std::vector<unsigned int> neighbour_sites(unsigned int site): Sites whose rates change if a step at the given site is executed
+*/
+template <class ConfigurationType, class StepType, class RandomNumberGenerator>
+class KineticMonteCarlo : public Simulation<ConfigurationType, RandomNumberGenerator>
+{
+  // Check the configuration concept
+  BOOST_CONCEPT_ASSERT((Concepts::ConfigurationConcept<ConfigurationType, StepType>));  
+  // Check the step concept
+  BOOST_CONCEPT_ASSERT((Concepts::StepConcept<StepType>));
+  // Check the random number generator concept
+  BOOST_CONCEPT_ASSERT((Concepts::RandomNumberGeneratorConcept<RandomNumberGenerator>));
+
+public:
+  //! Typedef of this class
+  typedef KineticMonteCarlo<ConfigurationType, StepType, RandomNumberGenerator> this_type;
+  // Typedefs for integers
+  typedef typename Simulation<ConfigurationType, RandomNumberGenerator>::StepNumberType StepNumberType;
+  typedef uint32_t MeasurementNumberType;
+  //! Forward declaration of the struct storing the Parameters of a kinetic Monte-Carlo simulation
+  struct Parameters;
+
+  //! Enum for the different transition rates that can be used
+  enum RateType
+  {
+    //! Metropolis rates \f$ \nu \min(1, e^{-\beta \Delta E}) \f$
+    metropolis_rates,
+    //! Glauber (heat-bath) rates \f$ \nu / (1 + e^{\beta \Delta E}) \f$
+    glauber_rates
+  };
+
+  //! Standard class for observing the energy of the system
+  struct ObserveEnergy
+  {
+    typedef BOOST_TYPEOF(&ConfigurationType::energy) energy_function_type;
+    typedef typename boost::function_types::result_type<energy_function_type>::type observable_type;
+    static observable_type observe(ConfigurationType* config) { return config->energy(); }
+  };
+  //! Typedef for the default observable
+  typedef typename KineticMonteCarlo<ConfigurationType, StepType, RandomNumberGenerator>::ObserveEnergy DefaultObservator;
+
+  //! Boost signal handler invoked after every measurement
+  boost::signals2::signal<void (Simulation<ConfigurationType,RandomNumberGenerator>*)> signal_handler_measurement;
+
+  //! Initialise a kinetic MC simulation with default configuration space and default Parameters
+  KineticMonteCarlo() : Simulation<ConfigurationType, RandomNumberGenerator>(), simulation_parameters(), physical_time(0.0), rate_tree() {}
+  //! Initialise a kinetic MC simulation with default configuration space and given Parameters
+  KineticMonteCarlo(const Parameters& params) : Simulation<ConfigurationType, RandomNumberGenerator>(), simulation_parameters(params), physical_time(0.0), rate_tree() {}
+  //! Initialise a kinetic MC simulation with given parameters and given configuration space
+  KineticMonteCarlo(const Parameters& params, ConfigurationType* initial_configuration) : Simulation<ConfigurationType, RandomNumberGenerator>(initial_configuration), simulation_parameters(params), physical_time(0.0), rate_tree() {}
+
+  //! Get-accessor for the parameters of the kinetic MC simulation
+  const Parameters& get_simulation_parameters() { return simulation_parameters; }
+  //! Set-accessor for the parameters of the kinetic MC simulation
+  void set_parameters(const Parameters& value) { simulation_parameters = value; }
+  //! Get-accessor for the physical time elapsed in the simulation
+  double get_physical_time() const { return physical_time; }
+  //! Set-accessor for the physical time elapsed in the simulation
+  void set_physical_time(double value) { physical_time = value; }
+
+  //! Calculate the transition rate of a given step at inverse temperature beta
+  double rate(StepType& step, double beta) const;
+  //! Calculate the total rate of all steps at the given site at inverse temperature beta
+  double site_rate(unsigned int site, double beta);
+  //! Get the total rate of all steps of the configuration (valid after a call of one of the do_kinetic_monte_carlo functions)
+  double total_rate() const { return rate_tree.total_rate(); }
+
+  //! Execute a given number of kinetic MC steps on the configuration at inverse temperature beta
+  void do_kinetic_monte_carlo_steps(const StepNumberType& number, double beta);
+  //! Evolve the configuration for the given interval of physical time at inverse temperature beta
+  void do_kinetic_monte_carlo_time(double time, double beta);
+
+  //! Execute a kinetic Monte-Carlo simulation at given inverse temperature
+  template<class Observator = DefaultObservator>
+  std::vector<typename Observator::observable_type> do_kinetic_monte_carlo_simulation(double beta);
+  //! Execute a kinetic Monte-Carlo simulation at given inverse temperature with an accumulator for storing the measurement results
+  template<class Observator = DefaultObservator, class Accumulator>
+  void do_kinetic_monte_carlo_simulation(double beta, Accumulator& measurement_accumulator);
+
+  //! Load the data of the kinetic MC simulation from a serialization stream
+  virtual void load_serialize(std::istream& input_stream);
+  //! Load the data of the kinetic MC simulation from a serialization file
+  virtual void load_serialize(const char* filename);
+  //! Save the data of the kinetic MC simulation to a serialization stream
+  virtual void save_serialize(std::ostream& output_stream) const;
+  //! Save the data of the kinetic MC simulation to a serialization file
+  virtual void save_serialize(const char* filename) const;
+
+private:
+  //! Member variable storing the parameters of the simulation
+  Parameters simulation_parameters;
+  //! Physical time elapsed in the simulation
+  double physical_time;
+  //! Binary sum tree storing the rates of all sites
+  Details::KineticMonteCarlo::RateTree rate_tree;
+
+  //! Calculate the rates of all sites and store them in the rate tree
+  void initialise_rates(double beta);
+  //! Choose a site and a step according to the rates, execute the step and update the affected rates
+  void execute_event(double beta);
+  //! Evolve the configuration for the given physical time assuming valid rates
+  void evolve(double time, double beta);
+
+  //! Member variable for boost serialization
+  friend class boost::serialization::access;
+  //! Method to serialize this class (omitted version name to avoid unused parameter warnings)
+  template<class Archive> void serialize(Archive & ar, const unsigned int)
+  {
+    // serialize base class information
+    ar & boost::serialization::base_object<Simulation<ConfigurationType, RandomNumberGenerator> >(*this);
+    ar & physical_time;
+  }
+};
+
+//! Struct storing the definition of the Parameters of a kinetic Monte-Carlo simulation
+template <class ConfigurationType, class StepType, class RandomNumberGenerator>
+struct KineticMonteCarlo<ConfigurationType, StepType, RandomNumberGenerator>::Parameters
+{
+  //! Type of the transition rates
+  RateType rate_type;
+  //! Attempt frequency \f$ \nu \f$ multiplying all rates
+  double attempt_frequency;
+  //! Physical time to evolve before taking data
+  double relaxation_time;
+  //! Number of data points per temperature
+  MeasurementNumberType measurement_number;
+  //! Physical time between two data measurements
+  double time_between_measurement;
+  
+  //! Standard constructor for setting default values
+  Parameters() : rate_type(metropolis_rates),
+		 attempt_frequency(1.0),
+		 relaxation_time(10.0),
+		 measurement_number(100),
+		 time_between_measurement(1.0) {}
+};
+  
+} // of namespace Mocasinns
+
+#include "src/kinetic_monte_carlo.cpp"
+
+#endif
@@ -0,0 +1,340 @@
+/*! \file libmocasinns_wrap.cpp
+ * \brief Python module for the simulations of Ising lattices, the histograms and the accumulators
+ * \details The module is built as shared library libmocasinns_wrap.so, e.g. with
+ * g++ -std=c++0x -O2 -fopenmp -shared -fPIC -I.. -I../../../libgespinst/include $(python3-config --includes) libmocasinns_wrap.cpp -o libmocasinns_wrap.so -lboost_python311 -lboost_serialization
+ * make python_test in libmocasinns/test builds this module and libgespinst_wrap and runs the smoke test test_python/test_python_bindings.py.
+ *
+ * The lattices are exported by libgespinst_wrap, which is imported by this module. The time series of the vector accumulators and the buffers of the dense histograms are exported through the buffer protocol without copies (e.g. numpy.asarray(accumulator.values())). While views of the time series exist, the accumulator raises a BufferError instead of accumulating further values, since the vector could reallocate its memory. The bins of the microcanonical accumulators and the means of the moments accumulators grow with the accumulated values and are small, they are copied like the values of the histograms, which are stored in a std::map. The do_* functions of the simulations release the global interpreter lock, so other Python threads continue while the simulation runs. The lattice and the attached accumulators must not be used from Python until the call returns.
+ * \author Benedikt Krüger
+ */
+#include <boost/python.hpp>
+#include <boost/iterator/transform_iterator.hpp>
+
+#include <string>
+#include <stdexcept>
+
+#include <gespinst/spin_lattice.hpp>
+#include <gespinst/spins/ising_spin.hpp>
+#include <gespinst/details/python_support.hpp>
+
+#include "metropolis.hpp"
+#include "wang_landau.hpp"
+#include "histograms/histocrete.hpp"
+#include "observables/dense_histogram_observable.hpp"
+#include "accumulators/moments_accumulator.hpp"
+#include "accumulators/microcanonical_accumulator.hpp"
+#include "details/metropolis/vector_accumulator.hpp"
+#include "random/boost_random.hpp"
+
+using namespace boost::python;
+using namespace Mocasinns;
+using namespace Gespinst;
+
+namespace
+{
+  typedef Histograms::Histocrete<int, double> HistocreteDouble;
+  typedef Histograms::Histocrete<int, uint64_t> HistocreteIncidence;
+  typedef Observables::DenseHistogramObservable<int, double> DenseHistogramDouble;
+  typedef Details::Metropolis::VectorAccumulator<double> VectorAccumulatorDouble;
+  typedef Accumulators::MomentsAccumulator<double> MomentsAccumulatorDouble;
+  typedef Accumulators::MicrocanonicalAccumulator<int, double> MicrocanonicalAccumulatorDouble;
+
+  //! Convert a new reference into an object, throws if the reference is null because a Python exception is set
+  object to_object(PyObject* new_reference) { return object(handle<>(new_reference)); }
+
+  //! Observator for the magnetization of a lattice
+  template<class ConfigurationType> struct ObserveMagnetization
+  {
+    typedef double observable_type;
+    static observable_type observe(ConfigurationType* config) { return config->magnetization(); }
+  };
+
+  //! Functor selecting the x-value of a histogram bin
+  template<class Histo> struct HistogramXValue
+  {
+    typedef typename Histo::key_type result_type;
+    result_type operator()(const typename Histo::value_type& bin) const { return bin.first; }
+  };
+  //! Functor selecting the y-value of a histogram bin
+  template<class Histo> struct HistogramYValue
+  {
+    typedef typename Histo::mapped_type result_type;
+    result_type operator()(const typename Histo::value_type& bin) const { return bin.second; }
+  };
+
+  //! Copy the x-values of a histogram into an array, the histogram has no contiguous storage
+  template<class Histo>
+  object histogram_x_values(const Histo& histogram)
+  {
+    return to_object(Python::create_array_copy<typename Histo::key_type>(boost::make_transform_iterator(histogram.begin(), HistogramXValue<Histo>()),
+									   boost::make_transform_iterator(histogram.end(), HistogramXValue<Histo>()), histogram.size()));
+  }
+  //! Copy the y-values of a histogram into an array, the histogram has no contiguous storage
+  template<class Histo>
+  object histogram_y_values(const Histo& histogram)
+  {
+    return to_object(Python::create_array_copy<typename Histo::mapped_type>(boost::make_transform_iterator(histogram.begin(), HistogramYValue<Histo>()),
+									      boost::make_transform_iterator(histogram.end(), HistogramYValue<Histo>()), histogram.size()));
+  }
+  //! Convert a histogram into a dense histogram with contiguous storage
+  DenseHistogramDouble histogram_to_dense(const HistocreteDouble& histogram)
+  {
+    return DenseHistogramDouble(DenseHistogramDouble::create_x_axis(histogram), histogram);
+  }
+
+  //! View of the shared x-axis of a dense histogram, the view keeps the histogram alive
+  object dense_x_values(object self)
+  {
+    const DenseHistogramDouble& histogram = extract<const DenseHistogramDouble&>(self);
+    if (!histogram.get_x_axis()) return to_object(Python::create_array_copy<int>(static_cast<int*>(NULL), static_cast<int*>(NULL), 0));
+    return to_object(Python::create_vector_view(self.ptr(), *histogram.get_x_axis()));
+  }
+  //! Writable view of the y-values of a dense histogram, the view keeps the histogram alive
+  object dense_y_values(object self)
+  {
+    const DenseHistogramDouble& histogram = extract<const DenseHistogramDouble&>(self);
+    return to_object(Python::create_vector_view(self.ptr(), histogram.get_y_values(), false));
+  }
+
+  //! Raise a BufferError if views of the time series of a vector accumulator exist
+  void check_accumulator_resizable(const VectorAccumulatorDouble& accumulator)
+  {
+    if (!Python::check_vector_resizable(&accumulator.internal_vector)) throw_error_already_set();
+  }
+  //! The memory of a moments accumulator is not exported
+  void check_accumulator_resizable(const MomentsAccumulatorDouble&) {}
+
+  //! View of the time series of a vector accumulator, no values can be accumulated while the view exists
+  object vector_accumulator_values(object self)
+  {
+    const VectorAccumulatorDouble& accumulator = extract<const VectorAccumulatorDouble&>(self);
+    return to_object(Python::create_vector_view(self.ptr(), accumulator.internal_vector));
+  }
+  //! Get the number of values of a vector accumulator
+  std::size_t vector_accumulator_size(const VectorAccumulatorDouble& accumulator) { return accumulator.internal_vector.size(); }
+  //! Remove the values of a vector accumulator, the memory is kept for the next series
+  void vector_accumulator_clear(VectorAccumulatorDouble& accumulator)
+  {
+    check_accumulator_resizable(accumulator);
+    accumulator.internal_vector.clear();
+  }
+
+  //! Array with the running means of the components of a moments accumulator, the means are reallocated by reset and merge
+  object moments_accumulator_means(const MomentsAccumulatorDouble& accumulator)
+  {
+    return to_object(Python::create_array_copy<double>(accumulator.get_means().begin(), accumulator.get_means().end(), accumulator.get_means().size()));
+  }
+  //! Accumulate a value into a moments accumulator
+  void moments_accumulator_add(MomentsAccumulatorDouble& accumulator, double value) { accumulator(value); }
+
+  //! Array with the energy bins of a microcanonical accumulator, the bins are copied since an attached simulation inserts new bins
+  object microcanonical_energies(const MicrocanonicalAccumulatorDouble& accumulator)
+  {
+    return to_object(Python::create_array_copy<int>(accumulator.get_energies().begin(), accumulator.get_energies().end(), accumulator.get_energies().size()));
+  }
+  //! Array with the measurement counts of a microcanonical accumulator, the counts are copied since an attached simulation inserts new bins
+  object microcanonical_counts(const MicrocanonicalAccumulatorDouble& accumulator)
+  {
+    return to_object(Python::create_array_copy<uint64_t>(accumulator.get_counts().begin(), accumulator.get_counts().end(), accumulator.get_counts().size()));
+  }
+  //! Array with the microcanonical averages of a microcanonical accumulator
+  object microcanonical_averages(const MicrocanonicalAccumulatorDouble& accumulator)
+  {
+    const std::vector<double> averages = accumulator.microcanonical_averages();
+    return to_object(Python::create_array_copy<double>(averages.begin(), averages.end(), averages.size()));
+  }
+  //! Initialise the energy bins of a microcanonical accumulator with the bins of a density of states
+  void microcanonical_initialise_bins(MicrocanonicalAccumulatorDouble& accumulator, const HistocreteDouble& histogram) { accumulator.initialise_bins(histogram); }
+  //! Calculate the canonical average of a microcanonical accumulator
+  double microcanonical_canonical_average(const MicrocanonicalAccumulatorDouble& accumulator, const HistocreteDouble& log_density_of_states, double beta)
+  {
+    return accumulator.canonical_average(log_density_of_states, beta);
+  }
+
+  //! Do Metropolis steps without the global interpreter lock
+  template<class SimulationType>
+  void metropolis_steps(SimulationType& simulation, typename SimulationType::StepNumberType number, double beta)
+  {
+    Python::ScopedGILRelease release;
+    simulation.do_metropolis_steps(number, beta);
+  }
+  //! Do the relaxation of a Metropolis simulation without the global interpreter lock
+  template<class SimulationType>
+  typename SimulationType::StepNumberType metropolis_relaxation(SimulationType& simulation, double beta)
+  {
+    Python::ScopedGILRelease release;
+    return simulation.do_metropolis_relaxation(beta);
+  }
+  /*!
+   * \details The simulation runs without the global interpreter lock.
+   * \param observable Name of the observable, "energy" or "magnetization"
+   */
+  template<class SimulationType, class ConfigurationType, class Accumulator>
+  void metropolis_simulation(SimulationType& simulation, double beta, Accumulator& accumulator, const std::string& observable)
+  {
+    if (observable != "energy" && observable != "magnetization")
+      throw std::invalid_argument("The observable must be \"energy\" or \"magnetization\".");
+    check_accumulator_resizable(accumulator);
+
+    Python::ScopedGILRelease release;
+    if (observable == "energy")
+      simulation.template do_metropolis_simulation<typename SimulationType::DefaultObservator>(beta, accumulator);
+    else
+      simulation.template do_metropolis_simulation<ObserveMagnetization<ConfigurationType> >(beta, accumulator);
+  }
+
+  //! Do Wang-Landau steps at the current modification factor without the global interpreter lock
+  template<class SimulationType>
+  void wang_landau_steps(SimulationType& simulation, uint32_t number)
+  {
+    Python::ScopedGILRelease release;
+    simulation.do_wang_landau_steps(number);
+  }
+  //! Do Wang-Landau steps until the incidence counter is flat without the global interpreter lock
+  template<class SimulationType>
+  void wang_landau_steps_until_flat(SimulationType& simulation)
+  {
+    Python::ScopedGILRelease release;
+    simulation.do_wang_landau_steps();
+  }
+  //! Do a complete Wang-Landau simulation without the global interpreter lock
+  template<class SimulationType>
+  void wang_landau_simulation(SimulationType& simulation)
+  {
+    Python::ScopedGILRelease release;
+    simulation.do_wang_landau_simulation();
+  }
+  //! Attach a microcanonical accumulator for the magnetization to a Wang-Landau simulation
+  template<class SimulationType, class ConfigurationType>
+  void wang_landau_attach_magnetization(SimulationType& simulation, MicrocanonicalAccumulatorDouble& accumulator, typename SimulationType::StepNumberType measurement_spacing)
+  {
+    simulation.template attach_microcanonical_accumulator<ObserveMagnetization<ConfigurationType> >(accumulator, measurement_spacing);
+  }
+
+  //! Export a Metropolis simulation of an Ising lattice with the given dimension
+  template<unsigned int dimension>
+  void export_metropolis(const char* simulation_name, const char* parameters_name)
+  {
+    typedef SpinLattice<dimension, IsingSpin> LatticeType;
+    typedef Metropolis<LatticeType, SpinLatticeStep<dimension, IsingSpin>, Random::Boost_MT19937> SimulationType;
+    typedef typename SimulationType::Parameters ParametersType;
+
+    class_<ParametersType>(parameters_name)
+      .def_readwrite("relaxation_steps", &ParametersType::relaxation_steps)
+      .def_readwrite("measurement_number", &ParametersType::measurement_number)
+      .def_readwrite("steps_between_measurement", &ParametersType::steps_between_measurement)
+      .def_readwrite("detect_equilibration", &ParametersType::detect_equilibration)
+      .def_readwrite("adapt_measurement_spacing", &ParametersType::adapt_measurement_spacing)
+      .def_readwrite("target_error", &ParametersType::target_error)
+      .def_readwrite("measurement_worker_number", &ParametersType::measurement_worker_number)
+      .def_readwrite("measurement_slot_number", &ParametersType::measurement_slot_number)
+    ;
+
+    class_<SimulationType, boost::noncopyable>(simulation_name, init<const ParametersType&, LatticeType*>()[with_custodian_and_ward<1, 3>()])
+      .def("get_random_seed", &SimulationType::get_random_seed)
+      .def("set_random_seed", &SimulationType::set_random_seed)
+      .def("get_simulation_parameters", &SimulationType::get_simulation_parameters, return_value_policy<copy_const_reference>())
+      .def("set_parameters", &SimulationType::set_parameters)
+      .def("do_metropolis_steps", &metropolis_steps<SimulationType>, (arg("number"), arg("beta") = 0.0))
+      .def("do_metropolis_relaxation", &metropolis_relaxation<SimulationType>)
+      .def("do_metropolis_simulation", &metropolis_simulation<SimulationType, LatticeType, VectorAccumulatorDouble>, (arg("beta"), arg("accumulator"), arg("observable") = "energy"))
+      .def("do_metropolis_simulation", &metropolis_simulation<SimulationType, LatticeType, MomentsAccumulatorDouble>, (arg("beta"), arg("accumulator"), arg("observable") = "energy"))
+      .def("get_equilibration_time", &SimulationType::get_equilibration_time)
+      .def("get_last_steps_between_measurement", &SimulationType::get_last_steps_between_measurement)
+      .def("get_last_measurement_number", &SimulationType::get_last_measurement_number)
+      .def("get_last_error_of_mean", &SimulationType::get_last_error_of_mean)
+    ;
+  }
+
+  //! Export a Wang-Landau simulation of an Ising lattice with the given dimension
+  template<unsigned int dimension>
+  void export_wang_landau(const char* simulation_name, const char* parameters_name)
+  {
+    typedef SpinLattice<dimension, IsingSpin> LatticeType;
+    typedef WangLandau<LatticeType, SpinLatticeStep<dimension, IsingSpin>, int, Histograms::Histocrete, Random::Boost_MT19937> SimulationType;
+    typedef typename SimulationType::Parameters ParametersType;
+
+    class_<ParametersType>(parameters_name)
+      .def_readwrite("binning_reference", &ParametersType::binning_reference)
+      .def_readwrite("binning_width", &ParametersType::binning_width)
+      .def_readwrite("flatness", &ParametersType::flatness)
+      .def_readwrite("modification_factor_initial", &ParametersType::modification_factor_initial)
+      .def_readwrite("modification_factor_final", &ParametersType::modification_factor_final)
+      .def_readwrite("modification_factor_multiplier", &ParametersType::modification_factor_multiplier)
+      .def_readwrite("sweep_steps", &ParametersType::sweep_steps)
+    ;
+
+    class_<SimulationType, boost::noncopyable>(simulation_name, init<const ParametersType&, LatticeType*>()[with_custodian_and_ward<1, 3>()])
+      .def("get_random_seed", &SimulationType::get_random_seed)
+      .def("set_random_seed", &SimulationType::set_random_seed)
+      .def("get_simulation_parameters", &SimulationType::get_simulation_parameters, return_value_policy<copy_const_reference>())
+      .def("set_simulation_parameters", &SimulationType::set_simulation_parameters)
+      .def("get_modification_factor_current", &SimulationType::get_modification_factor_current)
+      .def("set_modification_factor_current", &SimulationType::set_modification_factor_current)
+      .def("get_sweep_counter", &SimulationType::get_sweep_counter)
+      .def("get_log_density_of_states", &SimulationType::get_log_density_of_states, return_value_policy<copy_const_reference>())
+      .def("get_incidence_counter", &SimulationType::get_incidence_counter, return_value_policy<copy_const_reference>())
+      .def("do_wang_landau_steps", &wang_landau_steps<SimulationType>)
+      .def("do_wang_landau_steps", &wang_landau_steps_until_flat<SimulationType>)
+      .def("do_wang_landau_simulation", &wang_landau_simulation<SimulationType>)
+      .def("attach_microcanonical_accumulator", &wang_landau_attach_magnetization<SimulationType, LatticeType>, (arg("accumulator"), arg("measurement_spacing") = 1), with_custodian_and_ward<1, 2>())
+      .def("detach_microcanonical_accumulator", &SimulationType::detach_microcanonical_accumulator)
+    ;
+  }
+}
+
+BOOST_PYTHON_MODULE(libmocasinns_wrap)
+{
+    // Register the lattices
+    import("libgespinst_wrap");
+
+    class_<HistocreteDouble>("HistocreteDouble")
+      .def("__len__", &HistocreteDouble::size)
+      .def("x_values", &histogram_x_values<HistocreteDouble>)
+      .def("y_values", &histogram_y_values<HistocreteDouble>)
+      .def("to_dense", &histogram_to_dense)
+    ;
+
+    class_<HistocreteIncidence>("HistocreteIncidence")
+      .def("__len__", &HistocreteIncidence::size)
+      .def("x_values", &histogram_x_values<HistocreteIncidence>)
+      .def("y_values", &histogram_y_values<HistocreteIncidence>)
+    ;
+
+    class_<DenseHistogramDouble>("DenseHistogramDouble")
+      .def("__len__", &DenseHistogramDouble::size)
+      .def("x_values", &dense_x_values)
+      .def("y_values", &dense_y_values)
+    ;
+
+    class_<VectorAccumulatorDouble, boost::noncopyable>("VectorAccumulatorDouble")
+      .def("__len__", &vector_accumulator_size)
+      .def("values", &vector_accumulator_values)
+      .def("clear", &vector_accumulator_clear)
+    ;
+
+    class_<MomentsAccumulatorDouble>("MomentsAccumulatorDouble")
+      .def("__call__", &moments_accumulator_add)
+      .def("merge", &MomentsAccumulatorDouble::merge)
+      .def("reset", &MomentsAccumulatorDouble::reset)
+      .def("count", &MomentsAccumulatorDouble::count)
+      .def("mean", &MomentsAccumulatorDouble::mean)
+      .def("variance", &MomentsAccumulatorDouble::variance)
+      .def("error_of_mean", &MomentsAccumulatorDouble::error_of_mean)
+      .def("means", &moments_accumulator_means)
+    ;
+
+    class_<MicrocanonicalAccumulatorDouble>("MicrocanonicalAccumulatorDouble")
+      .def("__len__", &MicrocanonicalAccumulatorDouble::size)
+      .def("initialise_bins", &microcanonical_initialise_bins)
+      .def("merge", &MicrocanonicalAccumulatorDouble::merge)
+      .def("energies", &microcanonical_energies)
+      .def("counts", &microcanonical_counts)
+      .def("microcanonical_averages", &microcanonical_averages)
+      .def("canonical_average", &microcanonical_canonical_average)
+    ;
+
+    export_metropolis<1>("MetropolisIsing1d", "MetropolisIsing1dParameters");
+    export_metropolis<2>("MetropolisIsing2d", "MetropolisIsing2dParameters");
+    export_wang_landau<2>("WangLandauIsing2d", "WangLandauIsing2dParameters");
+}
@@ -12,6 +12,11 @@
 
 #include "simulation.hpp"
 #include "concepts/concepts.hpp"
+#include "analysis/mser_equilibration.hpp"
+#include "details/metropolis/equilibration_value.hpp"
+#include "details/metropolis/measurement_spacing.hpp"
+#include "details/metropolis/error_target.hpp"
+#include "details/metropolis/measurement_pipeline.hpp"
 
 // Boost serialization for derived classes
 #include <boost/serialization/base_object.hpp>
@@ -60,11 +65,11 @@ public:
   boost::signals2::signal<void (Simulation<ConfigurationType,RandomNumberGenerator>*)> signal_handler_measurement;
 
   //! Initialise a Metropolis-MC simulation with default configuration space and default Parameters
-  Metropolis() : Simulation<ConfigurationType, RandomNumberGenerator>(), simulation_parameters() {}
+  Metropolis() : Simulation<ConfigurationType, RandomNumberGenerator>(), simulation_parameters(), equilibration_time(0), equilibration_detected(false), last_steps_between_measurement(0), measurement_autocorrelation_time(0.0), last_measurement_number(0), last_error_of_mean(0.0), last_waiting_measurement_number(0) {}
   //! Initialise a Metropolis-MC simulation with default configuration space and given Parameters
-  Metropolis(const Parameters& params) : Simulation<ConfigurationType, RandomNumberGenerator>(), simulation_parameters(params) {}
+  Metropolis(const Parameters& params) : Simulation<ConfigurationType, RandomNumberGenerator>(), simulation_parameters(params), equilibration_time(0), equilibration_detected(false), last_steps_between_measurement(0), measurement_autocorrelation_time(0.0), last_measurement_number(0), last_error_of_mean(0.0), last_waiting_measurement_number(0) {}
   //! Initialise a Metropolis-MC simulation with given parameters and given configuration space
-  Metropolis(const Parameters& params, ConfigurationType* initial_configuration) : Simulation<ConfigurationType, RandomNumberGenerator>(initial_configuration), simulation_parameters(params) {}
+  Metropolis(const Parameters& params, ConfigurationType* initial_configuration) : Simulation<ConfigurationType, RandomNumberGenerator>(initial_configuration), simulation_parameters(params), equilibration_time(0), equilibration_detected(false), last_steps_between_measurement(0), measurement_autocorrelation_time(0.0), last_measurement_number(0), last_error_of_mean(0.0), last_waiting_measurement_number(0) {}
 
   //! Get-accessor for the parameters of the Metropolis simulation
   const Parameters& get_simulation_parameters() { return simulation_parameters; }
@@ -101,6 +106,24 @@ public:
     this->template do_steps<this_type, StepType>(number, beta);
   }
 
+  //! Perform the relaxation steps at inverse temperature beta, either Parameters::relaxation_steps or until the equilibration of the energy is detected
+  template<class TemperatureType>
+  StepNumberType do_metropolis_relaxation(const TemperatureType& beta);
+  //! Get the equilibration time of the last relaxation (the detected one, or the number of relaxation steps if no equilibration was detected)
+  StepNumberType get_equilibration_time() const { return equilibration_time; }
+  //! Get whether the equilibration was detected in the last relaxation
+  bool get_equilibration_detected() const { return equilibration_detected; }
+  //! Get the number of steps between the measurements at the end of the last simulation (differs from Parameters::steps_between_measurement if the spacing is adapted)
+  StepNumberType get_last_steps_between_measurement() const { return last_steps_between_measurement; }
+  //! Get the integrated autocorrelation time in steps estimated at the last adaptation of the measurement spacing, 0 if there was no adaptation
+  double get_measurement_autocorrelation_time() const { return measurement_autocorrelation_time; }
+  //! Get the number of measurements taken in the last simulation
+  MeasurementNumberType get_last_measurement_number() const { return last_measurement_number; }
+  //! Get the error of the mean of the monitored value estimated in the last simulation with target error, 0 without target error
+  double get_last_error_of_mean() const { return last_error_of_mean; }
+  //! Get the number of measurements in the last simulation that had to wait for a free snapshot slot of the measurement workers
+  MeasurementNumberType get_last_waiting_measurement_number() const { return last_waiting_measurement_number; }
+
   //! Execute a Metropolis Monte-Carlo simulation at given inverse temperature
   template<class Observator = DefaultObservator, class TemperatureType = double>
   std::vector<typename Observator::observable_type> do_metropolis_simulation(const TemperatureType& beta);
@@ -134,6 +157,24 @@ public:
 private:
   //! Member variable storing the parameters of the simulation
   Parameters simulation_parameters;
+  //! Equilibration time of the last relaxation
+  StepNumberType equilibration_time;
+  //! Flag indicating whether the equilibration was detected in the last relaxation
+  bool equilibration_detected;
+  //! Number of steps between the measurements at the end of the last simulation
+  StepNumberType last_steps_between_measurement;
+  //! Integrated autocorrelation time in steps of the last adaptation of the measurement spacing
+  double measurement_autocorrelation_time;
+  //! Number of measurements taken in the last simulation
+  MeasurementNumberType last_measurement_number;
+  //! Error of the mean of the monitored value in the last simulation
+  double last_error_of_mean;
+  //! Number of measurements in the last simulation that had to wait for a free snapshot slot
+  MeasurementNumberType last_waiting_measurement_number;
+
+  //! Perform the measurements of a simulation, evaluating the observables on worker threads
+  template<class Observator, class Accumulator, class TemperatureType>
+  MeasurementNumberType do_pipelined_measurements(const TemperatureType& beta, Accumulator& measurement_accumulator, Details::Metropolis::MeasurementSpacing<StepNumberType>& measurement_spacing, Details::Metropolis::ErrorTarget<StepNumberType>& error_target);
 
   //! Member variable for boost serialization
   friend class boost::serialization::access;
@@ -155,11 +196,50 @@ struct Metropolis<ConfigurationType, StepType, RandomNumberGenerator>::Parameter
   MeasurementNumberType measurement_number;
   //! Number of steps to perform between two data measurements
   StepNumberType steps_between_measurement;
+  //! Flag indicating whether the relaxation stops when the equilibration of the energy is detected (relaxation_steps is then the maximal number of relaxation steps)
+  bool detect_equilibration;
+  //! Number of steps between two energy samples of the equilibration detection
+  StepNumberType equilibration_check_steps;
+  //! Minimal number of MSER batches (of five samples) before the relaxation may stop
+  unsigned int equilibration_minimal_batches;
+  //! Flag indicating whether the number of steps between measurements is adapted to the integrated autocorrelation time estimated during the run (steps_between_measurement is then the initial spacing)
+  bool adapt_measurement_spacing;
+  //! Target number of steps between measurements in units of the integrated autocorrelation time
+  double measurement_spacing_tau_fraction;
+  //! Number of measurements used for one estimate of the integrated autocorrelation time
+  unsigned int measurement_spacing_window;
+  //! Minimal number of steps between measurements of the adaptation
+  StepNumberType minimal_steps_between_measurement;
+  //! Maximal number of steps between measurements of the adaptation, 0 for no limit
+  StepNumberType maximal_steps_between_measurement;
+  //! Target error of the mean of the observable (of the energy for non-scalar observables), if positive the measurements stop when the error estimated by a blocking analysis reaches the target (measurement_number is then ignored), 0 to take measurement_number measurements
+  double target_error;
+  //! Minimal number of measurements before the target error is checked
+  MeasurementNumberType minimal_measurement_number;
+  //! Maximal number of steps performed for the measurements with target error, 0 for measurement_number times steps_between_measurement
+  StepNumberType measurement_step_budget;
+  //! Number of worker threads evaluating the observables on snapshots of the configuration while the steps continue, 0 to evaluate the observables on the stepping thread
+  unsigned int measurement_worker_number;
+  //! Number of snapshots of the configuration in the ring buffer of the workers, 0 for two snapshots per worker
+  unsigned int measurement_slot_number;
   
   //! Standard constructor for setting default values
   Parameters() : relaxation_steps(1000),
 		 measurement_number(100),
-		 steps_between_measurement(100) {}
+		 steps_between_measurement(100),
+		 detect_equilibration(false),
+		 equilibration_check_steps(100),
+		 equilibration_minimal_batches(10),
+		 adapt_measurement_spacing(false),
+		 measurement_spacing_tau_fraction(1.0),
+		 measurement_spacing_window(256),
+		 minimal_steps_between_measurement(1),
+		 maximal_steps_between_measurement(0),
+		 target_error(0.0),
+		 minimal_measurement_number(128),
+		 measurement_step_budget(0),
+		 measurement_worker_number(0),
+		 measurement_slot_number(0) {}
 };
   
 } // of namespace Mocasinns
@@ -13,9 +13,15 @@
 #include "simulation.hpp"
 #include "metropolis.hpp"
 #include "concepts/concepts.hpp"
+#include "parallel/numa_topology.hpp"
+#include "parallel/work_stealing_scheduler.hpp"
+#include "parallel/distributed_coordinator.hpp"
+#include "details/metropolis/run_statistics.hpp"
+#include "details/metropolis/run_buffer.hpp"
 
 // Boost serialization for derived classes
 #include <boost/serialization/base_object.hpp>
+#include <boost/serialization/vector.hpp>
 
 namespace Mocasinns
 {
@@ -48,11 +54,11 @@ public:
   boost::signals2::signal<void (Simulation<ConfigurationType,RandomNumberGenerator>*)> signal_handler_run;
 
   //! Initialise a parallel Metropolis-MC simulation with default configuration space and default Parameters
-  MetropolisParallel() : Simulation<ConfigurationType, RandomNumberGenerator>(), simulation_parameters() {}
+  MetropolisParallel() : Simulation<ConfigurationType, RandomNumberGenerator>(), simulation_parameters(), stolen_run_number(0) {}
   //! Initialise a parallel Metropolis-MC simulation with default configuration space and given Parameters
-  MetropolisParallel(const Parameters& params) : Simulation<ConfigurationType, RandomNumberGenerator>(), simulation_parameters(params) {}
+  MetropolisParallel(const Parameters& params) : Simulation<ConfigurationType, RandomNumberGenerator>(), simulation_parameters(params), stolen_run_number(0) {}
   //! Initialise a parallel Metropolis-MC simulation with given parameters and given configuration space
-  MetropolisParallel(const Parameters& params, ConfigurationType* initial_configuration) : Simulation<ConfigurationType, RandomNumberGenerator>(initial_configuration), simulation_parameters(params) {}
+  MetropolisParallel(const Parameters& params, ConfigurationType* initial_configuration) : Simulation<ConfigurationType, RandomNumberGenerator>(initial_configuration), simulation_parameters(params), stolen_run_number(0) {}
 
   //! Get-accessor for the parameters of the Metropolis simulation
   const Parameters& get_simulation_parameters() { return simulation_parameters; }
@@ -73,6 +79,23 @@ public:
   template<class Observator, class AccumulatorIterator, class InverseTemperatureIterator>
   void do_parallel_metropolis_simulation(InverseTemperatureIterator beta_begin, InverseTemperatureIterator beta_end, AccumulatorIterator measurement_accumulator_begin, AccumulatorIterator measurement_accumulator_end);
 
+  //! Execute a Metropolis Monte-Carlo simulation at given range of inverse temperatures, the runs are performed by the workers of the given coordinator
+  template<class Observator, class AccumulatorIterator, class InverseTemperatureIterator>
+  void do_distributed_metropolis_simulation(Parallel::DistributedCoordinator& coordinator, InverseTemperatureIterator beta_begin, InverseTemperatureIterator beta_end, AccumulatorIterator measurement_accumulator_begin, AccumulatorIterator measurement_accumulator_end, unsigned int local_worker_number = 0);
+  //! Execute a Metropolis Monte-Carlo simulation at given range of inverse temperatures, the runs are performed by the workers connecting to a coordinator on the given TCP port of the interface with the given IPv4 address
+  template<class Observator, class AccumulatorIterator, class InverseTemperatureIterator>
+  void do_distributed_metropolis_simulation(uint16_t port, const std::string& bind_address, InverseTemperatureIterator beta_begin, InverseTemperatureIterator beta_end, AccumulatorIterator measurement_accumulator_begin, AccumulatorIterator measurement_accumulator_end, unsigned int local_worker_number = 0);
+  //! Perform the runs requested by the coordinator of a distributed Metropolis Monte-Carlo simulation at given range of inverse temperatures
+  template<class Observator, class AccumulatorIterator, class InverseTemperatureIterator>
+  void serve_distributed_metropolis_simulation(Parallel::SocketChannel& channel, InverseTemperatureIterator beta_begin, InverseTemperatureIterator beta_end, AccumulatorIterator measurement_accumulator_begin, AccumulatorIterator measurement_accumulator_end);
+
+  //! Get the equilibration times of the runs of the last parallel simulation (first index: inverse temperature, second index: run)
+  const std::vector<std::vector<StepNumberType> >& get_equilibration_times() const { return equilibration_times; }
+  //! Get the numbers of measurements of the runs of the last parallel simulation (first index: inverse temperature, second index: run)
+  const std::vector<std::vector<unsigned long> >& get_measurement_numbers() const { return measurement_numbers; }
+  //! Get the number of runs that were stolen by other threads in the last parallel simulation
+  unsigned int get_stolen_run_number() const { return stolen_run_number; }
+
   //! Load the data of the Metropolis simulation from a serialization stream
   virtual void load_serialize(std::istream& input_stream);
   //! Load the data of the Metropolis simulation from a serialization file
@@ -84,6 +107,21 @@ public:
 
 private:
   Parameters simulation_parameters;
+  //! Number of runs that were stolen by other threads in the last parallel simulation
+  unsigned int stolen_run_number;
+  //! Equilibration times of the runs of the last parallel simulation
+  std::vector<std::vector<StepNumberType> > equilibration_times;
+  //! Numbers of measurements of the runs of the last parallel simulation
+  std::vector<std::vector<unsigned long> > measurement_numbers;
+
+  //! Functor performing a run of a distributed simulation and returning its serialized run buffer
+  template<class Observator, class TemperatureType, class AccumulatorIterator> class DistributedRunTask;
+  //! Functor serving a distributed simulation in a local worker process
+  template<class Observator, class TemperatureType, class AccumulatorIterator> class DistributedLocalWorker;
+
+  //! Perform a single run at the given inverse temperature and route its measurements to the given accumulator
+  template<class Observator, class Accumulator, class TemperatureType>
+  StepNumberType do_run(const TemperatureType& beta, RunNumberType run, Accumulator& measurement_accumulator, omp_lock_t* measurement_accumulator_lock, Details::Metropolis::RunStatistics* run_statistics = 0);
 
   //! Member variable for boost serialization
   friend class boost::serialization::access;
@@ -104,13 +142,57 @@ struct MetropolisParallel<ConfigurationType, StepType, RandomNumberGenerator>::P
   RunNumberType run_number;
   //! Number of processes to use
   RunNumberType process_number;
+  //! Flag indicating whether the threads are pinned to processors distributed over the NUMA nodes, default value is false because pinning interferes with other processes and an affinity set by the caller (e.g. numactl or a batch system)
+  bool pin_threads;
+  //! Flag indicating whether the measurements are given to the accumulators in the order of the runs, independent of the number of threads
+  bool deterministic;
   
   //! Standard constructor for setting default values
   Parameters() : MetropolisSerial::Parameters(),
 		 run_number(2),
-		 process_number(2) {}
+		 process_number(2),
+		 pin_threads(false),
+		 deterministic(false) {}
+};
+
+template <class ConfigurationType, class StepType, class RandomNumberGenerator>
+template<class Observator, class TemperatureType, class AccumulatorIterator>
+class MetropolisParallel<ConfigurationType, StepType, RandomNumberGenerator>::DistributedRunTask
+{
+public:
+  DistributedRunTask(MetropolisParallel* simulation_pointer, const std::vector<TemperatureType>& inverse_temperatures, const std::vector<AccumulatorIterator>& accumulators)
+    : simulation(simulation_pointer), betas(inverse_temperatures), measurement_accumulators(accumulators) {}
+
+  //! Perform the run with the given task number (temperature task / run_number, run task % run_number)
+  std::string operator()(unsigned int task);
+
+private:
+  MetropolisParallel* simulation;
+  std::vector<TemperatureType> betas;
+  //! Accumulators of the temperatures, the run buffers are created from them
+  std::vector<AccumulatorIterator> measurement_accumulators;
 };
 
+template <class ConfigurationType, class StepType, class RandomNumberGenerator>
+template<class Observator, class TemperatureType, class AccumulatorIterator>
+class MetropolisParallel<ConfigurationType, StepType, RandomNumberGenerator>::DistributedLocalWorker
+{
+public:
+  DistributedLocalWorker(MetropolisParallel* simulation_pointer, const std::vector<TemperatureType>& inverse_temperatures, AccumulatorIterator accumulator_begin, AccumulatorIterator accumulator_end)
+    : simulation(simulation_pointer), betas(inverse_temperatures), measurement_accumulator_begin(accumulator_begin), measurement_accumulator_end(accumulator_end) {}
+
+  //! Serve the coordinator connected to the given channel
+  void operator()(Parallel::SocketChannel& channel)
+  {
+    simulation->template serve_distributed_metropolis_simulation<Observator>(channel, betas.begin(), betas.end(), measurement_accumulator_begin, measurement_accumulator_end);
+  }
+
+private:
+  MetropolisParallel* simulation;
+  std::vector<TemperatureType> betas;
+  AccumulatorIterator measurement_accumulator_begin;
+  AccumulatorIterator measurement_accumulator_end;
+};
 
 } // of namespace Mocasinns
 
@@ -4,7 +4,7 @@
 #include <boost/array.hpp>
 #include <cmath>
 
-#include <boost/accumulators/numeric/functional_fwd.hpp>
+#include <boost/accumulators/numeric/functional.hpp>
 
 #include "../details/stl_extensions/array_addable.hpp"
 
@@ -0,0 +1,396 @@
+#ifndef MOCASINNS_OBSERVABLES_DENSE_HISTOGRAM_OBSERVABLE_HPP
+#define MOCASINNS_OBSERVABLES_DENSE_HISTOGRAM_OBSERVABLE_HPP
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/accumulators/numeric/functional.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/split_member.hpp>
+
+#include "histogram_observable.hpp"
+
+namespace Mocasinns
+{
+  namespace Observables
+  {
+    //! Class representing the histogram of an observable as new observable, stored in contiguous memory with an x-axis shared by all observables
+    /*!
+      \details The x-values are stored in a sorted, immutable vector that is shared (via boost::shared_ptr) by all observables created from the same axis, the y-values are stored in a vector with the same order. Two observables are compatible if they share the same axis, which is checked by comparing the pointers. Only observables with different axis objects are compared element by element. Therefore averaging distributions (e.g. with boost::accumulators) does not copy or walk the x-values, and the arithmetic operations are plain loops over contiguous y-values that the compiler can vectorise.
+
+      A default constructed observable has no axis and acts as zero in the additive operations, i.e. it takes the axis of the other observable. This is the initial value of the sum in boost::accumulators.
+
+      \tparam x_value_type Type of the x-values of the histogram
+      \tparam y_value_type Type of the y-values of the histogram
+     */
+    template <class x_value_type, class y_value_type>
+    class DenseHistogramObservable
+    {
+    public:
+      //! Type of the x-axis
+      typedef std::vector<x_value_type> XAxisType;
+      //! Type of the shared pointer to the x-axis
+      typedef boost::shared_ptr<const XAxisType> XAxisPointer;
+      //! Type of the container of the y-values
+      typedef std::vector<y_value_type> YValuesType;
+      //! Iterator over the y-values
+      typedef typename YValuesType::iterator iterator;
+      //! Const-iterator over the y-values
+      typedef typename YValuesType::const_iterator const_iterator;
+      //! Type of the y-values
+      typedef y_value_type value_type;
+      //! Unsigned integral type
+      typedef typename YValuesType::size_type size_type;
+
+      //! Creates an empty observable without axis
+      DenseHistogramObservable() {}
+      //! Creates an observable with the given axis and all y-values zero
+      explicit DenseHistogramObservable(const XAxisPointer& x_axis) : x_values(x_axis), y_values(x_axis->size(), y_value_type(0)) {}
+      //! Creates an observable with the given axis and y-values
+      DenseHistogramObservable(const XAxisPointer& x_axis, const YValuesType& values) : x_values(x_axis), y_values(values) { check_size(); }
+      //! Creates an observable with the given axis and moves the given y-values into the observable
+      DenseHistogramObservable(const XAxisPointer& x_axis, YValuesType&& values) : x_values(x_axis), y_values(std::move(values)) { check_size(); }
+      //! Creates an observable with the given axis from a histogram (e.g. Histograms::Histocrete), bins missing in the histogram are zero
+      template <class Histo>
+      DenseHistogramObservable(const XAxisPointer& x_axis, const Histo& histogram);
+
+      //! Create an x-axis containing the x-values of a histogram (e.g. Histograms::Histocrete)
+      template <class Histo>
+      static XAxisPointer create_x_axis(const Histo& histogram);
+      //! Create an x-axis from a sorted vector of x-values
+      static XAxisPointer create_x_axis(const XAxisType& x_axis) { return XAxisPointer(new XAxisType(x_axis)); }
+
+      //! Get the shared x-axis
+      const XAxisPointer& get_x_axis() const { return x_values; }
+      //! Get the y-values
+      const YValuesType& get_y_values() const { return y_values; }
+      //! Get the x-value of the bin with the given index
+      const x_value_type& x_value(size_type index) const { return (*x_values)[index]; }
+
+      //! Get the y-value of the bin with the given index
+      y_value_type& operator[](size_type index) { return y_values[index]; }
+      //! Get the y-value of the bin with the given index
+      const y_value_type& operator[](size_type index) const { return y_values[index]; }
+      //! Get the y-value of the bin with the given x-value, throws XValuesDoNotMatchException if the x-value is not on the axis
+      y_value_type& at(const x_value_type& x) { return y_values[index_of(x)]; }
+      //! Get the y-value of the bin with the given x-value, throws XValuesDoNotMatchException if the x-value is not on the axis
+      const y_value_type& at(const x_value_type& x) const { return y_values[index_of(x)]; }
+
+      //! Return the number of bins
+      size_type size() const { return y_values.size(); }
+      //! Check whether the observable has no axis
+      bool empty() const { return !x_values; }
+      //! Return iterator to the first y-value
+      iterator begin() { return y_values.begin(); }
+      //! Return const-iterator to the first y-value
+      const_iterator begin() const { return y_values.begin(); }
+      //! Return iterator behind the last y-value
+      iterator end() { return y_values.end(); }
+      //! Return const-iterator behind the last y-value
+      const_iterator end() const { return y_values.end(); }
+
+      //! Operator for adding a scalar to every bin
+      DenseHistogramObservable& operator+=(const y_value_type& rhs)
+      {
+	y_value_type* data = y_values.data();
+	for (size_type i = 0; i < y_values.size(); ++i) data[i] += rhs;
+	return *this;
+      }
+      //! Operator for substracting a scalar from every bin
+      DenseHistogramObservable& operator-=(const y_value_type& rhs)
+      {
+	y_value_type* data = y_values.data();
+	for (size_type i = 0; i < y_values.size(); ++i) data[i] -= rhs;
+	return *this;
+      }
+      //! Operator for multiplying every bin with a scalar
+      DenseHistogramObservable& operator*=(const y_value_type& rhs)
+      {
+	y_value_type* data = y_values.data();
+	for (size_type i = 0; i < y_values.size(); ++i) data[i] *= rhs;
+	return *this;
+      }
+      //! Operator for dividing every bin by a scalar
+      DenseHistogramObservable& operator/=(const y_value_type& rhs)
+      {
+	y_value_type* data = y_values.data();
+	for (size_type i = 0; i < y_values.size(); ++i) data[i] /= rhs;
+	return *this;
+      }
+
+      //! Operator for adding another observable bin by bin, an empty observable takes the values of the other observable
+      DenseHistogramObservable& operator+=(const DenseHistogramObservable& rhs)
+      {
+	if (adopt_if_empty(rhs, 1)) return *this;
+	y_value_type* data = y_values.data();
+	const y_value_type* other_data = rhs.y_values.data();
+	for (size_type i = 0; i < y_values.size(); ++i) data[i] += other_data[i];
+	return *this;
+      }
+      //! Operator for substracting another observable bin by bin, an empty observable takes the negative values of the other observable
+      DenseHistogramObservable& operator-=(const DenseHistogramObservable& rhs)
+      {
+	if (adopt_if_empty(rhs, -1)) return *this;
+	y_value_type* data = y_values.data();
+	const y_value_type* other_data = rhs.y_values.data();
+	for (size_type i = 0; i < y_values.size(); ++i) data[i] -= other_data[i];
+	return *this;
+      }
+      //! Operator for multiplying with another observable bin by bin
+      DenseHistogramObservable& operator*=(const DenseHistogramObservable& rhs)
+      {
+	check_x_axis(rhs);
+	y_value_type* data = y_values.data();
+	const y_value_type* other_data = rhs.y_values.data();
+	for (size_type i = 0; i < y_values.size(); ++i) data[i] *= other_data[i];
+	return *this;
+      }
+      //! Operator for dividing by another observable bin by bin
+      DenseHistogramObservable& operator/=(const DenseHistogramObservable& rhs)
+      {
+	check_x_axis(rhs);
+	y_value_type* data = y_values.data();
+	const y_value_type* other_data = rhs.y_values.data();
+	for (size_type i = 0; i < y_values.size(); ++i) data[i] /= other_data[i];
+	return *this;
+      }
+
+      //! Check whether this observable has the same x-values as another observable, the comparison of the values is only done if the axis objects differ
+      bool x_values_match(const DenseHistogramObservable& other) const
+      {
+	if (x_values == other.x_values) return true;
+	if (!x_values || !other.x_values) return false;
+	return *x_values == *other.x_values;
+      }
+
+    private:
+      //! Shared x-axis
+      XAxisPointer x_values;
+      //! Y-values in the order of the x-axis
+      YValuesType y_values;
+
+      //! Throw if the number of y-values differs from the size of the axis
+      void check_size() const
+      {
+	if (!x_values || x_values->size() != y_values.size()) throw XValuesDoNotMatchException();
+      }
+      //! Throw if the x-values of the other observable do not match
+      void check_x_axis(const DenseHistogramObservable& other) const
+      {
+	if (!x_values_match(other)) throw XValuesDoNotMatchException();
+      }
+      //! If this observable is empty, copy the other observable multiplied with the sign and return true, otherwise check the x-values and return false
+      bool adopt_if_empty(const DenseHistogramObservable& other, int sign)
+      {
+	if (!empty())
+	{
+	  check_x_axis(other);
+	  return false;
+	}
+	x_values = other.x_values;
+	y_values = other.y_values;
+	if (sign < 0) (*this) *= y_value_type(-1);
+	return true;
+      }
+      //! Return the index of an x-value
+      size_type index_of(const x_value_type& x) const
+      {
+	if (!x_values) throw XValuesDoNotMatchException();
+	typename XAxisType::const_iterator position = std::lower_bound(x_values->begin(), x_values->end(), x);
+	if (position == x_values->end() || *position != x) throw XValuesDoNotMatchException();
+	return position - x_values->begin();
+      }
+
+      //! Member variable for boost serialization
+      friend class boost::serialization::access;
+      //! Save the axis and the y-values (omitted version name to avoid unused parameter warnings)
+      template<class Archive> void save(Archive & ar, const unsigned int) const
+      {
+	const XAxisType x_axis = x_values ? *x_values : XAxisType();
+	ar & x_axis;
+	ar & y_values;
+      }
+      //! Load the axis and the y-values, the axis is not shared with other observables afterwards (omitted version name to avoid unused parameter warnings)
+      template<class Archive> void load(Archive & ar, const unsigned int)
+      {
+	XAxisType x_axis;
+	ar & x_axis;
+	ar & y_values;
+	if (x_axis.empty() && y_values.empty()) x_values.reset();
+	else x_values = create_x_axis(x_axis);
+      }
+      BOOST_SERIALIZATION_SPLIT_MEMBER()
+    };
+
+    template <class x_value_type, class y_value_type>
+    template <class Histo>
+    DenseHistogramObservable<x_value_type, y_value_type>::DenseHistogramObservable(const XAxisPointer& x_axis, const Histo& histogram)
+      : x_values(x_axis), y_values(x_axis->size(), y_value_type(0))
+    {
+      // Both the histogram and the axis are sorted, so the bins are found in one pass
+      typename XAxisType::const_iterator position = x_values->begin();
+      for (typename Histo::const_iterator bin = histogram.begin(); bin != histogram.end(); ++bin)
+      {
+	while (position != x_values->end() && *position < bin->first) ++position;
+	if (position == x_values->end() || *position != bin->first) throw XValuesDoNotMatchException();
+	y_values[position - x_values->begin()] = bin->second;
+      }
+    }
+
+    template <class x_value_type, class y_value_type>
+    template <class Histo>
+    typename DenseHistogramObservable<x_value_type, y_value_type>::XAxisPointer DenseHistogramObservable<x_value_type, y_value_type>::create_x_axis(const Histo& histogram)
+    {
+      XAxisType* x_axis = new XAxisType;
+      x_axis->reserve(histogram.size());
+      for (typename Histo::const_iterator bin = histogram.begin(); bin != histogram.end(); ++bin)
+	x_axis->push_back(bin->first);
+      return XAxisPointer(x_axis);
+    }
+
+    //! Binary operator for adding two dense histogram observables
+    template <class x_value_type, class y_value_type>
+    DenseHistogramObservable<x_value_type, y_value_type> operator+(const DenseHistogramObservable<x_value_type, y_value_type>& lhs, const DenseHistogramObservable<x_value_type, y_value_type>& rhs)
+    {
+      DenseHistogramObservable<x_value_type, y_value_type> result(lhs);
+      result += rhs;
+      return result;
+    }
+    //! Binary operator for adding two dense histogram observables, the temporary left hand side is reused for the result
+    template <class x_value_type, class y_value_type>
+    DenseHistogramObservable<x_value_type, y_value_type> operator+(DenseHistogramObservable<x_value_type, y_value_type>&& lhs, const DenseHistogramObservable<x_value_type, y_value_type>& rhs)
+    {
+      lhs += rhs;
+      return std::move(lhs);
+    }
+    //! Binary operator for substracting two dense histogram observables
+    template <class x_value_type, class y_value_type>
+    DenseHistogramObservable<x_value_type, y_value_type> operator-(const DenseHistogramObservable<x_value_type, y_value_type>& lhs, const DenseHistogramObservable<x_value_type, y_value_type>& rhs)
+    {
+      DenseHistogramObservable<x_value_type, y_value_type> result(lhs);
+      result -= rhs;
+      return result;
+    }
+    //! Binary operator for substracting two dense histogram observables, the temporary left hand side is reused for the result
+    template <class x_value_type, class y_value_type>
+    DenseHistogramObservable<x_value_type, y_value_type> operator-(DenseHistogramObservable<x_value_type, y_value_type>&& lhs, const DenseHistogramObservable<x_value_type, y_value_type>& rhs)
+    {
+      lhs -= rhs;
+      return std::move(lhs);
+    }
+    //! Binary operator for multiplying two dense histogram observables
+    template <class x_value_type, class y_value_type>
+    DenseHistogramObservable<x_value_type, y_value_type> operator*(const DenseHistogramObservable<x_value_type, y_value_type>& lhs, const DenseHistogramObservable<x_value_type, y_value_type>& rhs)
+    {
+      DenseHistogramObservable<x_value_type, y_value_type> result(lhs);
+      result *= rhs;
+      return result;
+    }
+    //! Binary operator for multiplying two dense histogram observables, the temporary left hand side is reused for the result
+    template <class x_value_type, class y_value_type>
+    DenseHistogramObservable<x_value_type, y_value_type> operator*(DenseHistogramObservable<x_value_type, y_value_type>&& lhs, const DenseHistogramObservable<x_value_type, y_value_type>& rhs)
+    {
+      lhs *= rhs;
+      return std::move(lhs);
+    }
+    //! Binary operator for dividing two dense histogram observables
+    template <class x_value_type, class y_value_type>
+    DenseHistogramObservable<x_value_type, y_value_type> operator/(const DenseHistogramObservable<x_value_type, y_value_type>& lhs, const DenseHistogramObservable<x_value_type, y_value_type>& rhs)
+    {
+      DenseHistogramObservable<x_value_type, y_value_type> result(lhs);
+      result /= rhs;
+      return result;
+    }
+    //! Binary operator for dividing two dense histogram observables, the temporary left hand side is reused for the result
+    template <class x_value_type, class y_value_type>
+    DenseHistogramObservable<x_value_type, y_value_type> operator/(DenseHistogramObservable<x_value_type, y_value_type>&& lhs, const DenseHistogramObservable<x_value_type, y_value_type>& rhs)
+    {
+      lhs /= rhs;
+      return std::move(lhs);
+    }
+
+    //! Multiply a dense histogram observable with a scalar
+    template <class x_value_type, class y_value_type>
+    DenseHistogramObservable<x_value_type, y_value_type> operator*(const DenseHistogramObservable<x_value_type, y_value_type>& lhs, const typename DenseHistogramObservable<x_value_type, y_value_type>::value_type& rhs)
+    {
+      DenseHistogramObservable<x_value_type, y_value_type> result(lhs);
+      result *= rhs;
+      return result;
+    }
+    //! Multiply a scalar with a dense histogram observable
+    template <class x_value_type, class y_value_type>
+    DenseHistogramObservable<x_value_type, y_value_type> operator*(const typename DenseHistogramObservable<x_value_type, y_value_type>::value_type& lhs, const DenseHistogramObservable<x_value_type, y_value_type>& rhs)
+    {
+      return rhs * lhs;
+    }
+    //! Divide a dense histogram observable by a scalar
+    template <class x_value_type, class y_value_type>
+    DenseHistogramObservable<x_value_type, y_value_type> operator/(const DenseHistogramObservable<x_value_type, y_value_type>& lhs, const typename DenseHistogramObservable<x_value_type, y_value_type>::value_type& rhs)
+    {
+      DenseHistogramObservable<x_value_type, y_value_type> result(lhs);
+      result /= rhs;
+      return result;
+    }
+
+    //! Compare two dense histogram observables lexicographically by their y-values
+    template <class x_value_type, class y_value_type>
+    bool operator<(const DenseHistogramObservable<x_value_type, y_value_type>& lhs, const DenseHistogramObservable<x_value_type, y_value_type>& rhs)
+    {
+      return lhs.get_y_values() < rhs.get_y_values();
+    }
+
+    //! Exponentiate the dense histogram observable with a scalar
+    template <class x_value_type, class y_value_type, class S>
+    DenseHistogramObservable<x_value_type, y_value_type> pow(const DenseHistogramObservable<x_value_type, y_value_type>& base, const S& exponent)
+    {
+      DenseHistogramObservable<x_value_type, y_value_type> result(base);
+      for (typename DenseHistogramObservable<x_value_type, y_value_type>::iterator it = result.begin(); it != result.end(); ++it)
+	*it = std::pow(*it, exponent);
+      return result;
+    }
+    //! Takes the square root of a dense histogram observable
+    template <class x_value_type, class y_value_type>
+    DenseHistogramObservable<x_value_type, y_value_type> sqrt(const DenseHistogramObservable<x_value_type, y_value_type>& base)
+    {
+      return pow(base, 0.5);
+    }
+  }
+}
+
+namespace boost
+{
+  namespace numeric
+  {
+    namespace functional
+    {
+      // Tag type for DenseHistogramObservable
+      template <class x_value_type, class y_value_type>
+      struct DenseHistogramObservableTag;
+
+      // Specialise tag<> for DenseHistogramObservable
+      template <class x_value_type, class y_value_type> struct tag<Mocasinns::Observables::DenseHistogramObservable<x_value_type, y_value_type> >
+      {
+	typedef DenseHistogramObservableTag<x_value_type, y_value_type> type;
+      };
+
+      // Specify how to devide a DenseHistogramObservable by an integral count
+      template <typename Left, typename Right, class x_value_type, class y_value_type>
+      struct average<Left, Right, DenseHistogramObservableTag<x_value_type, y_value_type>, void>
+      {
+	// Define the type of the result
+	typedef Mocasinns::Observables::DenseHistogramObservable<x_value_type, y_value_type> result_type;
+
+	// Define the result operator
+	result_type operator()(Left& left , Right& right) const
+	{
+	  return left / static_cast<y_value_type>(right);
+	}
+      };
+    }
+  }
+}
+
+#endif
@@ -3,8 +3,9 @@
 
 #include <stdexcept>
 #include <cmath>
+#include <utility>
 
-#include <boost/accumulators/numeric/functional_fwd.hpp>
+#include <boost/accumulators/numeric/functional.hpp>
 
 namespace Mocasinns
 {
@@ -33,8 +34,8 @@ namespace Mocasinns
       HistogramObservable() : HistoType () {}
       //! Constructor taking a base object
       HistogramObservable(const HistoType& base_histo) : HistoType(base_histo) {}
-      //! Copy constructor
-      HistogramObservable(const HistogramObservable<Histo, x_value_type, y_value_type>& other) : HistoType(static_cast<HistoType>(other)) {}
+      //! Constructor taking a temporary base object, the bins are moved into the observable
+      HistogramObservable(HistoType&& base_histo) : HistoType(std::move(base_histo)) {}
 
       //! Operator for adding a scalar to this HistogramObservable
       HistogramObservable& operator+=(const y_value_type rhs)
@@ -75,7 +76,7 @@ namespace Mocasinns
       }
       
       //! Operator for adding another HistogramObservable with this HistogramObservable
-      HistogramObservable& operator+=(const HistogramObservable<Histo, x_value_type, y_value_type> rhs)
+      HistogramObservable& operator+=(const HistogramObservable<Histo, x_value_type, y_value_type>& rhs)
       {
 	if (x_values_match(rhs) == false) throw XValuesDoNotMatchException();
                                                 
@@ -89,7 +90,7 @@ namespace Mocasinns
 	return *this;
       }
       //! Operator for dividing another HistogramObservable from this HistogramObservable
-      HistogramObservable& operator-=(const HistogramObservable<Histo, x_value_type, y_value_type> rhs)
+      HistogramObservable& operator-=(const HistogramObservable<Histo, x_value_type, y_value_type>& rhs)
       {
 	if (x_values_match(rhs) == false) throw XValuesDoNotMatchException();
 
@@ -103,7 +104,7 @@ namespace Mocasinns
 	return *this;
       }
       //! Operator for multiplying the HistogramObservable with another HistogramObservable
-      HistogramObservable& operator*=(const HistogramObservable<Histo, x_value_type, y_value_type> rhs)
+      HistogramObservable& operator*=(const HistogramObservable<Histo, x_value_type, y_value_type>& rhs)
       {
 	if (x_values_match(rhs) == false) throw XValuesDoNotMatchException();
 
@@ -117,7 +118,7 @@ namespace Mocasinns
 	return *this;
       }
       //! Operator for dividing the HistogramObservable by another HistogramObservable
-      HistogramObservable& operator/=(const HistogramObservable<Histo, x_value_type, y_value_type> rhs)
+      HistogramObservable& operator/=(const HistogramObservable<Histo, x_value_type, y_value_type>& rhs)
       {
 	if (x_values_match(rhs) == false) throw XValuesDoNotMatchException();
 
@@ -152,44 +153,80 @@ namespace Mocasinns
 
     //! Binary operator for adding two histogram observables
     template <template <class,class> class Histo, class x_value_type, class y_value_type>
-    const HistogramObservable<Histo, x_value_type, y_value_type> operator+(const HistogramObservable<Histo, x_value_type, y_value_type>& lhs, const HistogramObservable<Histo, x_value_type, y_value_type>& rhs)
+    HistogramObservable<Histo, x_value_type, y_value_type> operator+(const HistogramObservable<Histo, x_value_type, y_value_type>& lhs, const HistogramObservable<Histo, x_value_type, y_value_type>& rhs)
     {
-      return HistogramObservable<Histo, x_value_type, y_value_type>(lhs) += rhs;
+      HistogramObservable<Histo, x_value_type, y_value_type> result(lhs);
+      result += rhs;
+      return result;
+    }
+    //! Binary operator for adding two histogram observables, the temporary left hand side is reused for the result
+    template <template <class,class> class Histo, class x_value_type, class y_value_type>
+    HistogramObservable<Histo, x_value_type, y_value_type> operator+(HistogramObservable<Histo, x_value_type, y_value_type>&& lhs, const HistogramObservable<Histo, x_value_type, y_value_type>& rhs)
+    {
+      lhs += rhs;
+      return std::move(lhs);
     }
     //! Binary operator for substracting two histogram observables
     template <template <class,class> class Histo, class x_value_type, class y_value_type>
-    const HistogramObservable<Histo, x_value_type, y_value_type> operator-(const HistogramObservable<Histo, x_value_type, y_value_type>& lhs, const HistogramObservable<Histo, x_value_type, y_value_type>& rhs)
+    HistogramObservable<Histo, x_value_type, y_value_type> operator-(const HistogramObservable<Histo, x_value_type, y_value_type>& lhs, const HistogramObservable<Histo, x_value_type, y_value_type>& rhs)
+    {
+      HistogramObservable<Histo, x_value_type, y_value_type> result(lhs);
+      result -= rhs;
+      return result;
+    }
+    //! Binary operator for substracting two histogram observables, the temporary left hand side is reused for the result
+    template <template <class,class> class Histo, class x_value_type, class y_value_type>
+    HistogramObservable<Histo, x_value_type, y_value_type> operator-(HistogramObservable<Histo, x_value_type, y_value_type>&& lhs, const HistogramObservable<Histo, x_value_type, y_value_type>& rhs)
     {
-      return HistogramObservable<Histo, x_value_type, y_value_type>(lhs) -= rhs;
+      lhs -= rhs;
+      return std::move(lhs);
     }
     //! Binary operator for multiplying two histogram observables
     template <template <class,class> class Histo, class x_value_type, class y_value_type>
-    const HistogramObservable<Histo, x_value_type, y_value_type> operator*(const HistogramObservable<Histo, x_value_type, y_value_type>& lhs, const HistogramObservable<Histo, x_value_type, y_value_type>& rhs)
+    HistogramObservable<Histo, x_value_type, y_value_type> operator*(const HistogramObservable<Histo, x_value_type, y_value_type>& lhs, const HistogramObservable<Histo, x_value_type, y_value_type>& rhs)
     {
-      return HistogramObservable<Histo, x_value_type, y_value_type>(lhs) *= rhs;
+      HistogramObservable<Histo, x_value_type, y_value_type> result(lhs);
+      result *= rhs;
+      return result;
+    }
+    //! Binary operator for multiplying two histogram observables, the temporary left hand side is reused for the result
+    template <template <class,class> class Histo, class x_value_type, class y_value_type>
+    HistogramObservable<Histo, x_value_type, y_value_type> operator*(HistogramObservable<Histo, x_value_type, y_value_type>&& lhs, const HistogramObservable<Histo, x_value_type, y_value_type>& rhs)
+    {
+      lhs *= rhs;
+      return std::move(lhs);
     }
     //! Binary operator for dividing two histogram observables
     template <template <class,class> class Histo, class x_value_type, class y_value_type>
-    const HistogramObservable<Histo, x_value_type, y_value_type> operator/(const HistogramObservable<Histo, x_value_type, y_value_type>& lhs, const HistogramObservable<Histo, x_value_type, y_value_type>& rhs)
+    HistogramObservable<Histo, x_value_type, y_value_type> operator/(const HistogramObservable<Histo, x_value_type, y_value_type>& lhs, const HistogramObservable<Histo, x_value_type, y_value_type>& rhs)
+    {
+      HistogramObservable<Histo, x_value_type, y_value_type> result(lhs);
+      result /= rhs;
+      return result;
+    }
+    //! Binary operator for dividing two histogram observables, the temporary left hand side is reused for the result
+    template <template <class,class> class Histo, class x_value_type, class y_value_type>
+    HistogramObservable<Histo, x_value_type, y_value_type> operator/(HistogramObservable<Histo, x_value_type, y_value_type>&& lhs, const HistogramObservable<Histo, x_value_type, y_value_type>& rhs)
     {
-      return HistogramObservable<Histo, x_value_type, y_value_type>(lhs) /= rhs;
+      lhs /= rhs;
+      return std::move(lhs);
     }
 
     //! Exponentiate the histogram observable with a scalar
     template <template <class, class> class Histo, class x_value_type, class y_value_type, class S>
-    const HistogramObservable<Histo, x_value_type, y_value_type> pow(const HistogramObservable<Histo, x_value_type, y_value_type>& base, const S& exponent)
+    HistogramObservable<Histo, x_value_type, y_value_type> pow(const HistogramObservable<Histo, x_value_type, y_value_type>& base, const S& exponent)
     {
       HistogramObservable<Histo, x_value_type, y_value_type> result;
       for (typename HistogramObservable<Histo, x_value_type, y_value_type>::const_iterator it = base.begin(); it != base.end(); ++it)
       {
-	result[it->first] = std::pow(it->second, exponent);
+	result.insert(result.end(), std::make_pair(it->first, std::pow(it->second, exponent)));
       }
       return result;
     }
     
     // Takes the square root of a histogram observable
     template <template <class, class> class Histo, class x_value_type, class y_value_type>
-    const HistogramObservable<Histo, x_value_type, y_value_type> sqrt(const HistogramObservable<Histo, x_value_type, y_value_type>& base)
+    HistogramObservable<Histo, x_value_type, y_value_type> sqrt(const HistogramObservable<Histo, x_value_type, y_value_type>& base)
     {
       return pow(base, 0.5);
     }
@@ -5,7 +5,7 @@
 #include <stdexcept>
 #include <cmath>
 
-#include <boost/accumulators/numeric/functional_fwd.hpp>
+#include <boost/accumulators/numeric/functional.hpp>
 
 #include "../details/stl_extensions/vector_addable.hpp"
 
@@ -14,6 +14,7 @@
 
 // Boost serialization for derived classes
 #include <boost/serialization/base_object.hpp>
+#include <boost/serialization/version.hpp>
 
 namespace Mocasinns
 {
@@ -77,6 +78,8 @@ namespace Mocasinns
     const HistoType<EnergyType, IncidenceCounterYValueType>& get_incidence_counter_positive() { return incidence_counter_positive; }
     //! Get-Accessor for the incidence counter of negative labled walkers
     const HistoType<EnergyType, IncidenceCounterYValueType>& get_incidence_counter_negative() { return incidence_counter_negative; }
+    //! Get-Accessor for the number of the current iteration, zero if no simulation is running or interrupted
+    unsigned int get_iteration_counter() const { return iteration_counter; }
 
     //! Find the minimal and the maximal energy of the system
     template<class TemperatureType>
@@ -89,6 +92,8 @@ namespace Mocasinns
 
     //! Calculate the acceptance probability of a step
     double acceptance_probability(StepType& step_to_execute, Details::Multicanonical::StepParameter<EnergyType>& step_parameters);
+    //! Calculate the logarithm of the acceptance probability of a step (-infinity if the step is forbidden)
+    double log_acceptance_probability(StepType& step_to_execute, Details::Multicanonical::StepParameter<EnergyType>& step_parameters);
     //! Handle an accepted step
     void handle_executed_step(StepType& executed_step, Details::Multicanonical::StepParameter<EnergyType>& step_parameters);
     //! Handle a rejected step
@@ -124,6 +129,8 @@ namespace Mocasinns
     enum WalkerLabel { positive, negative};
     //! Flag that indicates the label of the walker
     WalkerLabel walker_label;
+    //! Number of the current iteration, kept if the simulation stops at the deadline
+    unsigned int iteration_counter;
 
     //! Calculate the density of states from the current total incidence counter and the total weights
     HistoType<EnergyType, double> calculate_log_density_of_states() const;
@@ -132,8 +139,8 @@ namespace Mocasinns
 
     //! Friend class declaration for boost serialization
     friend class boost::serialization::access;
-    //! Method to serialize this class (omitted version name to avoid unused parameter warnings)
-    template<class Archive> void serialize(Archive & ar, const unsigned int)
+    //! Method to serialize this class, the iteration counter is stored since version 1
+    template<class Archive> void serialize(Archive & ar, const unsigned int version)
     {
       // serialize base class information
       ar & boost::serialization::base_object<Simulation<ConfigurationType, RandomNumberGenerator> >(*this);
@@ -141,6 +148,7 @@ namespace Mocasinns
       ar & incidence_counter_positive;
       ar & incidence_counter_negative;
       ar & walker_label;
+      if (version >= 1) ar & iteration_counter;
     }
 
   };
@@ -185,6 +193,21 @@ namespace Mocasinns
   
 } // of namespace Mocasinns
 
+namespace boost
+{
+  namespace serialization
+  {
+    //! Version of the serialization of OptimalEnsembleSampling (BOOST_CLASS_VERSION cannot be used for class templates)
+    template<class ConfigurationType, class StepType, class EnergyType, template<class,class> class HistoType, class RandomNumberGenerator>
+    struct version<Mocasinns::OptimalEnsembleSampling<ConfigurationType, StepType, EnergyType, HistoType, RandomNumberGenerator> >
+    {
+      typedef mpl::int_<1> type;
+      typedef mpl::integral_c_tag tag;
+      BOOST_STATIC_CONSTANT(int, value = version::type::value);
+    };
+  }
+}
+
 #include "src/optimal_ensemble_sampling.cpp"
 
 #endif
@@ -0,0 +1,132 @@
+/**
+ * \file distributed_coordinator.hpp
+ * \brief Classes for distributing independent tasks of a simulation to worker processes on several machines
+ *
+ * The coordinator hands out task numbers over SocketChannel connections, the workers perform the tasks and send back the serialized results (e.g. accumulators or histograms), which are merged by the coordinator. For testing, the workers can be forked on the local machine.
+ *
+ * \author Benedikt Krüger
+ */
+
+#ifndef MOCASINNS_PARALLEL_DISTRIBUTED_COORDINATOR_HPP
+#define MOCASINNS_PARALLEL_DISTRIBUTED_COORDINATOR_HPP
+
+#include "socket_channel.hpp"
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <sstream>
+#include <stdexcept>
+#include <sys/types.h>
+#include <time.h>
+
+// Boost serialization of the results
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/archive/text_iarchive.hpp>
+
+namespace Mocasinns
+{
+namespace Parallel
+{
+
+//! Exception thrown if the tasks of a distributed simulation cannot be completed
+class ExceptionDistributed : public std::runtime_error
+{
+public:
+  ExceptionDistributed(const std::string& reason) : std::runtime_error("Distributed simulation failed: " + reason) {}
+};
+
+//! Class handing out the tasks 0, ..., task_number - 1 to worker processes connected over sockets and collecting their results
+/*!
+  \details Workers can connect at any time, also while run() is executing. Every worker gets one task at a time, if a worker disconnects before sending the result of its task or sends a message that is not the result of its task, the connection is closed and the task is handed to another worker. A task that has failed maximal_failure_number times (e.g. because its result is longer than SocketChannel::maximal_message_length) is not handed out again and run() throws ExceptionDistributed. run() blocks until all results have arrived, if no worker is connected for worker_timeout milliseconds it throws ExceptionDistributed. A worker whose message stalls for worker_timeout milliseconds is treated as lost, so a slow worker does not block the other workers.
+
+  The destructor stops the workers and waits at most stop_timeout milliseconds for the local workers to exit, the remaining local workers are killed.
+
+  The workers are not authenticated and their results are deserialized from Boost text archives, so a TCP coordinator bound to an address reachable from other machines must only be used in a trusted network. By default it accepts only connections from the same machine.
+*/
+class DistributedCoordinator
+{
+public:
+  //! Create a coordinator listening on the given TCP port (0 chooses a free port) of the interface with the given IPv4 address (see SocketListener::listen_tcp)
+  explicit DistributedCoordinator(uint16_t port, const std::string& bind_address = "127.0.0.1");
+  //! Create a coordinator listening on a Unix domain socket at the given path
+  explicit DistributedCoordinator(const std::string& path);
+  //! Stop the connected workers and wait for the local workers, local workers that do not exit within stop_timeout milliseconds are killed
+  ~DistributedCoordinator();
+
+  //! Get the listener the workers connect to
+  const SocketListener& get_listener() const { return *listener; }
+  //! Get the number of connected workers
+  unsigned int get_worker_number() const { return workers.size(); }
+
+  //! Get the number of failed attempts after which a task is given up
+  unsigned int get_maximal_failure_number() const { return maximal_failure_number; }
+  //! Set the number of failed attempts after which a task is given up
+  void set_maximal_failure_number(unsigned int value) { maximal_failure_number = value; }
+  //! Get the time in milliseconds run() waits for a worker to connect while no worker is connected
+  int get_worker_timeout() const { return worker_timeout; }
+  //! Set the time in milliseconds run() waits for a worker to connect while no worker is connected (-1 waits forever)
+  void set_worker_timeout(int value) { worker_timeout = value; }
+  //! Get the time in milliseconds the destructor waits for the local workers to exit before killing them
+  int get_stop_timeout() const { return stop_timeout; }
+  //! Set the time in milliseconds the destructor waits for the local workers to exit before killing them (-1 waits forever)
+  void set_stop_timeout(int value) { stop_timeout = value; }
+
+  //! Fork the given number of local worker processes, each connects to this coordinator and calls worker_function(SocketChannel&), must not be called inside an active OpenMP parallel region
+  template<class WorkerFunction>
+  void spawn_local_workers(unsigned int worker_number, WorkerFunction worker_function);
+
+  //! Hand out the given number of tasks and store the result message of task t in results[t]
+  void run(unsigned int task_number, std::vector<std::string>& results);
+
+private:
+  //! Structure of a connected worker
+  struct Worker
+  {
+    //! Channel to the worker
+    SocketChannel* channel;
+    //! Task the worker is performing, -1 if the worker is idle
+    int task;
+  };
+
+  //! Listener the workers connect to
+  SocketListener* listener;
+  //! Connected workers
+  std::vector<Worker> workers;
+  //! Process ids of the forked local workers
+  std::vector<pid_t> local_workers;
+  //! Number of failed attempts after which a task is given up
+  unsigned int maximal_failure_number;
+  //! Time in milliseconds run() waits for a worker to connect while no worker is connected
+  int worker_timeout;
+  //! Time in milliseconds the destructor waits for the local workers to exit
+  int stop_timeout;
+
+  //! Copy constructor (not copyable)
+  DistributedCoordinator(const DistributedCoordinator&);
+  //! Assignment operator (not assignable)
+  DistributedCoordinator& operator=(const DistributedCoordinator&);
+
+  //! Send the stop message to all workers and close the connections
+  void stop_workers();
+  //! Get the current time of the monotonic clock in milliseconds
+  static double now();
+  //! Close the connection to the given worker and return its task to the pending tasks, throws ExceptionDistributed if the task has failed too often
+  void remove_worker(unsigned int worker_index, std::deque<unsigned int>& pending_tasks, std::vector<unsigned int>& failure_numbers);
+};
+
+//! Answer the task messages of a coordinator on the given channel with the result messages of task_function(unsigned int) until the coordinator stops the worker
+template<class TaskFunction>
+void run_distributed_worker(SocketChannel& channel, TaskFunction& task_function);
+
+//! Serialize an object to a string with a boost text archive
+template<class T> std::string serialize_to_string(const T& object);
+//! Deserialize an object from a string written with serialize_to_string
+template<class T> void deserialize_from_string(const std::string& data, T& object);
+
+} // of namespace Parallel
+} // of namespace Mocasinns
+
+#include "../src/parallel/distributed_coordinator.cpp"
+
+#endif
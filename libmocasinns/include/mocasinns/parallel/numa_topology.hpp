@@ -0,0 +1,119 @@
+/**
+ * \file numa_topology.hpp
+ * \brief Classes for the NUMA topology of the machine and for pinning threads to processors
+ *
+ * The topology is read from libnuma if MOCASINNS_USE_LIBNUMA is defined (link with -lnuma), otherwise from /sys/devices/system/node. If neither is available, all processors are assumed to belong to one node.
+ *
+ * \author Benedikt Krüger
+ */
+
+#ifndef MOCASINNS_PARALLEL_NUMA_TOPOLOGY_HPP
+#define MOCASINNS_PARALLEL_NUMA_TOPOLOGY_HPP
+
+#include <vector>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace Mocasinns
+{
+namespace Parallel
+{
+
+//! Class describing the NUMA nodes of the machine and the processors that belong to them
+/*!
+  \details Only the processors the calling thread is allowed to run on (e.g. restricted by taskset or a batch system) are considered, so the topology should be detected outside of pinned threads. The function thread_cpu() distributes the threads of a parallel region round-robin over the nodes, so that the memory bandwidth of all nodes is used if less threads than processors are started.
+*/
+class NumaTopology
+{
+public:
+  //! Enum describing where the topology information came from
+  enum Source
+  {
+    //! No topology information was found, one node with all processors is assumed
+    source_default,
+    //! The topology was read from /sys/devices/system/node
+    source_sysfs,
+    //! The topology was read using libnuma
+    source_libnuma
+  };
+
+  //! Detect the topology of the machine
+  NumaTopology();
+
+  //! Get the source of the topology information
+  Source get_source() const { return source; }
+  //! Get the number of NUMA nodes with usable processors
+  unsigned int node_number() const { return nodes.size(); }
+  //! Get the total number of usable processors
+  unsigned int cpu_number() const;
+  //! Get the usable processors of the given node
+  const std::vector<unsigned int>& node_cpus(unsigned int node) const { return nodes[node]; }
+  //! Get the node of the given processor, -1 if the processor is not usable
+  int cpu_node(unsigned int cpu) const;
+
+  //! Get the processor that a thread of a parallel region with the given number of threads should run on
+  unsigned int thread_cpu(unsigned int thread, unsigned int thread_number) const;
+
+  //! Pin the calling thread to the given processor, returns whether this was successful
+  static bool pin_current_thread(unsigned int cpu);
+  //! Get the processor the calling thread is running on, -1 if unknown
+  static int current_cpu();
+
+  //! Parse a list of processors in the kernel format (e.g. "0-3,8,10-11")
+  static std::vector<unsigned int> parse_cpu_list(const std::string& cpu_list);
+
+private:
+  //! Source of the topology information
+  Source source;
+  //! Processors of the nodes, nodes without usable processors are omitted
+  std::vector<std::vector<unsigned int> > nodes;
+
+  //! Read the topology with libnuma, returns false if libnuma is not available
+  bool detect_libnuma();
+  //! Read the topology from the sysfs, returns false if there is no information
+  bool detect_sysfs();
+  //! Assume one node containing all usable processors
+  void detect_default();
+  //! Test whether the process is allowed to run on the given processor
+  static bool cpu_usable(unsigned int cpu);
+};
+
+//! Class pinning the calling thread to a processor for the lifetime of the object
+/*!
+  \details The affinity of the thread before the pinning is restored in the destructor, so that the threads of the OpenMP thread pool are not restricted after a parallel region has finished.
+*/
+class ScopedThreadPinning
+{
+public:
+  //! Pin the calling thread to the given processor
+  ScopedThreadPinning(unsigned int cpu);
+  //! Restore the previous affinity of the thread
+  ~ScopedThreadPinning();
+
+  //! Get whether the pinning was successful
+  bool is_pinned() const { return pinned; }
+
+private:
+  //! Flag indicating whether the thread was pinned
+  bool pinned;
+#ifdef __linux__
+  //! Affinity of the thread before the pinning
+  cpu_set_t previous_affinity;
+#endif
+
+  //! Copy constructor (not copyable)
+  ScopedThreadPinning(const ScopedThreadPinning&);
+  //! Assignment operator (not assignable)
+  ScopedThreadPinning& operator=(const ScopedThreadPinning&);
+};
+
+} // of namespace Parallel
+} // of namespace Mocasinns
+
+#include "../src/parallel/numa_topology.cpp"
+
+#endif
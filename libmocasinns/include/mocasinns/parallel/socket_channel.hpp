@@ -0,0 +1,125 @@
+/**
+ * \file socket_channel.hpp
+ * \brief Classes for exchanging length-prefixed messages between processes over TCP or Unix domain sockets
+ *
+ * \author Benedikt Krüger
+ */
+
+#ifndef MOCASINNS_PARALLEL_SOCKET_CHANNEL_HPP
+#define MOCASINNS_PARALLEL_SOCKET_CHANNEL_HPP
+
+#include <string>
+#include <stdexcept>
+#include <stdint.h>
+
+namespace Mocasinns
+{
+namespace Parallel
+{
+
+//! Exception thrown if a socket operation fails
+class ExceptionSocket : public std::runtime_error
+{
+public:
+  ExceptionSocket(const std::string& operation) : std::runtime_error("Socket operation failed: " + operation) {}
+};
+
+//! Class for a connected stream socket that transports messages consisting of a 32 bit length and the data
+class SocketChannel
+{
+public:
+  //! Take over an already connected socket
+  explicit SocketChannel(int file_descriptor) : socket_descriptor(file_descriptor), receive_timeout(-1) {}
+  //! Close the socket
+  ~SocketChannel();
+
+  //! Connect to a TCP socket at the given host and port
+  static SocketChannel* connect_tcp(const std::string& host, uint16_t port);
+  //! Connect to a Unix domain socket at the given path
+  static SocketChannel* connect_unix(const std::string& path);
+
+  //! Get the file descriptor of the socket (e.g. for poll)
+  int get_file_descriptor() const { return socket_descriptor; }
+
+  //! Get the time in milliseconds receive_message waits for further data of a message (-1 waits forever)
+  int get_receive_timeout() const { return receive_timeout; }
+  //! Set the time in milliseconds receive_message waits for further data of a message (-1 waits forever)
+  void set_receive_timeout(int value) { receive_timeout = value; }
+
+  //! Maximal length of a message in bytes, so a corrupted or hostile length prefix cannot make the receiver allocate arbitrary memory
+  static const uint32_t maximal_message_length = 256u << 20;
+
+  //! Send a message, throws ExceptionSocket if the connection is broken or the message is longer than maximal_message_length
+  void send_message(const std::string& message);
+  //! Receive a message, returns false if the connection was closed by the other side, the announced length exceeds maximal_message_length or no data arrived for receive_timeout milliseconds
+  bool receive_message(std::string& message);
+
+private:
+  //! File descriptor of the socket
+  int socket_descriptor;
+  //! Time in milliseconds receive_message waits for further data of a message
+  int receive_timeout;
+
+  //! Copy constructor (not copyable)
+  SocketChannel(const SocketChannel&);
+  //! Assignment operator (not assignable)
+  SocketChannel& operator=(const SocketChannel&);
+
+  //! Write the given number of bytes, returns false on failure
+  bool write_all(const char* data, size_t size);
+  //! Read the given number of bytes, returns false if the connection was closed or failed or no data arrived for receive_timeout milliseconds
+  bool read_all(char* data, size_t size);
+};
+
+//! Class for a listening TCP or Unix domain socket accepting SocketChannel connections
+class SocketListener
+{
+public:
+  //! Listen on the given TCP port of the interface with the given IPv4 address (0 chooses a free port, "0.0.0.0" listens on all interfaces)
+  static SocketListener* listen_tcp(uint16_t port, const std::string& bind_address = "127.0.0.1");
+  //! Listen on a Unix domain socket at the given path, an existing file at the path is removed
+  static SocketListener* listen_unix(const std::string& path);
+  //! Close the socket and remove the socket file of a Unix domain socket
+  ~SocketListener();
+
+  //! Get the file descriptor of the socket (e.g. for poll)
+  int get_file_descriptor() const { return socket_descriptor; }
+  //! Get whether this is a Unix domain socket
+  bool is_unix() const { return !path.empty(); }
+  //! Get the TCP port (after listen_tcp(0) the port chosen by the system)
+  uint16_t get_port() const { return port; }
+  //! Get the IPv4 address the TCP socket is bound to
+  const std::string& get_address() const { return address; }
+  //! Get the path of the Unix domain socket
+  const std::string& get_path() const { return path; }
+
+  //! Accept a connection, blocks until a process connects
+  SocketChannel* accept_connection();
+  //! Connect a new channel to this listener from the same machine (e.g. in a forked worker process)
+  SocketChannel* connect_local() const;
+
+private:
+  //! File descriptor of the socket
+  int socket_descriptor;
+  //! TCP port of the socket
+  uint16_t port;
+  //! IPv4 address the TCP socket is bound to, empty for Unix domain sockets
+  std::string address;
+  //! Path of the Unix domain socket, empty for TCP sockets
+  std::string path;
+
+  //! Constructor used by the static creation functions
+  SocketListener(int file_descriptor, uint16_t listen_port, const std::string& listen_address, const std::string& listen_path)
+    : socket_descriptor(file_descriptor), port(listen_port), address(listen_address), path(listen_path) {}
+  //! Copy constructor (not copyable)
+  SocketListener(const SocketListener&);
+  //! Assignment operator (not assignable)
+  SocketListener& operator=(const SocketListener&);
+};
+
+} // of namespace Parallel
+} // of namespace Mocasinns
+
+#include "../src/parallel/socket_channel.cpp"
+
+#endif
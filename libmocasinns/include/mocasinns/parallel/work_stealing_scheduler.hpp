@@ -0,0 +1,71 @@
+/**
+ * \file work_stealing_scheduler.hpp
+ * \brief Class distributing a fixed number of independent tasks over the threads of a parallel region with work stealing
+ *
+ * \author Benedikt Krüger
+ */
+
+#ifndef MOCASINNS_PARALLEL_WORK_STEALING_SCHEDULER_HPP
+#define MOCASINNS_PARALLEL_WORK_STEALING_SCHEDULER_HPP
+
+#include <vector>
+#include <deque>
+#include <omp.h>
+
+namespace Mocasinns
+{
+namespace Parallel
+{
+
+//! Class distributing the tasks 0, ..., task_number - 1 over a number of queues, one for every thread of a parallel region
+/*!
+  \details The tasks are dealt out round-robin to the queues before the parallel region starts. Every thread takes the tasks from the front of its own queue, if the own queue is empty it steals a task from the back of the other queues. Every queue has its own lock, so threads only contend if they access the same queue. No tasks can be added after the construction, therefore next_task() returning false means that all tasks have been handed out.
+*/
+class WorkStealingScheduler
+{
+public:
+  //! Distribute the given number of tasks over the given number of queues
+  WorkStealingScheduler(unsigned int task_number, unsigned int queue_number);
+  //! Destructor freeing the queues and their locks
+  ~WorkStealingScheduler();
+
+  //! Get the number of queues
+  unsigned int get_queue_number() const { return queues.size(); }
+  //! Get the number of tasks that were stolen from other queues
+  unsigned int get_stolen_task_number() const { return stolen_task_number; }
+
+  //! Get the next task for the thread owning the given queue, returns false if there are no tasks left
+  bool next_task(unsigned int queue, unsigned int& task);
+
+private:
+  //! Structure of one queue, allocated separately to avoid false sharing between the locks
+  struct Queue
+  {
+    //! Tasks of the queue
+    std::deque<unsigned int> tasks;
+    //! Lock protecting the tasks
+    omp_lock_t lock;
+  };
+
+  //! Queues of the threads
+  std::vector<Queue*> queues;
+  //! Number of stolen tasks
+  unsigned int stolen_task_number;
+
+  //! Copy constructor (not copyable)
+  WorkStealingScheduler(const WorkStealingScheduler&);
+  //! Assignment operator (not assignable)
+  WorkStealingScheduler& operator=(const WorkStealingScheduler&);
+
+  //! Take a task from the front of the given queue
+  bool pop_task(unsigned int queue, unsigned int& task);
+  //! Take a task from the back of the given queue
+  bool steal_task(unsigned int queue, unsigned int& task);
+};
+
+} // of namespace Parallel
+} // of namespace Mocasinns
+
+#include "../src/parallel/work_stealing_scheduler.cpp"
+
+#endif
@@ -25,6 +25,8 @@
 
 // Header for the standard random number generator
 #include "random/boost_random.hpp"
+// Header for the wall clock budget
+#include "details/simulation/wall_clock_budget.hpp"
 
 namespace Mocasinns
 {
@@ -43,6 +45,8 @@ public:
   boost::signals2::signal<void (Simulation*)> signal_handler_sigusr1;
   //! Boost signal handler invoked when SIGUSR1 is caught
   boost::signals2::signal<void (Simulation*)> signal_handler_sigusr2;
+  //! Boost signal handler invoked when the wall clock budget does not allow the next unit of work, before the checkpoint is written
+  boost::signals2::signal<void (Simulation*)> signal_handler_deadline;
 
   //! Initialise a Simulation with default configuration space and default RandomNumberGenerator
   Simulation();
@@ -62,6 +66,17 @@ public:
   //! Set-Accesspr for the path and name of the dumped file
   void set_dump_filename(const std::string& value);
 
+  //! Set a wall clock budget in seconds from now, the simulation stops at a safe point and writes a checkpoint if the next unit of work would not finish safety_margin seconds before the deadline
+  void set_wall_clock_budget(double seconds, double safety_margin = 0.0);
+  //! Remove the wall clock budget
+  void clear_wall_clock_budget();
+  //! Get the remaining wall clock time in seconds, negative if the deadline has passed
+  double get_remaining_wall_clock_time() const;
+  //! Get whether the simulation was stopped because of the wall clock budget
+  bool get_deadline_reached() const;
+  //! Write the simulation atomically to the dump file, so that an interrupted or failed write never destroys the previous checkpoint (throws std::runtime_error if the write fails)
+  void write_checkpoint() const;
+
   //! Load the data of the simulation from a serialization stream
   virtual void load_serialize(std::istream& input_stream);
   //! Load the data of the simulation from a serialization file
@@ -99,6 +114,14 @@ protected:
   //! Bool that indicates whether the simulation is terminating
   bool is_terminating;
 
+  //! Wall clock budget of the simulation
+  Details::Simulation::WallClockBudget wall_clock_budget;
+  //! Bool that indicates whether the simulation was stopped because of the wall clock budget
+  bool deadline_reached;
+  //! Check whether the wall clock budget allows a unit of work of the given size, otherwise call the deadline signal handler, write a checkpoint and terminate
+  //! \returns True if the simulation is terminating, false otherwise
+  bool check_for_deadline(double next_work);
+
   //! Member variable for boost serialization
   friend class boost::serialization::access;
   //! Method for loading this class (omitted version name to avoid unused parameter warnings)
@@ -113,8 +136,8 @@ protected:
   void do_steps(const StepNumberType& step_number, AcceptanceProbabilityParameterType acceptance_probability_parameter);
 
 private:
-  //! Do a number of generic steps using an acceptance probability provided by the actual algorithm
-  template <class Derived, class StepType, class AcceptanceProbabilityParameterType, bool step_has_is_executable, bool step_has_selection_probability_factor>
+  //! Do a number of generic steps using an acceptance probability (or its logarithm, if the algorithm provides log_acceptance_probability) provided by the actual algorithm
+  template <class Derived, class StepType, class AcceptanceProbabilityParameterType, bool step_has_is_executable, bool step_has_selection_probability_factor, bool simulation_has_log_acceptance_probability>
   void do_generic_steps(const StepNumberType& step_number, AcceptanceProbabilityParameterType acceptance_probability_parameter);
 
   //! Set the signals for POSIX signals
@@ -0,0 +1,139 @@
+/**
+ * \file correlator_accumulator.cpp
+ * \brief Implementation of the CorrelatorAccumulator class
+ *
+ * Usage examples are found in the test cases.
+ *
+ * \author Benedikt Krüger
+ */
+#ifdef MOCASINNS_ACCUMULATORS_CORRELATOR_ACCUMULATOR_HPP
+
+#include <algorithm>
+
+namespace Mocasinns
+{
+namespace Accumulators
+{
+
+/*!
+  \param p_value Length of the shift registers, i.e. number of lags per level
+  \param m_value Number of values of a level that are averaged for the next level
+
+  \details Throws a std::invalid_argument if m is smaller than 2 or p is not a multiple of m.
+*/
+template <class Observable>
+CorrelatorAccumulator<Observable>::CorrelatorAccumulator(unsigned int p_value, unsigned int m_value)
+  : p(p_value), m(m_value), levels(0), measurement_count(0), measurement_sum(0.0)
+{
+  if (m < 2 || p < m || p % m != 0) throw std::invalid_argument("The length of the shift registers of the CorrelatorAccumulator must be a multiple of the averaging factor.");
+}
+
+/*!
+  \param other Accumulator whose correlations are merged into this accumulator
+
+  \details Merging accumulators with different p or m throws a std::invalid_argument.
+*/
+template <class Observable>
+void CorrelatorAccumulator<Observable>::merge(const CorrelatorAccumulator<Observable>& other)
+{
+  if (other.p != p || other.m != m) throw std::invalid_argument("The parameters of the CorrelatorAccumulators do not match.");
+
+  while (levels < other.levels) add_level();
+  for (unsigned int i = 0; i < other.correlation_sums.size(); ++i)
+  {
+    correlation_sums[i] += other.correlation_sums[i];
+    correlation_counts[i] += other.correlation_counts[i];
+  }
+  measurement_count += other.measurement_count;
+  measurement_sum += other.measurement_sum;
+}
+
+template <class Observable>
+std::vector<uint64_t> CorrelatorAccumulator<Observable>::lags() const
+{
+  std::vector<uint64_t> result;
+  uint64_t block_length = 1;
+  for (unsigned int level = 0; level < levels; ++level, block_length *= m)
+    for (unsigned int j = first_index(level); j < p; ++j)
+      if (correlation_counts[level*p + j] > 0) result.push_back(j*block_length);
+  return result;
+}
+
+template <class Observable>
+std::vector<double> CorrelatorAccumulator<Observable>::correlation() const
+{
+  std::vector<double> result;
+  for (unsigned int level = 0; level < levels; ++level)
+    for (unsigned int j = first_index(level); j < p; ++j)
+      if (correlation_counts[level*p + j] > 0)
+	result.push_back(correlation_sums[level*p + j] / static_cast<double>(correlation_counts[level*p + j]));
+  return result;
+}
+
+template <class Observable>
+std::vector<double> CorrelatorAccumulator<Observable>::connected_correlation() const
+{
+  std::vector<double> result = correlation();
+  const double squared_mean = mean()*mean();
+  for (unsigned int i = 0; i < result.size(); ++i)
+    result[i] -= squared_mean;
+  return result;
+}
+
+/*!
+  \param value Value that is added to the level
+  \param level Level of the value, 0 for the measurements
+*/
+template <class Observable>
+void CorrelatorAccumulator<Observable>::add(double value, unsigned int level)
+{
+  if (level >= levels) add_level();
+  if (level == 0)
+  {
+    ++measurement_count;
+    measurement_sum += value;
+  }
+
+  // Shift the register and insert the value at the front
+  double* shift_register = &shift_registers[level*p];
+  std::copy_backward(shift_register, shift_register + p - 1, shift_register + p);
+  shift_register[0] = value;
+  if (register_fill[level] < p) ++register_fill[level];
+
+  // Correlate the new value with the values in the register
+  double* correlation_sum = &correlation_sums[level*p];
+  uint64_t* correlation_count = &correlation_counts[level*p];
+  const unsigned int fill = register_fill[level];
+  for (unsigned int j = first_index(level); j < fill; ++j)
+  {
+    correlation_sum[j] += value * shift_register[j];
+    ++correlation_count[j];
+  }
+
+  // Pass the block average to the next level
+  block_sums[level] += value;
+  if (++block_fill[level] == m)
+  {
+    const double block_average = block_sums[level] / static_cast<double>(m);
+    block_sums[level] = 0.0;
+    block_fill[level] = 0;
+    add(block_average, level + 1);
+  }
+}
+
+template <class Observable>
+void CorrelatorAccumulator<Observable>::add_level()
+{
+  ++levels;
+  shift_registers.resize(levels*p, 0.0);
+  register_fill.resize(levels, 0);
+  correlation_sums.resize(levels*p, 0.0);
+  correlation_counts.resize(levels*p, 0);
+  block_sums.resize(levels, 0.0);
+  block_fill.resize(levels, 0);
+}
+
+} // of namespace Accumulators
+} // of namespace Mocasinns
+
+#endif
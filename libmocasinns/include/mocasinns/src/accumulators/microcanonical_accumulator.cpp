@@ -0,0 +1,182 @@
+/**
+ * \file microcanonical_accumulator.cpp
+ * \brief Implementation of the MicrocanonicalAccumulator class
+ *
+ * Usage examples are found in the test cases.
+ *
+ * \author Benedikt Krüger
+ */
+#ifdef MOCASINNS_ACCUMULATORS_MICROCANONICAL_ACCUMULATOR_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Mocasinns
+{
+namespace Accumulators
+{
+
+/*!
+  \tparam Histo Type of the histogram, e.g. Histograms::Histocrete or Histograms::HistogramNumber
+  \param histogram Histogram whose x-values are used as energy bins
+*/
+template <class EnergyType, class Observable>
+template <class Histo>
+void MicrocanonicalAccumulator<EnergyType, Observable>::initialise_bins(const Histo& histogram)
+{
+  energies.clear();
+  energies.reserve(histogram.size());
+  for (typename Histo::const_iterator bin = histogram.begin(); bin != histogram.end(); ++bin)
+    energies.push_back(bin->first);
+  counts.assign(energies.size(), 0);
+  sums.assign(energies.size()*component_number, 0.0);
+  last_bin = 0;
+}
+
+/*!
+  \param energy_bin Energy bin of the configuration, e.g. the result of Histograms::Histogram::bin_value
+  \param observable Value of the observable of the configuration
+
+  \details The first measurement fixes the number of components, a measurement with a different number of components throws a std::range_error.
+*/
+template <class EnergyType, class Observable>
+void MicrocanonicalAccumulator<EnergyType, Observable>::operator()(const EnergyType& energy_bin, const Observable& observable)
+{
+  const std::size_t components = Components::size(observable);
+  if (component_number == 0)
+  {
+    component_number = components;
+    prototype.reset(new result_type(Details::Accumulators::ObservableResult<Observable>::create(observable)));
+    sums.assign(energies.size()*component_number, 0.0);
+  }
+  else if (components != component_number)
+    throw std::range_error("The number of components of the observable does not match the MicrocanonicalAccumulator.");
+
+  const std::size_t index = bin_index(energy_bin);
+  ++counts[index];
+  double* sum = &sums[index*component_number];
+  for (std::size_t i = 0; i < component_number; ++i)
+    sum[i] += Components::get(observable, i);
+}
+
+template <class EnergyType, class Observable>
+void MicrocanonicalAccumulator<EnergyType, Observable>::merge(const MicrocanonicalAccumulator<EnergyType, Observable>& other)
+{
+  if (other.component_number == 0) return;
+  if (component_number == 0)
+  {
+    component_number = other.component_number;
+    prototype = other.prototype;
+    sums.assign(energies.size()*component_number, 0.0);
+  }
+  else if (other.component_number != component_number)
+    throw std::range_error("The number of components of the observable does not match the MicrocanonicalAccumulator.");
+
+  for (std::size_t other_index = 0; other_index < other.energies.size(); ++other_index)
+  {
+    if (other.counts[other_index] == 0) continue;
+    const std::size_t index = bin_index(other.energies[other_index]);
+    counts[index] += other.counts[other_index];
+    for (std::size_t i = 0; i < component_number; ++i)
+      sums[index*component_number + i] += other.sums[other_index*component_number + i];
+  }
+}
+
+template <class EnergyType, class Observable>
+std::vector<typename MicrocanonicalAccumulator<EnergyType, Observable>::result_type> MicrocanonicalAccumulator<EnergyType, Observable>::microcanonical_averages() const
+{
+  std::vector<result_type> result;
+  result.reserve(energies.size());
+  std::vector<double> averages(component_number);
+  for (std::size_t bin = 0; bin < energies.size(); ++bin)
+  {
+    const double inverse_count = (counts[bin] > 0) ? 1.0 / static_cast<double>(counts[bin]) : 0.0;
+    for (std::size_t i = 0; i < component_number; ++i)
+      averages[i] = sums[bin*component_number + i] * inverse_count;
+    result.push_back(create_result(averages.data()));
+  }
+  return result;
+}
+
+template <class EnergyType, class Observable>
+template <class Histo>
+std::vector<double> MicrocanonicalAccumulator<EnergyType, Observable>::aligned_log_density_of_states(const Histo& log_density_of_states) const
+{
+  std::vector<double> result(energies.size(), -std::numeric_limits<double>::infinity());
+  for (std::size_t bin = 0; bin < energies.size(); ++bin)
+  {
+    typename Histo::const_iterator position = log_density_of_states.find(energies[bin]);
+    if (position != log_density_of_states.end()) result[bin] = position->second;
+  }
+  return result;
+}
+
+/*!
+  \param aligned_log_density_of_states Logarithmic density of states at the energy bins of this accumulator (see aligned_log_density_of_states), bins with -infinity are ignored
+  \param beta Inverse temperature
+
+  \details The weights \f$ \ln g(E) - \beta E \f$ are shifted by their maximum before the exponentiation to avoid overflows. Bins without measurements are ignored.
+*/
+template <class EnergyType, class Observable>
+typename MicrocanonicalAccumulator<EnergyType, Observable>::result_type MicrocanonicalAccumulator<EnergyType, Observable>::canonical_average(const std::vector<double>& aligned_log_density_of_states, double beta) const
+{
+  const std::size_t bins = energies.size();
+  std::vector<double> weights(bins, -std::numeric_limits<double>::infinity());
+  double maximal_weight = -std::numeric_limits<double>::infinity();
+  for (std::size_t bin = 0; bin < bins; ++bin)
+  {
+    if (counts[bin] == 0) continue;
+    weights[bin] = aligned_log_density_of_states[bin] - beta*static_cast<double>(energies[bin]);
+    if (weights[bin] > maximal_weight) maximal_weight = weights[bin];
+  }
+
+  // Sum the microcanonical averages weighted with the canonical probabilities of the bins
+  std::vector<double> result(component_number, 0.0);
+  double partition_function = 0.0;
+  for (std::size_t bin = 0; bin < bins; ++bin)
+  {
+    if (counts[bin] == 0) continue;
+    const double weight = std::exp(weights[bin] - maximal_weight);
+    partition_function += weight;
+    const double factor = weight / static_cast<double>(counts[bin]);
+    const double* sum = &sums[bin*component_number];
+    for (std::size_t i = 0; i < component_number; ++i)
+      result[i] += factor * sum[i];
+  }
+  for (std::size_t i = 0; i < component_number; ++i)
+    result[i] /= partition_function;
+
+  return create_result(result.data());
+}
+
+template <class EnergyType, class Observable>
+std::size_t MicrocanonicalAccumulator<EnergyType, Observable>::bin_index(const EnergyType& energy_bin)
+{
+  if (last_bin < energies.size() && energies[last_bin] == energy_bin) return last_bin;
+
+  typename std::vector<EnergyType>::iterator position = std::lower_bound(energies.begin(), energies.end(), energy_bin);
+  last_bin = position - energies.begin();
+  if (position == energies.end() || *position != energy_bin)
+  {
+    energies.insert(position, energy_bin);
+    counts.insert(counts.begin() + last_bin, 0);
+    sums.insert(sums.begin() + last_bin*component_number, component_number, 0.0);
+  }
+  return last_bin;
+}
+
+template <class EnergyType, class Observable>
+typename MicrocanonicalAccumulator<EnergyType, Observable>::result_type MicrocanonicalAccumulator<EnergyType, Observable>::create_result(const double* values) const
+{
+  if (!prototype) return result_type();
+  result_type result(*prototype);
+  for (std::size_t i = 0; i < component_number; ++i)
+    ResultComponents::set(result, i, values[i]);
+  return result;
+}
+
+} // of namespace Accumulators
+} // of namespace Mocasinns
+
+#endif
@@ -0,0 +1,240 @@
+/**
+ * \file moments_accumulator.cpp
+ * \brief Implementation of the MomentsAccumulator class
+ *
+ * Usage examples are found in the test cases.
+ *
+ * \author Benedikt Krüger
+ */
+#ifdef MOCASINNS_ACCUMULATORS_MOMENTS_ACCUMULATOR_HPP
+
+namespace Mocasinns
+{
+namespace Accumulators
+{
+
+/*!
+  \param observable Measurement that is added to the accumulator
+
+  \details With the number of measurements \f$ n \f$ after the update, \f$ \delta = x - \bar{x}_{n-1} \f$ and \f$ \delta_n = \delta / n \f$ every component is updated by
+  \f{eqnarray*}{
+  \bar{x}_n &=& \bar{x}_{n-1} + \delta_n \\
+  M_{4,n} &=& M_{4,n-1} + \delta \delta_n^3 (n-1)(n^2 - 3n + 3) + 6 \delta_n^2 M_{2,n-1} - 4 \delta_n M_{3,n-1} \\
+  M_{3,n} &=& M_{3,n-1} + \delta \delta_n^2 (n-1)(n-2) - 3 \delta_n M_{2,n-1} \\
+  M_{2,n} &=& M_{2,n-1} + \delta \delta_n (n-1)
+  \f}
+  The first measurement fixes the number of components, a measurement with a different number of components throws a ComponentNumbersDoNotMatchException.
+*/
+template <class Observable, unsigned int moment_order>
+void MomentsAccumulator<Observable, moment_order>::operator()(const Observable& observable)
+{
+  const std::size_t components = Components::size(observable);
+  if (measurement_count == 0)
+  {
+    initialise(components);
+    prototype.reset(new result_type(Details::Accumulators::ObservableResult<Observable>::create(observable)));
+  }
+  else if (components != means.size())
+    throw ComponentNumbersDoNotMatchException();
+
+  // Copy the components into the aligned buffer, afterwards all loops run over contiguous arrays
+  double* x = sample.data();
+  for (std::size_t i = 0; i < components; ++i)
+    x[i] = Components::get(observable, i);
+
+  ++measurement_count;
+  const double n = static_cast<double>(measurement_count);
+  const double inverse_n = 1.0 / n;
+  double* mean = means.data();
+  double* sum_2 = m2.data();
+
+  if (moment_order >= 4)
+  {
+    double* sum_3 = m3.data();
+    double* sum_4 = m4.data();
+    const double factor_4 = (n - 1.0)*(n*n - 3.0*n + 3.0);
+    const double factor_3 = (n - 1.0)*(n - 2.0);
+    for (std::size_t i = 0; i < components; ++i)
+    {
+      const double delta = x[i] - mean[i];
+      const double delta_n = delta * inverse_n;
+      const double delta_n_2 = delta_n * delta_n;
+      mean[i] += delta_n;
+      sum_4[i] += delta*delta_n*delta_n_2*factor_4 + 6.0*delta_n_2*sum_2[i] - 4.0*delta_n*sum_3[i];
+      sum_3[i] += delta*delta_n_2*factor_3 - 3.0*delta_n*sum_2[i];
+      sum_2[i] += delta*delta_n*(n - 1.0);
+    }
+  }
+  else if (moment_order == 3)
+  {
+    double* sum_3 = m3.data();
+    const double factor_3 = (n - 1.0)*(n - 2.0);
+    for (std::size_t i = 0; i < components; ++i)
+    {
+      const double delta = x[i] - mean[i];
+      const double delta_n = delta * inverse_n;
+      mean[i] += delta_n;
+      sum_3[i] += delta*delta_n*delta_n*factor_3 - 3.0*delta_n*sum_2[i];
+      sum_2[i] += delta*delta_n*(n - 1.0);
+    }
+  }
+  else
+  {
+    for (std::size_t i = 0; i < components; ++i)
+    {
+      const double delta = x[i] - mean[i];
+      const double delta_n = delta * inverse_n;
+      mean[i] += delta_n;
+      sum_2[i] += delta*delta_n*(n - 1.0);
+    }
+  }
+}
+
+/*!
+  \param other Accumulator whose measurements are merged into this accumulator
+
+  \details With the numbers of measurements \f$ n_A \f$ of this and \f$ n_B \f$ of the other accumulator, \f$ n = n_A + n_B \f$ and \f$ \delta = \bar{x}_B - \bar{x}_A \f$ every component is combined by
+  \f{eqnarray*}{
+  \bar{x} &=& \bar{x}_A + \delta n_B / n \\
+  M_2 &=& M_{2,A} + M_{2,B} + \delta^2 n_A n_B / n \\
+  M_3 &=& M_{3,A} + M_{3,B} + \delta^3 n_A n_B (n_A - n_B) / n^2 + 3 \delta (n_A M_{2,B} - n_B M_{2,A}) / n \\
+  M_4 &=& M_{4,A} + M_{4,B} + \delta^4 n_A n_B (n_A^2 - n_A n_B + n_B^2) / n^3 + 6 \delta^2 (n_A^2 M_{2,B} + n_B^2 M_{2,A}) / n^2 + 4 \delta (n_A M_{3,B} - n_B M_{3,A}) / n
+  \f}
+  Merging accumulators with different numbers of components throws a ComponentNumbersDoNotMatchException.
+*/
+template <class Observable, unsigned int moment_order>
+void MomentsAccumulator<Observable, moment_order>::merge(const MomentsAccumulator<Observable, moment_order>& other)
+{
+  if (other.measurement_count == 0) return;
+  if (measurement_count == 0)
+  {
+    measurement_count = other.measurement_count;
+    means = other.means;
+    m2 = other.m2;
+    m3 = other.m3;
+    m4 = other.m4;
+    sample.resize(means.size());
+    prototype = other.prototype;
+    return;
+  }
+  if (other.means.size() != means.size()) throw ComponentNumbersDoNotMatchException();
+
+  const std::size_t components = means.size();
+  const double n_a = static_cast<double>(measurement_count);
+  const double n_b = static_cast<double>(other.measurement_count);
+  const double n = n_a + n_b;
+  double* mean = means.data();
+  double* sum_2 = m2.data();
+  const double* other_mean = other.means.data();
+  const double* other_sum_2 = other.m2.data();
+
+  if (moment_order >= 3)
+  {
+    double* sum_3 = m3.data();
+    double* sum_4 = (moment_order >= 4) ? m4.data() : 0;
+    const double* other_sum_3 = other.m3.data();
+    const double* other_sum_4 = (moment_order >= 4) ? other.m4.data() : 0;
+    for (std::size_t i = 0; i < components; ++i)
+    {
+      const double delta = other_mean[i] - mean[i];
+      const double delta_2 = delta*delta;
+      if (moment_order >= 4)
+	sum_4[i] += other_sum_4[i] + delta_2*delta_2*n_a*n_b*(n_a*n_a - n_a*n_b + n_b*n_b)/(n*n*n) + 6.0*delta_2*(n_a*n_a*other_sum_2[i] + n_b*n_b*sum_2[i])/(n*n) + 4.0*delta*(n_a*other_sum_3[i] - n_b*sum_3[i])/n;
+      sum_3[i] += other_sum_3[i] + delta_2*delta*n_a*n_b*(n_a - n_b)/(n*n) + 3.0*delta*(n_a*other_sum_2[i] - n_b*sum_2[i])/n;
+      sum_2[i] += other_sum_2[i] + delta_2*n_a*n_b/n;
+      mean[i] += delta*n_b/n;
+    }
+  }
+  else
+  {
+    for (std::size_t i = 0; i < components; ++i)
+    {
+      const double delta = other_mean[i] - mean[i];
+      sum_2[i] += other_sum_2[i] + delta*delta*n_a*n_b/n;
+      mean[i] += delta*n_b/n;
+    }
+  }
+  measurement_count += other.measurement_count;
+}
+
+template <class Observable, unsigned int moment_order>
+void MomentsAccumulator<Observable, moment_order>::reset()
+{
+  measurement_count = 0;
+  initialise(0);
+  prototype.reset();
+}
+
+template <class Observable, unsigned int moment_order>
+typename MomentsAccumulator<Observable, moment_order>::result_type MomentsAccumulator<Observable, moment_order>::variance() const
+{
+  ComponentArray result(m2);
+  const double inverse_n = 1.0 / static_cast<double>(measurement_count);
+  for (std::size_t i = 0; i < result.size(); ++i)
+    result[i] *= inverse_n;
+  return create_result(result);
+}
+
+template <class Observable, unsigned int moment_order>
+typename MomentsAccumulator<Observable, moment_order>::result_type MomentsAccumulator<Observable, moment_order>::error_of_mean() const
+{
+  ComponentArray result(m2);
+  const double n = static_cast<double>(measurement_count);
+  const double factor = 1.0 / (n*(n - 1.0));
+  for (std::size_t i = 0; i < result.size(); ++i)
+    result[i] = std::sqrt(result[i]*factor);
+  return create_result(result);
+}
+
+/*!
+  \returns The skewness \f$ \sqrt{n} M_3 / M_2^{3/2} \f$ of every component
+*/
+template <class Observable, unsigned int moment_order>
+typename MomentsAccumulator<Observable, moment_order>::result_type MomentsAccumulator<Observable, moment_order>::skewness() const
+{
+  BOOST_STATIC_ASSERT(moment_order >= 3);
+  ComponentArray result(m3);
+  const double sqrt_n = std::sqrt(static_cast<double>(measurement_count));
+  for (std::size_t i = 0; i < result.size(); ++i)
+    result[i] *= sqrt_n / std::pow(m2[i], 1.5);
+  return create_result(result);
+}
+
+/*!
+  \returns The excess kurtosis \f$ n M_4 / M_2^2 - 3 \f$ of every component
+*/
+template <class Observable, unsigned int moment_order>
+typename MomentsAccumulator<Observable, moment_order>::result_type MomentsAccumulator<Observable, moment_order>::kurtosis() const
+{
+  BOOST_STATIC_ASSERT(moment_order >= 4);
+  ComponentArray result(m4);
+  const double n = static_cast<double>(measurement_count);
+  for (std::size_t i = 0; i < result.size(); ++i)
+    result[i] = n*result[i] / (m2[i]*m2[i]) - 3.0;
+  return create_result(result);
+}
+
+template <class Observable, unsigned int moment_order>
+void MomentsAccumulator<Observable, moment_order>::initialise(std::size_t components)
+{
+  means.assign(components, 0.0);
+  m2.assign(components, 0.0);
+  m3.assign(moment_order >= 3 ? components : 0, 0.0);
+  m4.assign(moment_order >= 4 ? components : 0, 0.0);
+  sample.assign(components, 0.0);
+}
+
+template <class Observable, unsigned int moment_order>
+typename MomentsAccumulator<Observable, moment_order>::result_type MomentsAccumulator<Observable, moment_order>::create_result(const ComponentArray& values) const
+{
+  if (!prototype) return result_type();
+  result_type result(*prototype);
+  for (std::size_t i = 0; i < values.size(); ++i)
+    ResultComponents::set(result, i, values[i]);
+  return result;
+}
+
+} // of namespace Accumulators
+} // of namespace Mocasinns
+
+#endif
@@ -0,0 +1,177 @@
+/**
+ * \file quantile_accumulator.cpp
+ * \brief Implementation of the QuantileAccumulator class
+ *
+ * Usage examples are found in the test cases.
+ *
+ * \author Benedikt Krüger
+ */
+#ifdef MOCASINNS_ACCUMULATORS_QUANTILE_ACCUMULATOR_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace Mocasinns
+{
+namespace Accumulators
+{
+
+template <class Observable>
+QuantileAccumulator<Observable>::QuantileAccumulator(unsigned int k_value, uint64_t seed)
+  : k(k_value < 8 ? 8 : k_value), measurement_count(0), retained_size(0), maximal_size(0), minimum(0.0), maximum(0.0), random_state(seed == 0 ? 1 : seed)
+{
+  grow();
+}
+
+template <class Observable>
+void QuantileAccumulator<Observable>::operator()(const Observable& observable)
+{
+  const double value = static_cast<double>(observable);
+  if (measurement_count == 0 || value < minimum) minimum = value;
+  if (measurement_count == 0 || value > maximum) maximum = value;
+  ++measurement_count;
+
+  compactors[0].push_back(value);
+  ++retained_size;
+  if (retained_size >= maximal_size) compress();
+}
+
+/*!
+  \param other Accumulator whose measurements are merged into this accumulator
+
+  \details The compactors of the same level are concatenated and compressed afterwards. Merging accumulators with different accuracy parameters throws a std::invalid_argument.
+*/
+template <class Observable>
+void QuantileAccumulator<Observable>::merge(const QuantileAccumulator<Observable>& other)
+{
+  if (other.k != k) throw std::invalid_argument("The accuracy parameters of the QuantileAccumulators do not match.");
+  if (other.measurement_count == 0) return;
+
+  if (measurement_count == 0 || other.minimum < minimum) minimum = other.minimum;
+  if (measurement_count == 0 || other.maximum > maximum) maximum = other.maximum;
+  measurement_count += other.measurement_count;
+
+  while (compactors.size() < other.compactors.size()) grow();
+  for (unsigned int level = 0; level < other.compactors.size(); ++level)
+  {
+    compactors[level].insert(compactors[level].end(), other.compactors[level].begin(), other.compactors[level].end());
+    retained_size += other.compactors[level].size();
+  }
+  while (retained_size >= maximal_size) compress();
+}
+
+template <class Observable>
+double QuantileAccumulator<Observable>::rank(const Observable& value) const
+{
+  if (measurement_count == 0) return 0.0;
+  const double x = static_cast<double>(value);
+  uint64_t weight_below = 0;
+  for (unsigned int level = 0; level < compactors.size(); ++level)
+    for (std::vector<double>::const_iterator item = compactors[level].begin(); item != compactors[level].end(); ++item)
+      if (*item <= x) weight_below += static_cast<uint64_t>(1) << level;
+  return static_cast<double>(weight_below) / static_cast<double>(measurement_count);
+}
+
+/*!
+  \param fraction Fraction of the measurements that are smaller or equal than the quantile, 0 gives the minimum and 1 the maximum
+  \returns Estimate of the quantile, the normalised rank of the result deviates from the fraction by at most rank_error_bound() with a probability of 99%
+*/
+template <class Observable>
+Observable QuantileAccumulator<Observable>::quantile(double fraction) const
+{
+  if (measurement_count == 0) return Observable();
+  if (fraction <= 0.0) return min();
+  if (fraction >= 1.0) return max();
+
+  std::vector<std::pair<double, uint64_t> > items;
+  weighted_items(items);
+
+  // The weights of the retained items add up to the number of measurements
+  uint64_t total_weight = 0;
+  for (unsigned int i = 0; i < items.size(); ++i) total_weight += items[i].second;
+  const double target = fraction * static_cast<double>(total_weight);
+  uint64_t cumulated_weight = 0;
+  for (unsigned int i = 0; i < items.size(); ++i)
+  {
+    cumulated_weight += items[i].second;
+    if (static_cast<double>(cumulated_weight) >= target) return static_cast<Observable>(items[i].first);
+  }
+  return max();
+}
+
+template <class Observable>
+unsigned int QuantileAccumulator<Observable>::capacity(unsigned int level) const
+{
+  const unsigned int depth = compactors.size() - level - 1;
+  return static_cast<unsigned int>(std::ceil(std::pow(2.0/3.0, static_cast<double>(depth)) * k)) + 1;
+}
+
+template <class Observable>
+void QuantileAccumulator<Observable>::grow()
+{
+  compactors.push_back(std::vector<double>());
+  maximal_size = 0;
+  for (unsigned int level = 0; level < compactors.size(); ++level)
+    maximal_size += capacity(level);
+}
+
+/*!
+  \details The lowest full compactor is sorted and every second item is moved to the next level. An odd item stays in the compactor, so the weights of the retained items always add up to the number of measurements. Further compactors are only compacted if the sketch is still too large (lazy compaction).
+*/
+template <class Observable>
+void QuantileAccumulator<Observable>::compress()
+{
+  for (unsigned int level = 0; level < compactors.size(); ++level)
+  {
+    if (compactors[level].size() < capacity(level)) continue;
+    if (level + 1 >= compactors.size()) grow();
+
+    std::vector<double>& compactor = compactors[level];
+    std::sort(compactor.begin(), compactor.end());
+
+    // Keep the last item of an odd number of items
+    bool has_odd_item = (compactor.size() % 2 == 1);
+    double odd_item = 0.0;
+    if (has_odd_item)
+    {
+      odd_item = compactor.back();
+      compactor.pop_back();
+    }
+
+    // Promote every second item starting at a random offset
+    std::vector<double>& next_compactor = compactors[level + 1];
+    for (unsigned int i = random_bit(); i < compactor.size(); i += 2)
+      next_compactor.push_back(compactor[i]);
+    retained_size -= compactor.size() / 2;
+    compactor.clear();
+    if (has_odd_item) compactor.push_back(odd_item);
+
+    if (retained_size < maximal_size) break;
+  }
+}
+
+template <class Observable>
+unsigned int QuantileAccumulator<Observable>::random_bit()
+{
+  random_state ^= random_state >> 12;
+  random_state ^= random_state << 25;
+  random_state ^= random_state >> 27;
+  return static_cast<unsigned int>((random_state * 2685821657736338717ull) >> 63);
+}
+
+template <class Observable>
+void QuantileAccumulator<Observable>::weighted_items(std::vector<std::pair<double, uint64_t> >& items) const
+{
+  items.clear();
+  items.reserve(retained_size);
+  for (unsigned int level = 0; level < compactors.size(); ++level)
+    for (std::vector<double>::const_iterator item = compactors[level].begin(); item != compactors[level].end(); ++item)
+      items.push_back(std::make_pair(*item, static_cast<uint64_t>(1) << level));
+  std::sort(items.begin(), items.end());
+}
+
+} // of namespace Accumulators
+} // of namespace Mocasinns
+
+#endif
@@ -9,6 +9,8 @@
 
 #ifdef MOCASINNS_ENTROPIC_SAMPLING_HPP
 
+#include <limits>
+
 namespace Mocasinns
 {
 
@@ -72,18 +74,24 @@ EntropicSampling<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGen
 
 template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
 double EntropicSampling<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGenerator>::acceptance_probability(StepType& step_to_execute, Details::Multicanonical::StepParameter<EnergyType>& step_parameters)
+{
+  return exp(log_acceptance_probability(step_to_execute, step_parameters));
+}
+
+template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
+double EntropicSampling<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGenerator>::log_acceptance_probability(StepType& step_to_execute, Details::Multicanonical::StepParameter<EnergyType>& step_parameters)
 {
   // Calculate the energy difference of the step
   step_parameters.delta_E = step_to_execute.delta_E();
   EnergyType total_energy_after_step = step_parameters.total_energy + step_parameters.delta_E;
 
-  // If an energy cutoff is used and the step would violate the energy cutoff, return 0.0
+  // If an energy cutoff is used and the step would violate the energy cutoff, return -infinity
   if ((simulation_parameters.use_energy_cutoff_upper && total_energy_after_step > simulation_parameters.energy_cutoff_upper) || 
       (simulation_parameters.use_energy_cutoff_lower && total_energy_after_step < simulation_parameters.energy_cutoff_lower))
-    return 0.0;
+    return -std::numeric_limits<double>::infinity();
 
-  // Calculate and return the acceptance probability
-  return exp(log_density_of_states[step_parameters.total_energy] - log_density_of_states[total_energy_after_step]);
+  // Calculate and return the logarithm of the acceptance probability
+  return log_density_of_states[step_parameters.total_energy] - log_density_of_states[total_energy_after_step];
 }
 
 template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
@@ -93,6 +101,9 @@ void EntropicSampling<ConfigurationType,StepType,EnergyType,HistoType,RandomNumb
   step_parameters.total_energy += step_parameters.delta_E;
   // Update the histograms
   incidence_counter[step_parameters.total_energy]++;
+
+  // Measure the microcanonical observable
+  if (microcanonical_measurement) microcanonical_measurement->step(incidence_counter.bin_value(step_parameters.total_energy), this->configuration_space);
 }
 
 template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
@@ -100,6 +111,9 @@ void EntropicSampling<ConfigurationType,StepType,EnergyType,HistoType,RandomNumb
 {
   // Update the histograms
   incidence_counter[step_parameters.total_energy]++;
+
+  // Measure the microcanonical observable
+  if (microcanonical_measurement) microcanonical_measurement->step(incidence_counter.bin_value(step_parameters.total_energy), this->configuration_space);
 }
 
 template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
@@ -120,8 +134,13 @@ void EntropicSampling<ConfigurationType,StepType,EnergyType,HistoType,RandomNumb
 
   while (flatness_current < simulation_parameters.flatness)
   {
+    // Return if the next sweep would not finish before the deadline
+    if (this->check_for_deadline(simulation_parameters.sweep_steps)) return;
+
     // Do a number of entropic sampling steps
+    this->wall_clock_budget.begin_work();
     do_entropic_sampling_steps(simulation_parameters.sweep_steps);
+    this->wall_clock_budget.end_work(simulation_parameters.sweep_steps);
 
     // Update the density of states
     for (typename HistoType<EnergyType,IncidenceCounterYValueType>::const_iterator it = incidence_counter.begin(); it != incidence_counter.end(); ++it)
@@ -205,10 +205,10 @@ void HistoBase<x_value_type,y_value_type,Derived>::initialise_empty(const HistoB
   // Clear all entries of this HistoBase
   clear();
 
-  // Enter all x-values
+  // Enter all x-values, they are sorted so every insertion happens at the end
   for (typename HistoBase<x_value_type, other_y_value_type, ArbitraryDerived>::const_iterator it = other.begin(); it != other.end(); ++it)
   {
-    values.insert(std::pair<x_value_type, y_value_type>(it->first, y_value_type(0)));
+    values.insert(values.end(), std::pair<x_value_type, y_value_type>(it->first, y_value_type(0)));
   }
 }
 
@@ -358,55 +358,75 @@ void HistoBase<x_value_type,y_value_type,Derived>::save_csv(const char* filename
 }
 
 template<class x_value_type, class y_value_type, class Derived>
-const Derived operator+(const Derived& lhs, const y_value_type& scalar)
+Derived operator+(const Derived& lhs, const y_value_type& scalar)
 {
-  return Derived(lhs) += scalar;
+  Derived result(lhs);
+  result += scalar;
+  return result;
 }
 template<class x_value_type, class y_value_type, class Derived>
-const Derived operator+(const y_value_type& scalar, const Derived& rhs)
+Derived operator+(const y_value_type& scalar, const Derived& rhs)
 {
-  return Derived(rhs) += scalar;
+  Derived result(rhs);
+  result += scalar;
+  return result;
 }
 template<class x_value_type, class y_value_type, class Derived>
-const Derived operator-(const Derived& lhs, const y_value_type& scalar)
+Derived operator-(const Derived& lhs, const y_value_type& scalar)
 {
-  return Derived(lhs) -= scalar;
+  Derived result(lhs);
+  result -= scalar;
+  return result;
 }
 template<class x_value_type, class y_value_type, class Derived>
-const Derived operator*(const Derived& lhs, const y_value_type& scalar)
+Derived operator*(const Derived& lhs, const y_value_type& scalar)
 {
-  return Derived(lhs) *= scalar;
+  Derived result(lhs);
+  result *= scalar;
+  return result;
 }
 template<class x_value_type, class y_value_type, class Derived>
-const Derived operator*(const y_value_type& scalar, const Derived& rhs)
+Derived operator*(const y_value_type& scalar, const Derived& rhs)
 {
-  return Derived(rhs) *= scalar;
+  Derived result(rhs);
+  result *= scalar;
+  return result;
 }
 template<class x_value_type, class y_value_type, class Derived>
-const Derived operator/(const Derived& lhs, const y_value_type& scalar)
+Derived operator/(const Derived& lhs, const y_value_type& scalar)
 {
-  return Derived(lhs) /= scalar;
+  Derived result(lhs);
+  result /= scalar;
+  return result;
 }
 
 template<class x_value_type, class y_value_type, class DerivedLeft, class DerivedRight>
-const DerivedLeft operator+(const HistoBase<x_value_type, y_value_type, DerivedLeft>& lhs, const HistoBase<x_value_type, y_value_type, DerivedRight>& rhs)
+DerivedLeft operator+(const HistoBase<x_value_type, y_value_type, DerivedLeft>& lhs, const HistoBase<x_value_type, y_value_type, DerivedRight>& rhs)
 {
-  return DerivedLeft(lhs) += rhs;
+  DerivedLeft result(lhs);
+  result += rhs;
+  return result;
 }
 template<class x_value_type, class y_value_type, class DerivedLeft, class DerivedRight>
-const DerivedLeft operator-(const HistoBase<x_value_type, y_value_type, DerivedLeft>& lhs, const HistoBase<x_value_type, y_value_type, DerivedRight>& rhs)
+DerivedLeft operator-(const HistoBase<x_value_type, y_value_type, DerivedLeft>& lhs, const HistoBase<x_value_type, y_value_type, DerivedRight>& rhs)
 {
-  return DerivedLeft(lhs) -= rhs;
+  DerivedLeft result(lhs);
+  result -= rhs;
+  return result;
 }
 template<class x_value_type, class y_value_type, class Derived>
-const Derived operator*(const HistoBase<x_value_type, y_value_type, Derived>& lhs, const HistoBase<x_value_type, y_value_type, Derived>& rhs)
+Derived operator*(const HistoBase<x_value_type, y_value_type, Derived>& lhs, const HistoBase<x_value_type, y_value_type, Derived>& rhs)
 {
-  return Derived(lhs) *= rhs;
+  Derived result(lhs);
+  result *= rhs;
+  return result;
 }
 template<class x_value_type, class y_value_type, class Derived>
-const Derived operator/(const HistoBase<x_value_type, y_value_type, Derived>& lhs, const HistoBase<x_value_type, y_value_type, Derived>& rhs)
+Derived operator/(const HistoBase<x_value_type, y_value_type, Derived>& lhs, const HistoBase<x_value_type, y_value_type, Derived>& rhs)
 {
-  return Derived(lhs) /= rhs;
+  Derived result(lhs);
+  result /= rhs;
+  return result;
 }
 
 template<class x_value_type, class y_value_type, class Derived>
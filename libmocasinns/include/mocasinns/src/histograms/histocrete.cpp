@@ -24,7 +24,7 @@ template<class other_y_value_type>
 void Histocrete<x_value_type, y_value_type>::initialise_empty(const Histocrete<x_value_type, other_y_value_type>& other)
 {
   // Call the according HistoBase-Function
-  Base::initialise_empty(static_cast<HistoBase<x_value_type, other_y_value_type, Histocrete<x_value_type, other_y_value_type> > >(other));
+  Base::initialise_empty(static_cast<const HistoBase<x_value_type, other_y_value_type, Histocrete<x_value_type, other_y_value_type> >&>(other));
   // Nothing else has to be done.
 }
 
@@ -24,11 +24,10 @@ template<class other_y_value_type>
 void Histogram<x_value_type, y_value_type, BinningFunctor>::initialise_empty(const Histogram<x_value_type, other_y_value_type, BinningFunctor>& other)
 {
   // Call the according HistoBase-Function
-  Base::initialise_empty(static_cast<HistoBase<x_value_type, other_y_value_type, Histogram<x_value_type, other_y_value_type, BinningFunctor> > >(other));
+  Base::initialise_empty(static_cast<const HistoBase<x_value_type, other_y_value_type, Histogram<x_value_type, other_y_value_type, BinningFunctor> >&>(other));
 
   // Copy the binning
-  set_binning_width(other.get_binning_width());
-  set_binning_reference(other.get_binning_reference());
+  set_binning(other.get_binning());
 }
 
 } // of namespace Histograms
@@ -0,0 +1,228 @@
+/*!
+ * \file kinetic_monte_carlo.cpp
+ * \brief Implementation of the continuous-time kinetic Monte-Carlo simulation
+ * 
+ * Usage examples are found in the test cases.
+ * 
+ * \author Benedikt Krüger
+ */
+
+#ifdef MOCASINNS_KINETIC_MONTE_CARLO_HPP
+
+#include <cmath>
+#include <algorithm>
+
+#include "../details/metropolis/vector_accumulator.hpp"
+
+namespace Mocasinns
+{
+
+/*!
+  \param step Step of which the transition rate is calculated
+  \param beta Inverse temperature
+  \returns The Metropolis or Glauber rate of the step multiplied by the attempt frequency, depending on the parameters
+*/
+template<class ConfigurationType, class Step, class RandomNumberGenerator>
+double KineticMonteCarlo<ConfigurationType, Step, RandomNumberGenerator>::rate(Step& step, double beta) const
+{
+  const double boltzmann_exponent = -beta*step.delta_E();
+  if (simulation_parameters.rate_type == glauber_rates)
+    return simulation_parameters.attempt_frequency / (1.0 + exp(-boltzmann_exponent));
+  else if (boltzmann_exponent >= 0.0)
+    return simulation_parameters.attempt_frequency;
+  else
+    return simulation_parameters.attempt_frequency * exp(boltzmann_exponent);
+}
+
+/*!
+  \param site Index of the site (between 0 and ConfigurationType::system_size() - 1)
+  \param beta Inverse temperature
+  \returns Sum of the rates of all steps returned by ConfigurationType::all_steps(site)
+*/
+template<class ConfigurationType, class Step, class RandomNumberGenerator>
+double KineticMonteCarlo<ConfigurationType, Step, RandomNumberGenerator>::site_rate(unsigned int site, double beta)
+{
+  std::vector<Step> site_steps = this->configuration_space->all_steps(site);
+  double result = 0.0;
+  for (typename std::vector<Step>::iterator step = site_steps.begin(); step != site_steps.end(); ++step)
+    result += rate(*step, beta);
+  return result;
+}
+
+template<class ConfigurationType, class Step, class RandomNumberGenerator>
+void KineticMonteCarlo<ConfigurationType, Step, RandomNumberGenerator>::initialise_rates(double beta)
+{
+  const unsigned int site_number = this->configuration_space->system_size();
+  rate_tree.resize(site_number);
+  for (unsigned int site = 0; site < site_number; ++site)
+    rate_tree.set_rate(site, site_rate(site, beta));
+}
+
+/*!
+  \details Chooses a site with probability proportional to its rate using the rate tree and one of the steps at this site with probability proportional to the rate of the step. After the step has been executed, the rates of the site and of its neighbours are updated.
+*/
+template<class ConfigurationType, class Step, class RandomNumberGenerator>
+void KineticMonteCarlo<ConfigurationType, Step, RandomNumberGenerator>::execute_event(double beta)
+{
+  // Choose the site
+  const unsigned int site = rate_tree.find(this->rng->random_double()*rate_tree.total_rate());
+
+  // Choose the step at the site
+  std::vector<Step> site_steps = this->configuration_space->all_steps(site);
+  double remaining_rate = this->rng->random_double()*rate_tree.get_rate(site);
+  typename std::vector<Step>::iterator chosen_step = site_steps.begin();
+  for (; chosen_step + 1 != site_steps.end(); ++chosen_step)
+  {
+    remaining_rate -= rate(*chosen_step, beta);
+    if (remaining_rate < 0.0) break;
+  }
+  chosen_step->execute();
+
+  // Update the rates of the changed site and its neighbours
+  rate_tree.set_rate(site, site_rate(site, beta));
+  std::vector<unsigned int> neighbours = this->configuration_space->neighbour_sites(site);
+  for (std::vector<unsigned int>::const_iterator neighbour = neighbours.begin(); neighbour != neighbours.end(); ++neighbour)
+    rate_tree.set_rate(*neighbour, site_rate(*neighbour, beta));
+}
+
+/*!
+  \details Draws exponentially distributed waiting times and executes events until the given time interval has passed. Because the waiting times are memoryless, the last waiting time that exceeds the interval is discarded and the physical time is set to the end of the interval. If the total rate vanishes (absorbing configuration), the time is advanced without executing events.
+*/
+template<class ConfigurationType, class Step, class RandomNumberGenerator>
+void KineticMonteCarlo<ConfigurationType, Step, RandomNumberGenerator>::evolve(double time, double beta)
+{
+  const double end_time = physical_time + time;
+  while (rate_tree.total_rate() > 0.0)
+  {
+    const double waiting_time = -log(1.0 - this->rng->random_double()) / rate_tree.total_rate();
+    if (physical_time + waiting_time > end_time) break;
+    physical_time += waiting_time;
+    execute_event(beta);
+  }
+  physical_time = end_time;
+}
+
+/*!
+  \param number Number of kinetic MC steps (executed events) that will be performed
+  \param beta Inverse temperature used for the calculation of the rates
+*/
+template<class ConfigurationType, class Step, class RandomNumberGenerator>
+void KineticMonteCarlo<ConfigurationType, Step, RandomNumberGenerator>::do_kinetic_monte_carlo_steps(const StepNumberType& number, double beta)
+{
+  initialise_rates(beta);
+  for (StepNumberType i = 0; i < number; ++i)
+  {
+    if (rate_tree.total_rate() <= 0.0) break;
+    physical_time += -log(1.0 - this->rng->random_double()) / rate_tree.total_rate();
+    execute_event(beta);
+  }
+}
+
+/*!
+  \param time Interval of physical time the configuration is evolved
+  \param beta Inverse temperature used for the calculation of the rates
+*/
+template<class ConfigurationType, class Step, class RandomNumberGenerator>
+void KineticMonteCarlo<ConfigurationType, Step, RandomNumberGenerator>::do_kinetic_monte_carlo_time(double time, double beta)
+{
+  initialise_rates(beta);
+  evolve(time, beta);
+}
+
+/*!
+  \tparam Observator Class with static function Observator::observe(ConfigurationType*) taking a pointer to the simulation and returning the value of a arbitrary observable. The class must contain a typedef ::observable_type classifying the return type of the functor.
+  \param beta Inverse temperature at which the simulation is performed.
+  \returns Vector containing the single measurements performed
+*/
+template<class ConfigurationType, class Step, class RandomNumberGenerator>
+template<class Observator>
+std::vector<typename Observator::observable_type> KineticMonteCarlo<ConfigurationType, Step, RandomNumberGenerator>::do_kinetic_monte_carlo_simulation(double beta)
+{
+  // Check the concept of the observator
+  BOOST_CONCEPT_ASSERT((Concepts::ObservatorConcept<Observator,ConfigurationType>));
+  // Check the concept of the observable
+  BOOST_CONCEPT_ASSERT((Concepts::ObservableConcept<typename Observator::observable_type>));
+
+  // Call the accumulator function using the VectorAccumulator
+  Details::Metropolis::VectorAccumulator<typename Observator::observable_type> measurements_accumulator;
+  do_kinetic_monte_carlo_simulation<Observator>(beta, measurements_accumulator);
+
+  // Return the plain data, the vector is moved out of the accumulator
+  return std::move(measurements_accumulator.internal_vector);
+}
+
+/*!
+ \details The configuration is evolved for Parameters::relaxation_time, afterwards Parameters::measurement_number measurements are taken, separated by Parameters::time_between_measurement of physical time. Since the configuration is constant between two events, each measurement observes the state of the system at the exact measurement time. If a wall clock budget is set (see Simulation::set_wall_clock_budget), the relaxation and the measurements are performed in intervals of Parameters::time_between_measurement and the simulation stops before an interval that would not finish before the deadline.
+ \tparam Observator Class with static function Observator::observe(ConfigurationType*) taking a pointer to the simulation and returning the value of an arbitrary observable. The class must contain a typedef ::observable_type classifying the return type of the functor.
+ \tparam Accumulator Class that accepts the observable in operator() and gathers the required informations about the observables (e.g. boost::accumulator)
+ \param beta Inverse temperature at which the simulation is performed
+ \param measurement_accumulator Reference to the accumulator that stores the simulation results
+*/
+template<class ConfigurationType, class Step, class RandomNumberGenerator>
+template<class Observator, class Accumulator>
+void KineticMonteCarlo<ConfigurationType, Step, RandomNumberGenerator>::do_kinetic_monte_carlo_simulation(double beta, Accumulator& measurement_accumulator)
+{
+  // Check the concept of the observator
+  BOOST_CONCEPT_ASSERT((Concepts::ObservatorConcept<Observator,ConfigurationType>));
+  // Check the concept of the observable
+  BOOST_CONCEPT_ASSERT((Concepts::ObservableConcept<typename Observator::observable_type>));
+  // Check the concept of the accumulator
+  BOOST_CONCEPT_ASSERT((Concepts::AccumulatorConcept<Accumulator, typename Observator::observable_type>));
+
+  // Calculate all rates once and relax the system
+  initialise_rates(beta);
+  const double relaxation_unit = (simulation_parameters.time_between_measurement > 0.0) ? simulation_parameters.time_between_measurement : simulation_parameters.relaxation_time;
+  for (double relaxed_time = 0.0; relaxed_time < simulation_parameters.relaxation_time; relaxed_time += relaxation_unit)
+  {
+    // The waiting times are memoryless, so the relaxation can be split into intervals at which the deadline is checked
+    const double time = std::min(relaxation_unit, simulation_parameters.relaxation_time - relaxed_time);
+    if (this->check_for_deadline(time)) return;
+    this->wall_clock_budget.begin_work();
+    evolve(time, beta);
+    this->wall_clock_budget.end_work(time);
+  }
+
+  // For each measurement, evolve the system, invoke the signal handler, take the measurement and check for posix signals
+  for (unsigned int m = 0; m < simulation_parameters.measurement_number; ++m)
+  {
+    // Stop if the evolution until the next measurement would not finish before the deadline
+    if (this->check_for_deadline(simulation_parameters.time_between_measurement)) return;
+    this->wall_clock_budget.begin_work();
+    evolve(simulation_parameters.time_between_measurement, beta);
+    this->wall_clock_budget.end_work(simulation_parameters.time_between_measurement);
+    signal_handler_measurement(this);
+    measurement_accumulator(Observator::observe(this->configuration_space));
+    if (this->check_for_posix_signal()) return;
+  }
+}
+
+template <class ConfigurationType, class Step, class RandomNumberGenerator>
+void KineticMonteCarlo<ConfigurationType, Step, RandomNumberGenerator>::load_serialize(std::istream& input_stream)
+{
+  boost::archive::text_iarchive input_archive(input_stream);
+  input_archive >> (*this);
+}
+template <class ConfigurationType, class Step, class RandomNumberGenerator>
+void KineticMonteCarlo<ConfigurationType, Step, RandomNumberGenerator>::load_serialize(const char* filename)
+{
+  std::ifstream input_filestream(filename);
+  load_serialize(input_filestream);
+  input_filestream.close();
+}
+template <class ConfigurationType, class Step, class RandomNumberGenerator>
+void KineticMonteCarlo<ConfigurationType, Step, RandomNumberGenerator>::save_serialize(std::ostream& output_stream) const
+{
+  boost::archive::text_oarchive output_archive(output_stream);
+  output_archive << (*this);
+}
+template <class ConfigurationType, class Step, class RandomNumberGenerator>
+void KineticMonteCarlo<ConfigurationType, Step, RandomNumberGenerator>::save_serialize(const char* filename) const
+{
+  std::ofstream output_filestream(filename);
+  save_serialize(output_filestream);
+  output_filestream.close();
+}
+
+} // of namespace Mocasinns
+
+#endif
@@ -12,6 +12,8 @@
 
 #include <iterator>
 #include <cmath>
+#include <exception>
+#include <omp.h>
 
 // Includes for boost accumulators
 #include <boost/accumulators/accumulators.hpp>
@@ -26,6 +28,65 @@ namespace ba = boost::accumulators;
 
 namespace Mocasinns
 {
+/*!
+  \details Without Parameters::detect_equilibration, Parameters::relaxation_steps steps are performed. Otherwise the energy is sampled every Parameters::equilibration_check_steps steps and passed to an Analysis::MserEquilibration detector, the relaxation stops as soon as the detector considers the energy series equilibrated, but after at most Parameters::relaxation_steps steps. The equilibration time is the MSER truncation point in steps, if the equilibration was not detected (or the energy is not a scalar) it is the number of performed relaxation steps.
+
+  If a wall clock budget is set (see Simulation::set_wall_clock_budget), the relaxation is performed in units of Parameters::steps_between_measurement steps (or Parameters::equilibration_check_steps steps with equilibration detection) and stops before a unit that would not finish before the deadline. The following measurements are skipped in this case.
+  \tparam TemperatureType Type of the inverse temperature, there must be an operator* defined this class and the energy type of the configuration.
+  \param beta Inverse temperature at which the relaxation is performed
+  \returns Equilibration time in steps
+*/
+template<class ConfigurationType, class Step, class RandomNumberGenerator>
+template<class TemperatureType>
+typename Metropolis<ConfigurationType, Step, RandomNumberGenerator>::StepNumberType Metropolis<ConfigurationType, Step, RandomNumberGenerator>::do_metropolis_relaxation(const TemperatureType& beta)
+{
+  typedef Details::Metropolis::EquilibrationValue<typename ObserveEnergy::observable_type> EquilibrationValueType;
+
+  equilibration_detected = false;
+  if (!simulation_parameters.detect_equilibration || !EquilibrationValueType::supported || simulation_parameters.equilibration_check_steps == 0)
+  {
+    // Relax in units of the measurement spacing, so that the deadline is checked during the relaxation
+    const StepNumberType unit = (simulation_parameters.steps_between_measurement > 0) ? simulation_parameters.steps_between_measurement : simulation_parameters.relaxation_steps;
+    StepNumberType performed_steps = 0;
+    while (performed_steps < simulation_parameters.relaxation_steps)
+    {
+      StepNumberType steps = unit;
+      if (steps > simulation_parameters.relaxation_steps - performed_steps) steps = simulation_parameters.relaxation_steps - performed_steps;
+      if (this->check_for_deadline(steps)) break;
+      this->wall_clock_budget.begin_work();
+      do_metropolis_steps(steps, beta);
+      this->wall_clock_budget.end_work(steps);
+      performed_steps += steps;
+    }
+    equilibration_time = performed_steps;
+    return equilibration_time;
+  }
+
+  // Sample the energy until the series is equilibrated or the maximal number of relaxation steps is reached
+  Analysis::MserEquilibration detector;
+  StepNumberType performed_steps = 0;
+  while (performed_steps < simulation_parameters.relaxation_steps)
+  {
+    StepNumberType steps = simulation_parameters.equilibration_check_steps;
+    if (steps > simulation_parameters.relaxation_steps - performed_steps) steps = simulation_parameters.relaxation_steps - performed_steps;
+    if (this->check_for_deadline(steps)) break;
+    this->wall_clock_budget.begin_work();
+    do_metropolis_steps(steps, beta);
+    this->wall_clock_budget.end_work(steps);
+    performed_steps += steps;
+
+    detector(EquilibrationValueType::value(ObserveEnergy::observe(this->configuration_space)));
+    if (detector.is_equilibrated(simulation_parameters.equilibration_minimal_batches))
+    {
+      equilibration_detected = true;
+      break;
+    }
+  }
+
+  equilibration_time = equilibration_detected ? detector.truncation_point()*simulation_parameters.equilibration_check_steps : performed_steps;
+  return equilibration_time;
+}
+
 /*!
   \fn std::vector<typename Observator::observable_type> Metropolis<ConfigurationType, Step, RandomNumberGenerator>::do_metropolis_simulation(const TemperatureType& beta)
   \tparam Observator Class with static function Observator::observe(ConfigurationType*) taking a pointer to the simulation and returning the value of a arbitrary observable. The class must contain a typedef ::observable_type classifying the return type of the functor.
@@ -46,8 +107,8 @@ std::vector<typename Observator::observable_type> Metropolis<ConfigurationType,
   Details::Metropolis::VectorAccumulator<typename Observator::observable_type> measurements_accumulator;
   do_metropolis_simulation<Observator>(beta, measurements_accumulator);
 
-  // Return the plain data
-  return measurements_accumulator.internal_vector;
+  // Return the plain data, the vector is moved out of the accumulator
+  return std::move(measurements_accumulator.internal_vector);
 }
 
 /*!  
@@ -70,12 +131,14 @@ std::vector<std::vector<typename Observator::observable_type> > Metropolis<Confi
   std::vector<std::vector<typename Observator::observable_type> > results;
   for (InputIterator beta = first_beta; beta != last_beta; ++beta)
   {
-    results.push_back(do_metropolis_simulation(*beta));
+    results.push_back(do_metropolis_simulation<Observator>(*beta));
     if (this->is_terminating) break;
   }
+  return results;
 }  
 
 /*!
+ \details With Parameters::adapt_measurement_spacing the number of steps between two measurements is adapted to the integrated autocorrelation time of the observable (of the energy, if the observable is not a scalar), which is estimated with a blocking analysis during the run, see Details::Metropolis::MeasurementSpacing. With Parameters::target_error the measurements continue until the error of the mean of the same value reaches the target or the step budget is exhausted, see Details::Metropolis::ErrorTarget. If a wall clock budget is set (see Simulation::set_wall_clock_budget), the measurements stop before the steps of the next measurement would exceed the deadline. With Parameters::measurement_worker_number the observables are evaluated on worker threads, see do_pipelined_measurements.
  \tparam Observator Class with static function Observator::observe(ConfigurationType*) taking a pointer to the simulation and returning the value of an arbitrary observable. The class must contain a typedef ::observable_type classifying the return type of the functor.
  \tparam Accumulator Class that accepts the observable in operator() and gathers the required informations about the observables (e.g. boost::accumulator)
  \tparam TemperatureType Type of the inverse temperature, there must be an operator* defined this class and the energy type of the configuration.
@@ -93,17 +156,95 @@ void Metropolis<ConfigurationType,Step,RandomNumberGenerator>::do_metropolis_sim
   // Check the concept of the accumulator
   BOOST_CONCEPT_ASSERT((Concepts::AccumulatorConcept<Accumulator, typename Observator::observable_type>));
 
- // Perform the relaxation steps
-  do_metropolis_steps(simulation_parameters.relaxation_steps, beta);
+  // Perform the relaxation steps
+  do_metropolis_relaxation(beta);
   
   // For each measurement, perform the steps, invoke the signal handler, take the measurement and check for posix signals
-  for (unsigned int m = 0; m < simulation_parameters.measurement_number; ++m)
+  Details::Metropolis::MeasurementSpacing<StepNumberType> measurement_spacing(simulation_parameters);
+  Details::Metropolis::ErrorTarget<StepNumberType> error_target(simulation_parameters);
+  MeasurementNumberType m = 0;
+  last_waiting_measurement_number = 0;
+  if (simulation_parameters.measurement_worker_number > 0)
+    m = do_pipelined_measurements<Observator>(beta, measurement_accumulator, measurement_spacing, error_target);
+  else while (!error_target.is_finished(m))
   {
-    do_metropolis_steps(simulation_parameters.steps_between_measurement, beta);
+    // Stop before the steps if they would not finish before the deadline
+    if (this->check_for_deadline(measurement_spacing.get_steps_between_measurement())) break;
+    this->wall_clock_budget.begin_work();
+    do_metropolis_steps(measurement_spacing.get_steps_between_measurement(), beta);
+    this->wall_clock_budget.end_work(measurement_spacing.get_steps_between_measurement());
+    error_target.add_steps(measurement_spacing.get_steps_between_measurement());
     signal_handler_measurement(this);
-    measurement_accumulator(Observator::observe(this->configuration_space));
-    if (this->check_for_posix_signal()) return;
+    const typename Observator::observable_type observable = Observator::observe(this->configuration_space);
+    measurement_accumulator(observable);
+    ++m;
+    measurement_spacing.template observe<ObserveEnergy>(observable, this->configuration_space);
+    error_target.template observe<ObserveEnergy>(observable, this->configuration_space);
+    if (this->check_for_posix_signal()) break;
+  }
+
+  last_steps_between_measurement = measurement_spacing.get_steps_between_measurement();
+  measurement_autocorrelation_time = measurement_spacing.get_autocorrelation_time();
+  last_measurement_number = m;
+  last_error_of_mean = error_target.get_blocking().error_of_mean();
+}
+
+/*!
+ \details For expensive observables the measurements are pipelined: At every measurement the configuration is copied into a preallocated snapshot of a Details::Metropolis::MeasurementPipeline and the steps continue immediately, while Parameters::measurement_worker_number worker threads of an OpenMP parallel region evaluate the observator on the snapshots and pass the results to the accumulator in the order of the measurements. If all Parameters::measurement_slot_number snapshots are still waiting for evaluation, the stepping thread evaluates snapshots itself until the oldest slot is free. If the parallel region gets no additional threads (e.g. in nested parallel regions of MetropolisParallel), all snapshots are evaluated by the stepping thread.
+
+ Since the observable is not known at the time of the measurement, the adaptation of the measurement spacing and the target error use the energy of the configuration. The observator is called concurrently on different snapshots and must not modify shared state, the signal handler and the accumulator are only called by one thread at a time. An exception of the steps or the signal handler finishes the pipeline, the snapshots taken so far are evaluated and the exception is rethrown after the parallel region. An exception of the observator or the accumulator fails the pipeline, the stepping thread stops taking snapshots, all threads leave the parallel region and the exception is rethrown afterwards.
+ \returns Number of measurements taken
+*/
+template<class ConfigurationType, class Step, class RandomNumberGenerator>
+template<class Observator, class Accumulator, class TemperatureType>
+typename Metropolis<ConfigurationType,Step,RandomNumberGenerator>::MeasurementNumberType Metropolis<ConfigurationType,Step,RandomNumberGenerator>::do_pipelined_measurements(const TemperatureType& beta, Accumulator& measurement_accumulator, Details::Metropolis::MeasurementSpacing<StepNumberType>& measurement_spacing, Details::Metropolis::ErrorTarget<StepNumberType>& error_target)
+{
+  const unsigned int worker_number = simulation_parameters.measurement_worker_number;
+  const unsigned int slot_number = (simulation_parameters.measurement_slot_number > 0) ? simulation_parameters.measurement_slot_number : 2*worker_number;
+  Details::Metropolis::MeasurementPipeline<ConfigurationType, Observator, Accumulator> pipeline(*this->configuration_space, slot_number, measurement_accumulator);
+
+  MeasurementNumberType m = 0;
+  // Exceptions must not leave the parallel region, they are rethrown after the workers have returned
+  std::exception_ptr stepping_exception;
+#pragma omp parallel num_threads(worker_number + 1) shared(pipeline) shared(m) shared(stepping_exception)
+  {
+    if (omp_get_thread_num() == 0)
+    {
+      try
+      {
+	while (!error_target.is_finished(m))
+	{
+	  // Stop before the steps if they would not finish before the deadline
+	  if (this->check_for_deadline(measurement_spacing.get_steps_between_measurement())) break;
+	  this->wall_clock_budget.begin_work();
+	  do_metropolis_steps(measurement_spacing.get_steps_between_measurement(), beta);
+	  this->wall_clock_budget.end_work(measurement_spacing.get_steps_between_measurement());
+	  error_target.add_steps(measurement_spacing.get_steps_between_measurement());
+	  signal_handler_measurement(this);
+	  pipeline.submit(*this->configuration_space);
+	  ++m;
+	  const typename ObserveEnergy::observable_type energy = ObserveEnergy::observe(this->configuration_space);
+	  measurement_spacing.template observe<ObserveEnergy>(energy, this->configuration_space);
+	  error_target.template observe<ObserveEnergy>(energy, this->configuration_space);
+	  if (this->check_for_posix_signal()) break;
+	  // Stop taking snapshots if the observator of a worker has thrown
+	  if (pipeline.is_failed()) break;
+	}
+      }
+      catch (...)
+      {
+	stepping_exception = std::current_exception();
+      }
+      // The workers only return after the pipeline is finished
+      pipeline.finish();
+    }
+    else pipeline.work();
   }
+
+  last_waiting_measurement_number = pipeline.get_waiting_number();
+  if (stepping_exception) std::rethrow_exception(stepping_exception);
+  if (pipeline.get_exception()) std::rethrow_exception(pipeline.get_exception());
+  return m;
 }
 
 /*!
@@ -162,7 +303,7 @@ std::vector<typename Observator::observable_type> Metropolis<ConfigurationType,
   BOOST_CONCEPT_ASSERT((Concepts::ObservableConcept<typename Observator::observable_type>));
 
   // Do the relaxation steps
-  do_metropolis_steps(simulation_parameters.relaxation_steps, beta);
+  do_metropolis_relaxation(beta);
 
   // Define the vector with the results
   std::vector<typename Observator::observable_type> results;
@@ -10,6 +10,8 @@
 #ifdef MOCASINNS_METROPOLIS_PARALLEL_HPP
 
 #include <cmath>
+#include <exception>
+#include <iterator>
 #include <omp.h>
 
 namespace Mocasinns
@@ -35,7 +37,7 @@ std::vector<typename Observator::observable_type> MetropolisParallel<Configurati
   do_parallel_metropolis_simulation<Observator>(beta, measurements_accumulator);
 
   // Return the plain data
-  return measurements_accumulator.internal_vector;
+  return std::move(measurements_accumulator.internal_vector);
 }
 
 /*!  
@@ -55,13 +57,16 @@ std::vector<std::vector<typename Observator::observable_type> > MetropolisParall
   // Check the concept of the observable
   BOOST_CONCEPT_ASSERT((Concepts::ObservableConcept<typename Observator::observable_type>));
 
+  // Use one VectorAccumulator for every temperature, so that all temperatures are simulated in one task pool
+  std::vector<Details::Metropolis::VectorAccumulator<typename Observator::observable_type> > measurements_accumulators(std::distance(first_beta, last_beta));
+  do_parallel_metropolis_simulation<Observator>(first_beta, last_beta, measurements_accumulators.begin(), measurements_accumulators.end());
+
+  // Return the plain data
   std::vector<std::vector<typename Observator::observable_type> > results;
-  for (InputIterator beta = first_beta; beta != last_beta; ++beta)
-  {
-    results.push_back(do_parallel_metropolis_simulation(*beta));
-    if (this->is_terminating) break;
-  }
-}  
+  for (unsigned int i = 0; i < measurements_accumulators.size(); ++i)
+    results.push_back(std::move(measurements_accumulators[i].internal_vector));
+  return results;
+}
 
 /*!
  \tparam Observator Class with static function Observator::observe(ConfigurationType*) taking a pointer to the simulation and returning the value of an arbitrary observable. The class must contain a typedef ::observable_type classifying the return type of the functor.
@@ -81,67 +86,273 @@ void MetropolisParallel<ConfigurationType,Step,RandomNumberGenerator>::do_parall
   // Check the concept of the accumulator
   BOOST_CONCEPT_ASSERT((Concepts::AccumulatorConcept<Accumulator, typename Observator::observable_type>));
 
-  // Perform a parallel for-loop for the different runs
+  // Simulate the single temperature as a range of length one
+  do_parallel_metropolis_simulation<Observator>(&beta, &beta + 1, &measurement_accumulator, &measurement_accumulator + 1);
+}
+
+/*!
+ \tparam Observator Class with static function Observator::observe(ConfigurationType*) taking a pointer to the simulation and returning the value of an arbitrary observable. The class must contain a typedef ::observable_type classifying the return type of the functor.
+ \tparam AccumulatorIterator Iterator of a container of a class that accepts the observable in operator() and gathers the required informations about the observables (e.g. boost::accumulator)
+ \tparam InverseTemperatureIterator  Iterator of a container of a type of the inverse temperature, there must be an operator* defined this class and the energy type of the configuration.
+ \param beta_begin Iterator pointing to the first inverse temperature that is calculated
+ \param beta_end Iterator pointing on position after the last inverse temperature that is calculated
+ \param measurement_accumulator_begin Iterator pointing to the first accumulator that calculates the data for the first inverse temperature.
+ \param measurement_accumulator_end Iterator pointing one position after the last accumulator that calculates the data for the last inverse temperature
+ \details All pairs of inverse temperature and run are flattened into one pool of tasks that is distributed over the threads by a Parallel::WorkStealingScheduler, so there is no barrier between the temperatures and a thread that has finished its runs takes runs of other threads. Task number t belongs to the temperature t / run_number and the run t % run_number, the measurements of a run are routed to the accumulator of its temperature. Every accumulator has its own lock, so runs at different temperatures do not wait for each other when storing measurements.
+
+ If Parameters::deterministic is set, every run writes its measurements into its own buffer instead of the shared accumulator. The buffers are merged into the accumulators in the order of the tasks (temperature by temperature, run by run): whenever a run finishes, all finished runs following the last merged one are merged and their buffers are freed. Since the random number generator of a run only depends on the seed and the run number, the accumulators receive the same measurements in the same order for every number of threads, so also order-sensitive accumulators give bit-identical results.
+
+ If the accumulators can be merged (Accumulators::MomentsAccumulator, Accumulators::QuantileAccumulator, Accumulators::CorrelatorAccumulator), every run accumulates its measurements into its own accumulator, which is merged into the accumulator of the temperature at the end of the run (see Details::Metropolis::RunBuffer). Thus the shared accumulator is locked once per run instead of once per measurement, and the deterministic mode does not need to store the single measurements.
+
+ The equilibration time of every run (see Metropolis::do_metropolis_relaxation) is stored and can be read with get_equilibration_times(). With Parameters::adapt_measurement_spacing every run adapts its measurement spacing independently, as in Metropolis::do_metropolis_simulation.
+
+ With Parameters::target_error the runs of one temperature publish their numbers of measurements and their errors of the mean (estimated by a blocking analysis) to a shared Details::Metropolis::RunStatistics, and all runs of the temperature stop as soon as the combined error of the mean reaches the target (or their step budget is exhausted). Runs that are not scheduled yet count as missing runs with the statistics of the published runs, so every run takes about its share of the measurements. Thus the runs at temperatures with small fluctuations and short correlation times finish early and their threads continue with the runs of the remaining temperatures. In the deterministic mode the stopping decision must not depend on the timing of the other runs, therefore every run stops when its own error reaches the target times the square root of Parameters::run_number. The numbers of measurements of the runs can be read with get_measurement_numbers().
+
+ If a wall clock budget is set (see Simulation::set_wall_clock_budget), no further run is started when the predicted duration of a run (averaged over the finished runs) would exceed the deadline. The measurements of the finished runs are in the accumulators and a checkpoint is written, the dropped runs keep zero measurements. If the checkpoint cannot be written, the std::runtime_error of Simulation::write_checkpoint is thrown after the finished runs were merged.
+
+ Every thread of the parallel region is pinned to a processor (if Parameters::pin_threads is set) before it creates the configurations, the simulations and the random number generators of its runs, so that their memory is allocated and first touched on the NUMA node the thread runs on. The threads are distributed round-robin over the NUMA nodes, their affinity is restored at the end of the parallel region.
+*/
+template<class ConfigurationType, class Step, class RandomNumberGenerator>
+template<class Observator, class AccumulatorIterator, class InverseTemperatureIterator>
+void MetropolisParallel<ConfigurationType,Step,RandomNumberGenerator>::do_parallel_metropolis_simulation(InverseTemperatureIterator beta_begin, InverseTemperatureIterator beta_end, AccumulatorIterator measurement_accumulator_begin, AccumulatorIterator measurement_accumulator_end)
+{  
+  // Check the concept of the observator
+  BOOST_CONCEPT_ASSERT((Concepts::ObservatorConcept<Observator,ConfigurationType>));
+  // Check the concept of the observable
+  BOOST_CONCEPT_ASSERT((Concepts::ObservableConcept<typename Observator::observable_type>));  
+  // Check the concept of the accumulator
+  BOOST_CONCEPT_ASSERT((Concepts::AccumulatorConcept<typename std::iterator_traits<AccumulatorIterator>::value_type, typename Observator::observable_type>));
+
+  typedef typename std::iterator_traits<InverseTemperatureIterator>::value_type TemperatureType;
+  typedef typename std::iterator_traits<AccumulatorIterator>::value_type Accumulator;
+  typedef Details::Metropolis::RunBuffer<typename Observator::observable_type, Accumulator> RunBufferSelector;
+  typedef typename RunBufferSelector::type RunBuffer;
+
+  // Copy the temperatures and the addresses of the accumulators, so that every task can be routed to its accumulator
+  std::vector<TemperatureType> betas;
+  std::vector<Accumulator*> measurement_accumulators;
+  InverseTemperatureIterator beta_iterator = beta_begin;
+  AccumulatorIterator measurement_accumulator_iterator = measurement_accumulator_begin;
+  for (; beta_iterator != beta_end && measurement_accumulator_iterator != measurement_accumulator_end; ++beta_iterator, ++measurement_accumulator_iterator)
+  {
+    betas.push_back(*beta_iterator);
+    measurement_accumulators.push_back(&(*measurement_accumulator_iterator));
+  }
+  std::vector<omp_lock_t> measurement_accumulator_locks(measurement_accumulators.size());
+  for (unsigned int i = 0; i < measurement_accumulator_locks.size(); ++i)
+    omp_init_lock(&measurement_accumulator_locks[i]);
+
+  // Create the pool of tasks, one for every pair of temperature and run
+  const RunNumberType run_number = simulation_parameters.run_number;
+  const unsigned int task_number = betas.size()*run_number;
+  Parallel::WorkStealingScheduler scheduler(task_number, simulation_parameters.process_number);
+
+  // Reset the equilibration times, runs dropped due to termination keep zero
+  equilibration_times.assign(betas.size(), std::vector<StepNumberType>(run_number, 0));
+
+  // Statistics of the runs of every temperature, used for the target error
+  std::vector<Details::Metropolis::RunStatistics*> run_statistics;
+  for (unsigned int i = 0; i < betas.size(); ++i)
+    run_statistics.push_back(new Details::Metropolis::RunStatistics(run_number));
+
+  // Buffers of the finished runs in the deterministic mode and the next task to merge
+  std::vector<RunBuffer*> run_buffers(simulation_parameters.deterministic ? task_number : 0, static_cast<RunBuffer*>(0));
+  unsigned int next_merged_task = 0;
+
+  // Detect the processors of the NUMA nodes before any thread is pinned
+  const Parallel::NumaTopology topology;
+
+  // Exceptions must not leave the parallel region (e.g. if the checkpoint at the deadline cannot be written), the first one is rethrown after the cleanup
+  std::exception_ptr deadline_exception;
+
   // The signal handlers and the simulation parameters need not to be shared, because class members are allways shared
   omp_set_num_threads(simulation_parameters.process_number);
-#pragma omp parallel for shared(measurement_accumulator) shared(beta)
-  for (unsigned int run = 0; run < simulation_parameters.run_number; ++run)
+#pragma omp parallel shared(betas) shared(measurement_accumulators) shared(measurement_accumulator_locks) shared(scheduler) shared(topology) shared(run_buffers) shared(next_merged_task) shared(run_statistics) shared(deadline_exception)
   {
-    // Forward declare a pointer for the configuration and the simulation
-    ConfigurationType* copied_configuration;
-    Metropolis<ConfigurationType, Step, RandomNumberGenerator>* run_simulation;
-#pragma omp critical
-    {
-      // Copy a configuration from the initial one
-      copied_configuration = new ConfigurationType(*(this->get_config_space()));
-      // Create the new configuration
-      run_simulation = new Metropolis<ConfigurationType, Step, RandomNumberGenerator>(simulation_parameters, copied_configuration);
-    }
-    
-    // Set the seed of the simulation to the seed of this simulation plus the run number
-    run_simulation->set_random_seed(this->get_random_seed() + run);
-
-    // Perform the relaxation steps
-    run_simulation->do_metropolis_steps(simulation_parameters.relaxation_steps, beta);
+    // Pin the thread before it allocates the data of its runs
+    Parallel::ScopedThreadPinning* pinning = 0;
+    if (simulation_parameters.pin_threads)
+      pinning = new Parallel::ScopedThreadPinning(topology.thread_cpu(omp_get_thread_num(), omp_get_num_threads()));
 
-    // For each measurement, perform the steps, invoke the signal handler, take the measurement and check for posix signals
-    for (unsigned int m = 0; m < simulation_parameters.measurement_number && !this->check_for_posix_signal(); ++m)
+    // Take tasks from the own queue or steal them from the other threads until all are done
+    unsigned int task;
+    while (scheduler.next_task(omp_get_thread_num(), task))
     {
-      run_simulation->do_metropolis_steps(simulation_parameters.steps_between_measurement, beta);
+      // Drop the remaining tasks if the simulation is terminating or if the next run would not finish before the deadline
+      // The exception must be caught inside the critical section, it must not leave the structured block
+      bool terminating;
+#pragma omp critical
+      {
+	try
+	{
+	  terminating = this->is_terminating || this->check_for_deadline(1.0);
+	}
+	catch (...)
+	{
+	  if (!deadline_exception) deadline_exception = std::current_exception();
+	  terminating = true;
+	}
+      }
+      if (terminating) continue;
 
- #pragma omp critical
+      const unsigned int beta_index = task / run_number;
+      if (!simulation_parameters.deterministic && RunBufferSelector::mergeable)
+      {
+	// Accumulate the run into its own accumulator and merge it, so the shared accumulator is locked only once per run
+	RunBuffer run_buffer(RunBufferSelector::create(*measurement_accumulators[beta_index], task));
+	equilibration_times[beta_index][task % run_number] = do_run<Observator>(betas[beta_index], task % run_number, run_buffer, 0, run_statistics[beta_index]);
+	omp_set_lock(&measurement_accumulator_locks[beta_index]);
+	RunBufferSelector::merge(run_buffer, *measurement_accumulators[beta_index]);
+	omp_unset_lock(&measurement_accumulator_locks[beta_index]);
+	continue;
+      }
+      if (!simulation_parameters.deterministic)
       {
-	signal_handler_measurement(this);
-	measurement_accumulator(Observator::observe(run_simulation->get_config_space()));
+	equilibration_times[beta_index][task % run_number] = do_run<Observator>(betas[beta_index], task % run_number, *measurement_accumulators[beta_index], &measurement_accumulator_locks[beta_index], run_statistics[beta_index]);
+	continue;
+      }
+
+      // Perform the run into its own buffer and merge all finished runs that are next in the order of the tasks
+      RunBuffer* run_buffer = new RunBuffer(RunBufferSelector::create(*measurement_accumulators[beta_index], task));
+      equilibration_times[beta_index][task % run_number] = do_run<Observator>(betas[beta_index], task % run_number, *run_buffer, 0, run_statistics[beta_index]);
+#pragma omp critical (mocasinns_metropolis_parallel_merge)
+      {
+	run_buffers[task] = run_buffer;
+	for (; next_merged_task < task_number && run_buffers[next_merged_task] != 0; ++next_merged_task)
+	{
+	  RunBufferSelector::merge(*run_buffers[next_merged_task], *measurement_accumulators[next_merged_task / run_number]);
+	  delete run_buffers[next_merged_task];
+	}
       }
     }
-    
+
+    // Restore the affinity of the thread
+    delete pinning;
+  }
+
+  // Merge the runs that are left behind runs dropped due to termination
+  for (; next_merged_task < run_buffers.size(); ++next_merged_task)
+  {
+    if (run_buffers[next_merged_task] == 0) continue;
+    RunBufferSelector::merge(*run_buffers[next_merged_task], *measurement_accumulators[next_merged_task / run_number]);
+    delete run_buffers[next_merged_task];
+  }
+
+  for (unsigned int i = 0; i < measurement_accumulator_locks.size(); ++i)
+    omp_destroy_lock(&measurement_accumulator_locks[i]);
+
+  measurement_numbers.assign(betas.size(), std::vector<unsigned long>(run_number, 0));
+  for (unsigned int i = 0; i < betas.size(); ++i)
+  {
+    for (RunNumberType run = 0; run < run_number; ++run)
+      measurement_numbers[i][run] = run_statistics[i]->get_count(run);
+    delete run_statistics[i];
+  }
+  stolen_run_number = scheduler.get_stolen_task_number();
+
+  if (deadline_exception) std::rethrow_exception(deadline_exception);
+}
+
+/*!
+ \tparam Observator Class with static function Observator::observe(ConfigurationType*) taking a pointer to the simulation and returning the value of an arbitrary observable. The class must contain a typedef ::observable_type classifying the return type of the functor.
+ \tparam Accumulator Class that accepts the observable in operator() and gathers the required informations about the observables (e.g. boost::accumulator)
+ \tparam TemperatureType Type of the inverse temperature, there must be an operator* defined this class and the energy type of the configuration.
+ \param beta Inverse temperature at which the run is performed
+ \param run Number of the run, the seed of the run is the seed of this simulation plus the run number
+ \param measurement_accumulator Reference to the accumulator that stores the measurements of the run
+ \param measurement_accumulator_lock Lock that must be held while the accumulator is used, 0 if the accumulator is used by this run only
+ \param run_statistics Statistics of the runs at this temperature, the run publishes its number of measurements and its error of the mean after every measurement with Parameters::target_error and once after the measurements otherwise. If it is given and the simulation is not deterministic, the run stops as soon as the combined error of all runs reaches Parameters::target_error. Otherwise every run has to reach the target error times the square root of Parameters::run_number on its own.
+ \returns Equilibration time of the run (see Metropolis::do_metropolis_relaxation)
+*/
+template<class ConfigurationType, class Step, class RandomNumberGenerator>
+template<class Observator, class Accumulator, class TemperatureType>
+typename MetropolisParallel<ConfigurationType,Step,RandomNumberGenerator>::StepNumberType MetropolisParallel<ConfigurationType,Step,RandomNumberGenerator>::do_run(const TemperatureType& beta, RunNumberType run, Accumulator& measurement_accumulator, omp_lock_t* measurement_accumulator_lock, Details::Metropolis::RunStatistics* run_statistics)
+{
+  const double run_start = Details::Simulation::WallClockBudget::now();
+
+  // Copy the configuration from the initial one on this thread (first touch)
+  ConfigurationType* copied_configuration = new ConfigurationType(*(this->get_config_space()));
+  // Create the new simulation and its random number generator on this thread
+  Metropolis<ConfigurationType, Step, RandomNumberGenerator>* run_simulation;
 #pragma omp critical
-    {
-      // Call the signal handler for run finishing
-      if (!this->is_terminating)
-	signal_handler_run(this);
+  run_simulation = new Metropolis<ConfigurationType, Step, RandomNumberGenerator>(simulation_parameters, copied_configuration);
+  
+  // Set the seed of the simulation to the seed of this simulation plus the run number
+  run_simulation->set_random_seed(this->get_random_seed() + run);
+
+  // Perform the relaxation steps and remember the equilibration time
+  const StepNumberType equilibration_time = run_simulation->do_metropolis_relaxation(beta);
+
+  // For each measurement, perform the steps, invoke the signal handler, take the measurement and check for posix signals
+  Details::Metropolis::MeasurementSpacing<StepNumberType> measurement_spacing(simulation_parameters);
+  const bool combine_runs = (run_statistics != 0) && !simulation_parameters.deterministic;
+  Details::Metropolis::ErrorTarget<StepNumberType> error_target(simulation_parameters, combine_runs ? 1.0 : std::sqrt(static_cast<double>(simulation_parameters.run_number)));
+  double variance_of_mean = 0.0;
+  unsigned long m = 0;
+  for (; !error_target.is_finished(m, variance_of_mean) && !this->check_for_posix_signal(); )
+  {
+    run_simulation->do_metropolis_steps(measurement_spacing.get_steps_between_measurement(), beta);
+    error_target.add_steps(measurement_spacing.get_steps_between_measurement());
+
+#pragma omp critical
+    signal_handler_measurement(this);
+
+    // Observe outside of the lock, only the accumulation must be protected
+    const typename Observator::observable_type observable = Observator::observe(run_simulation->get_config_space());
+    if (measurement_accumulator_lock) omp_set_lock(measurement_accumulator_lock);
+    measurement_accumulator(observable);
+    if (measurement_accumulator_lock) omp_unset_lock(measurement_accumulator_lock);
+    ++m;
+    measurement_spacing.template observe<typename MetropolisSerial::ObserveEnergy>(observable, run_simulation->get_config_space());
+    error_target.template observe<typename MetropolisSerial::ObserveEnergy>(observable, run_simulation->get_config_space());
+
+    // Without target error the number of measurements is fixed, so the statistics are published only once after the measurements and the lock is not taken for every measurement
+    if (!error_target.is_active()) continue;
 
-      // Delete the created configuration and the simulation
-      delete run_simulation->get_config_space();
-      delete run_simulation;
+    // Publish the statistics of this run and decide on the own or the combined error
+    variance_of_mean = error_target.get_blocking().variance_of_mean();
+    if (run_statistics)
+    {
+      const double combined_variance_of_mean = run_statistics->publish(run, m, variance_of_mean);
+      if (combine_runs) variance_of_mean = combined_variance_of_mean;
     }
   }
+  if (run_statistics && !error_target.is_active())
+    run_statistics->publish(run, m, variance_of_mean);
+  
+#pragma omp critical
+  {
+    // Call the signal handler for run finishing
+    if (!this->is_terminating)
+      signal_handler_run(this);
+
+    // Time the run for the prediction of the wall clock budget
+    this->wall_clock_budget.add_timing(1.0, Details::Simulation::WallClockBudget::now() - run_start);
+
+    // Delete the created configuration and the simulation
+    delete run_simulation->get_config_space();
+    delete run_simulation;
+  }
+
+  return equilibration_time;
 }
 
 /*!
- \tparam Observator Class with static function Observator::observe(ConfigurationType*) taking a pointer to the simulation and returning the value of an arbitrary observable. The class must contain a typedef ::observable_type classifying the return type of the functor.
+ \tparam Observator Class with static function Observator::observe(ConfigurationType*) taking a pointer to the simulation and returning the value of an arbitrary observable. The class must contain a typedef ::observable_type classifying the return type of the functor, the observable type must be serializable with boost::serialization.
  \tparam AccumulatorIterator Iterator of a container of a class that accepts the observable in operator() and gathers the required informations about the observables (e.g. boost::accumulator)
  \tparam InverseTemperatureIterator  Iterator of a container of a type of the inverse temperature, there must be an operator* defined this class and the energy type of the configuration.
+ \param coordinator Coordinator the workers are connected to, a TCP coordinator listens on the loopback interface unless it was created with another bind address (see Parallel::DistributedCoordinator)
  \param beta_begin Iterator pointing to the first inverse temperature that is calculated
  \param beta_end Iterator pointing on position after the last inverse temperature that is calculated
  \param measurement_accumulator_begin Iterator pointing to the first accumulator that calculates the data for the first inverse temperature.
  \param measurement_accumulator_end Iterator pointing one position after the last accumulator that calculates the data for the last inverse temperature
+ \param local_worker_number Number of worker processes that are forked on this machine before the simulation starts (e.g. for testing), if it is not zero the function must not be called inside an active OpenMP parallel region (see Parallel::DistributedCoordinator::spawn_local_workers)
+ \details Every pair of inverse temperature and run is a task of the coordinator (task t belongs to the temperature t / run_number and the run t % run_number). The workers call serve_distributed_metropolis_simulation with the same temperatures, parameters, initial configuration, seed and accumulators, perform the runs and send back the serialized run buffers (see Details::Metropolis::RunBuffer). For mergeable accumulators (Accumulators::MomentsAccumulator, Accumulators::QuantileAccumulator, Accumulators::CorrelatorAccumulator) the run buffer is an accumulator of the run, so the size of the results does not grow with the number of measurements, for other accumulators it contains the single measurements. The run buffers are merged into the accumulators in the order of the tasks, so the result does not depend on the number of workers or on the order in which the results arrive. A machine with several processors should run several worker processes.
 */
 template<class ConfigurationType, class Step, class RandomNumberGenerator>
 template<class Observator, class AccumulatorIterator, class InverseTemperatureIterator>
-void MetropolisParallel<ConfigurationType,Step,RandomNumberGenerator>::do_parallel_metropolis_simulation(InverseTemperatureIterator beta_begin, InverseTemperatureIterator beta_end, AccumulatorIterator measurement_accumulator_begin, AccumulatorIterator measurement_accumulator_end)
-{  
+void MetropolisParallel<ConfigurationType,Step,RandomNumberGenerator>::do_distributed_metropolis_simulation(Parallel::DistributedCoordinator& coordinator, InverseTemperatureIterator beta_begin, InverseTemperatureIterator beta_end, AccumulatorIterator measurement_accumulator_begin, AccumulatorIterator measurement_accumulator_end, unsigned int local_worker_number)
+{
   // Check the concept of the observator
   BOOST_CONCEPT_ASSERT((Concepts::ObservatorConcept<Observator,ConfigurationType>));
   // Check the concept of the observable
@@ -149,15 +360,86 @@ void MetropolisParallel<ConfigurationType,Step,RandomNumberGenerator>::do_parall
   // Check the concept of the accumulator
   BOOST_CONCEPT_ASSERT((Concepts::AccumulatorConcept<typename std::iterator_traits<AccumulatorIterator>::value_type, typename Observator::observable_type>));
 
+  typedef typename std::iterator_traits<InverseTemperatureIterator>::value_type TemperatureType;
+  std::vector<TemperatureType> betas;
+  std::vector<AccumulatorIterator> measurement_accumulators;
   InverseTemperatureIterator beta_iterator = beta_begin;
   AccumulatorIterator measurement_accumulator_iterator = measurement_accumulator_begin;
-  for (; beta_iterator != beta_end; ++beta_iterator, ++measurement_accumulator_iterator)
+  for (; beta_iterator != beta_end && measurement_accumulator_iterator != measurement_accumulator_end; ++beta_iterator, ++measurement_accumulator_iterator)
+  {
+    betas.push_back(*beta_iterator);
+    measurement_accumulators.push_back(measurement_accumulator_iterator);
+  }
+
+  // Fork the local workers and distribute the runs
+  if (local_worker_number > 0)
+    coordinator.spawn_local_workers(local_worker_number, DistributedLocalWorker<Observator, TemperatureType, AccumulatorIterator>(this, betas, measurement_accumulator_begin, measurement_accumulator_end));
+  std::vector<std::string> results;
+  coordinator.run(betas.size()*simulation_parameters.run_number, results);
+
+  // Merge the run buffers in the order of the tasks
+  typedef Details::Metropolis::RunBuffer<typename Observator::observable_type, typename std::iterator_traits<AccumulatorIterator>::value_type> RunBufferSelector;
+  for (unsigned int task = 0; task < results.size(); ++task)
   {
-    do_parallel_metropolis_simulation<Observator>(*beta_iterator, *measurement_accumulator_iterator);
-    if (this->is_terminating) break;
+    const unsigned int beta_index = task / simulation_parameters.run_number;
+    typename RunBufferSelector::type run_buffer(RunBufferSelector::create(*measurement_accumulators[beta_index], task));
+    Parallel::deserialize_from_string(results[task], run_buffer);
+    RunBufferSelector::merge(run_buffer, *measurement_accumulators[beta_index]);
   }
 }
 
+/*!
+ \param port TCP port the coordinator listens on
+ \param bind_address IPv4 address of the interface the coordinator listens on, "127.0.0.1" accepts only workers on the same machine and "0.0.0.0" workers on all interfaces
+ \details Creates a Parallel::DistributedCoordinator with default timeouts and performs the simulation like the overload taking a coordinator. The workers are not authenticated and their run buffers are deserialized from Boost text archives, so an address reachable from other machines must only be used in a trusted network.
+*/
+template<class ConfigurationType, class Step, class RandomNumberGenerator>
+template<class Observator, class AccumulatorIterator, class InverseTemperatureIterator>
+void MetropolisParallel<ConfigurationType,Step,RandomNumberGenerator>::do_distributed_metropolis_simulation(uint16_t port, const std::string& bind_address, InverseTemperatureIterator beta_begin, InverseTemperatureIterator beta_end, AccumulatorIterator measurement_accumulator_begin, AccumulatorIterator measurement_accumulator_end, unsigned int local_worker_number)
+{
+  Parallel::DistributedCoordinator coordinator(port, bind_address);
+  do_distributed_metropolis_simulation<Observator>(coordinator, beta_begin, beta_end, measurement_accumulator_begin, measurement_accumulator_end, local_worker_number);
+}
+
+/*!
+ \tparam Observator Class with static function Observator::observe(ConfigurationType*) taking a pointer to the simulation and returning the value of an arbitrary observable. The class must contain a typedef ::observable_type classifying the return type of the functor, the observable type must be serializable with boost::serialization.
+ \tparam InverseTemperatureIterator  Iterator of a container of a type of the inverse temperature, there must be an operator* defined this class and the energy type of the configuration.
+ \param channel Channel connected to the coordinator (e.g. created with Parallel::SocketChannel::connect_tcp)
+ \param beta_begin Iterator pointing to the first inverse temperature of the simulation of the coordinator
+ \param beta_end Iterator pointing on position after the last inverse temperature of the simulation of the coordinator
+ \param measurement_accumulator_begin Iterator pointing to the accumulator of the first inverse temperature, it must have the type and the parameters of the accumulator of the coordinator
+ \param measurement_accumulator_end Iterator pointing one position after the accumulator of the last inverse temperature
+ \details The accumulators are not changed, they only determine the type and the parameters of the run buffers that are sent to the coordinator. Returns when the coordinator stops the worker or closes the connection.
+*/
+template<class ConfigurationType, class Step, class RandomNumberGenerator>
+template<class Observator, class AccumulatorIterator, class InverseTemperatureIterator>
+void MetropolisParallel<ConfigurationType,Step,RandomNumberGenerator>::serve_distributed_metropolis_simulation(Parallel::SocketChannel& channel, InverseTemperatureIterator beta_begin, InverseTemperatureIterator beta_end, AccumulatorIterator measurement_accumulator_begin, AccumulatorIterator measurement_accumulator_end)
+{
+  typedef typename std::iterator_traits<InverseTemperatureIterator>::value_type TemperatureType;
+  std::vector<TemperatureType> betas;
+  std::vector<AccumulatorIterator> measurement_accumulators;
+  for (; beta_begin != beta_end && measurement_accumulator_begin != measurement_accumulator_end; ++beta_begin, ++measurement_accumulator_begin)
+  {
+    betas.push_back(*beta_begin);
+    measurement_accumulators.push_back(measurement_accumulator_begin);
+  }
+
+  DistributedRunTask<Observator, TemperatureType, AccumulatorIterator> run_task(this, betas, measurement_accumulators);
+  Parallel::run_distributed_worker(channel, run_task);
+}
+
+template<class ConfigurationType, class Step, class RandomNumberGenerator>
+template<class Observator, class TemperatureType, class AccumulatorIterator>
+std::string MetropolisParallel<ConfigurationType,Step,RandomNumberGenerator>::DistributedRunTask<Observator, TemperatureType, AccumulatorIterator>::operator()(unsigned int task)
+{
+  typedef Details::Metropolis::RunBuffer<typename Observator::observable_type, typename std::iterator_traits<AccumulatorIterator>::value_type> RunBufferSelector;
+  const RunNumberType run_number = simulation->simulation_parameters.run_number;
+  typename RunBufferSelector::type run_buffer(RunBufferSelector::create(*measurement_accumulators[task / run_number], task));
+  simulation->template do_run<Observator>(betas[task / run_number], task % run_number, run_buffer, 0);
+
+  return Parallel::serialize_to_string(run_buffer);
+}
+
 template <class ConfigurationType, class Step, class RandomNumberGenerator>
 void MetropolisParallel<ConfigurationType, Step, RandomNumberGenerator>::load_serialize(std::istream& input_stream)
 {
@@ -11,25 +11,27 @@
 
 #include "../metropolis.hpp"
 
+#include <limits>
+
 namespace Mocasinns
 {
   template <class ConfigurationType, class StepType, class EnergyType, template<class,class> class HistoType, class RandomNumberGenerator>
   OptimalEnsembleSampling<ConfigurationType, StepType, EnergyType, HistoType, RandomNumberGenerator>::OptimalEnsembleSampling()
-    : Simulation<ConfigurationType, RandomNumberGenerator>(), simulation_parameters()
+    : Simulation<ConfigurationType, RandomNumberGenerator>(), simulation_parameters(), iteration_counter(0)
   { 
     initialize_with_parameters();
   }
 
   template <class ConfigurationType, class StepType, class EnergyType, template<class,class> class HistoType, class RandomNumberGenerator>
   OptimalEnsembleSampling<ConfigurationType, StepType, EnergyType, HistoType, RandomNumberGenerator>::OptimalEnsembleSampling(const Parameters& parameters)
-    : Simulation<ConfigurationType, RandomNumberGenerator>(), simulation_parameters(parameters)
+    : Simulation<ConfigurationType, RandomNumberGenerator>(), simulation_parameters(parameters), iteration_counter(0)
   {
     initialize_with_parameters();
   }
 
   template <class ConfigurationType, class StepType, class EnergyType, template<class,class> class HistoType, class RandomNumberGenerator>
   OptimalEnsembleSampling<ConfigurationType, StepType, EnergyType, HistoType, RandomNumberGenerator>::OptimalEnsembleSampling(const Parameters& parameters, ConfigurationType* initial_configuration)
-    : Simulation<ConfigurationType, RandomNumberGenerator>(initial_configuration), simulation_parameters(parameters)
+    : Simulation<ConfigurationType, RandomNumberGenerator>(initial_configuration), simulation_parameters(parameters), iteration_counter(0)
   {
     initialize_with_parameters();
   }
@@ -100,7 +102,7 @@ namespace Mocasinns
     // Perform the WangLandau simulation
     wl_simulation.do_wang_landau_simulation();
     // Extract the density of states
-    HistoType<EnergyType, double> log_density_of_states = wl_simulation.get_log_density_of_states();
+    const HistoType<EnergyType, double>& log_density_of_states = wl_simulation.get_log_density_of_states();
 
     // Set the weights to the logarithm of the inverse density of states
     for (typename HistoType<EnergyType, double>::const_iterator dos = log_density_of_states.begin();
@@ -112,15 +114,21 @@ namespace Mocasinns
 
   template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
   double OptimalEnsembleSampling<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGenerator>::acceptance_probability(StepType& step_to_execute, Details::Multicanonical::StepParameter<EnergyType>& step_parameters)
+  {
+    return exp(log_acceptance_probability(step_to_execute, step_parameters));
+  }
+
+  template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
+  double OptimalEnsembleSampling<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGenerator>::log_acceptance_probability(StepType& step_to_execute, Details::Multicanonical::StepParameter<EnergyType>& step_parameters)
   {
     // Calculate the energy difference of the step
     step_parameters.delta_E = step_to_execute.delta_E();
     EnergyType total_energy_after_step = step_parameters.total_energy + step_parameters.delta_E;
 
-    // If an energy cutoff is used and the step would violate the energy cutoff, return 0.0
+    // If an energy cutoff is used and the step would violate the energy cutoff, return -infinity
     if ((simulation_parameters.use_energy_cutoff_lower && step_parameters.total_energy + step_parameters.delta_E < simulation_parameters.energy_cutoff_lower) ||
 	(simulation_parameters.use_energy_cutoff_upper && step_parameters.total_energy + step_parameters.delta_E > simulation_parameters.energy_cutoff_upper))
-      return 0.0;
+      return -std::numeric_limits<double>::infinity();
     
     // Check whether one leaves the energy range (then allways do the step)
     if (total_energy_after_step > simulation_parameters.maximal_energy)
@@ -130,7 +138,7 @@ namespace Mocasinns
       // Reset the maximal energy parameter
       simulation_parameters.maximal_energy = total_energy_after_step;
       // Execute the step 
-      return 1.0;
+      return 0.0;
     }
     if (total_energy_after_step < simulation_parameters.minimal_energy)
     {
@@ -139,11 +147,11 @@ namespace Mocasinns
       // Reset the minimal energy parameter
       simulation_parameters.minimal_energy = total_energy_after_step;
       // Execute the step
-      return 1.0;
+      return 0.0;
     }
     
-    // calculate the normal acceptance probability
-    return exp(weights[total_energy_after_step] - weights[step_parameters.total_energy]);
+    // calculate the logarithm of the normal acceptance probability
+    return weights[total_energy_after_step] - weights[step_parameters.total_energy];
   }
   
   template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
@@ -192,7 +200,8 @@ namespace Mocasinns
   }
 
   /*!
-    \returns Histogram with the logarithmic density of states associated to each energy.
+    \details If a wall clock budget is set (see Simulation::set_wall_clock_budget) and the next sampling steps would not finish before the deadline, the simulation stops, get_deadline_reached() is true and the current estimate of the density of states is returned. If the deadline is reached before the first sampling steps of an iteration, the estimate is the one of the finished iterations. The weights and the number of the interrupted iteration are kept in the checkpoint, so a simulation loaded from the checkpoint continues with the interrupted iteration.
+    \returns Histogram with the logarithmic density of states associated to each energy, the current estimate if the deadline was reached.
    */
   template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
   HistoType<EnergyType, double> OptimalEnsembleSampling<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGenerator>::do_optimal_ensemble_sampling_simulation()
@@ -200,9 +209,13 @@ namespace Mocasinns
     // Create the fraction histogram
     HistoType<EnergyType, double> fraction_histogram;
 
-    // Do the iterations
-    for (unsigned int iteration = 0; iteration < simulation_parameters.iterations; ++iteration)
+    // Do the iterations, starting with the interrupted iteration of a loaded checkpoint
+    for (; iteration_counter < simulation_parameters.iterations; ++iteration_counter)
     {
+      // Return the estimate of the finished iterations if the first sampling steps would not finish before the deadline, the incidence counters are not reset yet
+      const double sampling_steps = pow(2,iteration_counter) * simulation_parameters.initial_steps_per_iteration;
+      if (this->check_for_deadline(sampling_steps)) return calculate_log_density_of_states();
+
       // Reset the positive and the negative incidence counter as well as the fraction histogram
       incidence_counter_positive.initialise_empty(weights);
       incidence_counter_negative.initialise_empty(weights);
@@ -212,10 +225,17 @@ namespace Mocasinns
       bool incidence_counters_vanish = false;
       bool incidence_counters_zero_y_values = false;
       bool fraction_derivative_negative = false;
+      bool first_sampling = true;
       do
       {
+	// Return if further sampling steps would not finish before the deadline
+	if (!first_sampling && this->check_for_deadline(sampling_steps)) return calculate_log_density_of_states();
+	first_sampling = false;
+
 	// Do the sampling steps
-	do_optimal_ensemble_sampling_steps(pow(2,iteration) * simulation_parameters.initial_steps_per_iteration);
+	this->wall_clock_budget.begin_work();
+	do_optimal_ensemble_sampling_steps(sampling_steps);
+	this->wall_clock_budget.end_work(sampling_steps);
 
 	// Check for signals and return if simulation should be terminated
 	if (this->check_for_posix_signal()) return HistoType<EnergyType, double>();
@@ -272,6 +292,8 @@ namespace Mocasinns
       // Invoke the signal handler after iteration
       signal_handler_iteration(this);
     }
+    // A further call starts a new simulation
+    iteration_counter = 0;
       
     // Calculate and return the density of states
     return calculate_log_density_of_states();
@@ -307,6 +329,7 @@ namespace Mocasinns
   template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
   HistoType<EnergyType, double> OptimalEnsembleSampling<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGenerator>::calculate_log_density_of_states() const
   {
+    // Energies without incidence (e.g. if the simulation stopped at the deadline during an iteration) have no estimate
     HistoType<EnergyType, double> log_density_of_states;
     log_density_of_states.initialise_empty(weights);
     for (typename HistoType<EnergyType, double>::const_iterator energy_weight = weights.begin();
@@ -314,12 +337,16 @@ namespace Mocasinns
     {
       EnergyType energy = energy_weight->first;
       double weight = energy_weight->second;
-      double positive_incidence = incidence_counter_positive.find(energy)->second;
-      double negative_incidence = incidence_counter_negative.find(energy)->second;
-      log_density_of_states[energy] = log(static_cast<double>(positive_incidence + negative_incidence)) - weight;
+      typename HistoType<EnergyType, IncidenceCounterYValueType>::const_iterator positive_incidence = incidence_counter_positive.find(energy);
+      typename HistoType<EnergyType, IncidenceCounterYValueType>::const_iterator negative_incidence = incidence_counter_negative.find(energy);
+      double incidence = 0.0;
+      if (positive_incidence != incidence_counter_positive.end()) incidence += positive_incidence->second;
+      if (negative_incidence != incidence_counter_negative.end()) incidence += negative_incidence->second;
+      if (incidence > 0.0) log_density_of_states[energy] = log(incidence) - weight;
+      else log_density_of_states.erase(energy);
     }
 
-    log_density_of_states.shift_bin_zero(log_density_of_states.min_y_value());
+    if (log_density_of_states.size() > 0) log_density_of_states.shift_bin_zero(log_density_of_states.min_y_value());
 
     return log_density_of_states;
   }
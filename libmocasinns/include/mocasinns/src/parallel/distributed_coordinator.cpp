@@ -0,0 +1,286 @@
+/**
+ * \file distributed_coordinator.cpp
+ * \brief Implementation of the coordinator and the worker loop for distributed simulations
+ *
+ * The protocol consists of the messages "task <number>" and "stop" from the coordinator to the worker and "result <number>" followed by a newline and the result data from the worker to the coordinator.
+ *
+ * \author Benedikt Krüger
+ */
+#ifdef MOCASINNS_PARALLEL_DISTRIBUTED_COORDINATOR_HPP
+
+#include <cstdlib>
+#include <cerrno>
+#include <poll.h>
+#include <csignal>
+#include <unistd.h>
+#include <sys/wait.h>
+
+namespace Mocasinns
+{
+namespace Parallel
+{
+
+inline DistributedCoordinator::DistributedCoordinator(uint16_t port, const std::string& bind_address) : listener(SocketListener::listen_tcp(port, bind_address)), maximal_failure_number(3), worker_timeout(60000), stop_timeout(10000) {}
+
+inline DistributedCoordinator::DistributedCoordinator(const std::string& path) : listener(SocketListener::listen_unix(path)), maximal_failure_number(3), worker_timeout(60000), stop_timeout(10000) {}
+
+inline DistributedCoordinator::~DistributedCoordinator()
+{
+  stop_workers();
+
+  // Local workers connect asynchronously, stop the ones that have not been accepted yet and wait for all of them until the stop timeout
+  const double stop_deadline = now() + stop_timeout;
+  while (!local_workers.empty() && (stop_timeout < 0 || now() < stop_deadline))
+  {
+    struct pollfd poll_descriptor;
+    poll_descriptor.fd = listener->get_file_descriptor();
+    poll_descriptor.events = POLLIN;
+    if (poll(&poll_descriptor, 1, 10) > 0 && (poll_descriptor.revents & POLLIN))
+    {
+      SocketChannel* channel = listener->accept_connection();
+      try
+      {
+	channel->send_message("stop");
+      }
+      catch (ExceptionSocket&) {}
+      delete channel;
+    }
+    stop_workers();
+  }
+
+  // Kill the local workers that hang (e.g. in a task or in a stalled message) and reap them
+  for (std::vector<pid_t>::iterator pid = local_workers.begin(); pid != local_workers.end(); ++pid)
+  {
+    kill(*pid, SIGKILL);
+    while (waitpid(*pid, 0, 0) < 0 && errno == EINTR) {}
+  }
+  local_workers.clear();
+  delete listener;
+}
+
+/*!
+  \details The worker processes are created with fork(), so they share the state of the calling process at the time of the call (e.g. the configuration and the parameters of a simulation). A worker connects with SocketListener::connect_local(), calls worker_function with the channel and exits. The coordinator waits for the workers in its destructor.
+
+  The function must not be called inside an active OpenMP parallel region: The forked process contains only the calling thread, so locks held by other threads and the thread pool of the OpenMP runtime are left in an undefined state and a parallel region in the worker can deadlock. Parallel regions before and after the call are fine.
+  \tparam WorkerFunction Function or functor with operator()(SocketChannel&)
+  \param worker_number Number of worker processes to fork
+  \param worker_function Function executed in the worker processes
+*/
+template<class WorkerFunction>
+void DistributedCoordinator::spawn_local_workers(unsigned int worker_number, WorkerFunction worker_function)
+{
+  for (unsigned int w = 0; w < worker_number; ++w)
+  {
+    const pid_t pid = fork();
+    if (pid < 0) throw ExceptionSocket("fork local worker");
+    if (pid == 0)
+    {
+      int exit_code = 0;
+      try
+      {
+	SocketChannel* channel = listener->connect_local();
+	worker_function(*channel);
+	delete channel;
+      }
+      catch (...)
+      {
+	exit_code = 1;
+      }
+      // Do not run the destructors and exit handlers of the parent process
+      _exit(exit_code);
+    }
+    local_workers.push_back(pid);
+  }
+}
+
+/*!
+  \param task_number Number of tasks to perform
+  \param results Vector that is resized to task_number, results[t] is the result data of task t
+  \details Throws ExceptionDistributed if a task has failed maximal_failure_number times or if no worker is connected for worker_timeout milliseconds, the connected workers are stopped then, since they might still send results of this call.
+*/
+inline void DistributedCoordinator::run(unsigned int task_number, std::vector<std::string>& results)
+{
+  results.assign(task_number, std::string());
+  std::deque<unsigned int> pending_tasks;
+  for (unsigned int t = 0; t < task_number; ++t) pending_tasks.push_back(t);
+  std::vector<unsigned int> failure_numbers(task_number, 0);
+  unsigned int finished_tasks = 0;
+
+  while (finished_tasks < task_number)
+  {
+    // Give every idle worker a task
+    for (std::vector<Worker>::iterator worker = workers.begin(); worker != workers.end() && !pending_tasks.empty(); ++worker)
+    {
+      if (worker->task >= 0) continue;
+      worker->task = pending_tasks.front();
+      pending_tasks.pop_front();
+      std::ostringstream message;
+      message << "task " << worker->task;
+      try
+      {
+	worker->channel->send_message(message.str());
+      }
+      catch (ExceptionSocket&)
+      {
+	// The worker is gone, it is removed when poll reports the closed connection
+      }
+    }
+
+    // Wait for new workers and for results
+    std::vector<struct pollfd> poll_descriptors(workers.size() + 1);
+    poll_descriptors[0].fd = listener->get_file_descriptor();
+    poll_descriptors[0].events = POLLIN;
+    for (unsigned int w = 0; w < workers.size(); ++w)
+    {
+      poll_descriptors[w + 1].fd = workers[w].channel->get_file_descriptor();
+      poll_descriptors[w + 1].events = POLLIN;
+    }
+    const int ready_number = poll(&poll_descriptors[0], poll_descriptors.size(), workers.empty() ? worker_timeout : -1);
+    if (ready_number < 0)
+    {
+      if (errno == EINTR) continue;
+      throw ExceptionSocket("poll");
+    }
+    if (ready_number == 0) throw ExceptionDistributed("no worker connected");
+
+    // Read the results, remove closed connections and return their tasks to the pool
+    for (int w = workers.size() - 1; w >= 0; --w)
+    {
+      if (poll_descriptors[w + 1].revents == 0) continue;
+
+      std::string message;
+      if (!workers[w].channel->receive_message(message))
+      {
+	remove_worker(w, pending_tasks, failure_numbers);
+	continue;
+      }
+
+      // A message that is not the result of the task of the worker is a protocol error
+      const std::string::size_type header_end = message.find('\n');
+      std::istringstream header(message.substr(0, header_end));
+      std::string command;
+      int task = -1;
+      header >> command >> task;
+      if (command != "result" || workers[w].task < 0 || task != workers[w].task || header_end == std::string::npos)
+      {
+	remove_worker(w, pending_tasks, failure_numbers);
+	continue;
+      }
+      results[task] = message.substr(header_end + 1);
+      ++finished_tasks;
+      workers[w].task = -1;
+    }
+
+    // Accept a new worker
+    if (poll_descriptors[0].revents & POLLIN)
+    {
+      Worker worker;
+      worker.channel = listener->accept_connection();
+      worker.channel->set_receive_timeout(worker_timeout);
+      worker.task = -1;
+      workers.push_back(worker);
+    }
+  }
+}
+
+inline double DistributedCoordinator::now()
+{
+  struct timespec current_time;
+  clock_gettime(CLOCK_MONOTONIC, &current_time);
+  return 1e3*current_time.tv_sec + 1e-6*current_time.tv_nsec;
+}
+
+inline void DistributedCoordinator::stop_workers()
+{
+  for (std::vector<Worker>::iterator worker = workers.begin(); worker != workers.end(); ++worker)
+  {
+    try
+    {
+      worker->channel->send_message("stop");
+    }
+    catch (ExceptionSocket&) {}
+    delete worker->channel;
+  }
+  workers.clear();
+
+  // Wait for the local workers that have been stopped
+  for (std::vector<pid_t>::iterator pid = local_workers.begin(); pid != local_workers.end();)
+  {
+    if (waitpid(*pid, 0, WNOHANG) != 0) pid = local_workers.erase(pid);
+    else ++pid;
+  }
+}
+
+/*!
+  \details The worker is stopped, so it cannot send a late result. If it was performing a task, the task is returned to the front of the pending tasks.
+  \param worker_index Index of the worker in workers
+  \param pending_tasks Tasks that have not been handed out
+  \param failure_numbers Number of failed attempts of every task
+*/
+inline void DistributedCoordinator::remove_worker(unsigned int worker_index, std::deque<unsigned int>& pending_tasks, std::vector<unsigned int>& failure_numbers)
+{
+  const int task = workers[worker_index].task;
+  try
+  {
+    workers[worker_index].channel->send_message("stop");
+  }
+  catch (ExceptionSocket&) {}
+  delete workers[worker_index].channel;
+  workers.erase(workers.begin() + worker_index);
+
+  if (task < 0) return;
+  if (++failure_numbers[task] >= maximal_failure_number)
+  {
+    std::ostringstream reason;
+    reason << "task " << task << " failed " << failure_numbers[task] << " times";
+    stop_workers();
+    throw ExceptionDistributed(reason.str());
+  }
+  pending_tasks.push_front(task);
+}
+
+/*!
+  \tparam TaskFunction Functor with operator()(unsigned int) returning the result data of the task as std::string
+  \param channel Channel connected to the coordinator
+  \param task_function Functor performing the tasks
+*/
+template<class TaskFunction>
+void run_distributed_worker(SocketChannel& channel, TaskFunction& task_function)
+{
+  std::string message;
+  while (channel.receive_message(message))
+  {
+    std::istringstream command_stream(message);
+    std::string command;
+    command_stream >> command;
+    if (command != "task") break;
+
+    unsigned int task;
+    command_stream >> task;
+    std::ostringstream result;
+    result << "result " << task << "\n" << task_function(task);
+    channel.send_message(result.str());
+  }
+}
+
+template<class T> std::string serialize_to_string(const T& object)
+{
+  std::ostringstream output_stream;
+  {
+    boost::archive::text_oarchive output_archive(output_stream);
+    output_archive << object;
+  }
+  return output_stream.str();
+}
+
+template<class T> void deserialize_from_string(const std::string& data, T& object)
+{
+  std::istringstream input_stream(data);
+  boost::archive::text_iarchive input_archive(input_stream);
+  input_archive >> object;
+}
+
+} // of namespace Parallel
+} // of namespace Mocasinns
+
+#endif
@@ -0,0 +1,207 @@
+/**
+ * \file numa_topology.cpp
+ * \brief Implementation of the classes for the NUMA topology and the thread pinning
+ *
+ * \author Benedikt Krüger
+ */
+#ifdef MOCASINNS_PARALLEL_NUMA_TOPOLOGY_HPP
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <dirent.h>
+#include <unistd.h>
+
+#ifdef MOCASINNS_USE_LIBNUMA
+#include <numa.h>
+#endif
+
+namespace Mocasinns
+{
+namespace Parallel
+{
+
+/*!
+  \details Tries libnuma (if enabled), then the sysfs and falls back to a single node with all usable processors.
+*/
+inline NumaTopology::NumaTopology() : source(source_default)
+{
+  if (detect_libnuma()) source = source_libnuma;
+  else if (detect_sysfs()) source = source_sysfs;
+  else detect_default();
+}
+
+inline unsigned int NumaTopology::cpu_number() const
+{
+  unsigned int result = 0;
+  for (std::vector<std::vector<unsigned int> >::const_iterator node = nodes.begin(); node != nodes.end(); ++node)
+    result += node->size();
+  return result;
+}
+
+inline int NumaTopology::cpu_node(unsigned int cpu) const
+{
+  for (unsigned int node = 0; node < nodes.size(); ++node)
+    for (std::vector<unsigned int>::const_iterator node_cpu = nodes[node].begin(); node_cpu != nodes[node].end(); ++node_cpu)
+      if (*node_cpu == cpu) return node;
+  return -1;
+}
+
+/*!
+  \details The threads are distributed round-robin over the nodes (thread t runs on node t % node_number()), inside a node the processors are used in ascending order. If there are more threads than processors, the processors are used several times.
+  \param thread Number of the thread (e.g. omp_get_thread_num())
+  \param thread_number Number of threads in the parallel region (e.g. omp_get_num_threads())
+*/
+inline unsigned int NumaTopology::thread_cpu(unsigned int thread, unsigned int thread_number) const
+{
+  // Use nodes only if they can run at least one of the threads
+  const unsigned int used_nodes = (thread_number < nodes.size()) ? thread_number : nodes.size();
+  const std::vector<unsigned int>& cpus = nodes[thread % used_nodes];
+  return cpus[(thread / used_nodes) % cpus.size()];
+}
+
+inline bool NumaTopology::pin_current_thread(unsigned int cpu)
+{
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu, &cpu_set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set) == 0;
+#else
+  return false;
+#endif
+}
+
+inline int NumaTopology::current_cpu()
+{
+#ifdef __linux__
+  return sched_getcpu();
+#else
+  return -1;
+#endif
+}
+
+/*!
+  \param cpu_list String with comma separated processor numbers or ranges of processor numbers, as found in /sys/devices/system/node/node0/cpulist
+  \returns Vector with all processors in the list
+*/
+inline std::vector<unsigned int> NumaTopology::parse_cpu_list(const std::string& cpu_list)
+{
+  std::vector<unsigned int> result;
+  std::istringstream list_stream(cpu_list);
+  std::string range;
+  while (std::getline(list_stream, range, ','))
+  {
+    if (range.find_first_of("0123456789") == std::string::npos) continue;
+    const std::string::size_type dash = range.find('-');
+    const unsigned int first = std::atoi(range.substr(0, dash).c_str());
+    const unsigned int last = (dash == std::string::npos) ? first : std::atoi(range.substr(dash + 1).c_str());
+    for (unsigned int cpu = first; cpu <= last; ++cpu)
+      result.push_back(cpu);
+  }
+  return result;
+}
+
+inline bool NumaTopology::detect_libnuma()
+{
+#ifdef MOCASINNS_USE_LIBNUMA
+  if (numa_available() < 0) return false;
+
+  struct bitmask* cpu_mask = numa_allocate_cpumask();
+  const int configured_cpus = numa_num_configured_cpus();
+  for (int node = 0; node <= numa_max_node(); ++node)
+  {
+    if (numa_node_to_cpus(node, cpu_mask) != 0) continue;
+    std::vector<unsigned int> cpus;
+    for (int cpu = 0; cpu < configured_cpus; ++cpu)
+      if (numa_bitmask_isbitset(cpu_mask, cpu) && cpu_usable(cpu)) cpus.push_back(cpu);
+    if (!cpus.empty()) nodes.push_back(cpus);
+  }
+  numa_free_cpumask(cpu_mask);
+  return !nodes.empty();
+#else
+  return false;
+#endif
+}
+
+/*!
+  \details Reads the files /sys/devices/system/node/node<i>/cpulist for all nodes.
+*/
+inline bool NumaTopology::detect_sysfs()
+{
+  const std::string node_directory("/sys/devices/system/node");
+  DIR* directory = opendir(node_directory.c_str());
+  if (directory == 0) return false;
+
+  // Collect the node numbers, they need not to be contiguous
+  std::vector<unsigned int> node_ids;
+  for (struct dirent* entry = readdir(directory); entry != 0; entry = readdir(directory))
+  {
+    const std::string name(entry->d_name);
+    if (name.size() > 4 && name.compare(0, 4, "node") == 0 && name.find_first_not_of("0123456789", 4) == std::string::npos)
+      node_ids.push_back(std::atoi(name.c_str() + 4));
+  }
+  closedir(directory);
+  std::sort(node_ids.begin(), node_ids.end());
+
+  for (std::vector<unsigned int>::const_iterator node_id = node_ids.begin(); node_id != node_ids.end(); ++node_id)
+  {
+    std::ostringstream filename;
+    filename << node_directory << "/node" << *node_id << "/cpulist";
+    std::ifstream cpu_list_file(filename.str().c_str());
+    std::string cpu_list;
+    std::getline(cpu_list_file, cpu_list);
+
+    std::vector<unsigned int> all_cpus = parse_cpu_list(cpu_list);
+    std::vector<unsigned int> cpus;
+    for (std::vector<unsigned int>::const_iterator cpu = all_cpus.begin(); cpu != all_cpus.end(); ++cpu)
+      if (cpu_usable(*cpu)) cpus.push_back(*cpu);
+    if (!cpus.empty()) nodes.push_back(cpus);
+  }
+  return !nodes.empty();
+}
+
+inline void NumaTopology::detect_default()
+{
+  nodes.clear();
+  std::vector<unsigned int> cpus;
+  long configured_cpus = sysconf(_SC_NPROCESSORS_CONF);
+  if (configured_cpus < 1) configured_cpus = 1;
+  for (long cpu = 0; cpu < configured_cpus; ++cpu)
+    if (cpu_usable(cpu)) cpus.push_back(cpu);
+  if (cpus.empty()) cpus.push_back(0);
+  nodes.push_back(cpus);
+}
+
+inline bool NumaTopology::cpu_usable(unsigned int cpu)
+{
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  if (sched_getaffinity(0, sizeof(cpu_set_t), &cpu_set) != 0) return true;
+  return (cpu < CPU_SETSIZE) && CPU_ISSET(cpu, &cpu_set);
+#else
+  return true;
+#endif
+}
+
+inline ScopedThreadPinning::ScopedThreadPinning(unsigned int cpu) : pinned(false)
+{
+#ifdef __linux__
+  if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &previous_affinity) == 0)
+    pinned = NumaTopology::pin_current_thread(cpu);
+#endif
+}
+
+inline ScopedThreadPinning::~ScopedThreadPinning()
+{
+#ifdef __linux__
+  if (pinned) pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &previous_affinity);
+#endif
+}
+
+} // of namespace Parallel
+} // of namespace Mocasinns
+
+#endif
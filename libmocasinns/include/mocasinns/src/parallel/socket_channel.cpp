@@ -0,0 +1,239 @@
+/**
+ * \file socket_channel.cpp
+ * \brief Implementation of the socket channels and listeners
+ *
+ * \author Benedikt Krüger
+ */
+#ifdef MOCASINNS_PARALLEL_SOCKET_CHANNEL_HPP
+
+#include <cstring>
+#include <cerrno>
+#include <sstream>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+namespace Mocasinns
+{
+namespace Parallel
+{
+
+inline SocketChannel::~SocketChannel()
+{
+  close(socket_descriptor);
+}
+
+/*!
+  \param host Name or address of the host
+  \param port TCP port of the coordinator
+  \returns Pointer to a new channel, the caller takes ownership
+*/
+inline SocketChannel* SocketChannel::connect_tcp(const std::string& host, uint16_t port)
+{
+  std::ostringstream port_string;
+  port_string << port;
+
+  struct addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* addresses;
+  if (getaddrinfo(host.c_str(), port_string.str().c_str(), &hints, &addresses) != 0)
+    throw ExceptionSocket("resolve " + host);
+
+  // Try all addresses of the host until one accepts the connection
+  int file_descriptor = -1;
+  for (struct addrinfo* address = addresses; address != 0; address = address->ai_next)
+  {
+    file_descriptor = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (file_descriptor < 0) continue;
+    if (connect(file_descriptor, address->ai_addr, address->ai_addrlen) == 0) break;
+    close(file_descriptor);
+    file_descriptor = -1;
+  }
+  freeaddrinfo(addresses);
+  if (file_descriptor < 0) throw ExceptionSocket("connect to " + host + ":" + port_string.str());
+
+  // The messages are small and answered immediately, so do not delay them
+  int flag = 1;
+  setsockopt(file_descriptor, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+  return new SocketChannel(file_descriptor);
+}
+
+/*!
+  \param path Path of the socket file of the coordinator
+  \returns Pointer to a new channel, the caller takes ownership
+*/
+inline SocketChannel* SocketChannel::connect_unix(const std::string& path)
+{
+  struct sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) throw ExceptionSocket("connect to " + path + " (path too long)");
+  std::strcpy(address.sun_path, path.c_str());
+
+  int file_descriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (file_descriptor < 0) throw ExceptionSocket("create socket");
+  if (connect(file_descriptor, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0)
+  {
+    close(file_descriptor);
+    throw ExceptionSocket("connect to " + path);
+  }
+  return new SocketChannel(file_descriptor);
+}
+
+/*!
+  \details The length of the message is sent as 32 bit unsigned integer in network byte order before the data.
+*/
+inline void SocketChannel::send_message(const std::string& message)
+{
+  if (message.size() > maximal_message_length) throw ExceptionSocket("send a message longer than the maximal message length");
+  const uint32_t length = htonl(static_cast<uint32_t>(message.size()));
+  if (!write_all(reinterpret_cast<const char*>(&length), sizeof(length)) || !write_all(message.data(), message.size()))
+    throw ExceptionSocket("send");
+}
+
+/*!
+  \details A frame announcing more than maximal_message_length bytes is not read, the connection has to be closed afterwards because the stream is no longer at a frame boundary. The same holds if a part of the message did not arrive within receive_timeout milliseconds, so a stalled sender cannot block the receiver.
+*/
+inline bool SocketChannel::receive_message(std::string& message)
+{
+  uint32_t length;
+  if (!read_all(reinterpret_cast<char*>(&length), sizeof(length))) return false;
+  length = ntohl(length);
+  if (length > maximal_message_length) return false;
+  message.resize(length);
+  if (message.empty()) return true;
+  return read_all(&message[0], message.size());
+}
+
+inline bool SocketChannel::write_all(const char* data, size_t size)
+{
+  while (size > 0)
+  {
+    // Do not raise SIGPIPE if the other side has closed the connection
+    const ssize_t written = send(socket_descriptor, data, size, MSG_NOSIGNAL);
+    if (written < 0 && errno == EINTR) continue;
+    if (written <= 0) return false;
+    data += written;
+    size -= written;
+  }
+  return true;
+}
+
+inline bool SocketChannel::read_all(char* data, size_t size)
+{
+  while (size > 0)
+  {
+    if (receive_timeout >= 0)
+    {
+      struct pollfd poll_descriptor;
+      poll_descriptor.fd = socket_descriptor;
+      poll_descriptor.events = POLLIN;
+      const int ready_number = poll(&poll_descriptor, 1, receive_timeout);
+      if (ready_number < 0 && errno == EINTR) continue;
+      if (ready_number <= 0) return false;
+    }
+    const ssize_t read_bytes = recv(socket_descriptor, data, size, 0);
+    if (read_bytes < 0 && errno == EINTR) continue;
+    if (read_bytes <= 0) return false;
+    data += read_bytes;
+    size -= read_bytes;
+  }
+  return true;
+}
+
+/*!
+  \param port TCP port to listen on, 0 lets the system choose a free port that can be read with get_port()
+  \param bind_address IPv4 address of the interface to listen on, the default accepts only connections from the same machine
+  \returns Pointer to a new listener, the caller takes ownership
+  \details The connections are not authenticated, so a listener bound to an address reachable from other machines must only be used in a trusted network.
+*/
+inline SocketListener* SocketListener::listen_tcp(uint16_t port, const std::string& bind_address)
+{
+  struct sockaddr_in address;
+  std::memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  if (inet_pton(AF_INET, bind_address.c_str(), &address.sin_addr) != 1) throw ExceptionSocket("listen on " + bind_address + " (invalid IPv4 address)");
+  address.sin_port = htons(port);
+
+  int file_descriptor = socket(AF_INET, SOCK_STREAM, 0);
+  if (file_descriptor < 0) throw ExceptionSocket("create socket");
+  int flag = 1;
+  setsockopt(file_descriptor, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
+
+  socklen_t address_length = sizeof(address);
+  if (bind(file_descriptor, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0
+      || listen(file_descriptor, SOMAXCONN) != 0
+      || getsockname(file_descriptor, reinterpret_cast<struct sockaddr*>(&address), &address_length) != 0)
+  {
+    close(file_descriptor);
+    throw ExceptionSocket("listen on TCP port");
+  }
+  return new SocketListener(file_descriptor, ntohs(address.sin_port), bind_address, "");
+}
+
+/*!
+  \param path Path of the socket file
+  \returns Pointer to a new listener, the caller takes ownership
+*/
+inline SocketListener* SocketListener::listen_unix(const std::string& path)
+{
+  struct sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) throw ExceptionSocket("listen on " + path + " (path too long)");
+  std::strcpy(address.sun_path, path.c_str());
+
+  int file_descriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (file_descriptor < 0) throw ExceptionSocket("create socket");
+  unlink(path.c_str());
+  if (bind(file_descriptor, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0 || listen(file_descriptor, SOMAXCONN) != 0)
+  {
+    close(file_descriptor);
+    throw ExceptionSocket("listen on " + path);
+  }
+  return new SocketListener(file_descriptor, 0, "", path);
+}
+
+inline SocketListener::~SocketListener()
+{
+  close(socket_descriptor);
+  if (is_unix()) unlink(path.c_str());
+}
+
+inline SocketChannel* SocketListener::accept_connection()
+{
+  int file_descriptor;
+  do
+  {
+    file_descriptor = accept(socket_descriptor, 0, 0);
+  } while (file_descriptor < 0 && errno == EINTR);
+  if (file_descriptor < 0) throw ExceptionSocket("accept");
+
+  if (!is_unix())
+  {
+    int flag = 1;
+    setsockopt(file_descriptor, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+  }
+  return new SocketChannel(file_descriptor);
+}
+
+inline SocketChannel* SocketListener::connect_local() const
+{
+  if (is_unix()) return SocketChannel::connect_unix(path);
+  // A listener on all interfaces is reachable over the loopback interface
+  else if (address == "0.0.0.0") return SocketChannel::connect_tcp("127.0.0.1", port);
+  else return SocketChannel::connect_tcp(address, port);
+}
+
+} // of namespace Parallel
+} // of namespace Mocasinns
+
+#endif
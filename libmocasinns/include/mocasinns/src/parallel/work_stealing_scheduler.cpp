@@ -0,0 +1,93 @@
+/**
+ * \file work_stealing_scheduler.cpp
+ * \brief Implementation of the work stealing scheduler
+ *
+ * \author Benedikt Krüger
+ */
+#ifdef MOCASINNS_PARALLEL_WORK_STEALING_SCHEDULER_HPP
+
+namespace Mocasinns
+{
+namespace Parallel
+{
+
+/*!
+  \details Task t is put into queue t % queue_number, so that every queue gets tasks from all parts of the task range.
+  \param task_number Number of tasks to distribute
+  \param queue_number Number of queues, usually the number of threads (at least one queue is created)
+*/
+inline WorkStealingScheduler::WorkStealingScheduler(unsigned int task_number, unsigned int queue_number) : stolen_task_number(0)
+{
+  if (queue_number == 0) queue_number = 1;
+  for (unsigned int q = 0; q < queue_number; ++q)
+  {
+    queues.push_back(new Queue);
+    omp_init_lock(&queues.back()->lock);
+  }
+  for (unsigned int t = 0; t < task_number; ++t)
+    queues[t % queue_number]->tasks.push_back(t);
+}
+
+inline WorkStealingScheduler::~WorkStealingScheduler()
+{
+  for (std::vector<Queue*>::iterator queue = queues.begin(); queue != queues.end(); ++queue)
+  {
+    omp_destroy_lock(&(*queue)->lock);
+    delete *queue;
+  }
+}
+
+/*!
+  \details The other queues are searched for a task to steal in the order queue + 1, queue + 2, ..., so that different thieves start at different victims.
+  \param queue Number of the queue of the calling thread (e.g. omp_get_thread_num()), numbers larger than the number of queues are wrapped around
+  \param task Reference to the variable the number of the task is written to
+*/
+inline bool WorkStealingScheduler::next_task(unsigned int queue, unsigned int& task)
+{
+  queue %= queues.size();
+  if (pop_task(queue, task)) return true;
+
+  for (unsigned int offset = 1; offset < queues.size(); ++offset)
+  {
+    if (steal_task((queue + offset) % queues.size(), task))
+    {
+#pragma omp atomic
+      ++stolen_task_number;
+      return true;
+    }
+  }
+  return false;
+}
+
+inline bool WorkStealingScheduler::pop_task(unsigned int queue, unsigned int& task)
+{
+  bool found = false;
+  omp_set_lock(&queues[queue]->lock);
+  if (!queues[queue]->tasks.empty())
+  {
+    task = queues[queue]->tasks.front();
+    queues[queue]->tasks.pop_front();
+    found = true;
+  }
+  omp_unset_lock(&queues[queue]->lock);
+  return found;
+}
+
+inline bool WorkStealingScheduler::steal_task(unsigned int queue, unsigned int& task)
+{
+  bool found = false;
+  omp_set_lock(&queues[queue]->lock);
+  if (!queues[queue]->tasks.empty())
+  {
+    task = queues[queue]->tasks.back();
+    queues[queue]->tasks.pop_back();
+    found = true;
+  }
+  omp_unset_lock(&queues[queue]->lock);
+  return found;
+}
+
+} // of namespace Parallel
+} // of namespace Mocasinns
+
+#endif
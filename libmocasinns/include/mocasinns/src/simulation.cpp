@@ -11,6 +11,11 @@
 
 #include "../details/optional_concept_checks/step_type_has_is_executable.hpp"
 #include "../details/optional_concept_checks/step_type_has_selection_probability_factor.hpp"
+#include "../details/optional_concept_checks/simulation_has_log_acceptance_probability.hpp"
+#include "../details/simulation/acceptance_test.hpp"
+
+#include <cstdio>
+#include <stdexcept>
 
 namespace Mocasinns
 {
@@ -93,18 +98,36 @@ bool Simulation<ConfigurationType, RandomNumberGenerator>::check_for_posix_signa
   }
 }
 
+/*!
+  \details The engines call this function at the boundaries of their units of work (e.g. before a sweep, a measurement or an iteration), where the simulation can be stopped and continued from a checkpoint. The duration of the next unit is predicted from the durations of the previous units (see Details::Simulation::WallClockBudget), as long as no unit was timed the work is always allowed.
+  \param next_work Size of the next unit of work in the unit used by the engine for timing (usually steps)
+*/
+template <class ConfigurationType, class RandomNumberGenerator>
+bool Simulation<ConfigurationType, RandomNumberGenerator>::check_for_deadline(double next_work)
+{
+  if (deadline_reached) return true;
+  if (wall_clock_budget.allows(next_work)) return false;
+
+  deadline_reached = true;
+  is_terminating = true;
+  signal_handler_deadline(this);
+  write_checkpoint();
+  return true;
+}
+
 template <class ConfigurationType, class RandomNumberGenerator>
 template <class Derived, class StepType, class AcceptanceProbabilityParameterType>
 void Simulation<ConfigurationType, RandomNumberGenerator>::do_steps(const StepNumberType& step_number, AcceptanceProbabilityParameterType acceptance_probability_parameter)
 {
   // Call the generic get steps function
   do_generic_steps<Derived, StepType, AcceptanceProbabilityParameterType, 
-		   Details::OptionalConceptChecks::StepTypeHasIsExecutable<StepType>::value, Details::OptionalConceptChecks::StepTypeHasSelectionProbabilityFactor<StepType>::value>
+		   Details::OptionalConceptChecks::StepTypeHasIsExecutable<StepType>::value, Details::OptionalConceptChecks::StepTypeHasSelectionProbabilityFactor<StepType>::value,
+		   Details::OptionalConceptChecks::SimulationHasLogAcceptanceProbability<Derived>::value>
     (step_number, acceptance_probability_parameter);
 }
 
 template <class ConfigurationType, class RandomNumberGenerator>
-template <class Derived, class StepType, class AcceptanceProbabilityParameterType, bool STEP_HAS_IS_EXECUTABLE, bool STEP_HAS_SELECTION_PROBABILITY_FACTOR>
+template <class Derived, class StepType, class AcceptanceProbabilityParameterType, bool STEP_HAS_IS_EXECUTABLE, bool STEP_HAS_SELECTION_PROBABILITY_FACTOR, bool SIMULATION_HAS_LOG_ACCEPTANCE_PROBABILITY>
 void Simulation<ConfigurationType, RandomNumberGenerator>::do_generic_steps(const StepNumberType& step_number, AcceptanceProbabilityParameterType acceptance_probability_parameter)
 {
   for (StepNumberType i = 0; i < step_number; ++i)
@@ -113,17 +136,10 @@ void Simulation<ConfigurationType, RandomNumberGenerator>::do_generic_steps(cons
     StepType next_step = this->configuration_space->propose_step(this->rng);
     
     // If the next step is executable, calculate the acceptance probability
-    if (STEP_HAS_IS_EXECUTABLE && next_step.is_executable())
+    if (Details::Simulation::StepExecutable<STEP_HAS_IS_EXECUTABLE>::check(next_step))
     {
-      // Calculate selection probability factor and acceptance probability
-      double step_probability(static_cast<Derived*>(this)->acceptance_probability(next_step, acceptance_probability_parameter));
-      if (STEP_HAS_SELECTION_PROBABILITY_FACTOR)
-      {
-	step_probability /= next_step.selection_probability_factor();
-      }
-
-      // Do the step with the correct probability and call the handlers
-      if (step_probability > 0.0 && (step_probability >= 1.0 || this->rng->random_double() < step_probability))
+      // Do the step with the acceptance probability (linear or logarithmic) divided by the selection probability factor and call the handlers
+      if (Details::Simulation::AcceptanceTest<SIMULATION_HAS_LOG_ACCEPTANCE_PROBABILITY>::template accept<STEP_HAS_SELECTION_PROBABILITY_FACTOR>(static_cast<Derived*>(this), next_step, acceptance_probability_parameter, this->rng))
       {
 	next_step.execute();
 	static_cast<Derived*>(this)->handle_executed_step(next_step, acceptance_probability_parameter);
@@ -139,7 +155,7 @@ void Simulation<ConfigurationType, RandomNumberGenerator>::do_generic_steps(cons
 
 template <class ConfigurationType, class RandomNumberGenerator>
 Simulation<ConfigurationType, RandomNumberGenerator>::Simulation()
-  : rng_seed(0), is_terminating(false)
+  : rng_seed(0), is_terminating(false), deadline_reached(false)
 {
   rng = new RandomNumberGenerator();
   rng->set_seed(rng_seed);
@@ -150,7 +166,7 @@ Simulation<ConfigurationType, RandomNumberGenerator>::Simulation()
 
 template <class ConfigurationType, class RandomNumberGenerator>
 Simulation<ConfigurationType, RandomNumberGenerator>::Simulation(ConfigurationType* new_configuration)
-  : rng_seed(0), is_terminating(false)
+  : rng_seed(0), is_terminating(false), deadline_reached(false)
 {
   rng = new RandomNumberGenerator();
   rng->set_seed(rng_seed);
@@ -192,6 +208,68 @@ void Simulation<ConfigurationType, RandomNumberGenerator>::set_dump_filename(con
   dump_filename = value;
 }
 
+template <class ConfigurationType, class RandomNumberGenerator>
+void Simulation<ConfigurationType, RandomNumberGenerator>::set_wall_clock_budget(double seconds, double safety_margin)
+{
+  wall_clock_budget.set(seconds, safety_margin);
+  deadline_reached = false;
+}
+template <class ConfigurationType, class RandomNumberGenerator>
+void Simulation<ConfigurationType, RandomNumberGenerator>::clear_wall_clock_budget()
+{
+  wall_clock_budget.clear();
+}
+template <class ConfigurationType, class RandomNumberGenerator>
+double Simulation<ConfigurationType, RandomNumberGenerator>::get_remaining_wall_clock_time() const
+{
+  return wall_clock_budget.remaining();
+}
+template <class ConfigurationType, class RandomNumberGenerator>
+bool Simulation<ConfigurationType, RandomNumberGenerator>::get_deadline_reached() const
+{
+  return deadline_reached;
+}
+
+/*!
+  \details The simulation is saved with the virtual save_serialize() to the file dump_filename.tmp, which is renamed to the dump file afterwards. The file is only renamed if the checkpoint was written completely. Since the renaming is atomic, the dump file always contains a complete checkpoint, even if the process is killed while writing.
+
+  If writing or renaming fails, the temporary file is removed, the previous checkpoint is kept and a std::runtime_error is thrown (exceptions of the serialization are rethrown).
+*/
+template <class ConfigurationType, class RandomNumberGenerator>
+void Simulation<ConfigurationType, RandomNumberGenerator>::write_checkpoint() const
+{
+  const std::string temporary_filename = dump_filename + ".tmp";
+  bool written = false;
+  try
+  {
+    std::ofstream output_filestream(temporary_filename.c_str());
+    if (output_filestream.good())
+    {
+      save_serialize(output_filestream);
+      output_filestream.flush();
+      written = output_filestream.good();
+      output_filestream.close();
+      written = written && !output_filestream.fail();
+    }
+  }
+  catch (...)
+  {
+    std::remove(temporary_filename.c_str());
+    throw;
+  }
+
+  if (!written)
+  {
+    std::remove(temporary_filename.c_str());
+    throw std::runtime_error("The checkpoint could not be written to " + temporary_filename + ".");
+  }
+  if (std::rename(temporary_filename.c_str(), dump_filename.c_str()) != 0)
+  {
+    std::remove(temporary_filename.c_str());
+    throw std::runtime_error("The checkpoint could not be renamed to " + dump_filename + ".");
+  }
+}
+
 template <class ConfigurationType, class RandomNumberGenerator>
 void Simulation<ConfigurationType, RandomNumberGenerator>::load_serialize(std::istream& input_stream)
 {
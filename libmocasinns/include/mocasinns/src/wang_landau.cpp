@@ -9,6 +9,10 @@
 
 #ifdef MOCASINNS_WANG_LANDAU_HPP
 
+#include <limits>
+#include <vector>
+#include <cmath>
+
 namespace Mocasinns
 {
 
@@ -25,6 +29,10 @@ WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGenerator
   modification_factor_final(1e-7),
   modification_factor_multiplier(0.9),
   sweep_steps(1000),
+  refinement_threshold(1.0),
+  refinement_minimal_incidence(1000),
+  refinement_level_maximal(4),
+  refinement_modification_factor(0.01),
   prototype_histo()
 {}
 template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
@@ -41,6 +49,10 @@ WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGenerator
   modification_factor_final(other.modification_factor_final),
   modification_factor_multiplier(other.modification_factor_multiplier),
   sweep_steps(other.sweep_steps),
+  refinement_threshold(other.refinement_threshold),
+  refinement_minimal_incidence(other.refinement_minimal_incidence),
+  refinement_level_maximal(other.refinement_level_maximal),
+  refinement_modification_factor(other.refinement_modification_factor),
   prototype_histo(other.prototype_histo)
 {}
 template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
@@ -56,7 +68,11 @@ bool WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGene
 	  (modification_factor_initial == rhs.modification_factor_initial) &&
 	  (modification_factor_final == rhs.modification_factor_final) &&
 	  (modification_factor_multiplier == rhs.modification_factor_multiplier) &&
-	  (sweep_steps == rhs.sweep_steps));
+	  (sweep_steps == rhs.sweep_steps) &&
+	  (refinement_threshold == rhs.refinement_threshold) &&
+	  (refinement_minimal_incidence == rhs.refinement_minimal_incidence) &&
+	  (refinement_level_maximal == rhs.refinement_level_maximal) &&
+	  (refinement_modification_factor == rhs.refinement_modification_factor));
 }
 template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
 bool WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGenerator>::Parameters::operator!=(const Parameters& rhs) const
@@ -83,7 +99,7 @@ void WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGene
 
 template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
 WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGenerator>::WangLandau()
-  : Simulation<ConfigurationType, RandomNumberGenerator>(static_cast<ConfigurationType*>(0)), sweep_counter(0)
+  : Simulation<ConfigurationType, RandomNumberGenerator>(static_cast<ConfigurationType*>(0)), sweep_counter(0), warm_started(false)
 {
   simulation_parameters = Parameters();
   initialise_with_parameters();
@@ -91,14 +107,14 @@ WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGenerator
   
 template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
 WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGenerator>::WangLandau(const Parameters& params) 
-  : Simulation<ConfigurationType, RandomNumberGenerator>(static_cast<ConfigurationType*>(0)), sweep_counter(0)
+  : Simulation<ConfigurationType, RandomNumberGenerator>(static_cast<ConfigurationType*>(0)), sweep_counter(0), warm_started(false)
 {
   simulation_parameters = params;
   initialise_with_parameters();
 }
 template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
 WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGenerator>::WangLandau(const Parameters& params, ConfigurationType* initial_configuration) 
-  : Simulation<ConfigurationType, RandomNumberGenerator>(initial_configuration), sweep_counter(0)
+  : Simulation<ConfigurationType, RandomNumberGenerator>(initial_configuration), sweep_counter(0), warm_started(false)
 {
   simulation_parameters = params;
   initialise_with_parameters();
@@ -106,22 +122,28 @@ WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGenerator
 
 template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
 double WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGenerator>::acceptance_probability(StepType& step_to_execute, Details::Multicanonical::StepParameter<EnergyType>& step_parameters)
+{
+  return exp(log_acceptance_probability(step_to_execute, step_parameters));
+}
+
+template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
+double WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGenerator>::log_acceptance_probability(StepType& step_to_execute, Details::Multicanonical::StepParameter<EnergyType>& step_parameters)
 {
   // Calculate the energy difference of the step
   step_parameters.delta_E = step_to_execute.delta_E();
 
-  // If an energy cutoff is used and the step would violate the energy cutoff, return 0.0
+  // If an energy cutoff is used and the step would violate the energy cutoff, return -infinity
   if ((simulation_parameters.use_energy_cutoff_lower && step_parameters.total_energy + step_parameters.delta_E < simulation_parameters.energy_cutoff_lower) ||
       (simulation_parameters.use_energy_cutoff_upper && step_parameters.total_energy + step_parameters.delta_E > simulation_parameters.energy_cutoff_upper))
-    return 0.0;
+    return -std::numeric_limits<double>::infinity();
 
-  // Calculate and return the acceptance probability
-  // If the new energy is not contained in the density of the states, return an acceptance probability of 1.0
-  typename HistoType<EnergyType, double>::iterator new_energy_bin = log_density_of_states.find(step_parameters.total_energy + step_parameters.delta_E);
+  // Calculate and return the logarithm of the acceptance probability
+  // If the new energy is not contained in the density of the states, return a logarithmic acceptance probability of 0.0
+  typename HistoType<EnergyType, double>::iterator new_energy_bin = log_density_of_states.find_value(step_parameters.total_energy + step_parameters.delta_E);
   if (new_energy_bin != log_density_of_states.end())
-    return exp(log_density_of_states[step_parameters.total_energy] - new_energy_bin->second);
+    return log_density_of_states[step_parameters.total_energy] - new_energy_bin->second;
   else
-    return 1.0;
+    return 0.0;
 }
 
 template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
@@ -132,7 +154,7 @@ void WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGene
   
   // If the according bin does not exist in the density of states, initialise the density of states with the minimum dos + the current modification factor
   // If the according bin does exist, add the current modification factor to the density of states
-  typename HistoType<EnergyType, double>::iterator update_position = log_density_of_states.find(step_parameters.total_energy);
+  typename HistoType<EnergyType, double>::iterator update_position = log_density_of_states.find_value(step_parameters.total_energy);
   if (update_position == log_density_of_states.end())
     log_density_of_states.insert(std::pair<EnergyType, double>(step_parameters.total_energy, log_density_of_states.min_y_value()->second + modification_factor_current));
   else
@@ -140,6 +162,9 @@ void WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGene
   
   // Update the incidence counter
   incidence_counter[step_parameters.total_energy]++;
+
+  // Measure the microcanonical observable
+  if (microcanonical_measurement) microcanonical_measurement->step(incidence_counter.bin_value(step_parameters.total_energy), this->configuration_space);
 }
 
 template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
@@ -148,6 +173,9 @@ void WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGene
   // Update the histograms
   log_density_of_states[step_parameters.total_energy] += modification_factor_current;
   incidence_counter[step_parameters.total_energy]++;
+
+  // Measure the microcanonical observable
+  if (microcanonical_measurement) microcanonical_measurement->step(incidence_counter.bin_value(step_parameters.total_energy), this->configuration_space);
 }
 
 template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
@@ -167,12 +195,15 @@ void WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGene
   // While the flatness is below the desired flatness, do sweep_steps wang landau steps
   while (incidence_counter.flatness() < simulation_parameters.flatness)
   {
-    // Check for signals and return if simulation should be terminated
+    // Check for signals and return if simulation should be terminated or the next sweep would not finish before the deadline
     if (this->check_for_posix_signal()) return;
+    if (this->check_for_deadline(simulation_parameters.sweep_steps)) return;
     // Handle the sweep signal handler
     signal_handler_sweep(this);
 
+    this->wall_clock_budget.begin_work();
     do_wang_landau_steps(simulation_parameters.sweep_steps);
+    this->wall_clock_budget.end_work(simulation_parameters.sweep_steps);
     sweep_counter++;
   }
 }
@@ -190,6 +221,11 @@ void WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGene
     // If the simulation was aborted, exit the loop
     if (this->is_terminating) break;
 
+    // Split the steep bins of an adaptive binning and continue with the same modification factor until the refined incidence counter is flat
+    if (modification_factor_current <= simulation_parameters.refinement_modification_factor &&
+	Details::Multicanonical::refine_bins(log_density_of_states, incidence_counter, simulation_parameters.refinement_threshold, simulation_parameters.refinement_minimal_incidence, simulation_parameters.refinement_level_maximal))
+      continue;
+
     // Reset the incidence counter
     incidence_counter.set_all_y_values(0);
     // Renormalize the density of states
@@ -197,6 +233,88 @@ void WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGene
     // Decrease the modification factor
     modification_factor_current *= simulation_parameters.modification_factor_multiplier;
   }
+
+  // Remove the bins of the warm start that the system never reached, if no step was taken (e.g. the modification factor of the warm start is not above the final one) nothing is known about them yet
+  if (warm_started && !this->is_terminating && incidence_counter.size() > 0)
+  {
+    for (typename HistoType<EnergyType, double>::iterator bin = log_density_of_states.begin(); bin != log_density_of_states.end();)
+    {
+      if (incidence_counter.exists(bin->first)) ++bin;
+      else log_density_of_states.erase(bin++);
+    }
+    warm_started = false;
+  }
+}
+
+/*!
+  \details The entropy per site \f$ s(e) = \ln g(Ne)/N \f$ is approximately independent of the system size N. Therefore the logarithmic density of states of the new system with \f$ N \f$ sites is estimated from the one of the previous system with \f$ N' \f$ sites as
+  \f[
+  \ln g_N(E) = \frac{N}{N'} \ln g_{N'}\left(\frac{N'}{N} E \right)
+  \f]
+  where the values between the bins of the previous density of states are linearly interpolated. The density of states is set for all energies Parameters::binning_reference + k Parameters::binning_width in the rescaled energy range of the previous density of states, so Parameters::binning_width should be the spacing of the energy levels of the new system (e.g. 4 for the Ising model). Bins that are never visited during the following do_wang_landau_simulation are removed at its end, if the simulation takes no step (because the modification factor is not above Parameters::modification_factor_final) all bins are kept.
+
+  Since the rescaled density of states is already a good estimate, the simulation can start at a much smaller modification factor than Parameters::modification_factor_initial. The incidence counter is reset.
+
+  \param previous_log_density_of_states Logarithmic density of states of the previous simulation
+  \param previous_system_size Number of sites of the system of the previous simulation
+  \param modification_factor Modification factor to continue with
+*/
+template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
+void WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGenerator>::warm_start(const HistoType<EnergyType, double>& previous_log_density_of_states, double previous_system_size, double modification_factor)
+{
+  log_density_of_states.initialise_empty(simulation_parameters.prototype_histo);
+  incidence_counter.initialise_empty(simulation_parameters.prototype_histo);
+  modification_factor_current = modification_factor;
+  warm_started = true;
+  if (previous_log_density_of_states.size() == 0) return;
+
+  // Copy the previous density of states for the interpolation
+  std::vector<std::pair<double, double> > previous_values;
+  for (typename HistoType<EnergyType, double>::const_iterator bin = previous_log_density_of_states.begin(); bin != previous_log_density_of_states.end(); ++bin)
+    previous_values.push_back(std::pair<double, double>(static_cast<double>(bin->first), bin->second));
+
+  // Fill the energies of the new binning inside the rescaled energy range
+  const double size_ratio = static_cast<double>(this->configuration_space->system_size()) / previous_system_size;
+  const double reference = static_cast<double>(simulation_parameters.binning_reference);
+  const double width = static_cast<double>(simulation_parameters.binning_width);
+  const long first_bin = static_cast<long>(std::ceil((size_ratio*previous_values.front().first - reference) / width - 1e-9));
+  const long last_bin = static_cast<long>(std::floor((size_ratio*previous_values.back().first - reference) / width + 1e-9));
+
+  unsigned int upper = 0;
+  for (long bin = first_bin; bin <= last_bin; ++bin)
+  {
+    // Place the energy with the binning of the histogram (like the lookups during the simulation) and interpolate at its bin, a bin must not be binned again
+    const EnergyType energy = static_cast<EnergyType>(reference + bin*width);
+    const double previous_energy = static_cast<double>(log_density_of_states.bin_of(energy)) / size_ratio;
+
+    // Find the first previous bin not below the energy and interpolate with the bin before
+    while (upper + 1 < previous_values.size() && previous_values[upper].first < previous_energy) ++upper;
+    double previous_log_density = previous_values[upper].second;
+    if (upper > 0 && previous_values[upper].first > previous_energy)
+    {
+      const std::pair<double, double>& lower_value = previous_values[upper - 1];
+      const double fraction = (previous_energy - lower_value.first) / (previous_values[upper].first - lower_value.first);
+      previous_log_density = lower_value.second + fraction*(previous_values[upper].second - lower_value.second);
+    }
+    typename HistoType<EnergyType, double>::iterator position = log_density_of_states.find_value(energy);
+    if (position == log_density_of_states.end())
+      log_density_of_states.insert(std::pair<EnergyType, double>(energy, size_ratio*previous_log_density));
+    else
+      position->second = size_ratio*previous_log_density;
+  }
+}
+
+/*!
+  \param previous_log_density_of_states_filename Name of the csv file containing the logarithmic density of states of the previous simulation
+  \param previous_system_size Number of sites of the system of the previous simulation
+  \param modification_factor Modification factor to continue with
+*/
+template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
+void WangLandau<ConfigurationType,StepType,EnergyType,HistoType,RandomNumberGenerator>::warm_start(const char* previous_log_density_of_states_filename, double previous_system_size, double modification_factor)
+{
+  HistoType<EnergyType, double> previous_log_density_of_states;
+  previous_log_density_of_states.load_csv(previous_log_density_of_states_filename);
+  warm_start(previous_log_density_of_states, previous_system_size, modification_factor);
 }
 
 template <class ConfigurationType, class StepType, class EnergyType, template <class,class> class HistoType, class RandomNumberGenerator>
@@ -13,9 +13,16 @@
 #include "simulation.hpp"
 #include "concepts/concepts.hpp"
 #include "details/multicanonical/step_parameter.hpp"
+#include "details/multicanonical/microcanonical_measurement.hpp"
+#include "details/multicanonical/bin_refinement.hpp"
 
 // Boost serialization for derived classes
 #include <boost/serialization/base_object.hpp>
+#include <boost/serialization/traits.hpp>
+#include <boost/serialization/version.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <utility>
 
 namespace Mocasinns
 {
@@ -70,20 +77,35 @@ public:
   const HistoType<EnergyType, double>& get_log_density_of_states() const { return log_density_of_states; }
   //! Set-Accessor for the estimation of the density of states
   void set_log_density_of_states(const HistoType<EnergyType, double>& value) { log_density_of_states = value; }
+  //! Set-Accessor for the estimation of the density of states taking a temporary histogram, the bins are moved into the simulation
+  void set_log_density_of_states(HistoType<EnergyType, double>&& value) { log_density_of_states = std::move(value); }
   //! Get-Accessor for the incidence counter
   const HistoType<EnergyType, IncidenceCounterYValueType>& get_incidence_counter() const { return incidence_counter; }
   //! Set-Accessor for the incidence counter
   void set_incidence_counter(const HistoType<EnergyType, IncidenceCounterYValueType>& value) { incidence_counter = value; }
+  //! Set-Accessor for the incidence counter taking a temporary histogram, the bins are moved into the simulation
+  void set_incidence_counter(HistoType<EnergyType, IncidenceCounterYValueType>&& value) { incidence_counter = std::move(value); }
   //! Get-Accessor for the sweep counter
   StepNumberType get_sweep_counter() const { return sweep_counter; }
 
   //! Calculate the acceptance probability of a step
   double acceptance_probability(StepType& step_to_execute, Details::Multicanonical::StepParameter<EnergyType>& step_parameters);
+  //! Calculate the logarithm of the acceptance probability of a step (-infinity if the step is forbidden)
+  double log_acceptance_probability(StepType& step_to_execute, Details::Multicanonical::StepParameter<EnergyType>& step_parameters);
   //! Handle an accepted step
   void handle_executed_step(StepType& executed_step, Details::Multicanonical::StepParameter<EnergyType>& step_parameters);
   //! Handle a rejected step
   void handle_rejected_step(StepType& rejected_step, Details::Multicanonical::StepParameter<EnergyType>& step_parameters);
 
+  //! Attach an accumulator that is called with the energy bin and the observable of the Observator after every measurement_spacing steps (e.g. Accumulators::MicrocanonicalAccumulator), the accumulator must live as long as it is attached
+  template <class Observator, class Accumulator>
+  void attach_microcanonical_accumulator(Accumulator& accumulator, StepNumberType measurement_spacing = 1)
+  {
+    microcanonical_measurement.reset(new Details::Multicanonical::ObservatorMicrocanonicalMeasurement<EnergyType, ConfigurationType, Observator, Accumulator>(accumulator, measurement_spacing));
+  }
+  //! Detach the microcanonical accumulator
+  void detach_microcanonical_accumulator() { microcanonical_measurement.reset(); }
+
   //! Do a certain number of wang-landau steps updating the log_density_of_states and the incidence_counter at the current modification factor
   void do_wang_landau_steps(const uint32_t& number);
   //! Do wang-landau steps until the incidence counter is flat
@@ -91,6 +113,11 @@ public:
   //! Do a complete wang-landau simulation until the final modification factor is reached
   void do_wang_landau_simulation();
 
+  //! Initialise the density of states by rescaling the density of states of a previous simulation of a system with another size and continue at the given modification factor
+  void warm_start(const HistoType<EnergyType, double>& previous_log_density_of_states, double previous_system_size, double modification_factor);
+  //! Initialise the density of states by rescaling the density of states of a previous simulation saved as csv file (see Histograms::HistoBase::save_csv) and continue at the given modification factor
+  void warm_start(const char* previous_log_density_of_states_filename, double previous_system_size, double modification_factor);
+
   //! Load the data of the Wang-Landau simulation from a serialization stream
   virtual void load_serialize(std::istream& input_stream);
   //! Load the data of the Wang-Landau simulation from a serialization file
@@ -111,17 +138,21 @@ private:
   HistoType<EnergyType, double> log_density_of_states;
   //! Histogram for the incidence counter
   HistoType<EnergyType, IncidenceCounterYValueType> incidence_counter;
+  //! Measurement of the microcanonical accumulator, null if no accumulator is attached
+  boost::shared_ptr<Details::Multicanonical::MicrocanonicalMeasurement<EnergyType, ConfigurationType> > microcanonical_measurement;
 
   //! Counter for the number of sweeps
   StepNumberType sweep_counter;
+  //! Flag indicating whether the density of states was initialised by warm_start, the bins that were never visited are removed at the end of the simulation
+  bool warm_started;
 
   //! Set the class properties that depend on the parameters, this function can be called each time the parameters will be updated
   void initialise_with_parameters();
 
   //! Member variable for boost serialization
   friend class boost::serialization::access;
-  //! Method to serialize this class (omitted version name to avoid unused parameter warnings)
-  template<class Archive> void serialize(Archive & ar, const unsigned int)
+  //! Method to serialize this class, the warm start flag is stored since version 1
+  template<class Archive> void serialize(Archive & ar, const unsigned int version)
   {
     // serialize base class information
     ar & boost::serialization::base_object<Simulation<ConfigurationType, RandomNumberGenerator> >(*this);
@@ -129,12 +160,17 @@ private:
     ar & modification_factor_current;
     ar & log_density_of_states;
     ar & incidence_counter;
+    if (version >= 1) ar & warm_started;
   }
 };
 
 //! Struct for dealing with the parameters of a Wang-Landau-simulation
+/*!
+  \details The struct derives from boost::serialization::traits to set its serialization version, BOOST_CLASS_VERSION cannot be used for a class nested in a class template. The refinement parameters are stored since version 1.
+*/
 template<class ConfigurationType, class StepType, class EnergyType, template<class,class> class HistoType, class RandomNumberGenerator>
 struct WangLandau<ConfigurationType, StepType, EnergyType, HistoType, RandomNumberGenerator>::Parameters
+  : public boost::serialization::traits<Parameters, boost::serialization::object_class_info, boost::serialization::track_selectively, 1>
 {
 public:
   //! Energy value that is used as a reference point for the binning
@@ -164,6 +200,15 @@ public:
   //! Number of steps to take before checking again the flatness
   StepNumberType sweep_steps;
 
+  //! Maximal change of the logarithmic density of states across a bin before the bin is split, only used for histograms with adaptive binning (Histograms::HistogramAdaptive)
+  double refinement_threshold;
+  //! Minimal number of visits of a bin before the bin can be split
+  IncidenceCounterYValueType refinement_minimal_incidence;
+  //! Maximal number of times a bin of the initial binning is split
+  unsigned int refinement_level_maximal;
+  //! Bins are only split if the current modification factor is not larger than this value, so that the density of states is already accurate enough to estimate its slope
+  double refinement_modification_factor;
+
   //! Prototype histogram for all settings that the histograms of the simulation can have (e.g. binning width ...)
   HistoType<EnergyType, IncidenceCounterYValueType> prototype_histo;
     
@@ -181,10 +226,9 @@ public:
 private:
   //! Member variable for boost serialization
   friend class boost::serialization::access;
-  //! Method to serialize this class (omitted version name to avoid unused parameter warnings)
-  template<class Archive> void serialize(Archive & ar, const unsigned int)
+  //! Method to serialize this class, the refinement parameters are stored since version 1
+  template<class Archive> void serialize(Archive & ar, const unsigned int version)
   {
-    // serialize base class information
     ar & binning_reference;
     ar & binning_width;
     ar & energy_cutoff_lower;
@@ -196,6 +240,13 @@ private:
     ar & modification_factor_final;
     ar & modification_factor_multiplier;
     ar & sweep_steps;
+    if (version >= 1)
+    {
+      ar & refinement_threshold;
+      ar & refinement_minimal_incidence;
+      ar & refinement_level_maximal;
+      ar & refinement_modification_factor;
+    }
     ar & prototype_histo;
   }
 };
@@ -226,6 +277,21 @@ struct WangLandau<ConfigurationType, StepType, EnergyType, HistoType, RandomNumb
 
 } // of namespace Mocasinns
 
+namespace boost
+{
+  namespace serialization
+  {
+    //! Version of the serialization of WangLandau (BOOST_CLASS_VERSION cannot be used for class templates)
+    template<class ConfigurationType, class StepType, class EnergyType, template<class,class> class HistoType, class RandomNumberGenerator>
+    struct version<Mocasinns::WangLandau<ConfigurationType, StepType, EnergyType, HistoType, RandomNumberGenerator> >
+    {
+      typedef mpl::int_<1> type;
+      typedef mpl::integral_c_tag tag;
+      BOOST_STATIC_CONSTANT(int, value = version::type::value);
+    };
+  }
+}
+
 #include "src/wang_landau.cpp"
 
 #endif
@@ -15,10 +15,15 @@
 #include "test_entropic_sampling.hpp"
 #include "test_metropolis.hpp"
 #include "test_metropolis_parallel.hpp"
+#include "test_kinetic_monte_carlo.hpp"
 #include "test_wang_landau.hpp"
 #include "test_optimal_ensemble_sampling.hpp"
 #include "test_accumulators/test_histogram_accumulator.hpp"
 #include "test_accumulators/test_file_accumulator.hpp"
+#include "test_accumulators/test_moments_accumulator.hpp"
+#include "test_accumulators/test_quantile_accumulator.hpp"
+#include "test_accumulators/test_correlator_accumulator.hpp"
+#include "test_accumulators/test_microcanonical_accumulator.hpp"
 #include "test_histograms/test_binnings.hpp"
 #include "test_histograms/test_histobase.hpp"
 #include "test_histograms/test_histocrete.hpp"
@@ -29,8 +34,15 @@
 #include "test_energy_types/test_array_energy.hpp"
 #include "test_observables/test_array_observable.hpp"
 #include "test_observables/test_histogram_observable.hpp"
+#include "test_observables/test_dense_histogram_observable.hpp"
 #include "test_analysis/test_jackknife_analysis.hpp"
+#include "test_analysis/test_batched_jackknife_analysis.hpp"
 #include "test_analysis/test_bootstrap_analysis.hpp"
+#include "test_analysis/test_mser_equilibration.hpp"
+#include "test_analysis/test_blocking_analysis.hpp"
+#include "test_parallel/test_numa_topology.hpp"
+#include "test_parallel/test_work_stealing_scheduler.hpp"
+#include "test_parallel/test_distributed_coordinator.hpp"
 #include "test_details/test_stl_extensions/test_vector_addable.hpp"
 #include "test_details/test_stl_extensions/test_array_addable.hpp"
 // #include "test_details/test_stl_extensions/test_tuple_addable.hpp"
@@ -54,6 +66,8 @@ int main(int argc, char *argv[])
     runner.addTest(TestMetropolis::suite());
   if (test_all || test_name == "MetropolisParallel")
     runner.addTest(TestMetropolisParallel::suite());
+  if (test_all || test_name == "KineticMonteCarlo")
+    runner.addTest(TestKineticMonteCarlo::suite());
   if (test_all || test_name == "WangLandau")
     runner.addTest(TestWangLandau::suite());
   if (test_all || test_name == "OptimalEnsembleSampling")
@@ -62,11 +76,16 @@ int main(int argc, char *argv[])
   {
     runner.addTest(TestFileAccumulator::suite());
     runner.addTest(TestHistogramAccumulator::suite());
+    runner.addTest(TestMomentsAccumulator::suite());
+    runner.addTest(TestQuantileAccumulator::suite());
+    runner.addTest(TestCorrelatorAccumulator::suite());
+    runner.addTest(TestMicrocanonicalAccumulator::suite());
   }
   if (test_all || test_name == "Histograms")
   {
     runner.addTest(TestBinningNumber::suite());
     runner.addTest(TestBinningNumberVector::suite());
+    runner.addTest(TestBinningAdaptive::suite());
     runner.addTest(TestHistoBase::suite());
     runner.addTest(TestHistocrete::suite());
     runner.addTest(TestHistogram::suite());
@@ -77,14 +96,24 @@ int main(int argc, char *argv[])
     runner.addTest(TestVectorObservable::suite());
     runner.addTest(TestArrayObservable::suite());
     runner.addTest(TestHistogramObservable::suite());
+    runner.addTest(TestDenseHistogramObservable::suite());
     runner.addTest(TestJackknifeAnalysis::suite());
+    runner.addTest(TestBatchedJackknifeAnalysis::suite());
     runner.addTest(TestBootstrapAnalysis::suite());
+    runner.addTest(TestMserEquilibration::suite());
+    runner.addTest(TestBlockingAnalysis::suite());
   }
   if (test_all || test_name == "EnergyTypes")
   {
     runner.addTest(TestVectorEnergy::suite());
     runner.addTest(TestArrayEnergy::suite());
   }
+  if (test_all || test_name == "Parallel")
+  {
+    runner.addTest(TestNumaTopology::suite());
+    runner.addTest(TestWorkStealingScheduler::suite());
+    runner.addTest(TestDistributedCoordinator::suite());
+  }
   if (test_all || test_name == "Details")
   {
     runner.addTest(TestVectorAddable::suite());
@@ -0,0 +1,96 @@
+#include "test_correlator_accumulator.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/normal_distribution.hpp>
+
+CppUnit::Test* TestCorrelatorAccumulator::suite()
+{
+  CppUnit::TestSuite *suite_of_tests = new CppUnit::TestSuite("TestAccumulators/TestCorrelatorAccumulator");
+
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestCorrelatorAccumulator>("TestAccumulators/TestCorrelatorAccumulator: test_lags", &TestCorrelatorAccumulator::test_lags) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestCorrelatorAccumulator>("TestAccumulators/TestCorrelatorAccumulator: test_correlation", &TestCorrelatorAccumulator::test_correlation) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestCorrelatorAccumulator>("TestAccumulators/TestCorrelatorAccumulator: test_merge", &TestCorrelatorAccumulator::test_merge) );
+
+  return suite_of_tests;
+}
+
+void TestCorrelatorAccumulator::setUp()
+{
+  // Autoregressive process x_t = a x_{t-1} + noise with the correlation function a^t var(x) around the mean 3
+  boost::random::mt19937 rng(13);
+  boost::random::normal_distribution<double> noise(0.0, 1.0);
+  coefficient = 0.95;
+  variance = 1.0 / (1.0 - coefficient*coefficient);
+  samples.clear();
+  double x = 0.0;
+  for (unsigned int i = 0; i < 400000; ++i)
+  {
+    x = coefficient*x + noise(rng);
+    samples.push_back(3.0 + x);
+  }
+}
+
+void TestCorrelatorAccumulator::tearDown()
+{
+}
+
+void TestCorrelatorAccumulator::test_lags()
+{
+  CorrelatorAccumulator<double> correlator(8, 2);
+  for (unsigned int i = 0; i < 1024; ++i)
+    correlator(samples[i]);
+
+  // Level 0 gives the lags 0 to 7, level l the lags 4*2^l to 7*2^l
+  std::vector<uint64_t> lags = correlator.lags();
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(0), lags[0]);
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(7), lags[7]);
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(8), lags[8]);
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(14), lags[11]);
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(16), lags[12]);
+  for (unsigned int i = 1; i < lags.size(); ++i)
+    CPPUNIT_ASSERT(lags[i] > lags[i - 1]);
+  CPPUNIT_ASSERT_EQUAL(correlator.correlation().size(), lags.size());
+
+  // The number of levels grows logarithmically with the number of measurements
+  CPPUNIT_ASSERT_EQUAL(11u, correlator.level_number());
+
+  CPPUNIT_ASSERT_THROW(CorrelatorAccumulator<double>(7, 2), std::invalid_argument);
+}
+
+void TestCorrelatorAccumulator::test_correlation()
+{
+  CorrelatorAccumulator<double> correlator;
+  for (unsigned int i = 0; i < samples.size(); ++i)
+    correlator(samples[i]);
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(samples.size()), correlator.count());
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, correlator.mean(), 0.1);
+
+  // Compare with the exact correlation function up to lags of a few correlation times
+  std::vector<uint64_t> lags = correlator.lags();
+  std::vector<double> correlation = correlator.connected_correlation();
+  for (unsigned int i = 0; i < lags.size() && lags[i] <= 64; ++i)
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(std::pow(coefficient, static_cast<double>(lags[i])), correlation[i] / variance, 0.05);
+}
+
+void TestCorrelatorAccumulator::test_merge()
+{
+  // Two independent halves merged give the correlations of both time series
+  CorrelatorAccumulator<double> first, second;
+  for (unsigned int i = 0; i < samples.size() / 2; ++i)
+    first(samples[i]);
+  for (unsigned int i = samples.size() / 2; i < samples.size(); ++i)
+    second(samples[i]);
+  first.merge(second);
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(samples.size()), first.count());
+  std::vector<uint64_t> lags = first.lags();
+  std::vector<double> correlation = first.connected_correlation();
+  for (unsigned int i = 0; i < lags.size() && lags[i] <= 64; ++i)
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(std::pow(coefficient, static_cast<double>(lags[i])), correlation[i] / variance, 0.05);
+
+  CorrelatorAccumulator<double> other(32, 4);
+  CPPUNIT_ASSERT_THROW(first.merge(other), std::invalid_argument);
+}
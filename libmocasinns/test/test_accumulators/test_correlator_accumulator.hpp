@@ -0,0 +1,37 @@
+#ifndef TEST_CORRELATOR_ACCUMULATOR_HPP
+#define TEST_CORRELATOR_ACCUMULATOR_HPP
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/Test.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <vector>
+
+#include <mocasinns/accumulators/correlator_accumulator.hpp>
+
+using namespace Mocasinns::Accumulators;
+
+class TestCorrelatorAccumulator : CppUnit::TestFixture
+{
+private:
+  //! Time series of an autoregressive process with known correlation function
+  std::vector<double> samples;
+  //! Coefficient of the autoregressive process
+  double coefficient;
+  //! Variance of the autoregressive process
+  double variance;
+
+public:
+  static CppUnit::Test* suite();
+  
+  void setUp();
+  void tearDown();
+
+  void test_lags();
+  void test_correlation();
+  void test_merge();
+};
+
+#endif
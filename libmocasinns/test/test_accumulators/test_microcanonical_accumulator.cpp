@@ -0,0 +1,138 @@
+#include "test_microcanonical_accumulator.hpp"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+CppUnit::Test* TestMicrocanonicalAccumulator::suite()
+{
+  CppUnit::TestSuite *suite_of_tests = new CppUnit::TestSuite("TestAccumulators/TestMicrocanonicalAccumulator");
+
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMicrocanonicalAccumulator>("TestAccumulators/TestMicrocanonicalAccumulator: test_operator", &TestMicrocanonicalAccumulator::test_operator) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMicrocanonicalAccumulator>("TestAccumulators/TestMicrocanonicalAccumulator: test_initialise_bins", &TestMicrocanonicalAccumulator::test_initialise_bins) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMicrocanonicalAccumulator>("TestAccumulators/TestMicrocanonicalAccumulator: test_canonical_average", &TestMicrocanonicalAccumulator::test_canonical_average) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMicrocanonicalAccumulator>("TestAccumulators/TestMicrocanonicalAccumulator: test_merge", &TestMicrocanonicalAccumulator::test_merge) );
+
+  return suite_of_tests;
+}
+
+void TestMicrocanonicalAccumulator::setUp()
+{
+}
+
+void TestMicrocanonicalAccumulator::tearDown()
+{
+}
+
+void TestMicrocanonicalAccumulator::test_operator()
+{
+  // Measurements in unsorted energy bins
+  MicrocanonicalAccumulator<int, double> accumulator;
+  accumulator(4, 1.0);
+  accumulator(4, 3.0);
+  accumulator(-4, 5.0);
+  accumulator(0, 2.0);
+  accumulator(4, 5.0);
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(3), accumulator.size());
+  CPPUNIT_ASSERT_EQUAL(-4, accumulator.get_energies()[0]);
+  CPPUNIT_ASSERT_EQUAL(0, accumulator.get_energies()[1]);
+  CPPUNIT_ASSERT_EQUAL(4, accumulator.get_energies()[2]);
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(3), accumulator.get_counts()[2]);
+
+  std::vector<double> averages = accumulator.microcanonical_averages();
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(5.0, averages[0], 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, averages[1], 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, averages[2], 1e-12);
+
+  // Observables with more components
+  MicrocanonicalAccumulator<int, Observables::ArrayObservable<double, 2> > array_accumulator;
+  Observables::ArrayObservable<double, 2> observable;
+  observable[0] = 1.0; observable[1] = -1.0;
+  array_accumulator(2, observable);
+  observable[0] = 3.0; observable[1] = -5.0;
+  array_accumulator(2, observable);
+  std::vector<Observables::ArrayObservable<double, 2> > array_averages = array_accumulator.microcanonical_averages();
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, array_averages[0][0], 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-3.0, array_averages[0][1], 1e-12);
+
+  // The averages of integral observables (e.g. the magnetization of an Ising model) are not truncated
+  MicrocanonicalAccumulator<int, int> integral_accumulator;
+  integral_accumulator(0, 1);
+  integral_accumulator(0, 2);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, integral_accumulator.microcanonical_averages()[0], 1e-12);
+  MicrocanonicalAccumulator<int, Observables::VectorObservable<int> > integral_vector_accumulator;
+  integral_vector_accumulator(0, Observables::VectorObservable<int>(2, -1));
+  integral_vector_accumulator(0, Observables::VectorObservable<int>(2, -2));
+  std::vector<Observables::VectorObservable<double> > integral_vector_averages = integral_vector_accumulator.microcanonical_averages();
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.5, integral_vector_averages[0][1], 1e-12);
+}
+
+void TestMicrocanonicalAccumulator::test_initialise_bins()
+{
+  Histograms::Histocrete<int, double> log_density_of_states;
+  log_density_of_states[-2] = 0.0;
+  log_density_of_states[0] = 1.0;
+  log_density_of_states[2] = 0.0;
+
+  // The bins are aligned with the density of states
+  MicrocanonicalAccumulator<int, double> accumulator;
+  accumulator.initialise_bins(log_density_of_states);
+  CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(3), accumulator.size());
+  accumulator(0, 1.0);
+  accumulator(6, 1.0);
+  CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(4), accumulator.size());
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(0), accumulator.get_counts()[0]);
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(1), accumulator.get_counts()[1]);
+
+  // Bins missing in the density of states are -infinity
+  std::vector<double> aligned = accumulator.aligned_log_density_of_states(log_density_of_states);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, aligned[1], 1e-12);
+  CPPUNIT_ASSERT(aligned[3] == -std::numeric_limits<double>::infinity());
+}
+
+void TestMicrocanonicalAccumulator::test_canonical_average()
+{
+  // Two level system with energies 0 and 1, degeneracies 1 and 3 and the energy as observable
+  Histograms::Histocrete<int, double> log_density_of_states;
+  log_density_of_states[0] = 0.0;
+  log_density_of_states[1] = log(3.0);
+  MicrocanonicalAccumulator<int, double> accumulator;
+  accumulator(0, 0.0);
+  accumulator(1, 1.0);
+  accumulator(1, 1.0);
+
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.75, accumulator.canonical_average(log_density_of_states, 0.0), 1e-12);
+  const double beta = 1.5;
+  const double exact = 3.0*exp(-beta) / (1.0 + 3.0*exp(-beta));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(exact, accumulator.canonical_average(log_density_of_states, beta), 1e-12);
+
+  // Large inverse temperatures do not overflow
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, accumulator.canonical_average(log_density_of_states, 1000.0), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, accumulator.canonical_average(log_density_of_states, -1000.0), 1e-12);
+}
+
+void TestMicrocanonicalAccumulator::test_merge()
+{
+  MicrocanonicalAccumulator<int, double> accumulator_1;
+  accumulator_1(0, 1.0);
+  accumulator_1(2, 4.0);
+  MicrocanonicalAccumulator<int, double> accumulator_2;
+  accumulator_2(2, 2.0);
+  accumulator_2(4, 7.0);
+
+  accumulator_1.merge(accumulator_2);
+  CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(3), accumulator_1.size());
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(2), accumulator_1.get_counts()[1]);
+  std::vector<double> averages = accumulator_1.microcanonical_averages();
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, averages[0], 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, averages[1], 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(7.0, averages[2], 1e-12);
+
+  // Observables with a different number of components
+  MicrocanonicalAccumulator<int, Observables::VectorObservable<double> > vector_accumulator_1;
+  vector_accumulator_1(0, Observables::VectorObservable<double>(2, 1.0));
+  MicrocanonicalAccumulator<int, Observables::VectorObservable<double> > vector_accumulator_2;
+  vector_accumulator_2(0, Observables::VectorObservable<double>(3, 1.0));
+  CPPUNIT_ASSERT_THROW(vector_accumulator_1.merge(vector_accumulator_2), std::range_error);
+}
@@ -0,0 +1,32 @@
+#ifndef TEST_MICROCANONICAL_ACCUMULATOR_HPP
+#define TEST_MICROCANONICAL_ACCUMULATOR_HPP
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/Test.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <mocasinns/accumulators/microcanonical_accumulator.hpp>
+#include <mocasinns/observables/array_observable.hpp>
+#include <mocasinns/observables/vector_observable.hpp>
+#include <mocasinns/histograms/histocrete.hpp>
+
+using namespace Mocasinns;
+using namespace Mocasinns::Accumulators;
+
+class TestMicrocanonicalAccumulator : CppUnit::TestFixture
+{
+public:
+  static CppUnit::Test* suite();
+  
+  void setUp();
+  void tearDown();
+
+  void test_operator();
+  void test_initialise_bins();
+  void test_canonical_average();
+  void test_merge();
+};
+
+#endif
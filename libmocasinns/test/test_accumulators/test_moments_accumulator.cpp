@@ -0,0 +1,208 @@
+#include "test_moments_accumulator.hpp"
+
+#include <boost/accumulators/accumulators.hpp>
+#include <boost/accumulators/statistics/stats.hpp>
+#include <boost/accumulators/statistics/mean.hpp>
+#include <boost/accumulators/statistics/variance.hpp>
+#include <boost/accumulators/statistics/skewness.hpp>
+#include <boost/accumulators/statistics/kurtosis.hpp>
+#include <boost/accumulators/statistics/error_of_mean.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/exponential_distribution.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/archive/text_iarchive.hpp>
+
+#include <sstream>
+
+namespace ba = boost::accumulators;
+
+CppUnit::Test* TestMomentsAccumulator::suite()
+{
+  CppUnit::TestSuite *suite_of_tests = new CppUnit::TestSuite("TestAccumulators/TestMomentsAccumulator");
+
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMomentsAccumulator>("TestAccumulators/TestMomentsAccumulator: test_operator_accumulate", &TestMomentsAccumulator::test_operator_accumulate) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMomentsAccumulator>("TestAccumulators/TestMomentsAccumulator: test_higher_moments", &TestMomentsAccumulator::test_higher_moments) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMomentsAccumulator>("TestAccumulators/TestMomentsAccumulator: test_container_observables", &TestMomentsAccumulator::test_container_observables) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMomentsAccumulator>("TestAccumulators/TestMomentsAccumulator: test_integral_observables", &TestMomentsAccumulator::test_integral_observables) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMomentsAccumulator>("TestAccumulators/TestMomentsAccumulator: test_merge", &TestMomentsAccumulator::test_merge) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMomentsAccumulator>("TestAccumulators/TestMomentsAccumulator: test_serialize", &TestMomentsAccumulator::test_serialize) );
+
+  return suite_of_tests;
+}
+
+void TestMomentsAccumulator::setUp()
+{
+  // Skewed samples with a large offset, so that naive sums of powers would lose precision
+  boost::random::mt19937 rng(5);
+  boost::random::exponential_distribution<double> distribution(1.0);
+  samples.clear();
+  for (unsigned int i = 0; i < 1000; ++i)
+    samples.push_back(1e6 + distribution(rng));
+}
+
+void TestMomentsAccumulator::tearDown()
+{
+}
+
+void TestMomentsAccumulator::test_operator_accumulate()
+{
+  MomentsAccumulator<double> accumulator;
+  ba::accumulator_set<double, ba::stats<ba::tag::mean, ba::tag::variance, ba::tag::error_of<ba::tag::mean> > > reference;
+  for (unsigned int i = 0; i < samples.size(); ++i)
+  {
+    accumulator(samples[i]);
+    reference(samples[i] - 1e6);
+  }
+
+  CPPUNIT_ASSERT_EQUAL(1000ul, accumulator.count());
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), accumulator.component_number());
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(ba::mean(reference) + 1e6, accumulator.mean(), 1e-8);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(ba::variance(reference), accumulator.variance(), 1e-6);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(ba::error_of<ba::tag::mean>(reference), accumulator.error_of_mean(), 1e-6);
+
+  accumulator.reset();
+  CPPUNIT_ASSERT_EQUAL(0ul, accumulator.count());
+}
+
+void TestMomentsAccumulator::test_higher_moments()
+{
+  MomentsAccumulator<double, 4> accumulator;
+  ba::accumulator_set<double, ba::stats<ba::tag::skewness, ba::tag::kurtosis> > reference;
+  for (unsigned int i = 0; i < samples.size(); ++i)
+  {
+    accumulator(samples[i]);
+    reference(samples[i] - 1e6);
+  }
+
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(ba::skewness(reference), accumulator.skewness(), 1e-6);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(ba::kurtosis(reference), accumulator.kurtosis(), 1e-6);
+
+  MomentsAccumulator<double, 3> accumulator_3;
+  for (unsigned int i = 0; i < samples.size(); ++i)
+    accumulator_3(samples[i]);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(ba::skewness(reference), accumulator_3.skewness(), 1e-6);
+}
+
+void TestMomentsAccumulator::test_container_observables()
+{
+  MomentsAccumulator<ArrayObservable<double, 2>, 4> array_accumulator;
+  MomentsAccumulator<VectorObservable<double> > vector_accumulator;
+  MomentsAccumulator<double, 4> scalar_accumulator;
+  for (unsigned int i = 0; i < samples.size(); ++i)
+  {
+    ArrayObservable<double, 2> array_sample;
+    array_sample[0] = samples[i];
+    array_sample[1] = -2.0*samples[i];
+    array_accumulator(array_sample);
+
+    VectorObservable<double> vector_sample(3, samples[i]);
+    vector_sample[2] = 1.0;
+    vector_accumulator(vector_sample);
+
+    scalar_accumulator(samples[i]);
+  }
+
+  ArrayObservable<double, 2> array_mean = array_accumulator.mean();
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(scalar_accumulator.mean(), array_mean[0], 1e-8);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-2.0*scalar_accumulator.mean(), array_mean[1], 1e-8);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0*scalar_accumulator.variance(), array_accumulator.variance()[1], 1e-6);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-scalar_accumulator.skewness(), array_accumulator.skewness()[1], 1e-6);
+
+  VectorObservable<double> vector_variance = vector_accumulator.variance();
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), vector_variance.size());
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(scalar_accumulator.variance(), vector_variance[1], 1e-6);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, vector_variance[2], 1e-12);
+
+  // Observables with a different number of components cannot be accumulated
+  CPPUNIT_ASSERT_THROW(vector_accumulator(VectorObservable<double>(2, 0.0)), ComponentNumbersDoNotMatchException);
+}
+
+void TestMomentsAccumulator::test_integral_observables()
+{
+  // The results of integral observables (e.g. the energy of an Ising model) must not be truncated
+  MomentsAccumulator<int> scalar_accumulator;
+  MomentsAccumulator<VectorObservable<int> > vector_accumulator;
+  MomentsAccumulator<ArrayObservable<int, 2> > array_accumulator;
+  for (int i = 1; i <= 2; ++i)
+  {
+    scalar_accumulator(i);
+    vector_accumulator(VectorObservable<int>(3, -i));
+    ArrayObservable<int, 2> array_sample;
+    array_sample[0] = i;
+    array_sample[1] = 2*i;
+    array_accumulator(array_sample);
+  }
+
+  double scalar_mean = scalar_accumulator.mean();
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, scalar_mean, 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, scalar_accumulator.variance(), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, scalar_accumulator.error_of_mean(), 1e-12);
+
+  VectorObservable<double> vector_mean = vector_accumulator.mean();
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), vector_mean.size());
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.5, vector_mean[2], 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, vector_accumulator.variance()[0], 1e-12);
+
+  ArrayObservable<double, 2> array_error = array_accumulator.error_of_mean();
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, array_error[0], 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, array_error[1], 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, array_accumulator.mean()[1], 1e-12);
+}
+
+void TestMomentsAccumulator::test_merge()
+{
+  // Accumulate the samples in three unequal parts and merge them
+  MomentsAccumulator<double, 4> total;
+  MomentsAccumulator<double, 4> parts[3];
+  for (unsigned int i = 0; i < samples.size(); ++i)
+  {
+    total(samples[i]);
+    parts[(i < 100) ? 0 : (i < 700 ? 1 : 2)](samples[i]);
+  }
+  MomentsAccumulator<double, 4> merged;
+  for (unsigned int p = 0; p < 3; ++p)
+    merged.merge(parts[p]);
+  merged.merge(MomentsAccumulator<double, 4>());
+
+  CPPUNIT_ASSERT_EQUAL(total.count(), merged.count());
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(total.mean(), merged.mean(), 1e-8);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(total.variance(), merged.variance(), 1e-8);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(total.skewness(), merged.skewness(), 1e-8);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(total.kurtosis(), merged.kurtosis(), 1e-8);
+
+  // Accumulators with a different number of components cannot be merged
+  MomentsAccumulator<VectorObservable<double> > vector_1, vector_2;
+  vector_1(VectorObservable<double>(2, 1.0));
+  vector_2(VectorObservable<double>(3, 1.0));
+  CPPUNIT_ASSERT_THROW(vector_1.merge(vector_2), ComponentNumbersDoNotMatchException);
+}
+
+void TestMomentsAccumulator::test_serialize()
+{
+  // Accumulate the first half, save and load the accumulator and accumulate the second half
+  MomentsAccumulator<double, 4> total;
+  MomentsAccumulator<double, 4> first_half;
+  for (unsigned int i = 0; i < samples.size(); ++i)
+  {
+    total(samples[i]);
+    if (i < samples.size()/2) first_half(samples[i]);
+  }
+
+  std::stringstream archive_stream;
+  {
+    boost::archive::text_oarchive output_archive(archive_stream);
+    output_archive << first_half;
+  }
+  MomentsAccumulator<double, 4> restored;
+  {
+    boost::archive::text_iarchive input_archive(archive_stream);
+    input_archive >> restored;
+  }
+  for (unsigned int i = samples.size()/2; i < samples.size(); ++i)
+    restored(samples[i]);
+
+  CPPUNIT_ASSERT_EQUAL(total.count(), restored.count());
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(total.mean(), restored.mean(), 1e-8);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(total.variance(), restored.variance(), 1e-8);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(total.kurtosis(), restored.kurtosis(), 1e-8);
+}
@@ -0,0 +1,38 @@
+#ifndef TEST_MOMENTS_ACCUMULATOR_HPP
+#define TEST_MOMENTS_ACCUMULATOR_HPP
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/Test.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <vector>
+
+#include <mocasinns/accumulators/moments_accumulator.hpp>
+#include <mocasinns/observables/array_observable.hpp>
+#include <mocasinns/observables/vector_observable.hpp>
+
+using namespace Mocasinns::Accumulators;
+using namespace Mocasinns::Observables;
+
+class TestMomentsAccumulator : CppUnit::TestFixture
+{
+private:
+  std::vector<double> samples;
+
+public:
+  static CppUnit::Test* suite();
+  
+  void setUp();
+  void tearDown();
+
+  void test_operator_accumulate();
+  void test_higher_moments();
+  void test_container_observables();
+  void test_integral_observables();
+  void test_merge();
+  void test_serialize();
+};
+
+#endif
@@ -0,0 +1,103 @@
+#include "test_quantile_accumulator.hpp"
+
+#include <algorithm>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/exponential_distribution.hpp>
+
+CppUnit::Test* TestQuantileAccumulator::suite()
+{
+  CppUnit::TestSuite *suite_of_tests = new CppUnit::TestSuite("TestAccumulators/TestQuantileAccumulator");
+
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestQuantileAccumulator>("TestAccumulators/TestQuantileAccumulator: test_operator_accumulate", &TestQuantileAccumulator::test_operator_accumulate) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestQuantileAccumulator>("TestAccumulators/TestQuantileAccumulator: test_quantile", &TestQuantileAccumulator::test_quantile) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestQuantileAccumulator>("TestAccumulators/TestQuantileAccumulator: test_merge", &TestQuantileAccumulator::test_merge) );
+
+  return suite_of_tests;
+}
+
+void TestQuantileAccumulator::setUp()
+{
+  // Heavy-tailed samples (cube of exponential variables)
+  boost::random::mt19937 rng(11);
+  boost::random::exponential_distribution<double> distribution(1.0);
+  samples.clear();
+  for (unsigned int i = 0; i < 200000; ++i)
+  {
+    const double x = distribution(rng);
+    samples.push_back(x*x*x);
+  }
+  sorted_samples = samples;
+  std::sort(sorted_samples.begin(), sorted_samples.end());
+}
+
+void TestQuantileAccumulator::tearDown()
+{
+}
+
+double TestQuantileAccumulator::exact_rank(double value) const
+{
+  return static_cast<double>(std::upper_bound(sorted_samples.begin(), sorted_samples.end(), value) - sorted_samples.begin()) / sorted_samples.size();
+}
+
+void TestQuantileAccumulator::test_operator_accumulate()
+{
+  QuantileAccumulator<double> accumulator;
+  for (unsigned int i = 0; i < samples.size(); ++i)
+    accumulator(samples[i]);
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(samples.size()), accumulator.count());
+  CPPUNIT_ASSERT_EQUAL(sorted_samples.front(), accumulator.min());
+  CPPUNIT_ASSERT_EQUAL(sorted_samples.back(), accumulator.max());
+
+  // The memory is bounded by about 3k items
+  CPPUNIT_ASSERT(accumulator.retained_item_number() < 3*accumulator.get_k() + 32);
+}
+
+void TestQuantileAccumulator::test_quantile()
+{
+  QuantileAccumulator<double> accumulator;
+  for (unsigned int i = 0; i < samples.size(); ++i)
+    accumulator(samples[i]);
+
+  const double fractions[] = {0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99};
+  for (unsigned int f = 0; f < 7; ++f)
+  {
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(fractions[f], exact_rank(accumulator.quantile(fractions[f])), accumulator.rank_error_bound());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(exact_rank(sorted_samples[static_cast<unsigned int>(fractions[f]*samples.size())]), accumulator.rank(sorted_samples[static_cast<unsigned int>(fractions[f]*samples.size())]), accumulator.rank_error_bound());
+  }
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, exact_rank(accumulator.median()), accumulator.rank_error_bound());
+  CPPUNIT_ASSERT_EQUAL(sorted_samples.front(), accumulator.quantile(0.0));
+  CPPUNIT_ASSERT_EQUAL(sorted_samples.back(), accumulator.quantile(1.0));
+
+  // Integral observables, the quantiles are exact as long as no compaction was necessary
+  QuantileAccumulator<int> integer_accumulator;
+  for (int i = 1; i <= 101; ++i)
+    integer_accumulator(i);
+  CPPUNIT_ASSERT_EQUAL(51, integer_accumulator.median());
+  for (int i = 102; i <= 1001; ++i)
+    integer_accumulator(i);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(501.0, static_cast<double>(integer_accumulator.median()), 1001*integer_accumulator.rank_error_bound());
+}
+
+void TestQuantileAccumulator::test_merge()
+{
+  // Accumulate the samples in four parts of different sizes and merge them
+  QuantileAccumulator<double> parts[4];
+  for (unsigned int i = 0; i < samples.size(); ++i)
+    parts[(i < 1000) ? 0 : (i < 50000 ? 1 : (i < 150000 ? 2 : 3))](samples[i]);
+  QuantileAccumulator<double> merged;
+  for (unsigned int p = 0; p < 4; ++p)
+    merged.merge(parts[p]);
+
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(samples.size()), merged.count());
+  CPPUNIT_ASSERT_EQUAL(sorted_samples.front(), merged.min());
+  CPPUNIT_ASSERT_EQUAL(sorted_samples.back(), merged.max());
+  CPPUNIT_ASSERT(merged.retained_item_number() < 3*merged.get_k() + 32);
+  const double fractions[] = {0.01, 0.5, 0.99};
+  for (unsigned int f = 0; f < 3; ++f)
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(fractions[f], exact_rank(merged.quantile(fractions[f])), merged.rank_error_bound());
+
+  // Sketches with different accuracy parameters cannot be merged
+  QuantileAccumulator<double> other(100);
+  CPPUNIT_ASSERT_THROW(merged.merge(other), std::invalid_argument);
+}
@@ -0,0 +1,35 @@
+#ifndef TEST_QUANTILE_ACCUMULATOR_HPP
+#define TEST_QUANTILE_ACCUMULATOR_HPP
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/Test.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <vector>
+
+#include <mocasinns/accumulators/quantile_accumulator.hpp>
+
+using namespace Mocasinns::Accumulators;
+
+class TestQuantileAccumulator : CppUnit::TestFixture
+{
+private:
+  std::vector<double> samples;
+  std::vector<double> sorted_samples;
+
+  double exact_rank(double value) const;
+
+public:
+  static CppUnit::Test* suite();
+  
+  void setUp();
+  void tearDown();
+
+  void test_operator_accumulate();
+  void test_quantile();
+  void test_merge();
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include "test_batched_jackknife_analysis.hpp"
+
+#include <mocasinns/analysis/jackknife_analysis.hpp>
+
+#include <cmath>
+#include <stdexcept>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/normal_distribution.hpp>
+
+//! Functor calculating the ratio of the first two observables and the sum of all observables
+struct RatioAndSum
+{
+  std::vector<double> operator()(const std::vector<double>& means) const
+  {
+    std::vector<double> result(2, 0.0);
+    result[0] = means[0] / means[1];
+    for (unsigned int j = 0; j < means.size(); ++j) result[1] += means[j];
+    return result;
+  }
+};
+
+//! Functor returning a different number of values depending on the mean of the first observable
+struct VaryingSize
+{
+  std::vector<double> operator()(const std::vector<double>& means) const
+  {
+    return std::vector<double>(means[0] > 1.35 ? 2 : 1, means[0]);
+  }
+};
+
+//! Functor throwing for some bins, depending on the mean of the first observable
+struct ThrowingFunction
+{
+  std::vector<double> operator()(const std::vector<double>& means) const
+  {
+    if (means[0] > 1.35) throw std::domain_error("Mean out of range");
+    return std::vector<double>(1, means[0]);
+  }
+};
+
+CppUnit::Test* TestBatchedJackknifeAnalysis::suite()
+{
+  CppUnit::TestSuite *suite_of_tests = new CppUnit::TestSuite("TestObservables/TestBatchedJackknifeAnalysis");
+
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestBatchedJackknifeAnalysis>("TestObservables/TestBatchedJackknifeAnalysis: test_analyse", &TestBatchedJackknifeAnalysis::test_analyse) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestBatchedJackknifeAnalysis>("TestObservables/TestBatchedJackknifeAnalysis: test_covariance", &TestBatchedJackknifeAnalysis::test_covariance) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestBatchedJackknifeAnalysis>("TestObservables/TestBatchedJackknifeAnalysis: test_analyse_function", &TestBatchedJackknifeAnalysis::test_analyse_function) );
+  
+  return suite_of_tests;
+}
+
+void TestBatchedJackknifeAnalysis::test_analyse()
+{
+  // Two columns of measurements, the second column is the first one shifted
+  std::vector<double> values(5, 0.0);
+  values[0] = 1.0;
+  values[1] = 2.0;
+  values[2] = 1.5;
+  values[3] = 0.0;
+  values[4] = 2.0;
+  std::vector<double> matrix(values);
+  for (unsigned int i = 0; i < values.size(); ++i) matrix.push_back(values[i] + 10.0);
+
+  // The results agree with the JackknifeAnalysis of the single columns
+  BatchedJackknifeAnalysis analysis(matrix, 2);
+  CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(5), analysis.get_bin_number());
+  BatchedJackknifeAnalysis::Result result = analysis.analyse();
+  std::pair<double, double> compare = JackknifeAnalysis<double>::analyse(values.begin(), values.end());
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(compare.first, result.value[0], 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(compare.second, result.error[0], 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(compare.first + 10.0, result.value[1], 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(compare.second, result.error[1], 1e-12);
+
+  // Jackknife bins with more than one measurement, the remaining measurement is ignored
+  std::vector<double> shortened(values.begin(), values.begin() + 4);
+  std::pair<double, double> compare_binned = JackknifeAnalysis<double>::analyse(shortened.begin(), shortened.end(), 2);
+  BatchedJackknifeAnalysis::Result result_binned = BatchedJackknifeAnalysis(matrix, 2, 2).analyse();
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(compare_binned.first, result_binned.value[0], 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(compare_binned.second, result_binned.error[0], 1e-12);
+
+  CPPUNIT_ASSERT_THROW(BatchedJackknifeAnalysis(matrix, 3), std::invalid_argument);
+  CPPUNIT_ASSERT_THROW(BatchedJackknifeAnalysis(matrix, 2, 3), std::invalid_argument);
+}
+
+void TestBatchedJackknifeAnalysis::test_covariance()
+{
+  // Columns x, 2x and an independent variable y
+  boost::random::mt19937 rng(5);
+  boost::random::normal_distribution<double> normal(0.0, 1.0);
+  const unsigned int measurement_number = 20000;
+  std::vector<double> matrix(3*measurement_number);
+  for (unsigned int i = 0; i < measurement_number; ++i)
+  {
+    matrix[i] = normal(rng);
+    matrix[measurement_number + i] = 2.0*matrix[i];
+    matrix[2*measurement_number + i] = normal(rng);
+  }
+
+  BatchedJackknifeAnalysis::Result result = BatchedJackknifeAnalysis(matrix, 3, 100).analyse();
+  CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(3), result.size());
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0*result.covariance_element(0, 0), result.covariance_element(0, 1), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(result.covariance_element(0, 1), result.covariance_element(1, 0), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, result.correlation_element(0, 1), 1e-10);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, result.correlation_element(0, 2), 0.25);
+  // The error of the mean of independent standard normal values is 1/sqrt(N)
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0/sqrt(measurement_number), result.error[0], 0.0015);
+}
+
+void TestBatchedJackknifeAnalysis::test_analyse_function()
+{
+  std::vector<double> matrix;
+  for (unsigned int i = 0; i < 8; ++i) matrix.push_back(1.0 + 0.1*i);
+  for (unsigned int i = 0; i < 8; ++i) matrix.push_back(2.0 - 0.05*i);
+  BatchedJackknifeAnalysis analysis(matrix, 2);
+
+  // Compare with the leave-one-out values calculated by hand
+  std::vector<double> ratios;
+  for (unsigned int bin = 0; bin < 8; ++bin)
+  {
+    double sum_0 = 0.0;
+    double sum_1 = 0.0;
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+      if (i == bin) continue;
+      sum_0 += matrix[i];
+      sum_1 += matrix[8 + i];
+    }
+    ratios.push_back(sum_0 / sum_1);
+  }
+  double compare_value = 0.0;
+  for (unsigned int bin = 0; bin < 8; ++bin) compare_value += ratios[bin] / 8.0;
+  double compare_error = 0.0;
+  for (unsigned int bin = 0; bin < 8; ++bin) compare_error += 7.0 / 8.0 * pow(ratios[bin] - compare_value, 2);
+  compare_error = sqrt(compare_error);
+
+  BatchedJackknifeAnalysis::Result result = analysis.analyse(RatioAndSum());
+  CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(2), result.size());
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(compare_value, result.value[0], 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(compare_error, result.error[0], 1e-12);
+
+  // The sum of the means is linear, its jackknife estimate is the mean of all measurements
+  double total = 0.0;
+  for (unsigned int i = 0; i < matrix.size(); ++i) total += matrix[i] / 8.0;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(total, result.value[1], 1e-12);
+
+  // A function returning a different number of values for some bins is rejected after the parallel loop
+  CPPUNIT_ASSERT_THROW(analysis.analyse(VaryingSize()), std::invalid_argument);
+  // An exception of the function inside the parallel loop is passed to the caller
+  CPPUNIT_ASSERT_THROW(analysis.analyse(ThrowingFunction()), std::domain_error);
+}
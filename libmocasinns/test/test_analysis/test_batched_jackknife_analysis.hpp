@@ -0,0 +1,27 @@
+#ifndef TEST_BATCHED_JACKKNIFE_ANALYSIS_HPP
+#define TEST_BATCHED_JACKKNIFE_ANALYSIS_HPP
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/Test.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <mocasinns/analysis/batched_jackknife_analysis.hpp>
+
+using namespace Mocasinns::Analysis;
+
+class TestBatchedJackknifeAnalysis : CppUnit::TestFixture
+{
+public:
+  static CppUnit::Test* suite();
+
+  void setUp() {}
+  void tearDown() {}
+  
+  void test_analyse();
+  void test_covariance();
+  void test_analyse_function();
+};
+
+#endif
@@ -0,0 +1,75 @@
+#include "test_blocking_analysis.hpp"
+
+#include <cmath>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/variate_generator.hpp>
+
+CppUnit::Test* TestBlockingAnalysis::suite()
+{
+  CppUnit::TestSuite *suite_of_tests = new CppUnit::TestSuite("TestObservables/TestBlockingAnalysis");
+
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestBlockingAnalysis>("TestObservables/TestBlockingAnalysis: test_levels", &TestBlockingAnalysis::test_levels) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestBlockingAnalysis>("TestObservables/TestBlockingAnalysis: test_uncorrelated", &TestBlockingAnalysis::test_uncorrelated) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestBlockingAnalysis>("TestObservables/TestBlockingAnalysis: test_correlated", &TestBlockingAnalysis::test_correlated) );
+  
+  return suite_of_tests;
+}
+
+void TestBlockingAnalysis::test_levels()
+{
+  BlockingAnalysis blocking(2);
+  for (unsigned int i = 0; i < 8; ++i)
+    blocking(static_cast<double>(i));
+
+  CPPUNIT_ASSERT_EQUAL(8ul, blocking.get_count());
+  CPPUNIT_ASSERT_EQUAL(4u, blocking.get_level_number());
+  CPPUNIT_ASSERT_EQUAL(4ul, blocking.get_block_number(1));
+  CPPUNIT_ASSERT_EQUAL(2ul, blocking.get_block_number(2));
+  CPPUNIT_ASSERT_EQUAL(1ul, blocking.get_block_number(3));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(3.5, blocking.mean(), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(5.25, blocking.variance(), 1e-12);
+
+  // Level 0: 5.25/7, level 1 (means 0.5, 2.5, 4.5, 6.5): 5/3, level 2 (means 1.5, 5.5): 4
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.75, blocking.variance_of_mean(0), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(5.0/3.0, blocking.variance_of_mean(1), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0, blocking.variance_of_mean(2), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0, blocking.variance_of_mean(), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5*4.0/0.75, blocking.integrated_autocorrelation_time(), 1e-12);
+
+  blocking.clear();
+  CPPUNIT_ASSERT_EQUAL(0ul, blocking.get_count());
+}
+
+void TestBlockingAnalysis::test_uncorrelated()
+{
+  boost::mt19937 rng(42);
+  boost::variate_generator<boost::mt19937&, boost::normal_distribution<double> > normal(rng, boost::normal_distribution<double>(0.0, 1.0));
+
+  BlockingAnalysis blocking;
+  for (unsigned int i = 0; i < 65536; ++i)
+    blocking(normal());
+
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, blocking.mean(), 0.02);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0/256.0, blocking.error_of_mean(), 0.002);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, blocking.integrated_autocorrelation_time(), 0.3);
+}
+
+void TestBlockingAnalysis::test_correlated()
+{
+  // Autoregressive process with correlation 0.9, the integrated autocorrelation time is 0.5*(1 + 0.9)/(1 - 0.9) = 9.5
+  boost::mt19937 rng(42);
+  boost::variate_generator<boost::mt19937&, boost::normal_distribution<double> > normal(rng, boost::normal_distribution<double>(0.0, 1.0));
+
+  BlockingAnalysis blocking;
+  double value = 0.0;
+  for (unsigned int i = 0; i < 262144; ++i)
+  {
+    value = 0.9*value + std::sqrt(1.0 - 0.81)*normal();
+    blocking(value);
+  }
+
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(9.5, blocking.integrated_autocorrelation_time(), 3.0);
+  CPPUNIT_ASSERT(blocking.is_converged(0.3));
+}
@@ -0,0 +1,27 @@
+#ifndef TEST_BLOCKING_ANALYSIS_HPP
+#define TEST_BLOCKING_ANALYSIS_HPP
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/Test.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <mocasinns/analysis/blocking_analysis.hpp>
+
+using namespace Mocasinns::Analysis;
+
+class TestBlockingAnalysis : CppUnit::TestFixture
+{
+public:
+  static CppUnit::Test* suite();
+
+  void setUp() {}
+  void tearDown() {}
+  
+  void test_levels();
+  void test_uncorrelated();
+  void test_correlated();
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include "test_mser_equilibration.hpp"
+
+#include <vector>
+
+CppUnit::Test* TestMserEquilibration::suite()
+{
+  CppUnit::TestSuite *suite_of_tests = new CppUnit::TestSuite("TestObservables/TestMserEquilibration");
+
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMserEquilibration>("TestObservables/TestMserEquilibration: test_transient", &TestMserEquilibration::test_transient) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMserEquilibration>("TestObservables/TestMserEquilibration: test_stationary", &TestMserEquilibration::test_stationary) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMserEquilibration>("TestObservables/TestMserEquilibration: test_drift", &TestMserEquilibration::test_drift) );
+  
+  return suite_of_tests;
+}
+
+void TestMserEquilibration::test_transient()
+{
+  // Exponential decay from 10 to 0 within the first 100 values, afterwards alternating around 0
+  std::vector<double> values;
+  for (unsigned int i = 0; i < 1000; ++i)
+  {
+    double value = (i % 2 == 0) ? 0.5 : -0.5;
+    if (i < 100) value += 10.0 * (100 - i) / 100.0;
+    values.push_back(value);
+  }
+
+  unsigned int truncation = MserEquilibration::analyse(values.begin(), values.end());
+  CPPUNIT_ASSERT(truncation >= 80);
+  CPPUNIT_ASSERT(truncation <= 120);
+  CPPUNIT_ASSERT_EQUAL(truncation % 5, 0u);
+
+  MserEquilibration detector;
+  for (std::vector<double>::const_iterator value = values.begin(); value != values.end(); ++value)
+    detector(*value);
+  CPPUNIT_ASSERT_EQUAL(detector.get_batch_number(), 200u);
+  CPPUNIT_ASSERT_EQUAL(detector.truncation_point(), truncation);
+  CPPUNIT_ASSERT(detector.is_equilibrated());
+}
+
+void TestMserEquilibration::test_stationary()
+{
+  // Deterministic series without transient
+  MserEquilibration detector(10);
+  for (unsigned int i = 0; i < 500; ++i)
+    detector(static_cast<double>((i * 7) % 11));
+
+  CPPUNIT_ASSERT_EQUAL(detector.get_batch_size(), 10u);
+  CPPUNIT_ASSERT_EQUAL(detector.get_batch_number(), 50u);
+  CPPUNIT_ASSERT(detector.is_equilibrated());
+  CPPUNIT_ASSERT(!detector.is_equilibrated(100));
+}
+
+void TestMserEquilibration::test_drift()
+{
+  // Linear ramp, the truncation point is at the end of the allowed range
+  MserEquilibration detector;
+  for (unsigned int i = 0; i < 500; ++i)
+    detector(static_cast<double>(i));
+
+  CPPUNIT_ASSERT(!detector.is_equilibrated());
+  CPPUNIT_ASSERT(detector.truncation_point() >= 200);
+}
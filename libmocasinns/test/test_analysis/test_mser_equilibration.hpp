@@ -0,0 +1,27 @@
+#ifndef TEST_MSER_EQUILIBRATION_HPP
+#define TEST_MSER_EQUILIBRATION_HPP
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/Test.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <mocasinns/analysis/mser_equilibration.hpp>
+
+using namespace Mocasinns::Analysis;
+
+class TestMserEquilibration : CppUnit::TestFixture
+{
+public:
+  static CppUnit::Test* suite();
+
+  void setUp() {}
+  void tearDown() {}
+  
+  void test_transient();
+  void test_stationary();
+  void test_drift();
+};
+
+#endif
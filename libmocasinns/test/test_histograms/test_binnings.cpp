@@ -157,3 +157,64 @@ void TestBinningNumberVector::test_functor()
   CPPUNIT_ASSERT_EQUAL(-2.0, (*test_binning_double_diff)(test_4)[0]);
   CPPUNIT_ASSERT_EQUAL(5.0, (*test_binning_double_diff)(test_4)[1]);
 }
+
+CppUnit::Test* TestBinningAdaptive::suite()
+{
+  CppUnit::TestSuite *suite_of_tests = new CppUnit::TestSuite("TestHistograms/TestBinningAdaptive");
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestBinningAdaptive>("TestHistograms/TestBinningAdaptive: test_functor", &TestBinningAdaptive::test_functor) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestBinningAdaptive>("TestHistograms/TestBinningAdaptive: test_split", &TestBinningAdaptive::test_split) );
+  
+  return suite_of_tests;
+}
+
+void TestBinningAdaptive::setUp()
+{
+  test_binning_double = new BinningAdaptive<double>(1.0, 0.5);
+}
+
+void TestBinningAdaptive::tearDown()
+{
+  delete test_binning_double;
+}
+
+void TestBinningAdaptive::test_functor()
+{
+  // Without refinement the binning is regular
+  CPPUNIT_ASSERT_EQUAL(-1.5, (*test_binning_double)(-0.6));
+  CPPUNIT_ASSERT_EQUAL(-0.5, (*test_binning_double)(-0.4));
+  CPPUNIT_ASSERT_EQUAL(0.5, (*test_binning_double)(0.5));
+  CPPUNIT_ASSERT_EQUAL(2.5, (*test_binning_double)(3.2));
+  CPPUNIT_ASSERT_EQUAL(1.0, test_binning_double->bin_width(2.5));
+}
+
+void TestBinningAdaptive::test_split()
+{
+  // Split one bin
+  test_binning_double->split(0.5);
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), test_binning_double->get_refined_edges().size());
+  CPPUNIT_ASSERT_EQUAL(0.5, (*test_binning_double)(0.9));
+  CPPUNIT_ASSERT_EQUAL(1.0, (*test_binning_double)(1.2));
+  CPPUNIT_ASSERT_EQUAL(1.5, (*test_binning_double)(1.5));
+  CPPUNIT_ASSERT_EQUAL(-0.5, (*test_binning_double)(0.4));
+  CPPUNIT_ASSERT_EQUAL(0.5, test_binning_double->bin_width(0.5));
+  CPPUNIT_ASSERT_EQUAL(0.5, test_binning_double->bin_width(1.0));
+  CPPUNIT_ASSERT_EQUAL(1.0, test_binning_double->bin_width(1.5));
+
+  // Split a half again and a bin that is not adjacent, the regular bins in between stay unchanged
+  test_binning_double->split(1.0);
+  test_binning_double->split(3.5);
+  CPPUNIT_ASSERT_EQUAL(1.25, (*test_binning_double)(1.3));
+  CPPUNIT_ASSERT_EQUAL(0.25, test_binning_double->bin_width(1.0));
+  CPPUNIT_ASSERT_EQUAL(1.5, (*test_binning_double)(2.2));
+  CPPUNIT_ASSERT_EQUAL(1.0, test_binning_double->bin_width(1.5));
+  CPPUNIT_ASSERT_EQUAL(2.5, (*test_binning_double)(3.4));
+  CPPUNIT_ASSERT_EQUAL(3.5, (*test_binning_double)(3.9));
+  CPPUNIT_ASSERT_EQUAL(4.0, (*test_binning_double)(4.4));
+  CPPUNIT_ASSERT_EQUAL(4.5, (*test_binning_double)(4.6));
+
+  // Split a bin below the refined range
+  test_binning_double->split(-1.5);
+  CPPUNIT_ASSERT_EQUAL(-1.0, (*test_binning_double)(-0.6));
+  CPPUNIT_ASSERT_EQUAL(-0.5, (*test_binning_double)(-0.4));
+  CPPUNIT_ASSERT_EQUAL(1.0, test_binning_double->bin_width(-0.5));
+}
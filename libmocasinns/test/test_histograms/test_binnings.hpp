@@ -43,4 +43,19 @@ public:
   void test_functor();
 };
 
+class TestBinningAdaptive : CppUnit::TestFixture
+{
+private:
+  BinningAdaptive<double>* test_binning_double;
+
+public:
+  static CppUnit::Test* suite();
+  
+  void setUp();
+  void tearDown();
+
+  void test_functor();
+  void test_split();
+};
+
 #endif
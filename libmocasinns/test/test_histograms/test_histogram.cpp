@@ -9,6 +9,7 @@ CppUnit::Test* TestHistogram::suite()
     suiteOfTests->addTest( new CppUnit::TestCaller<TestHistogram>("TestHistograms/TestHistogram: test_operator_access", &TestHistogram::test_operator_access ) );
     suiteOfTests->addTest( new CppUnit::TestCaller<TestHistogram>("TestHistograms/TestHistogram: test_operator_increment", &TestHistogram::test_operator_increment ) );
     suiteOfTests->addTest( new CppUnit::TestCaller<TestHistogram>("TestHistograms/TestHistogram: test_operator_divide", &TestHistogram::test_operator_divide ) );
+    suiteOfTests->addTest( new CppUnit::TestCaller<TestHistogram>("TestHistograms/TestHistogram: test_find", &TestHistogram::test_find ) );
 
     suiteOfTests->addTest( new CppUnit::TestCaller<TestHistogram>("TestHistograms/TestHistogram: test_initialise_empty", &TestHistogram::test_initialise_empty ) );
     suiteOfTests->addTest( new CppUnit::TestCaller<TestHistogram>("TestHistograms/TestHistogram: test_insert", &TestHistogram::test_insert ) );
@@ -139,6 +140,31 @@ void TestHistogram::test_operator_divide()
 
 }
 
+void TestHistogram::test_find()
+{
+  // find and exists take bins, find_value and exists_value take values
+  CPPUNIT_ASSERT(testhisto_int->exists(3));
+  CPPUNIT_ASSERT(!testhisto_int->exists(4));
+  CPPUNIT_ASSERT(testhisto_int->exists_value(4));
+  CPPUNIT_ASSERT(testhisto_int->find(4) == testhisto_int->end());
+  CPPUNIT_ASSERT_EQUAL(3, testhisto_int->find_value(4)->first);
+  CPPUNIT_ASSERT_EQUAL(6, testhisto_int->bin_of(8));
+  CPPUNIT_ASSERT_EQUAL(7.5, testhisto_double->bin_of(7.9));
+  CPPUNIT_ASSERT_EQUAL(2.1, testhisto_double->find_value(7.9)->second);
+  CPPUNIT_ASSERT(!testhisto_double->exists_value(10.0));
+
+  // A value at a bin edge of a floating-point binning, its bin 0.1*43 is binned into the bin below again
+  Histogram<double, double, BinningNumber<double> > testhisto_fine(BinningNumber<double>(0.1));
+  testhisto_fine[4.35] = 1.0;
+  const double bin = testhisto_fine.begin()->first;
+  CPPUNIT_ASSERT_EQUAL(0.1*43, bin);
+  CPPUNIT_ASSERT(testhisto_fine.bin_of(bin) != bin);
+  // The bin is found by its key, and by the value
+  CPPUNIT_ASSERT(testhisto_fine.exists(bin));
+  CPPUNIT_ASSERT_EQUAL(1.0, testhisto_fine.find(bin)->second);
+  CPPUNIT_ASSERT_EQUAL(1.0, testhisto_fine.find_value(4.35)->second);
+}
+
 void TestHistogram::test_initialise_empty()
 {
   Histogram<double, double, BinningNumber<double> > initialised_testhisto_double;
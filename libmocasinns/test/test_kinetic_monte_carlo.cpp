@@ -0,0 +1,154 @@
+#include "test_kinetic_monte_carlo.hpp"
+
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+#include <boost/accumulators/accumulators.hpp>
+#include <boost/accumulators/statistics/stats.hpp>
+#include <boost/accumulators/statistics/mean.hpp>
+
+#include <mocasinns/details/kinetic_monte_carlo/rate_tree.hpp>
+
+namespace ba = boost::accumulators;
+
+//! Helper class to measure the energy of a configuration
+class TestKineticMonteCarlo::ObserveIsingEnergy
+{
+public:
+  typedef double observable_type;
+  static observable_type observe(ConfigurationType* config) { return config->energy(); }
+};
+
+CppUnit::Test* TestKineticMonteCarlo::suite()
+{
+  CppUnit::TestSuite *suite_of_tests = new CppUnit::TestSuite("TestKineticMonteCarlo");
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestKineticMonteCarlo>("TestKineticMonteCarlo: test_rate_tree", &TestKineticMonteCarlo::test_rate_tree) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestKineticMonteCarlo>("TestKineticMonteCarlo: test_rate", &TestKineticMonteCarlo::test_rate) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestKineticMonteCarlo>("TestKineticMonteCarlo: test_do_kinetic_monte_carlo_steps", &TestKineticMonteCarlo::test_do_kinetic_monte_carlo_steps) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestKineticMonteCarlo>("TestKineticMonteCarlo: test_do_kinetic_monte_carlo_time", &TestKineticMonteCarlo::test_do_kinetic_monte_carlo_time) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestKineticMonteCarlo>("TestKineticMonteCarlo: test_do_kinetic_monte_carlo_simulation", &TestKineticMonteCarlo::test_do_kinetic_monte_carlo_simulation) );
+    
+  return suite_of_tests;
+}
+
+void TestKineticMonteCarlo::setUp()
+{
+  // Assign the simulation parameters
+  SimulationType::Parameters test_parameters;
+  test_parameters.relaxation_time = 100.0;
+  test_parameters.measurement_number = 10000;
+  test_parameters.time_between_measurement = 2.0;
+
+  // Ring of 8 Ising spins
+  std::vector<unsigned int> size_1d(1, 8);
+
+  test_config_space = new ConfigurationType(size_1d);
+  test_simulation = new SimulationType(test_parameters, test_config_space);
+}
+
+void TestKineticMonteCarlo::tearDown()
+{
+  delete test_config_space;
+  delete test_simulation;
+}
+
+void TestKineticMonteCarlo::test_rate_tree()
+{
+  Details::KineticMonteCarlo::RateTree tree(5);
+  CPPUNIT_ASSERT_EQUAL(5u, tree.size());
+  CPPUNIT_ASSERT_EQUAL(0.0, tree.total_rate());
+
+  tree.set_rate(0, 1.0);
+  tree.set_rate(2, 2.0);
+  tree.set_rate(4, 0.5);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(3.5, tree.total_rate(), 1e-12);
+  CPPUNIT_ASSERT_EQUAL(2.0, tree.get_rate(2));
+
+  // Leaves with zero rate are never found
+  CPPUNIT_ASSERT_EQUAL(0u, tree.find(0.0));
+  CPPUNIT_ASSERT_EQUAL(0u, tree.find(0.99));
+  CPPUNIT_ASSERT_EQUAL(2u, tree.find(1.0));
+  CPPUNIT_ASSERT_EQUAL(2u, tree.find(2.99));
+  CPPUNIT_ASSERT_EQUAL(4u, tree.find(3.0));
+  CPPUNIT_ASSERT_EQUAL(4u, tree.find(3.5));
+
+  // Update a rate
+  tree.set_rate(2, 0.0);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, tree.total_rate(), 1e-12);
+  CPPUNIT_ASSERT_EQUAL(4u, tree.find(1.2));
+}
+
+void TestKineticMonteCarlo::test_rate()
+{
+  // In the ground state every spin flip costs the energy 4
+  std::vector<StepType> steps = test_config_space->all_steps(3);
+  CPPUNIT_ASSERT_EQUAL(1, (int)steps.size());
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(exp(-2.0), test_simulation->rate(steps[0], 0.5), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(exp(-2.0), test_simulation->site_rate(3, 0.5), 1e-12);
+
+  // Glauber rates
+  SimulationType::Parameters glauber_parameters;
+  glauber_parameters.rate_type = SimulationType::glauber_rates;
+  glauber_parameters.attempt_frequency = 2.0;
+  test_simulation->set_parameters(glauber_parameters);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0/(1.0 + exp(2.0)), test_simulation->rate(steps[0], 0.5), 1e-12);
+}
+
+void TestKineticMonteCarlo::test_do_kinetic_monte_carlo_steps()
+{
+  // At infinite temperature every step is executed, the physical time increases by 1/8 per step in average
+  test_simulation->do_kinetic_monte_carlo_steps(10000, 0.0);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(8.0, test_simulation->total_rate(), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1250.0, test_simulation->get_physical_time(), 50.0);
+  CPPUNIT_ASSERT_EQUAL(10000, test_config_space->get_simulation_time());
+}
+
+void TestKineticMonteCarlo::test_do_kinetic_monte_carlo_time()
+{
+  // The physical time must match the given time exactly
+  test_simulation->do_kinetic_monte_carlo_time(12.5, 0.3);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(12.5, test_simulation->get_physical_time(), 1e-12);
+  test_simulation->do_kinetic_monte_carlo_time(7.5, 0.3);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(20.0, test_simulation->get_physical_time(), 1e-12);
+
+  // At infinite temperature 8 events per unit time occur in average
+  int simulation_time_before = test_config_space->get_simulation_time();
+  test_simulation->do_kinetic_monte_carlo_time(1000.0, 0.0);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(8000.0, test_config_space->get_simulation_time() - simulation_time_before, 400.0);
+}
+
+void TestKineticMonteCarlo::test_do_kinetic_monte_carlo_simulation()
+{
+  // Exact mean energy of the periodic Ising chain with 8 spins
+  const double beta = 0.5;
+  const double t = tanh(beta);
+  const double exact_energy = -8.0*(t + pow(t, 7))/(1.0 + pow(t, 8));
+
+  // Perform the simulation with the default observable and metropolis rates
+  ba::accumulator_set<double, ba::stats<ba::tag::mean> > acc_default;
+  test_simulation->do_kinetic_monte_carlo_simulation(beta, acc_default);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(exact_energy, ba::mean(acc_default), 0.1);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(100.0 + 10000*2.0, test_simulation->get_physical_time(), 1e-6);
+
+  // Perform the simulation with glauber rates without accumulator
+  SimulationType::Parameters glauber_parameters = test_simulation->get_simulation_parameters();
+  glauber_parameters.rate_type = SimulationType::glauber_rates;
+  test_simulation->set_parameters(glauber_parameters);
+  std::vector<double> result_vector = test_simulation->do_kinetic_monte_carlo_simulation<ObserveIsingEnergy>(beta);
+  CPPUNIT_ASSERT_EQUAL(10000, (int)result_vector.size());
+  double sum = 0.0;
+  for (unsigned int i = 0; i < result_vector.size(); ++i) sum += result_vector[i];
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(exact_energy, sum/result_vector.size(), 0.1);
+
+  // If the budget is exhausted, the simulation stops already in the relaxation and writes a checkpoint
+  test_simulation->set_dump_filename("kinetic_monte_carlo_checkpoint_test.dat");
+  test_simulation->set_wall_clock_budget(0.0);
+  const double physical_time = test_simulation->get_physical_time();
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), test_simulation->do_kinetic_monte_carlo_simulation<ObserveIsingEnergy>(beta).size());
+  CPPUNIT_ASSERT(test_simulation->get_deadline_reached());
+  CPPUNIT_ASSERT_EQUAL(physical_time, test_simulation->get_physical_time());
+  CPPUNIT_ASSERT(std::ifstream("kinetic_monte_carlo_checkpoint_test.dat").good());
+  std::remove("kinetic_monte_carlo_checkpoint_test.dat");
+}
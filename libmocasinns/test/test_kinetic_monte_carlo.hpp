@@ -0,0 +1,43 @@
+#ifndef TEST_KINETIC_MONTE_CARLO_HPP
+#define TEST_KINETIC_MONTE_CARLO_HPP
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/Test.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <gespinst/spin_lattice.hpp>
+#include <gespinst/spins/ising_spin.hpp>
+
+#include <mocasinns/kinetic_monte_carlo.hpp>
+#include <mocasinns/random/boost_random.hpp>
+
+using namespace Mocasinns;
+
+class TestKineticMonteCarlo : CppUnit::TestFixture
+{
+  typedef Gespinst::SpinLattice<1, Gespinst::IsingSpin> ConfigurationType;
+  typedef Gespinst::SpinLatticeStep<1, Gespinst::IsingSpin> StepType;
+  typedef KineticMonteCarlo<ConfigurationType, StepType, Random::Boost_MT19937> SimulationType;
+
+private:
+  ConfigurationType* test_config_space;
+  SimulationType* test_simulation;
+
+  class ObserveIsingEnergy;
+
+public:
+  static CppUnit::Test* suite();
+  
+  void setUp();
+  void tearDown();
+
+  void test_rate_tree();
+  void test_rate();
+  void test_do_kinetic_monte_carlo_steps();
+  void test_do_kinetic_monte_carlo_time();
+  void test_do_kinetic_monte_carlo_simulation();
+};
+
+#endif
@@ -2,6 +2,12 @@
 
 #include <vector>
 #include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <atomic>
+#include <random>
+#include <cmath>
 
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/stats.hpp>
@@ -9,6 +15,7 @@
 #include <boost/accumulators/statistics/error_of_mean.hpp>
 
 #include <mocasinns/observables/vector_observable.hpp>
+#include <mocasinns/accumulators/correlator_accumulator.hpp>
 
 namespace ba = boost::accumulators;
 
@@ -33,12 +40,47 @@ public:
   }
 };
 
+//! Helper class throwing at the given measurement, used to abort a simulation
+class ThrowAtMeasurement
+{
+public:
+  ThrowAtMeasurement(unsigned int measurement) : remaining(measurement) {}
+  template <class SimulationType> void operator()(SimulationType*)
+  {
+    if (--remaining == 0) throw std::runtime_error("Measurement aborted");
+  }
+private:
+  unsigned int remaining;
+};
+
+//! Helper class measuring the energy that throws from the given observation on, used to fail the measurement pipeline
+class ThrowingObservator
+{
+public:
+  typedef double observable_type;
+  template <class ConfigurationType> static observable_type observe(ConfigurationType* config)
+  {
+    if (++observation_number >= throwing_observation) throw std::runtime_error("Observation failed");
+    return config->energy();
+  }
+  static std::atomic<unsigned int> observation_number;
+  static unsigned int throwing_observation;
+};
+std::atomic<unsigned int> ThrowingObservator::observation_number(0);
+unsigned int ThrowingObservator::throwing_observation = 0;
+
 CppUnit::Test* TestMetropolis::suite()
 {
   CppUnit::TestSuite *suite_of_tests = new CppUnit::TestSuite("TestMetropolis");
   suite_of_tests->addTest( new CppUnit::TestCaller<TestMetropolis>("TestMetropolis: test_do_metropolis_steps", &TestMetropolis::test_do_metropolis_steps) );
   suite_of_tests->addTest( new CppUnit::TestCaller<TestMetropolis>("TestMetropolis: test_do_metropolis_simulation", &TestMetropolis::test_do_metropolis_simulation) );
   suite_of_tests->addTest( new CppUnit::TestCaller<TestMetropolis>("TestMetropolis: test_integrated_autocorrelation_time", &TestMetropolis::test_integrated_autocorrelation_time) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMetropolis>("TestMetropolis: test_correlator_accumulator", &TestMetropolis::test_correlator_accumulator) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMetropolis>("TestMetropolis: test_do_metropolis_relaxation", &TestMetropolis::test_do_metropolis_relaxation) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMetropolis>("TestMetropolis: test_adapt_measurement_spacing", &TestMetropolis::test_adapt_measurement_spacing) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMetropolis>("TestMetropolis: test_target_error", &TestMetropolis::test_target_error) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMetropolis>("TestMetropolis: test_wall_clock_budget", &TestMetropolis::test_wall_clock_budget) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMetropolis>("TestMetropolis: test_pipelined_measurements", &TestMetropolis::test_pipelined_measurements) );
     
   return suite_of_tests;
 }
@@ -105,6 +147,14 @@ void TestMetropolis::test_do_metropolis_simulation()
   for (unsigned int i = 0; i < result_vector.size(); ++i) sum += result_vector.at(i);
   // Test the results
   CPPUNIT_ASSERT_DOUBLES_EQUAL(ba::mean(acc), sum/result_vector.size(), 0.15);
+
+  // Perform the simulation for several temperatures without accumulator
+  std::vector<double> betas;
+  betas.push_back(0.0); betas.push_back(0.1);
+  std::vector<std::vector<double> > result_vectors = test_simulation->do_metropolis_simulation<ObserveIsingEnergy>(betas.begin(), betas.end());
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), result_vectors.size());
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(10000), result_vectors[0].size());
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(10000), result_vectors[1].size());
 }
 
 void TestMetropolis::test_integrated_autocorrelation_time()
@@ -115,3 +165,188 @@ void TestMetropolis::test_integrated_autocorrelation_time()
   // Call the method for a more complicated observable
   Observables::VectorObservable<double> int_auto_time_vec = test_simulation->integrated_autocorrelation_time<ObserveIsingEnergyMagnetization>(0.0, 100, 5);
 }
+
+void TestMetropolis::test_correlator_accumulator()
+{
+  // Measure the correlation function while taking the measurements, at infinite temperature the measurements are uncorrelated
+  Accumulators::CorrelatorAccumulator<double> correlator;
+  test_simulation->do_metropolis_simulation<ObserveIsingEnergy>(0.0, correlator);
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(10000), correlator.count());
+  std::vector<double> correlation = correlator.connected_correlation();
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(32.0, correlation[0], 3.0);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, correlation[1] / correlation[0], 0.1);
+}
+
+void TestMetropolis::test_do_metropolis_relaxation()
+{
+  // Without detection the full number of relaxation steps is performed
+  CPPUNIT_ASSERT_EQUAL(test_simulation->do_metropolis_relaxation(0.2), static_cast<uint64_t>(10000));
+  CPPUNIT_ASSERT_EQUAL(test_simulation->get_equilibration_time(), static_cast<uint64_t>(10000));
+  CPPUNIT_ASSERT(!test_simulation->get_equilibration_detected());
+
+  // With detection the relaxation stops as soon as MSER finds the energy equilibrated
+  SimulationType::Parameters detection_parameters = test_simulation->get_simulation_parameters();
+  detection_parameters.detect_equilibration = true;
+  detection_parameters.equilibration_check_steps = 10;
+  detection_parameters.equilibration_minimal_batches = 10;
+  test_simulation->set_parameters(detection_parameters);
+
+  uint64_t performed_steps = test_simulation->do_metropolis_relaxation(0.2);
+  CPPUNIT_ASSERT(test_simulation->get_equilibration_detected());
+  CPPUNIT_ASSERT(performed_steps < 10000);
+  CPPUNIT_ASSERT(test_simulation->get_equilibration_time() <= performed_steps);
+}
+
+void TestMetropolis::test_adapt_measurement_spacing()
+{
+  // Without adaptation the spacing of the parameters is used
+  SimulationType::Parameters adaptive_parameters = test_simulation->get_simulation_parameters();
+  adaptive_parameters.relaxation_steps = 1000;
+  adaptive_parameters.measurement_number = 2048;
+  adaptive_parameters.steps_between_measurement = 400;
+  test_simulation->set_parameters(adaptive_parameters);
+  test_simulation->do_metropolis_simulation(0.1);
+  CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(400), test_simulation->get_last_steps_between_measurement());
+  CPPUNIT_ASSERT_EQUAL(0.0, test_simulation->get_measurement_autocorrelation_time());
+
+  // At high temperature the correlation time is far below the initial spacing, so the spacing shrinks
+  adaptive_parameters.adapt_measurement_spacing = true;
+  adaptive_parameters.measurement_spacing_window = 256;
+  adaptive_parameters.minimal_steps_between_measurement = 4;
+  test_simulation->set_parameters(adaptive_parameters);
+  std::vector<double> measurements = test_simulation->do_metropolis_simulation(0.1);
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2048), measurements.size());
+  CPPUNIT_ASSERT(test_simulation->get_last_steps_between_measurement() < 100);
+  CPPUNIT_ASSERT(test_simulation->get_last_steps_between_measurement() >= 4);
+  CPPUNIT_ASSERT(test_simulation->get_measurement_autocorrelation_time() > 0.0);
+}
+
+void TestMetropolis::test_target_error()
+{
+  SimulationType::Parameters target_parameters = test_simulation->get_simulation_parameters();
+  target_parameters.relaxation_steps = 1000;
+  target_parameters.measurement_number = 10000;
+  target_parameters.steps_between_measurement = 50;
+  target_parameters.target_error = 0.2;
+  test_simulation->set_parameters(target_parameters);
+
+  // The measurements stop as soon as the target error is reached
+  std::vector<double> measurements = test_simulation->do_metropolis_simulation(0.1);
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(test_simulation->get_last_measurement_number()), measurements.size());
+  CPPUNIT_ASSERT(measurements.size() >= 128);
+  CPPUNIT_ASSERT(measurements.size() < 10000);
+  CPPUNIT_ASSERT(test_simulation->get_last_error_of_mean() <= 0.2);
+
+  // A target that cannot be reached stops at the step budget
+  target_parameters.target_error = 1e-9;
+  target_parameters.measurement_step_budget = 300*50;
+  test_simulation->set_parameters(target_parameters);
+  measurements = test_simulation->do_metropolis_simulation(0.1);
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(300), measurements.size());
+
+  // Strongly correlated AR(1) series x' = phi x + sqrt(1 - phi^2) noise with unit variance, the squared error of the mean is (1 + phi)/(1 - phi)/N
+  // With the minimal number of measurements the blocks are much shorter than the correlation time and the error estimate is far too small
+  const double phi = 0.99;
+  target_parameters.target_error = 0.2;
+  target_parameters.measurement_number = 1000000;
+  target_parameters.steps_between_measurement = 1;
+  target_parameters.measurement_step_budget = 0;
+  const double true_measurement_number = (1.0 + phi)/(1.0 - phi)/(0.2*0.2);
+  std::mt19937 rng(0);
+  std::normal_distribution<double> noise;
+  for (unsigned int series = 0; series < 5; ++series)
+  {
+    Details::Metropolis::ErrorTarget<SimulationType::StepNumberType> error_target(target_parameters);
+    double value = noise(rng);
+    unsigned long m = 0;
+    for (; !error_target.is_finished(m); ++m)
+    {
+      value = phi*value + std::sqrt(1.0 - phi*phi)*noise(rng);
+      error_target.add_steps(1);
+      error_target.observe<ObserveIsingEnergy>(value, static_cast<ConfigurationType*>(0));
+    }
+    CPPUNIT_ASSERT(m > 0.5*true_measurement_number);
+    CPPUNIT_ASSERT(m < 1000000);
+  }
+}
+
+void TestMetropolis::test_wall_clock_budget()
+{
+  SimulationType::Parameters budget_parameters = test_simulation->get_simulation_parameters();
+  budget_parameters.relaxation_steps = 1000;
+  budget_parameters.measurement_number = 100;
+  budget_parameters.steps_between_measurement = 100;
+  test_simulation->set_parameters(budget_parameters);
+  test_simulation->set_dump_filename("metropolis_checkpoint_test.dat");
+
+  // A generous budget does not change the simulation
+  test_simulation->set_wall_clock_budget(1000.0);
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(100), test_simulation->do_metropolis_simulation(0.2).size());
+  CPPUNIT_ASSERT(!test_simulation->get_deadline_reached());
+  CPPUNIT_ASSERT(!std::ifstream("metropolis_checkpoint_test.dat").good());
+
+  // If the budget is exhausted, the simulation stops before the next measurement and writes a checkpoint
+  test_simulation->set_wall_clock_budget(0.0);
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), test_simulation->do_metropolis_simulation(0.2).size());
+  CPPUNIT_ASSERT(test_simulation->get_deadline_reached());
+  CPPUNIT_ASSERT(std::ifstream("metropolis_checkpoint_test.dat").good());
+  // The relaxation is checked against the deadline as well
+  CPPUNIT_ASSERT_EQUAL(static_cast<SimulationType::StepNumberType>(0), test_simulation->get_equilibration_time());
+
+  std::remove("metropolis_checkpoint_test.dat");
+}
+
+void TestMetropolis::test_pipelined_measurements()
+{
+  SimulationType::Parameters pipeline_parameters = test_simulation->get_simulation_parameters();
+  pipeline_parameters.relaxation_steps = 1000;
+  pipeline_parameters.measurement_number = 500;
+  pipeline_parameters.steps_between_measurement = 10;
+  test_simulation->set_parameters(pipeline_parameters);
+  test_simulation->set_random_seed(7);
+  std::vector<ObserveIsingEnergyMagnetization::observable_type> direct_measurements = test_simulation->do_metropolis_simulation<ObserveIsingEnergyMagnetization>(0.3);
+
+  // The pipelined measurements give the same series in the same order, also if the single slot forces the stepping thread to wait
+  for (unsigned int slot_number = 0; slot_number <= 1; ++slot_number)
+  {
+    std::vector<unsigned int> size_2d(2, 4);
+    ConfigurationType pipeline_config_space(size_2d);
+    SimulationType pipeline_simulation(pipeline_parameters, &pipeline_config_space);
+    SimulationType::Parameters worker_parameters = pipeline_parameters;
+    worker_parameters.measurement_worker_number = 2;
+    worker_parameters.measurement_slot_number = slot_number;
+    pipeline_simulation.set_parameters(worker_parameters);
+    pipeline_simulation.set_random_seed(7);
+    std::vector<ObserveIsingEnergyMagnetization::observable_type> pipelined_measurements = pipeline_simulation.do_metropolis_simulation<ObserveIsingEnergyMagnetization>(0.3);
+
+    CPPUNIT_ASSERT_EQUAL(direct_measurements.size(), pipelined_measurements.size());
+    CPPUNIT_ASSERT_EQUAL(500u, pipeline_simulation.get_last_measurement_number());
+    for (unsigned int i = 0; i < direct_measurements.size(); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL(direct_measurements[i][0], pipelined_measurements[i][0]);
+      CPPUNIT_ASSERT_EQUAL(direct_measurements[i][1], pipelined_measurements[i][1]);
+    }
+  }
+
+  // An exception of the stepping thread leaves the parallel region without terminating the program
+  std::vector<unsigned int> size_2d(2, 4);
+  ConfigurationType aborted_config_space(size_2d);
+  SimulationType aborted_simulation(pipeline_parameters, &aborted_config_space);
+  SimulationType::Parameters worker_parameters = pipeline_parameters;
+  worker_parameters.measurement_worker_number = 2;
+  aborted_simulation.set_parameters(worker_parameters);
+  aborted_simulation.signal_handler_measurement.connect(ThrowAtMeasurement(100));
+  CPPUNIT_ASSERT_THROW(aborted_simulation.do_metropolis_simulation<ObserveIsingEnergyMagnetization>(0.3), std::runtime_error);
+
+  // An exception of the observator on a worker thread is rethrown after the parallel region, with free and with full slots
+  ThrowingObservator::throwing_observation = 100;
+  for (unsigned int slot_number = 1; slot_number <= 8; slot_number *= 8)
+  {
+    ConfigurationType failing_config_space(size_2d);
+    SimulationType failing_simulation(pipeline_parameters, &failing_config_space);
+    worker_parameters.measurement_slot_number = slot_number;
+    failing_simulation.set_parameters(worker_parameters);
+    ThrowingObservator::observation_number = 0;
+    CPPUNIT_ASSERT_THROW(failing_simulation.do_metropolis_simulation<ThrowingObservator>(0.3), std::runtime_error);
+  }
+}
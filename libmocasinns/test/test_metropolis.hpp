@@ -38,6 +38,12 @@ public:
   void test_do_metropolis_steps();
   void test_do_metropolis_simulation();
   void test_integrated_autocorrelation_time();
+  void test_correlator_accumulator();
+  void test_do_metropolis_relaxation();
+  void test_adapt_measurement_spacing();
+  void test_target_error();
+  void test_wall_clock_budget();
+  void test_pipelined_measurements();
 };
 
 #endif
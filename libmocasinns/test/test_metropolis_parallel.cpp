@@ -8,6 +8,8 @@
 #include <boost/accumulators/statistics/mean.hpp>
 #include <boost/accumulators/statistics/moment.hpp>
 
+#include <mocasinns/accumulators/moments_accumulator.hpp>
+
 namespace ba = boost::accumulators;
 
 //! Helper class to measure the energy of a configuration
@@ -22,6 +24,12 @@ CppUnit::Test* TestMetropolisParallel::suite()
 {
   CppUnit::TestSuite *suite_of_tests = new CppUnit::TestSuite("TestMetropolisParallel");
   suite_of_tests->addTest( new CppUnit::TestCaller<TestMetropolisParallel>("TestMetropolisParallel: test_do_parallel_metropolis_simulation", &TestMetropolisParallel::test_do_parallel_metropolis_simulation) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMetropolisParallel>("TestMetropolisParallel: test_do_parallel_metropolis_simulation_temperatures", &TestMetropolisParallel::test_do_parallel_metropolis_simulation_temperatures) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMetropolisParallel>("TestMetropolisParallel: test_do_distributed_metropolis_simulation", &TestMetropolisParallel::test_do_distributed_metropolis_simulation) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMetropolisParallel>("TestMetropolisParallel: test_deterministic", &TestMetropolisParallel::test_deterministic) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMetropolisParallel>("TestMetropolisParallel: test_target_error", &TestMetropolisParallel::test_target_error) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMetropolisParallel>("TestMetropolisParallel: test_moments_accumulator", &TestMetropolisParallel::test_moments_accumulator) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestMetropolisParallel>("TestMetropolisParallel: test_deadline_checkpoint_failure", &TestMetropolisParallel::test_deadline_checkpoint_failure) );
     
   return suite_of_tests;
 }
@@ -96,3 +104,265 @@ void TestMetropolisParallel::test_do_parallel_metropolis_simulation()
   CPPUNIT_ASSERT_DOUBLES_EQUAL(ba::mean(accumulator_serial), ba::mean(accumulator_parallel), 1e-4);
   CPPUNIT_ASSERT_DOUBLES_EQUAL(ba::moment<2>(accumulator_serial), ba::moment<2>(accumulator_parallel), 1e-4);
 }
+
+void TestMetropolisParallel::test_do_parallel_metropolis_simulation_temperatures()
+{
+  // Use three runs on two threads, so that the runs of different temperatures are mixed
+  test_parameters.relaxation_steps = 1000;
+  test_parameters.measurement_number = 100;
+  test_parameters.steps_between_measurement = 100;
+  test_parameters.run_number = 3;
+  test_simulation->set_parameters(test_parameters);
+  test_simulation->set_random_seed(0);
+
+  std::vector<double> betas;
+  betas.push_back(0.1); betas.push_back(0.3); betas.push_back(1.0);
+  std::vector<std::vector<double> > parallel_results = test_simulation->do_parallel_metropolis_simulation<ObserveIsingEnergy>(betas.begin(), betas.end());
+  CPPUNIT_ASSERT_EQUAL(betas.size(), parallel_results.size());
+
+  // Every run of every temperature must be routed to the results of its temperature, compare with serial runs with the same seeds
+  SimulationTypeSerial::Parameters parameters_serial;
+  parameters_serial.relaxation_steps = 1000;
+  parameters_serial.measurement_number = 100;
+  parameters_serial.steps_between_measurement = 100;
+  for (unsigned int b = 0; b < betas.size(); ++b)
+  {
+    double serial_sum = 0.0;
+    unsigned int serial_size = 0;
+    for (unsigned int run = 0; run < 3; ++run)
+    {
+      SimulationTypeSerial serial_simulation(parameters_serial, new ConfigurationType(*test_config_space));
+      serial_simulation.set_random_seed(run);
+      std::vector<double> serial_result = serial_simulation.do_metropolis_simulation<ObserveIsingEnergy>(betas[b]);
+      for (unsigned int i = 0; i < serial_result.size(); ++i) serial_sum += serial_result[i];
+      serial_size += serial_result.size();
+      delete serial_simulation.get_config_space();
+    }
+
+    double parallel_sum = 0.0;
+    for (unsigned int i = 0; i < parallel_results[b].size(); ++i) parallel_sum += parallel_results[b][i];
+
+    CPPUNIT_ASSERT_EQUAL(serial_size, static_cast<unsigned int>(parallel_results[b].size()));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(serial_sum, parallel_sum, 1e-8);
+  }
+
+  // Without equilibration detection every run reports the full relaxation
+  CPPUNIT_ASSERT_EQUAL(betas.size(), test_simulation->get_equilibration_times().size());
+  for (unsigned int b = 0; b < betas.size(); ++b)
+  {
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), test_simulation->get_equilibration_times()[b].size());
+    for (unsigned int run = 0; run < 3; ++run)
+      CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(1000), test_simulation->get_equilibration_times()[b][run]);
+  }
+}
+
+void TestMetropolisParallel::test_do_distributed_metropolis_simulation()
+{
+  test_parameters.relaxation_steps = 1000;
+  test_parameters.measurement_number = 100;
+  test_parameters.steps_between_measurement = 100;
+  test_parameters.run_number = 3;
+  test_simulation->set_parameters(test_parameters);
+  test_simulation->set_random_seed(0);
+
+  std::vector<double> betas;
+  betas.push_back(0.1); betas.push_back(1.0);
+
+  // The distributed simulation with local workers must give the same measurements in the same order as a serial loop over the runs
+  std::vector<Details::Metropolis::VectorAccumulator<double> > distributed_results(betas.size());
+  {
+    Parallel::DistributedCoordinator coordinator(static_cast<uint16_t>(0));
+    test_simulation->do_distributed_metropolis_simulation<ObserveIsingEnergy>(coordinator, betas.begin(), betas.end(), distributed_results.begin(), distributed_results.end(), 2);
+  }
+
+  SimulationTypeSerial::Parameters parameters_serial;
+  parameters_serial.relaxation_steps = 1000;
+  parameters_serial.measurement_number = 100;
+  parameters_serial.steps_between_measurement = 100;
+  for (unsigned int b = 0; b < betas.size(); ++b)
+  {
+    std::vector<double> serial_results;
+    for (unsigned int run = 0; run < 3; ++run)
+    {
+      SimulationTypeSerial serial_simulation(parameters_serial, new ConfigurationType(*test_config_space));
+      serial_simulation.set_random_seed(run);
+      std::vector<double> serial_result = serial_simulation.do_metropolis_simulation<ObserveIsingEnergy>(betas[b]);
+      serial_results.insert(serial_results.end(), serial_result.begin(), serial_result.end());
+      delete serial_simulation.get_config_space();
+    }
+
+    CPPUNIT_ASSERT_EQUAL(serial_results.size(), distributed_results[b].internal_vector.size());
+    for (unsigned int i = 0; i < serial_results.size(); ++i)
+      CPPUNIT_ASSERT_EQUAL(serial_results[i], distributed_results[b].internal_vector[i]);
+  }
+
+  // Mergeable accumulators are sent as accumulators of the runs and merged in the order of the tasks like in the deterministic mode
+  std::vector<Accumulators::MomentsAccumulator<double> > distributed_moments(betas.size());
+  test_simulation->do_distributed_metropolis_simulation<ObserveIsingEnergy>(static_cast<uint16_t>(0), "127.0.0.1", betas.begin(), betas.end(), distributed_moments.begin(), distributed_moments.end(), 2);
+  test_parameters.deterministic = true;
+  test_simulation->set_parameters(test_parameters);
+  std::vector<Accumulators::MomentsAccumulator<double> > parallel_moments(betas.size());
+  test_simulation->do_parallel_metropolis_simulation<ObserveIsingEnergy>(betas.begin(), betas.end(), parallel_moments.begin(), parallel_moments.end());
+  for (unsigned int b = 0; b < betas.size(); ++b)
+  {
+    CPPUNIT_ASSERT_EQUAL(300ul, distributed_moments[b].count());
+    CPPUNIT_ASSERT_EQUAL(parallel_moments[b].mean(), distributed_moments[b].mean());
+    CPPUNIT_ASSERT_EQUAL(parallel_moments[b].variance(), distributed_moments[b].variance());
+  }
+}
+
+void TestMetropolisParallel::test_deterministic()
+{
+  test_parameters.relaxation_steps = 1000;
+  test_parameters.measurement_number = 100;
+  test_parameters.steps_between_measurement = 100;
+  test_parameters.run_number = 5;
+  test_parameters.deterministic = true;
+
+  std::vector<double> betas;
+  betas.push_back(0.2); betas.push_back(0.5);
+
+  // The results must be identical for every number of threads
+  std::vector<std::vector<std::vector<double> > > results;
+  for (unsigned int process_number = 1; process_number <= 3; ++process_number)
+  {
+    test_parameters.process_number = process_number;
+    test_simulation->set_parameters(test_parameters);
+    test_simulation->set_random_seed(7);
+    results.push_back(test_simulation->do_parallel_metropolis_simulation<ObserveIsingEnergy>(betas.begin(), betas.end()));
+  }
+  for (unsigned int p = 1; p < results.size(); ++p)
+  {
+    CPPUNIT_ASSERT_EQUAL(results[0].size(), results[p].size());
+    for (unsigned int b = 0; b < betas.size(); ++b)
+    {
+      CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(500), results[p][b].size());
+      for (unsigned int i = 0; i < results[0][b].size(); ++i)
+	CPPUNIT_ASSERT_EQUAL(results[0][b][i], results[p][b][i]);
+    }
+  }
+
+  // The order is the order of the runs, the first measurements belong to run 0 with seed 7
+  SimulationTypeSerial::Parameters parameters_serial;
+  parameters_serial.relaxation_steps = 1000;
+  parameters_serial.measurement_number = 100;
+  parameters_serial.steps_between_measurement = 100;
+  SimulationTypeSerial serial_simulation(parameters_serial, new ConfigurationType(*test_config_space));
+  serial_simulation.set_random_seed(7);
+  std::vector<double> serial_result = serial_simulation.do_metropolis_simulation<ObserveIsingEnergy>(betas[1]);
+  delete serial_simulation.get_config_space();
+  for (unsigned int i = 0; i < serial_result.size(); ++i)
+    CPPUNIT_ASSERT_EQUAL(serial_result[i], results[2][1][i]);
+}
+
+void TestMetropolisParallel::test_target_error()
+{
+  // Runs that have not published are missing, the published runs are extrapolated to all runs
+  Details::Metropolis::RunStatistics run_statistics(4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.01, run_statistics.publish(0, 100, 0.04), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.01, run_statistics.publish(1, 100, 0.04), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(800.0/(210.0*210.0)*0.75, run_statistics.publish(2, 10, 0.0), 1e-12);
+
+  // At high temperature the energy fluctuates little, at the critical temperature strongly, so the runs at high temperature finish first
+  test_parameters.relaxation_steps = 1000;
+  test_parameters.measurement_number = 2000;
+  test_parameters.steps_between_measurement = 50;
+  test_parameters.run_number = 3;
+  test_parameters.target_error = 0.15;
+  test_parameters.minimal_measurement_number = 64;
+  test_simulation->set_parameters(test_parameters);
+  test_simulation->set_random_seed(0);
+
+  std::vector<double> betas;
+  betas.push_back(0.05); betas.push_back(0.44);
+  std::vector<std::vector<double> > results = test_simulation->do_parallel_metropolis_simulation<ObserveIsingEnergy>(betas.begin(), betas.end());
+
+  const std::vector<std::vector<unsigned long> >& measurement_numbers = test_simulation->get_measurement_numbers();
+  CPPUNIT_ASSERT_EQUAL(betas.size(), measurement_numbers.size());
+  unsigned long total_measurements[2] = {0, 0};
+  for (unsigned int b = 0; b < betas.size(); ++b)
+  {
+    for (unsigned int run = 0; run < 3; ++run)
+    {
+      CPPUNIT_ASSERT(measurement_numbers[b][run] >= 64);
+      CPPUNIT_ASSERT(measurement_numbers[b][run] <= 2000);
+      total_measurements[b] += measurement_numbers[b][run];
+    }
+    CPPUNIT_ASSERT_EQUAL(total_measurements[b], static_cast<unsigned long>(results[b].size()));
+  }
+  CPPUNIT_ASSERT(total_measurements[0] < 3*2000);
+  // Every run takes at least half of its share of the measurements, also if it is scheduled after the other runs
+  for (unsigned int run = 0; run < 3; ++run)
+    CPPUNIT_ASSERT(2*3*measurement_numbers[0][run] >= total_measurements[0]);
+  CPPUNIT_ASSERT(total_measurements[0] < total_measurements[1]);
+
+  // A target that cannot be reached stops at the step budget
+  test_parameters.target_error = 1e-9;
+  test_parameters.measurement_step_budget = 100*50;
+  test_simulation->set_parameters(test_parameters);
+  results = test_simulation->do_parallel_metropolis_simulation<ObserveIsingEnergy>(betas.begin(), betas.end());
+  for (unsigned int b = 0; b < betas.size(); ++b)
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3*100), results[b].size());
+
+  // Without target error the runs publish their fixed number of measurements once
+  test_parameters.target_error = 0.0;
+  test_parameters.measurement_number = 100;
+  test_simulation->set_parameters(test_parameters);
+  results = test_simulation->do_parallel_metropolis_simulation<ObserveIsingEnergy>(betas.begin(), betas.end());
+  for (unsigned int b = 0; b < betas.size(); ++b)
+    for (unsigned int run = 0; run < 3; ++run)
+      CPPUNIT_ASSERT_EQUAL(100ul, test_simulation->get_measurement_numbers()[b][run]);
+}
+
+void TestMetropolisParallel::test_moments_accumulator()
+{
+  test_parameters.relaxation_steps = 1000;
+  test_parameters.measurement_number = 100;
+  test_parameters.steps_between_measurement = 100;
+  test_parameters.run_number = 3;
+
+  std::vector<double> betas;
+  betas.push_back(0.2); betas.push_back(0.5);
+
+  // The measurements of all runs of a temperature
+  test_simulation->set_parameters(test_parameters);
+  test_simulation->set_random_seed(3);
+  std::vector<std::vector<double> > results = test_simulation->do_parallel_metropolis_simulation<ObserveIsingEnergy>(betas.begin(), betas.end());
+
+  // The merged accumulators of the runs must have the moments of all measurements, with and without deterministic mode
+  for (unsigned int deterministic = 0; deterministic < 2; ++deterministic)
+  {
+    test_parameters.deterministic = (deterministic == 1);
+    test_simulation->set_parameters(test_parameters);
+    test_simulation->set_random_seed(3);
+    std::vector<Accumulators::MomentsAccumulator<double> > moments(betas.size());
+    test_simulation->do_parallel_metropolis_simulation<ObserveIsingEnergy>(betas.begin(), betas.end(), moments.begin(), moments.end());
+
+    for (unsigned int b = 0; b < betas.size(); ++b)
+    {
+      ba::accumulator_set<double, ba::stats<ba::tag::mean, ba::tag::moment<2> > > accumulator;
+      for (unsigned int i = 0; i < results[b].size(); ++i) accumulator(results[b][i]);
+
+      CPPUNIT_ASSERT_EQUAL(static_cast<unsigned long>(results[b].size()), moments[b].count());
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(ba::mean(accumulator), moments[b].mean(), 1e-8);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(ba::moment<2>(accumulator) - ba::mean(accumulator)*ba::mean(accumulator), moments[b].variance(), 1e-6);
+    }
+  }
+}
+
+void TestMetropolisParallel::test_deadline_checkpoint_failure()
+{
+  test_parameters.relaxation_steps = 1000;
+  test_parameters.measurement_number = 10;
+  test_parameters.steps_between_measurement = 100;
+  test_parameters.run_number = 4;
+  test_simulation->set_parameters(test_parameters);
+
+  // The first run is timed, afterwards the exhausted budget stops the simulation and the checkpoint cannot be written
+  test_simulation->set_dump_filename("checkpoint_missing_directory/checkpoint_test.dat");
+  test_simulation->set_wall_clock_budget(0.0);
+  std::vector<double> betas;
+  betas.push_back(0.2); betas.push_back(0.4);
+  CPPUNIT_ASSERT_THROW(test_simulation->do_parallel_metropolis_simulation<ObserveIsingEnergy>(betas.begin(), betas.end()), std::runtime_error);
+  CPPUNIT_ASSERT(test_simulation->get_deadline_reached());
+}
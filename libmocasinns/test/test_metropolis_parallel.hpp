@@ -37,6 +37,12 @@ public:
   void tearDown();
 
   void test_do_parallel_metropolis_simulation();
+  void test_do_parallel_metropolis_simulation_temperatures();
+  void test_do_distributed_metropolis_simulation();
+  void test_deterministic();
+  void test_target_error();
+  void test_moments_accumulator();
+  void test_deadline_checkpoint_failure();
 };
 
 #endif
@@ -0,0 +1,170 @@
+#include "test_dense_histogram_observable.hpp"
+
+#include <boost/accumulators/accumulators.hpp>
+#include <boost/accumulators/statistics/stats.hpp>
+#include <boost/accumulators/statistics/mean.hpp>
+
+CppUnit::Test* TestDenseHistogramObservable::suite()
+{
+  CppUnit::TestSuite *suite_of_tests = new CppUnit::TestSuite("TestObservables/TestDenseHistogramObservable");
+
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestDenseHistogramObservable>("TestObservables/TestDenseHistogramObservable: test_constructor", &TestDenseHistogramObservable::test_constructor) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestDenseHistogramObservable>("TestObservables/TestDenseHistogramObservable: test_operator_add", &TestDenseHistogramObservable::test_operator_add) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestDenseHistogramObservable>("TestObservables/TestDenseHistogramObservable: test_operator_substract", &TestDenseHistogramObservable::test_operator_substract) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestDenseHistogramObservable>("TestObservables/TestDenseHistogramObservable: test_operator_multiply", &TestDenseHistogramObservable::test_operator_multiply) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestDenseHistogramObservable>("TestObservables/TestDenseHistogramObservable: test_operator_divide", &TestDenseHistogramObservable::test_operator_divide) );
+
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestDenseHistogramObservable>("TestObservables/TestDenseHistogramObservable: test_pow", &TestDenseHistogramObservable::test_pow) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestDenseHistogramObservable>("TestObservables/TestDenseHistogramObservable: test_accumulator", &TestDenseHistogramObservable::test_accumulator) );
+  
+  return suite_of_tests;
+}
+
+void TestDenseHistogramObservable::setUp()
+{
+  Histocrete<int, double> histocrete_1;
+  histocrete_1[0] = 1.0;
+  histocrete_1[2] = 2.5;
+  histocrete_1[4] = -2.0;
+
+  Histocrete<int, double> histocrete_2;
+  histocrete_2[0] = 1.0;
+  histocrete_2[4] = 2.5;
+  histocrete_2[2] = -2.0;
+
+  x_axis = DenseObservable::create_x_axis(histocrete_1);
+  dense_observable_1 = DenseObservable(x_axis, histocrete_1);
+  dense_observable_2 = DenseObservable(x_axis, histocrete_2);
+
+  std::vector<int> other_x_values;
+  other_x_values.push_back(0);
+  other_x_values.push_back(2);
+  other_x_values.push_back(3);
+  dense_observable_3 = DenseObservable(DenseObservable::create_x_axis(other_x_values));
+}
+
+void TestDenseHistogramObservable::tearDown()
+{
+}
+
+void TestDenseHistogramObservable::test_constructor()
+{
+  CPPUNIT_ASSERT_EQUAL(3, static_cast<int>(dense_observable_1.size()));
+  CPPUNIT_ASSERT_EQUAL(2, dense_observable_1.x_value(1));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(2.5, dense_observable_1.at(2), 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-2.0, dense_observable_1[2], 1e-4);
+  CPPUNIT_ASSERT_THROW(dense_observable_1.at(3), XValuesDoNotMatchException);
+
+  // The observables created from one axis share it
+  CPPUNIT_ASSERT(dense_observable_1.get_x_axis() == dense_observable_2.get_x_axis());
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, dense_observable_3.at(3), 1e-4);
+
+  // Bins of the histogram must be on the axis, missing bins are zero
+  Histocrete<int, double> histocrete_partial;
+  histocrete_partial[4] = 1.5;
+  DenseObservable partial(x_axis, histocrete_partial);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, partial.at(0), 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, partial.at(4), 1e-4);
+  histocrete_partial[5] = 1.0;
+  CPPUNIT_ASSERT_THROW(DenseObservable(x_axis, histocrete_partial), XValuesDoNotMatchException);
+  CPPUNIT_ASSERT_THROW(DenseObservable(x_axis, std::vector<double>(2, 0.0)), XValuesDoNotMatchException);
+}
+
+void TestDenseHistogramObservable::test_operator_add()
+{
+  // Test the right result
+  DenseObservable result = dense_observable_1 + dense_observable_2;
+  CPPUNIT_ASSERT_EQUAL(3, static_cast<int>(result.size()));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, result.at(0), 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, result.at(2), 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, result.at(4), 1e-4);
+  CPPUNIT_ASSERT(result.get_x_axis() == x_axis);
+
+  // Test a chain of operations that reuses the temporary results, the operands are unchanged
+  result = dense_observable_1 + dense_observable_2 + dense_observable_1;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, result.at(0), 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, result.at(2), 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.5, result.at(4), 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(2.5, dense_observable_1.at(2), 1e-4);
+
+  // An empty observable acts as zero
+  DenseObservable empty;
+  empty += dense_observable_1;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(2.5, empty.at(2), 1e-4);
+
+  // Observables with equal axis objects are compatible
+  DenseObservable copied_axis(DenseObservable::create_x_axis(*x_axis));
+  result = dense_observable_1 + copied_axis;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-2.0, result.at(4), 1e-4);
+
+  // Test that the operator throws if using not valid histograms
+  CPPUNIT_ASSERT_THROW(result = dense_observable_1 + dense_observable_3, XValuesDoNotMatchException);
+}
+
+void TestDenseHistogramObservable::test_operator_substract()
+{
+  DenseObservable result = dense_observable_1 - dense_observable_2;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, result.at(0), 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(4.5, result.at(2), 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-4.5, result.at(4), 1e-4);
+
+  DenseObservable empty;
+  empty -= dense_observable_1;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-2.5, empty.at(2), 1e-4);
+
+  CPPUNIT_ASSERT_THROW(result = dense_observable_1 - dense_observable_3, XValuesDoNotMatchException);
+}
+
+void TestDenseHistogramObservable::test_operator_multiply()
+{
+  DenseObservable result = dense_observable_1 * dense_observable_2;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, result.at(0), 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-5.0, result.at(2), 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-5.0, result.at(4), 1e-4);
+
+  result = 2.0 * dense_observable_1;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(5.0, result.at(2), 1e-4);
+  result = dense_observable_1 * 2.0;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-4.0, result.at(4), 1e-4);
+
+  CPPUNIT_ASSERT_THROW(result = dense_observable_1 * dense_observable_3, XValuesDoNotMatchException);
+}
+
+void TestDenseHistogramObservable::test_operator_divide()
+{
+  DenseObservable result = dense_observable_1 / dense_observable_2;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, result.at(0), 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.25, result.at(2), 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-0.8, result.at(4), 1e-4);
+
+  result = dense_observable_1 / 2.0;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.25, result.at(2), 1e-4);
+
+  CPPUNIT_ASSERT_THROW(result = dense_observable_1 / dense_observable_3, XValuesDoNotMatchException);
+}
+
+void TestDenseHistogramObservable::test_pow()
+{
+  DenseObservable result = pow(dense_observable_1, 2);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, result.at(0), 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(6.25, result.at(2), 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0, result.at(4), 1e-4);
+
+  result = sqrt(result);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(2.5, result.at(2), 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, result.at(4), 1e-4);
+}
+
+void TestDenseHistogramObservable::test_accumulator()
+{
+  using namespace boost::accumulators;
+  accumulator_set<DenseObservable, stats<tag::mean> > accumulator;
+  accumulator(dense_observable_1);
+  accumulator(dense_observable_2);
+
+  DenseObservable result = mean(accumulator);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, result.at(0), 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, result.at(2), 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, result.at(4), 1e-4);
+  CPPUNIT_ASSERT(result.get_x_axis() == x_axis);
+}
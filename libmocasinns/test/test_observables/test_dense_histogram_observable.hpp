@@ -0,0 +1,40 @@
+#ifndef TEST_DENSE_HISTOGRAM_OBSERVABLE_HPP
+#define TEST_DENSE_HISTOGRAM_OBSERVABLE_HPP
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/Test.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <mocasinns/observables/dense_histogram_observable.hpp>
+#include <mocasinns/histograms/histocrete.hpp>
+
+using namespace Mocasinns::Observables;
+using namespace Mocasinns::Histograms;
+
+class TestDenseHistogramObservable : CppUnit::TestFixture
+{
+private:
+  typedef DenseHistogramObservable<int, double> DenseObservable;
+  DenseObservable::XAxisPointer x_axis;
+  DenseObservable dense_observable_1;
+  DenseObservable dense_observable_2;
+  DenseObservable dense_observable_3;
+
+public:
+  static CppUnit::Test* suite();
+  
+  void setUp();
+  void tearDown();
+
+  void test_constructor();
+  void test_operator_add();
+  void test_operator_substract();
+  void test_operator_multiply();
+  void test_operator_divide();
+  void test_pow();
+  void test_accumulator();
+};
+
+#endif
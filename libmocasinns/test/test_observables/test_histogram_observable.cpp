@@ -42,6 +42,13 @@ void TestHistogramObservable::test_operator_add()
   CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, result[2], 1e-4);
   CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, result[4], 1e-4);
 
+  // Test a chain of operations that reuses the temporary results, the operands are unchanged
+  result = histogram_observable_double_1 + histogram_observable_double_2 + histogram_observable_double_1;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, result[0], 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, result[2], 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.5, result[4], 1e-4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(2.5, histogram_observable_double_1[2], 1e-4);
+
   // Test that the operator throws if using not valid histograms
   CPPUNIT_ASSERT_THROW(result = histogram_observable_double_1 + histogram_observable_double_3, XValuesDoNotMatchException);
 }
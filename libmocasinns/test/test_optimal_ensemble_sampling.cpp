@@ -1,9 +1,26 @@
 #include "test_optimal_ensemble_sampling.hpp"
 
+#include <cstdio>
+#include <fstream>
+
+//! Helper class exhausting the wall clock budget after the given iteration
+class ExhaustBudgetAtIteration
+{
+public:
+  ExhaustBudgetAtIteration(unsigned int iteration) : remaining(iteration) {}
+  template <class SimulationType> void operator()(SimulationType* simulation)
+  {
+    if (--remaining == 0) simulation->set_wall_clock_budget(0.0);
+  }
+private:
+  unsigned int remaining;
+};
+
 CppUnit::Test* TestOptimalEnsembleSampling::suite()
 {
   CppUnit::TestSuite *suite_of_tests = new CppUnit::TestSuite("TestOptimalEnsembleSampling");
   suite_of_tests->addTest( new CppUnit::TestCaller<TestOptimalEnsembleSampling>("TestOptimalEnsembleSampling: test_do_optimal_ensemble_sampling_simulation", &TestOptimalEnsembleSampling::test_do_optimal_ensemble_sampling_simulation) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestOptimalEnsembleSampling>("TestOptimalEnsembleSampling: test_wall_clock_budget", &TestOptimalEnsembleSampling::test_wall_clock_budget) );
 
   return suite_of_tests;
 }
@@ -74,3 +91,36 @@ void TestOptimalEnsembleSampling::test_do_optimal_ensemble_sampling_simulation()
   first_excited++;
   CPPUNIT_ASSERT_DOUBLES_EQUAL(16.0, exp(first_excited->second) / exp(ground_state->second), 0.9);
 }
+
+void TestOptimalEnsembleSampling::test_wall_clock_budget()
+{
+  // If the budget is exhausted before the first iteration, there is no estimate of the density of states
+  test_ising_simulation_1d->set_dump_filename("optimal_ensemble_sampling_checkpoint_test.dat");
+  test_ising_simulation_1d->set_wall_clock_budget(0.0);
+  Histograms::Histocrete<int, double> result = test_ising_simulation_1d->do_optimal_ensemble_sampling_simulation();
+  CPPUNIT_ASSERT(test_ising_simulation_1d->get_deadline_reached());
+  CPPUNIT_ASSERT(result.size() == 0);
+  CPPUNIT_ASSERT_EQUAL(0u, test_ising_simulation_1d->get_iteration_counter());
+  CPPUNIT_ASSERT(std::ifstream("optimal_ensemble_sampling_checkpoint_test.dat").good());
+
+  // If the budget is exhausted after the second iteration, the estimate of the logarithmic density of states of the finished iterations is returned
+  test_ising_simulation_1d->set_wall_clock_budget(3600.0);
+  test_ising_simulation_1d->signal_handler_iteration.connect(ExhaustBudgetAtIteration(2));
+  result = test_ising_simulation_1d->do_optimal_ensemble_sampling_simulation();
+  CPPUNIT_ASSERT(test_ising_simulation_1d->get_deadline_reached());
+  CPPUNIT_ASSERT_EQUAL(2u, test_ising_simulation_1d->get_iteration_counter());
+  CPPUNIT_ASSERT(result.size() == 9);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, result.min_y_value()->second, 1e-10);
+  // The ground state has the smallest density of states but the largest weight
+  CPPUNIT_ASSERT(result[-16] < result[0]);
+  CPPUNIT_ASSERT(test_ising_simulation_1d->get_weights().find(-16)->second > test_ising_simulation_1d->get_weights().find(0)->second);
+
+  // A simulation loaded from the checkpoint continues with the interrupted iteration
+  std::vector<unsigned int> size_1d(1, 16);
+  IsingConfiguration1d loaded_config(size_1d);
+  IsingSimulation1d loaded_simulation(parameters_1d, &loaded_config);
+  loaded_simulation.load_serialize("optimal_ensemble_sampling_checkpoint_test.dat");
+  CPPUNIT_ASSERT_EQUAL(2u, loaded_simulation.get_iteration_counter());
+  CPPUNIT_ASSERT(loaded_simulation.get_weights() == test_ising_simulation_1d->get_weights());
+  std::remove("optimal_ensemble_sampling_checkpoint_test.dat");
+}
@@ -43,6 +43,7 @@ public:
   void tearDown();
 
   void test_do_optimal_ensemble_sampling_simulation();
+  void test_wall_clock_budget();
 };
 
 #endif
@@ -0,0 +1,287 @@
+#include "test_distributed_coordinator.hpp"
+
+#include <vector>
+#include <sstream>
+#include <ctime>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+#include <boost/serialization/vector.hpp>
+
+//! Task returning the serialized square of the task number
+class TestDistributedCoordinator::SquareTask
+{
+public:
+  std::string operator()(unsigned int task) { return serialize_to_string(task*task); }
+};
+
+//! Worker answering the tasks with SquareTask
+class TestDistributedCoordinator::SquareWorker
+{
+public:
+  void operator()(SocketChannel& channel)
+  {
+    SquareTask task;
+    run_distributed_worker(channel, task);
+  }
+};
+
+//! Worker that accepts a task and disconnects without sending a result
+class TestDistributedCoordinator::FailingWorker
+{
+public:
+  void operator()(SocketChannel& channel)
+  {
+    std::string message;
+    channel.receive_message(message);
+  }
+};
+
+//! Worker that performs the tasks but disconnects when it gets task 2, like a worker whose result cannot be sent
+class TestDistributedCoordinator::CrashingWorker
+{
+public:
+  void operator()(SocketChannel& channel)
+  {
+    std::string message;
+    while (channel.receive_message(message) && message != "task 2")
+    {
+      std::istringstream command_stream(message);
+      std::string command;
+      unsigned int task;
+      command_stream >> command >> task;
+      if (command != "task") return;
+      std::ostringstream result;
+      result << "result " << task << "\n" << serialize_to_string(task*task);
+      channel.send_message(result.str());
+    }
+  }
+};
+
+//! Worker that answers every task with the result of another task
+class TestDistributedCoordinator::WrongResultWorker
+{
+public:
+  void operator()(SocketChannel& channel)
+  {
+    std::string message;
+    while (channel.receive_message(message) && message != "stop")
+      channel.send_message("result 99\n" + serialize_to_string(0u));
+  }
+};
+
+//! Worker that accepts a task, announces a result without sending it and hangs without reading the stop message
+class TestDistributedCoordinator::StallingWorker
+{
+public:
+  void operator()(SocketChannel& channel)
+  {
+    std::string message;
+    if (!channel.receive_message(message)) return;
+    const uint32_t length = htonl(10);
+    if (write(channel.get_file_descriptor(), &length, sizeof(length)) != static_cast<ssize_t>(sizeof(length))) return;
+    while (true) sleep(1);
+  }
+};
+
+CppUnit::Test* TestDistributedCoordinator::suite()
+{
+  CppUnit::TestSuite *suite_of_tests = new CppUnit::TestSuite("TestParallel/TestDistributedCoordinator");
+
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestDistributedCoordinator>("TestParallel/TestDistributedCoordinator: test_serialize_to_string", &TestDistributedCoordinator::test_serialize_to_string) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestDistributedCoordinator>("TestParallel/TestDistributedCoordinator: test_run_unix", &TestDistributedCoordinator::test_run_unix) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestDistributedCoordinator>("TestParallel/TestDistributedCoordinator: test_run_tcp", &TestDistributedCoordinator::test_run_tcp) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestDistributedCoordinator>("TestParallel/TestDistributedCoordinator: test_bind_address", &TestDistributedCoordinator::test_bind_address) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestDistributedCoordinator>("TestParallel/TestDistributedCoordinator: test_run_lost_worker", &TestDistributedCoordinator::test_run_lost_worker) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestDistributedCoordinator>("TestParallel/TestDistributedCoordinator: test_run_failing_task", &TestDistributedCoordinator::test_run_failing_task) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestDistributedCoordinator>("TestParallel/TestDistributedCoordinator: test_run_protocol_error", &TestDistributedCoordinator::test_run_protocol_error) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestDistributedCoordinator>("TestParallel/TestDistributedCoordinator: test_run_without_workers", &TestDistributedCoordinator::test_run_without_workers) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestDistributedCoordinator>("TestParallel/TestDistributedCoordinator: test_message_length_limit", &TestDistributedCoordinator::test_message_length_limit) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestDistributedCoordinator>("TestParallel/TestDistributedCoordinator: test_stalling_worker", &TestDistributedCoordinator::test_stalling_worker) );
+
+  return suite_of_tests;
+}
+
+void TestDistributedCoordinator::setUp() {}
+void TestDistributedCoordinator::tearDown() {}
+
+void TestDistributedCoordinator::test_serialize_to_string()
+{
+  std::vector<double> data;
+  data.push_back(1.5); data.push_back(-2.0);
+  std::vector<double> result;
+  deserialize_from_string(serialize_to_string(data), result);
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), result.size());
+  CPPUNIT_ASSERT_EQUAL(1.5, result[0]);
+  CPPUNIT_ASSERT_EQUAL(-2.0, result[1]);
+}
+
+void TestDistributedCoordinator::test_run_unix()
+{
+  std::ostringstream path;
+  path << "/tmp/mocasinns_test_coordinator_" << getpid() << ".socket";
+  DistributedCoordinator coordinator(path.str());
+  coordinator.spawn_local_workers(3, SquareWorker());
+
+  std::vector<std::string> results;
+  coordinator.run(20, results);
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(20), results.size());
+  for (unsigned int t = 0; t < 20; ++t)
+  {
+    unsigned int square;
+    deserialize_from_string(results[t], square);
+    CPPUNIT_ASSERT_EQUAL(t*t, square);
+  }
+
+  // The coordinator can be used for a second round of tasks
+  coordinator.run(5, results);
+  unsigned int square;
+  deserialize_from_string(results[4], square);
+  CPPUNIT_ASSERT_EQUAL(16u, square);
+}
+
+void TestDistributedCoordinator::test_run_tcp()
+{
+  DistributedCoordinator coordinator(static_cast<uint16_t>(0));
+  CPPUNIT_ASSERT(coordinator.get_listener().get_port() != 0);
+  coordinator.spawn_local_workers(2, SquareWorker());
+
+  std::vector<std::string> results;
+  coordinator.run(10, results);
+  unsigned int square;
+  deserialize_from_string(results[7], square);
+  CPPUNIT_ASSERT_EQUAL(49u, square);
+}
+
+void TestDistributedCoordinator::test_bind_address()
+{
+  // The coordinator listens only on the loopback interface unless another address is given
+  {
+    DistributedCoordinator coordinator(static_cast<uint16_t>(0));
+    CPPUNIT_ASSERT_EQUAL(std::string("127.0.0.1"), coordinator.get_listener().get_address());
+  }
+
+  // Local workers reach a coordinator listening on all interfaces
+  DistributedCoordinator coordinator(static_cast<uint16_t>(0), "0.0.0.0");
+  CPPUNIT_ASSERT_EQUAL(std::string("0.0.0.0"), coordinator.get_listener().get_address());
+  coordinator.spawn_local_workers(1, SquareWorker());
+  std::vector<std::string> results;
+  coordinator.run(3, results);
+  unsigned int square;
+  deserialize_from_string(results[2], square);
+  CPPUNIT_ASSERT_EQUAL(4u, square);
+
+  CPPUNIT_ASSERT_THROW(DistributedCoordinator(static_cast<uint16_t>(0), "localhost:1"), ExceptionSocket);
+}
+
+void TestDistributedCoordinator::test_run_lost_worker()
+{
+  // The task of the failing worker must be performed by the other worker
+  DistributedCoordinator coordinator(static_cast<uint16_t>(0));
+  coordinator.spawn_local_workers(1, FailingWorker());
+  coordinator.spawn_local_workers(1, SquareWorker());
+
+  std::vector<std::string> results;
+  coordinator.run(6, results);
+  for (unsigned int t = 0; t < 6; ++t)
+  {
+    unsigned int square;
+    deserialize_from_string(results[t], square);
+    CPPUNIT_ASSERT_EQUAL(t*t, square);
+  }
+}
+
+void TestDistributedCoordinator::test_run_failing_task()
+{
+  // Every worker that gets task 2 is lost, the task is given up after the maximal number of failures instead of killing all workers
+  DistributedCoordinator coordinator(static_cast<uint16_t>(0));
+  coordinator.set_maximal_failure_number(2);
+  coordinator.spawn_local_workers(4, CrashingWorker());
+
+  std::vector<std::string> results;
+  CPPUNIT_ASSERT_THROW(coordinator.run(6, results), ExceptionDistributed);
+  CPPUNIT_ASSERT_EQUAL(0u, coordinator.get_worker_number());
+}
+
+void TestDistributedCoordinator::test_run_protocol_error()
+{
+  // The result of a wrong task is a failure of the task of the worker
+  {
+    DistributedCoordinator coordinator(static_cast<uint16_t>(0));
+    coordinator.set_maximal_failure_number(1);
+    coordinator.spawn_local_workers(1, WrongResultWorker());
+    std::vector<std::string> results;
+    CPPUNIT_ASSERT_THROW(coordinator.run(2, results), ExceptionDistributed);
+  }
+
+  // The worker sending the result of a wrong task is disconnected, its task is performed by the other worker
+  DistributedCoordinator coordinator(static_cast<uint16_t>(0));
+  coordinator.spawn_local_workers(1, WrongResultWorker());
+  coordinator.spawn_local_workers(1, SquareWorker());
+
+  std::vector<std::string> results;
+  coordinator.run(6, results);
+  for (unsigned int t = 0; t < 6; ++t)
+  {
+    unsigned int square;
+    deserialize_from_string(results[t], square);
+    CPPUNIT_ASSERT_EQUAL(t*t, square);
+  }
+}
+
+void TestDistributedCoordinator::test_run_without_workers()
+{
+  DistributedCoordinator coordinator(static_cast<uint16_t>(0));
+  coordinator.set_worker_timeout(100);
+  std::vector<std::string> results;
+  CPPUNIT_ASSERT_THROW(coordinator.run(3, results), ExceptionDistributed);
+
+  // A worker that is lost while no other worker is connected also ends in the timeout
+  coordinator.spawn_local_workers(1, FailingWorker());
+  CPPUNIT_ASSERT_THROW(coordinator.run(3, results), ExceptionDistributed);
+}
+
+void TestDistributedCoordinator::test_message_length_limit()
+{
+  int descriptors[2];
+  CPPUNIT_ASSERT_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, descriptors));
+  SocketChannel sender(descriptors[0]);
+  SocketChannel receiver(descriptors[1]);
+
+  // A normal message is transported
+  std::string message;
+  sender.send_message("square");
+  CPPUNIT_ASSERT(receiver.receive_message(message));
+  CPPUNIT_ASSERT_EQUAL(std::string("square"), message);
+
+  // A frame announcing more than the maximal length is rejected without allocating the announced size
+  const uint32_t length = htonl(SocketChannel::maximal_message_length + 1);
+  CPPUNIT_ASSERT_EQUAL(static_cast<ssize_t>(sizeof(length)), write(descriptors[0], &length, sizeof(length)));
+  CPPUNIT_ASSERT(!receiver.receive_message(message));
+}
+
+void TestDistributedCoordinator::test_stalling_worker()
+{
+  const time_t start_time = time(0);
+  {
+    DistributedCoordinator coordinator(static_cast<uint16_t>(0));
+    coordinator.set_worker_timeout(200);
+    coordinator.set_stop_timeout(200);
+
+    // The stalled result is given up after the worker timeout, then no worker is connected
+    coordinator.spawn_local_workers(1, StallingWorker());
+    std::vector<std::string> results;
+    CPPUNIT_ASSERT_THROW(coordinator.run(1, results), ExceptionDistributed);
+
+    // The coordinator still works with other workers
+    coordinator.spawn_local_workers(1, SquareWorker());
+    coordinator.run(3, results);
+    unsigned int square;
+    deserialize_from_string(results[2], square);
+    CPPUNIT_ASSERT_EQUAL(4u, square);
+
+    // The destructor kills the stalling worker, which does not read the stop message
+  }
+  CPPUNIT_ASSERT(time(0) - start_time < 10);
+}
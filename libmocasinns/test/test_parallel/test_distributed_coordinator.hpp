@@ -0,0 +1,42 @@
+#ifndef TEST_DISTRIBUTED_COORDINATOR_HPP
+#define TEST_DISTRIBUTED_COORDINATOR_HPP
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/Test.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <mocasinns/parallel/distributed_coordinator.hpp>
+
+using namespace Mocasinns::Parallel;
+
+class TestDistributedCoordinator : CppUnit::TestFixture
+{
+private:
+  class SquareTask;
+  class SquareWorker;
+  class FailingWorker;
+  class CrashingWorker;
+  class WrongResultWorker;
+  class StallingWorker;
+
+public:
+  static CppUnit::Test* suite();
+
+  void setUp();
+  void tearDown();
+
+  void test_serialize_to_string();
+  void test_run_unix();
+  void test_run_tcp();
+  void test_bind_address();
+  void test_run_lost_worker();
+  void test_run_failing_task();
+  void test_run_protocol_error();
+  void test_run_without_workers();
+  void test_message_length_limit();
+  void test_stalling_worker();
+};
+
+#endif
@@ -0,0 +1,68 @@
+#include "test_numa_topology.hpp"
+
+CppUnit::Test* TestNumaTopology::suite()
+{
+  CppUnit::TestSuite *suite_of_tests = new CppUnit::TestSuite("TestParallel/TestNumaTopology");
+
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestNumaTopology>("TestParallel/TestNumaTopology: test_parse_cpu_list", &TestNumaTopology::test_parse_cpu_list) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestNumaTopology>("TestParallel/TestNumaTopology: test_detection", &TestNumaTopology::test_detection) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestNumaTopology>("TestParallel/TestNumaTopology: test_thread_cpu", &TestNumaTopology::test_thread_cpu) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestNumaTopology>("TestParallel/TestNumaTopology: test_scoped_thread_pinning", &TestNumaTopology::test_scoped_thread_pinning) );
+
+  return suite_of_tests;
+}
+
+void TestNumaTopology::setUp() {}
+void TestNumaTopology::tearDown() {}
+
+void TestNumaTopology::test_parse_cpu_list()
+{
+  std::vector<unsigned int> cpus = NumaTopology::parse_cpu_list("0-3,8,10-11\n");
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(7), cpus.size());
+  CPPUNIT_ASSERT_EQUAL(0u, cpus[0]);
+  CPPUNIT_ASSERT_EQUAL(3u, cpus[3]);
+  CPPUNIT_ASSERT_EQUAL(8u, cpus[4]);
+  CPPUNIT_ASSERT_EQUAL(10u, cpus[5]);
+  CPPUNIT_ASSERT_EQUAL(11u, cpus[6]);
+
+  CPPUNIT_ASSERT(NumaTopology::parse_cpu_list("").empty());
+}
+
+void TestNumaTopology::test_detection()
+{
+  NumaTopology topology;
+  CPPUNIT_ASSERT(topology.node_number() >= 1);
+  CPPUNIT_ASSERT(topology.cpu_number() >= topology.node_number());
+
+  // Every processor belongs to exactly the node it is listed in
+  for (unsigned int node = 0; node < topology.node_number(); ++node)
+    for (unsigned int i = 0; i < topology.node_cpus(node).size(); ++i)
+      CPPUNIT_ASSERT_EQUAL(static_cast<int>(node), topology.cpu_node(topology.node_cpus(node)[i]));
+}
+
+void TestNumaTopology::test_thread_cpu()
+{
+  NumaTopology topology;
+  const unsigned int thread_number = 2*topology.cpu_number() + 1;
+  for (unsigned int thread = 0; thread < thread_number; ++thread)
+  {
+    const int node = topology.cpu_node(topology.thread_cpu(thread, thread_number));
+    CPPUNIT_ASSERT(node >= 0);
+    CPPUNIT_ASSERT_EQUAL(static_cast<int>(thread % topology.node_number()), node);
+  }
+}
+
+void TestNumaTopology::test_scoped_thread_pinning()
+{
+  NumaTopology topology;
+  const unsigned int cpu = topology.thread_cpu(0, 1);
+  {
+    ScopedThreadPinning pinning(cpu);
+    if (pinning.is_pinned())
+      CPPUNIT_ASSERT_EQUAL(static_cast<int>(cpu), NumaTopology::current_cpu());
+  }
+
+  // After the pinning the thread may run on all processors again
+  NumaTopology restored_topology;
+  CPPUNIT_ASSERT_EQUAL(topology.cpu_number(), restored_topology.cpu_number());
+}
@@ -0,0 +1,28 @@
+#ifndef TEST_NUMA_TOPOLOGY_HPP
+#define TEST_NUMA_TOPOLOGY_HPP
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/Test.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <mocasinns/parallel/numa_topology.hpp>
+
+using namespace Mocasinns::Parallel;
+
+class TestNumaTopology : CppUnit::TestFixture
+{
+public:
+  static CppUnit::Test* suite();
+
+  void setUp();
+  void tearDown();
+
+  void test_parse_cpu_list();
+  void test_detection();
+  void test_thread_cpu();
+  void test_scoped_thread_pinning();
+};
+
+#endif
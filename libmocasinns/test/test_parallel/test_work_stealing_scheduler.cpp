@@ -0,0 +1,74 @@
+#include "test_work_stealing_scheduler.hpp"
+
+#include <vector>
+
+CppUnit::Test* TestWorkStealingScheduler::suite()
+{
+  CppUnit::TestSuite *suite_of_tests = new CppUnit::TestSuite("TestParallel/TestWorkStealingScheduler");
+
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestWorkStealingScheduler>("TestParallel/TestWorkStealingScheduler: test_next_task", &TestWorkStealingScheduler::test_next_task) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestWorkStealingScheduler>("TestParallel/TestWorkStealingScheduler: test_steal_task", &TestWorkStealingScheduler::test_steal_task) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestWorkStealingScheduler>("TestParallel/TestWorkStealingScheduler: test_parallel_next_task", &TestWorkStealingScheduler::test_parallel_next_task) );
+
+  return suite_of_tests;
+}
+
+void TestWorkStealingScheduler::setUp() {}
+void TestWorkStealingScheduler::tearDown() {}
+
+void TestWorkStealingScheduler::test_next_task()
+{
+  // The tasks are dealt out round-robin and taken from the front of the own queue
+  WorkStealingScheduler scheduler(7, 3);
+  CPPUNIT_ASSERT_EQUAL(3u, scheduler.get_queue_number());
+  unsigned int task;
+  CPPUNIT_ASSERT(scheduler.next_task(1, task));
+  CPPUNIT_ASSERT_EQUAL(1u, task);
+  CPPUNIT_ASSERT(scheduler.next_task(1, task));
+  CPPUNIT_ASSERT_EQUAL(4u, task);
+  CPPUNIT_ASSERT(scheduler.next_task(0, task));
+  CPPUNIT_ASSERT_EQUAL(0u, task);
+  CPPUNIT_ASSERT_EQUAL(0u, scheduler.get_stolen_task_number());
+}
+
+void TestWorkStealingScheduler::test_steal_task()
+{
+  // Queue 0 holds 0, 2, 4, queue 1 holds 1, 3
+  WorkStealingScheduler scheduler(5, 2);
+  unsigned int task;
+  CPPUNIT_ASSERT(scheduler.next_task(1, task)); CPPUNIT_ASSERT_EQUAL(1u, task);
+  CPPUNIT_ASSERT(scheduler.next_task(1, task)); CPPUNIT_ASSERT_EQUAL(3u, task);
+
+  // The empty queue steals from the back of the other queue
+  CPPUNIT_ASSERT(scheduler.next_task(1, task)); CPPUNIT_ASSERT_EQUAL(4u, task);
+  CPPUNIT_ASSERT_EQUAL(1u, scheduler.get_stolen_task_number());
+  CPPUNIT_ASSERT(scheduler.next_task(0, task)); CPPUNIT_ASSERT_EQUAL(0u, task);
+  CPPUNIT_ASSERT(scheduler.next_task(1, task)); CPPUNIT_ASSERT_EQUAL(2u, task);
+  CPPUNIT_ASSERT_EQUAL(2u, scheduler.get_stolen_task_number());
+
+  // All tasks are handed out
+  CPPUNIT_ASSERT(!scheduler.next_task(0, task));
+  CPPUNIT_ASSERT(!scheduler.next_task(1, task));
+}
+
+void TestWorkStealingScheduler::test_parallel_next_task()
+{
+  // Every task must be handed out exactly once, even if the threads steal
+  const unsigned int task_number = 1000;
+  WorkStealingScheduler scheduler(task_number, 4);
+  std::vector<int> executions(task_number, 0);
+
+  omp_set_num_threads(4);
+#pragma omp parallel shared(scheduler) shared(executions)
+  {
+    unsigned int task;
+    while (scheduler.next_task(omp_get_thread_num(), task))
+    {
+#pragma omp atomic
+      ++executions[task];
+    }
+  }
+
+  for (unsigned int t = 0; t < task_number; ++t)
+    CPPUNIT_ASSERT_EQUAL(1, executions[t]);
+}
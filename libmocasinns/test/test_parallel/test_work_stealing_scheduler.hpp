@@ -0,0 +1,27 @@
+#ifndef TEST_WORK_STEALING_SCHEDULER_HPP
+#define TEST_WORK_STEALING_SCHEDULER_HPP
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/Test.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <mocasinns/parallel/work_stealing_scheduler.hpp>
+
+using namespace Mocasinns::Parallel;
+
+class TestWorkStealingScheduler : CppUnit::TestFixture
+{
+public:
+  static CppUnit::Test* suite();
+
+  void setUp();
+  void tearDown();
+
+  void test_next_task();
+  void test_steal_task();
+  void test_parallel_next_task();
+};
+
+#endif
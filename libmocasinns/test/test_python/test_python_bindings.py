@@ -0,0 +1,90 @@
+"""Smoke test of the Python modules libgespinst_wrap and libmocasinns_wrap, run with "make python_test" in libmocasinns/test."""
+
+import unittest
+
+import libgespinst_wrap as gespinst
+import libmocasinns_wrap as mocasinns
+
+
+class TestPythonBindings(unittest.TestCase):
+
+    def create_metropolis(self, lattice):
+        parameters = mocasinns.MetropolisIsing2dParameters()
+        parameters.relaxation_steps = 100
+        parameters.measurement_number = 50
+        parameters.steps_between_measurement = 10
+        simulation = mocasinns.MetropolisIsing2d(parameters, lattice)
+        simulation.set_random_seed(0)
+        return simulation
+
+    def test_lattice_spins(self):
+        lattice = gespinst.SpinLatticeIsing2d([4, 4])
+        spins = memoryview(lattice.spins())
+        self.assertEqual((4, 4), spins.shape)
+        self.assertEqual(16, sum(spins[x, y] for x in range(4) for y in range(4)))
+        spins[1, 2] = -1
+        self.assertEqual(14, lattice.magnetization())
+
+    def test_metropolis_vector_accumulator(self):
+        lattice = gespinst.SpinLatticeIsing2d([4, 4])
+        simulation = self.create_metropolis(lattice)
+        accumulator = mocasinns.VectorAccumulatorDouble()
+        simulation.do_metropolis_simulation(0.3, accumulator)
+        self.assertEqual(50, len(accumulator))
+
+        # The time series cannot grow while it is exported
+        values = memoryview(accumulator.values())
+        self.assertEqual(50, values.shape[0])
+        self.assertRaises(BufferError, simulation.do_metropolis_simulation, 0.3, accumulator)
+        self.assertRaises(BufferError, accumulator.clear)
+        values.release()
+        del values
+        simulation.do_metropolis_simulation(0.3, accumulator, "magnetization")
+        self.assertEqual(100, len(accumulator))
+
+    def test_moments_accumulator(self):
+        accumulator = mocasinns.MomentsAccumulatorDouble()
+        for value in [1.0, 2.0, 3.0]:
+            accumulator(value)
+        means = memoryview(accumulator.means())
+        self.assertEqual(3, accumulator.count())
+        self.assertAlmostEqual(2.0, accumulator.mean())
+        self.assertAlmostEqual(2.0, means[0])
+
+        # The copied means stay valid when the accumulator is reset
+        accumulator.reset()
+        accumulator(5.0)
+        self.assertAlmostEqual(2.0, means[0])
+        self.assertAlmostEqual(5.0, accumulator.mean())
+
+    def test_wang_landau_microcanonical_accumulator(self):
+        lattice = gespinst.SpinLatticeIsing2d([4, 4])
+        parameters = mocasinns.WangLandauIsing2dParameters()
+        parameters.modification_factor_initial = 1.0
+        parameters.modification_factor_final = 0.5
+        parameters.modification_factor_multiplier = 0.5
+        parameters.sweep_steps = 100
+        simulation = mocasinns.WangLandauIsing2d(parameters, lattice)
+        simulation.set_random_seed(0)
+        accumulator = mocasinns.MicrocanonicalAccumulatorDouble()
+        simulation.attach_microcanonical_accumulator(accumulator)
+
+        # Arrays requested before the simulation inserts the energy bins stay valid
+        energies = memoryview(accumulator.energies())
+        counts = memoryview(accumulator.counts())
+        self.assertEqual(0, len(energies))
+        simulation.do_wang_landau_simulation()
+        self.assertEqual(0, len(counts))
+
+        self.assertTrue(len(accumulator) > 0)
+        self.assertEqual(len(accumulator), len(memoryview(accumulator.energies())))
+        self.assertTrue(sum(memoryview(accumulator.counts())) > 0)
+        log_density_of_states = simulation.get_log_density_of_states()
+        self.assertTrue(len(log_density_of_states) > 0)
+        self.assertEqual(len(log_density_of_states), len(memoryview(log_density_of_states.x_values())))
+        dense = log_density_of_states.to_dense()
+        self.assertEqual(len(log_density_of_states), len(memoryview(dense.y_values())))
+
+
+if __name__ == "__main__":
+    unittest.main()
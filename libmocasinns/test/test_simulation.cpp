@@ -2,11 +2,42 @@
 
 #include <vector>
 #include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <limits>
+
+#include <mocasinns/metropolis.hpp>
+#include <mocasinns/wang_landau.hpp>
+#include <mocasinns/histograms/histocrete.hpp>
+#include <mocasinns/details/simulation/acceptance_test.hpp>
+
+namespace
+{
+  // Simulation returning the parameter as logarithm of the acceptance probability
+  struct LogProbabilitySimulation
+  {
+    template <class StepType>
+    double log_acceptance_probability(StepType&, double& log_probability) { return log_probability; }
+  };
+  // Steps with and without the optional member functions
+  struct StepWithOptionalMembers
+  {
+    bool is_executable() const { return true; }
+    double selection_probability_factor() const { return 2.0; }
+  };
+  struct StepWithoutOptionalMembers {};
+}
 
 CppUnit::Test* TestSimulation::suite()
 {
   CppUnit::TestSuite *suite_of_tests = new CppUnit::TestSuite("TestSimulation");
   suite_of_tests->addTest( new CppUnit::TestCaller<TestSimulation>("TestSimulation: test_serialize", &TestSimulation::test_serialize) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestSimulation>("TestSimulation: test_write_checkpoint", &TestSimulation::test_write_checkpoint) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestSimulation>("TestSimulation: test_acceptance_test", &TestSimulation::test_acceptance_test) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestSimulation>("TestSimulation: test_optional_concept_checks", &TestSimulation::test_optional_concept_checks) );
     
   return suite_of_tests;
 }
@@ -40,3 +71,85 @@ void TestSimulation::test_serialize()
   // Delete the loaded simulation
   delete test_simulation_loaded;
 }
+
+void TestSimulation::test_write_checkpoint()
+{
+  // The checkpoint is written to the dump file, the temporary file is renamed
+  test_simulation->set_dump_filename("checkpoint_test.dat");
+  test_simulation->write_checkpoint();
+  CPPUNIT_ASSERT(std::ifstream("checkpoint_test.dat").good());
+  CPPUNIT_ASSERT(!std::ifstream("checkpoint_test.dat.tmp").good());
+
+  SimulationType* test_simulation_loaded = new SimulationType();
+  test_simulation_loaded->load_serialize("checkpoint_test.dat");
+  CPPUNIT_ASSERT(*(test_simulation_loaded->get_config_space()) == *(test_simulation->get_config_space()));
+  delete test_simulation_loaded;
+
+  // A checkpoint that cannot be written throws and leaves no temporary file
+  test_simulation->set_dump_filename("checkpoint_missing_directory/checkpoint_test.dat");
+  CPPUNIT_ASSERT_THROW(test_simulation->write_checkpoint(), std::runtime_error);
+  CPPUNIT_ASSERT(!std::ifstream("checkpoint_missing_directory/checkpoint_test.dat.tmp").good());
+
+  // A checkpoint that cannot be renamed throws and removes the temporary file
+  mkdir("checkpoint_directory", 0755);
+  test_simulation->set_dump_filename("checkpoint_directory");
+  CPPUNIT_ASSERT_THROW(test_simulation->write_checkpoint(), std::runtime_error);
+  CPPUNIT_ASSERT(!std::ifstream("checkpoint_directory.tmp").good());
+  rmdir("checkpoint_directory");
+
+  // Without budget the deadline is never reached
+  CPPUNIT_ASSERT(!test_simulation->get_deadline_reached());
+  test_simulation->set_wall_clock_budget(100.0);
+  CPPUNIT_ASSERT(test_simulation->get_remaining_wall_clock_time() > 99.0);
+  CPPUNIT_ASSERT(test_simulation->get_remaining_wall_clock_time() <= 100.0);
+
+  std::remove("checkpoint_test.dat");
+}
+
+void TestSimulation::test_acceptance_test()
+{
+  LogProbabilitySimulation simulation;
+  StepWithOptionalMembers step;
+  Random::Boost_MT19937 rng;
+  Random::Boost_MT19937 reference_rng;
+  rng.set_seed(1234);
+  reference_rng.set_seed(1234);
+
+  // Forbidden steps are rejected and certain steps are accepted without drawing a random number
+  double log_probability = -std::numeric_limits<double>::infinity();
+  CPPUNIT_ASSERT(!(Details::Simulation::AcceptanceTest<true>::accept<false>(&simulation, step, log_probability, &rng)));
+  log_probability = 0.0;
+  CPPUNIT_ASSERT((Details::Simulation::AcceptanceTest<true>::accept<false>(&simulation, step, log_probability, &rng)));
+  log_probability = 0.5;
+  CPPUNIT_ASSERT((Details::Simulation::AcceptanceTest<true>::accept<false>(&simulation, step, log_probability, &rng)));
+  CPPUNIT_ASSERT_EQUAL(reference_rng.random_double(), rng.random_double());
+
+  // The selection probability factor 2 makes the step with log probability log(2) certain, one random number is drawn for log(1.5)
+  log_probability = log(2.0);
+  CPPUNIT_ASSERT((Details::Simulation::AcceptanceTest<true>::accept<true>(&simulation, step, log_probability, &rng)));
+  CPPUNIT_ASSERT_EQUAL(reference_rng.random_double(), rng.random_double());
+  log_probability = log(1.5);
+  const bool accepted = Details::Simulation::AcceptanceTest<true>::accept<true>(&simulation, step, log_probability, &rng);
+  CPPUNIT_ASSERT_EQUAL(reference_rng.random_double() < 0.75, accepted);
+  CPPUNIT_ASSERT_EQUAL(reference_rng.random_double(), rng.random_double());
+}
+
+void TestSimulation::test_optional_concept_checks()
+{
+  typedef Metropolis<ConfigurationType, StepType, Random::Boost_MT19937> MetropolisType;
+  typedef WangLandau<ConfigurationType, StepType, int, Histograms::Histocrete, Random::Boost_MT19937> WangLandauType;
+  CPPUNIT_ASSERT(!Details::OptionalConceptChecks::SimulationHasLogAcceptanceProbability<MetropolisType>::value);
+  CPPUNIT_ASSERT(Details::OptionalConceptChecks::SimulationHasLogAcceptanceProbability<WangLandauType>::value);
+
+  CPPUNIT_ASSERT(Details::OptionalConceptChecks::StepTypeHasIsExecutable<StepWithOptionalMembers>::value);
+  CPPUNIT_ASSERT(!Details::OptionalConceptChecks::StepTypeHasIsExecutable<StepWithoutOptionalMembers>::value);
+  CPPUNIT_ASSERT(Details::OptionalConceptChecks::StepTypeHasSelectionProbabilityFactor<StepWithOptionalMembers>::value);
+  CPPUNIT_ASSERT(!Details::OptionalConceptChecks::StepTypeHasSelectionProbabilityFactor<StepWithoutOptionalMembers>::value);
+  CPPUNIT_ASSERT(Details::OptionalConceptChecks::StepTypeHasIsExecutable<StepType>::value);
+  CPPUNIT_ASSERT(Details::OptionalConceptChecks::StepTypeHasSelectionProbabilityFactor<StepType>::value);
+
+  // Steps without the optional members are always executable and have the selection probability factor one
+  StepWithoutOptionalMembers step;
+  CPPUNIT_ASSERT(Details::Simulation::StepExecutable<false>::check(step));
+  CPPUNIT_ASSERT_EQUAL(1.0, Details::Simulation::SelectionProbabilityFactor<false>::get(step));
+}
@@ -32,6 +32,9 @@ public:
   void tearDown();
 
   void test_serialize();
+  void test_write_checkpoint();
+  void test_acceptance_test();
+  void test_optional_concept_checks();
 };
 
 #endif
@@ -1,10 +1,62 @@
 #include "test_wang_landau.hpp"
 
+#include <cmath>
+#include <algorithm>
+#include <sstream>
+
+//! Cumulative distribution function of the sum of three uniform random numbers
+static double irwin_hall_3(double x)
+{
+  if (x <= 1.0) return x*x*x/6.0;
+  if (x <= 2.0) return (-2.0*x*x*x + 9.0*x*x - 9.0*x + 3.0)/6.0;
+  return 1.0 - (3.0 - x)*(3.0 - x)*(3.0 - x)/6.0;
+}
+
+//! Helper class to measure the energy and the squared magnetization of a 1d Ising configuration
+class ObserveIsingEnergySquaredMagnetization
+{
+public:
+  typedef Observables::ArrayObservable<double, 2> observable_type;
+  static observable_type observe(IsingConfiguration1d* config)
+  {
+    observable_type result;
+    result[0] = config->energy();
+    result[1] = config->magnetization()*config->magnetization();
+    return result;
+  }
+};
+
+//! Helper class writing the parameters in the format of serialization version 0, without the refinement parameters
+struct IsingParametersVersion0
+{
+  IsingSimulation1d::Parameters parameters;
+  template<class Archive> void serialize(Archive & ar, const unsigned int)
+  {
+    ar & parameters.binning_reference;
+    ar & parameters.binning_width;
+    ar & parameters.energy_cutoff_lower;
+    ar & parameters.energy_cutoff_upper;
+    ar & parameters.use_energy_cutoff_lower;
+    ar & parameters.use_energy_cutoff_upper;
+    ar & parameters.flatness;
+    ar & parameters.modification_factor_initial;
+    ar & parameters.modification_factor_final;
+    ar & parameters.modification_factor_multiplier;
+    ar & parameters.sweep_steps;
+    ar & parameters.prototype_histo;
+  }
+};
+
 CppUnit::Test* TestWangLandau::suite()
 {
   CppUnit::TestSuite *suite_of_tests = new CppUnit::TestSuite("TestWangLandau");
   suite_of_tests->addTest( new CppUnit::TestCaller<TestWangLandau>("TestWangLandau: test_do_wang_landau_steps", &TestWangLandau::test_do_wang_landau_steps) );
   suite_of_tests->addTest( new CppUnit::TestCaller<TestWangLandau>("TestWangLandau: test_do_wang_landau_simulation", &TestWangLandau::test_do_wang_landau_simulation) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestWangLandau>("TestWangLandau: test_log_acceptance_probability", &TestWangLandau::test_log_acceptance_probability) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestWangLandau>("TestWangLandau: test_warm_start", &TestWangLandau::test_warm_start) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestWangLandau>("TestWangLandau: test_adaptive_binning", &TestWangLandau::test_adaptive_binning) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestWangLandau>("TestWangLandau: test_adaptive_binning_warm_start", &TestWangLandau::test_adaptive_binning_warm_start) );
+  suite_of_tests->addTest( new CppUnit::TestCaller<TestWangLandau>("TestWangLandau: test_microcanonical_accumulator", &TestWangLandau::test_microcanonical_accumulator) );
 
   suite_of_tests->addTest( new CppUnit::TestCaller<TestWangLandau>("TestWangLandau: test_serialize", &TestWangLandau::test_serialize) );
     
@@ -86,6 +138,190 @@ void TestWangLandau::test_do_wang_landau_simulation()
   CPPUNIT_ASSERT_DOUBLES_EQUAL(16.0, exp(first_excited->second) / exp(ground_state->second), 0.9);
 }
 
+void TestWangLandau::test_log_acceptance_probability()
+{
+  // Estimation of the density of states with a jump of 4 between the ground state and the first excited state
+  Histograms::Histocrete<int, double> log_density_of_states;
+  log_density_of_states[-16] = 0.0;
+  log_density_of_states[-12] = 4.0;
+  test_ising_simulation_1d->set_log_density_of_states(log_density_of_states);
+
+  // Flip a spin of the ground state
+  IsingStep1d step_up = test_ising_config_1d->all_steps(3)[0];
+  Details::Multicanonical::StepParameter<int> step_parameters(-16, 0);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-4.0, test_ising_simulation_1d->log_acceptance_probability(step_up, step_parameters), 1e-12);
+  CPPUNIT_ASSERT_EQUAL(4, step_parameters.delta_E);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(exp(-4.0), test_ising_simulation_1d->acceptance_probability(step_up, step_parameters), 1e-12);
+
+  // A step violating the energy cutoff has a logarithmic acceptance probability of -infinity
+  IsingSimulation1d::Parameters parameters_cutoff = parameters_1d;
+  parameters_cutoff.use_energy_cutoff_upper = true;
+  parameters_cutoff.energy_cutoff_upper = -14;
+  IsingSimulation1d simulation_cutoff(parameters_cutoff, test_ising_config_1d);
+  const double log_probability_cutoff = simulation_cutoff.log_acceptance_probability(step_up, step_parameters);
+  CPPUNIT_ASSERT(log_probability_cutoff < 0.0 && std::isinf(log_probability_cutoff));
+  CPPUNIT_ASSERT_EQUAL(0.0, simulation_cutoff.acceptance_probability(step_up, step_parameters));
+}
+
+void TestWangLandau::test_warm_start()
+{
+  // Density of states of the 1d Ising chain with 8 sites
+  Histograms::Histocrete<int, double> log_density_of_states_8;
+  log_density_of_states_8[-8] = 0.0;
+  log_density_of_states_8[-4] = log(28.0);
+  log_density_of_states_8[0] = log(70.0);
+  log_density_of_states_8[4] = log(28.0);
+  log_density_of_states_8[8] = 0.0;
+
+  // Rescale to 16 sites using a binning width of 2, so that there are bins the chain never reaches
+  IsingSimulation1d::Parameters parameters_warm = parameters_1d;
+  parameters_warm.binning_width = 2;
+  test_ising_simulation_1d->set_simulation_parameters(parameters_warm);
+  test_ising_simulation_1d->warm_start(log_density_of_states_8, 8, 0.01);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.01, test_ising_simulation_1d->get_modification_factor_current(), 1e-12);
+
+  Histograms::Histocrete<int, double> log_density_of_states_16 = test_ising_simulation_1d->get_log_density_of_states();
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(17), log_density_of_states_16.size());
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, log_density_of_states_16[-16], 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0*log(70.0), log_density_of_states_16[0], 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(log(28.0), log_density_of_states_16[-12], 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0*0.25*log(28.0), log_density_of_states_16[-14], 1e-12);
+
+  // Continue the simulation, the result must agree with the exact density of states and the unreachable bins are removed
+  test_ising_simulation_1d->do_wang_landau_simulation();
+  Histograms::Histocrete<int, double> entropy_estimation_1d = test_ising_simulation_1d->get_log_density_of_states();
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(9), entropy_estimation_1d.size());
+  CPPUNIT_ASSERT(!entropy_estimation_1d.exists(-14));
+  const double ground_state = entropy_estimation_1d[-16];
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(4.7875, entropy_estimation_1d[-12] - ground_state, 0.15);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(9.4627, entropy_estimation_1d[0] - ground_state, 0.15);
+
+  // A modification factor that is not above the final one takes no step, the rescaled density of states is kept completely
+  test_ising_simulation_1d->warm_start(log_density_of_states_8, 8, parameters_warm.modification_factor_final);
+  test_ising_simulation_1d->do_wang_landau_simulation();
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(17), test_ising_simulation_1d->get_log_density_of_states().size());
+
+  // With a floating-point binning some energies reference + k*width fall into the bin below, every bin must get the density of states at its own energy
+  Histograms::HistogramAdaptive<double, double> log_density_of_states_uniform(0.1, 0.0);
+  log_density_of_states_uniform.insert(std::pair<double, double>(0.0, 0.0));
+  log_density_of_states_uniform.insert(std::pair<double, double>(6.05, 0.0));
+  log_density_of_states_uniform.find_value(6.05)->second = log_density_of_states_uniform.bin_of(6.05);
+  UniformSumSimulation::Parameters parameters_uniform;
+  parameters_uniform.prototype_histo = Histograms::HistogramAdaptive<double, uint64_t>(0.1, 0.0);
+  parameters_uniform.binning_width = 0.1;
+  UniformSumConfiguration configuration_uniform(3);
+  UniformSumSimulation simulation_uniform(parameters_uniform, &configuration_uniform);
+  simulation_uniform.warm_start(log_density_of_states_uniform, 3, 0.01);
+  const Histograms::HistogramAdaptive<double, double>& log_density_of_states_warm = simulation_uniform.get_log_density_of_states();
+  CPPUNIT_ASSERT(log_density_of_states_warm.size() > 50);
+  for (Histograms::HistogramAdaptive<double, double>::const_iterator bin = log_density_of_states_warm.begin(); bin != log_density_of_states_warm.end(); ++bin)
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(bin->first, bin->second, 1e-9);
+}
+
+void TestWangLandau::test_adaptive_binning()
+{
+  // Sum of three uniform random numbers, the density of states is steep near the borders of the energy range
+  UniformSumSimulation::Parameters parameters;
+  parameters.prototype_histo = Histograms::HistogramAdaptive<double, uint64_t>(0.25, 0.0);
+  parameters.modification_factor_initial = 1.0;
+  parameters.modification_factor_final = 1e-6;
+  parameters.modification_factor_multiplier = 0.5;
+  parameters.flatness = 0.9;
+  parameters.sweep_steps = 10000;
+  parameters.refinement_threshold = 1.0;
+  parameters.refinement_minimal_incidence = 1000;
+  parameters.refinement_level_maximal = 2;
+  parameters.refinement_modification_factor = 0.01;
+
+  UniformSumConfiguration configuration(3);
+  UniformSumSimulation simulation(parameters, &configuration);
+  simulation.do_wang_landau_simulation();
+
+  // The bins at the borders are split twice, the flat bins in the middle are not split
+  const Histograms::HistogramAdaptive<double, double>& log_density_of_states = simulation.get_log_density_of_states();
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0625, log_density_of_states.bin_width(0.0), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0625, log_density_of_states.bin_width(2.9375), 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, log_density_of_states.bin_width(1.5), 1e-12);
+  CPPUNIT_ASSERT(log_density_of_states.size() > 12);
+  CPPUNIT_ASSERT_EQUAL(log_density_of_states.size(), simulation.get_incidence_counter().size());
+
+  // Compare the normalised density of states of every bin with the exact Irwin-Hall distribution
+  double log_sum = log_density_of_states.max_y_value()->second;
+  double sum = 0.0;
+  for (Histograms::HistogramAdaptive<double, double>::const_iterator bin = log_density_of_states.begin(); bin != log_density_of_states.end(); ++bin)
+    sum += exp(bin->second - log_sum);
+  log_sum += log(sum);
+  for (Histograms::HistogramAdaptive<double, double>::const_iterator bin = log_density_of_states.begin(); bin != log_density_of_states.end(); ++bin)
+  {
+    const double exact = irwin_hall_3(bin->first + log_density_of_states.bin_width(bin->first)) - irwin_hall_3(bin->first);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(log(exact), bin->second - log_sum, 0.1);
+  }
+}
+
+void TestWangLandau::test_adaptive_binning_warm_start()
+{
+  // Density of states of the sum of three uniform random numbers, extended by bins below and above the reachable energy range
+  Histograms::HistogramAdaptive<double, double> previous_log_density_of_states(0.25, 0.0);
+  for (int k = -2; k < 14; ++k)
+  {
+    const double edge = std::min(std::max(0.25*k, 0.0), 2.75);
+    previous_log_density_of_states.insert(std::pair<double, double>(0.25*k, log(irwin_hall_3(edge + 0.25) - irwin_hall_3(edge))));
+  }
+
+  UniformSumSimulation::Parameters parameters;
+  parameters.prototype_histo = Histograms::HistogramAdaptive<double, uint64_t>(0.25, 0.0);
+  parameters.binning_width = 0.25;
+  parameters.modification_factor_final = 1e-4;
+  parameters.modification_factor_multiplier = 0.5;
+  parameters.flatness = 0.8;
+  parameters.sweep_steps = 10000;
+  parameters.refinement_threshold = 1.0;
+  parameters.refinement_minimal_incidence = 1000;
+  parameters.refinement_level_maximal = 2;
+  parameters.refinement_modification_factor = 0.01;
+
+  // The unreachable bins of the warm start must not enter the incidence counter of the refined binning, otherwise it never becomes flat
+  UniformSumConfiguration configuration(3);
+  UniformSumSimulation simulation(parameters, &configuration);
+  simulation.warm_start(previous_log_density_of_states, 3, 0.01);
+  CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(16), simulation.get_log_density_of_states().size());
+  simulation.do_wang_landau_simulation();
+
+  // The border bins are split and the unreachable bins are removed
+  const Histograms::HistogramAdaptive<double, double>& log_density_of_states = simulation.get_log_density_of_states();
+  CPPUNIT_ASSERT(log_density_of_states.bin_width(0.0) < 0.25);
+  CPPUNIT_ASSERT(log_density_of_states.min_x_value()->first >= 0.0);
+  CPPUNIT_ASSERT(log_density_of_states.max_x_value()->first < 3.0);
+  CPPUNIT_ASSERT_EQUAL(log_density_of_states.size(), simulation.get_incidence_counter().size());
+}
+
+void TestWangLandau::test_microcanonical_accumulator()
+{
+  // Measure the energy and the squared magnetization per energy bin during the complete simulation
+  typedef Accumulators::MicrocanonicalAccumulator<int, ObserveIsingEnergySquaredMagnetization::observable_type> AccumulatorType;
+  AccumulatorType accumulator;
+  test_ising_simulation_1d->attach_microcanonical_accumulator<ObserveIsingEnergySquaredMagnetization>(accumulator, 4);
+  test_ising_simulation_1d->do_wang_landau_simulation();
+  test_ising_simulation_1d->detach_microcanonical_accumulator();
+
+  // The microcanonical average of the energy is the energy of the bin
+  CPPUNIT_ASSERT_EQUAL(static_cast<std::size_t>(9), accumulator.size());
+  std::vector<ObserveIsingEnergySquaredMagnetization::observable_type> averages = accumulator.microcanonical_averages();
+  for (unsigned int bin = 0; bin < accumulator.size(); ++bin)
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(accumulator.get_energies()[bin], averages[bin][0], 1e-10);
+  // Both ground states have the maximal magnetization
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(256.0, averages[0][1], 1e-10);
+
+  // At infinite temperature the spins are independent and the mean squared magnetization is the number of spins
+  ObserveIsingEnergySquaredMagnetization::observable_type infinite_temperature = accumulator.canonical_average(test_ising_simulation_1d->get_log_density_of_states(), 0.0);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, infinite_temperature[0], 0.2);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(16.0, infinite_temperature[1], 1.0);
+  // At low temperatures the ground states dominate
+  ObserveIsingEnergySquaredMagnetization::observable_type low_temperature = accumulator.canonical_average(test_ising_simulation_1d->get_log_density_of_states(), 5.0);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-16.0, low_temperature[0], 0.01);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(256.0, low_temperature[1], 0.5);
+}
+
 void TestWangLandau::test_serialize()
 {
   // Test the serialization of parameters
@@ -105,6 +341,24 @@ void TestWangLandau::test_serialize()
   }
   CPPUNIT_ASSERT(parameters_test == parameters_loaded);
 
+  // Parameters of version 0 are loaded with the default refinement parameters
+  IsingParametersVersion0 parameters_version_0;
+  parameters_version_0.parameters.modification_factor_final = 1e-6;
+  parameters_version_0.parameters.refinement_threshold = 0.25;
+  std::stringstream version_0_stream;
+  {
+    boost::archive::text_oarchive oa(version_0_stream);
+    oa << parameters_version_0;
+  }
+  IsingSimulation1d::Parameters parameters_version_0_loaded;
+  {
+    boost::archive::text_iarchive ia(version_0_stream);
+    ia >> parameters_version_0_loaded;
+  }
+  IsingSimulation1d::Parameters parameters_compare;
+  parameters_compare.modification_factor_final = 1e-6;
+  CPPUNIT_ASSERT(parameters_compare == parameters_version_0_loaded);
+
   // Test before doing any steps
   // Save the 1d ising simulation in a file, create a new one and load
   test_ising_simulation_1d->save_serialize("serialize_test.dat");
@@ -142,4 +396,23 @@ void TestWangLandau::test_serialize()
 		 test_ising_simulation_1d->get_modification_factor_current());
   // Delete the loaded simulation
   delete test_ising_simulation_1d_loaded;
+
+  // A warm started simulation still removes the unreachable bins after being loaded
+  Histograms::Histocrete<int, double> log_density_of_states_8;
+  log_density_of_states_8[-8] = 0.0;
+  log_density_of_states_8[-4] = log(28.0);
+  log_density_of_states_8[0] = log(70.0);
+  log_density_of_states_8[4] = log(28.0);
+  log_density_of_states_8[8] = 0.0;
+  IsingSimulation1d::Parameters parameters_warm = parameters_1d;
+  parameters_warm.binning_width = 2;
+  test_ising_simulation_1d->set_simulation_parameters(parameters_warm);
+  test_ising_simulation_1d->warm_start(log_density_of_states_8, 8, 0.01);
+  test_ising_simulation_1d->save_serialize("serialize_test.dat");
+  test_ising_simulation_1d_loaded = new IsingSimulation1d();
+  test_ising_simulation_1d_loaded->load_serialize("serialize_test.dat");
+  CPPUNIT_ASSERT(test_ising_simulation_1d_loaded->get_log_density_of_states().exists(-14));
+  test_ising_simulation_1d_loaded->do_wang_landau_simulation();
+  CPPUNIT_ASSERT(!test_ising_simulation_1d_loaded->get_log_density_of_states().exists(-14));
+  delete test_ising_simulation_1d_loaded;
 }
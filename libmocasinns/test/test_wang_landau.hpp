@@ -12,7 +12,10 @@
 
 #include <mocasinns/wang_landau.hpp>
 #include <mocasinns/histograms/histocrete.hpp>
+#include <mocasinns/histograms/histogram.hpp>
 #include <mocasinns/random/boost_random.hpp>
+#include <mocasinns/accumulators/microcanonical_accumulator.hpp>
+#include <mocasinns/observables/array_observable.hpp>
 
 using namespace Mocasinns;
 
@@ -24,6 +27,55 @@ typedef Gespinst::SpinLattice<2, Gespinst::IsingSpin> IsingConfiguration2d;
 typedef Gespinst::SpinLatticeStep<2, Gespinst::IsingSpin> IsingStep2d;
 typedef WangLandau<IsingConfiguration2d, IsingStep2d, int, Histograms::Histocrete, Random::Boost_MT19937> IsingSimulation2d;
 
+class UniformSumStep;
+//! Configuration of real numbers uniformly distributed in [0,1) with their sum as energy, i.e. a continuous energy with the Irwin-Hall distribution as density of states
+class UniformSumConfiguration
+{
+public:
+  UniformSumConfiguration(unsigned int size = 3) : values(size, 0.5) {}
+
+  double energy() const
+  {
+    double result = 0.0;
+    for (unsigned int i = 0; i < values.size(); ++i) result += values[i];
+    return result;
+  }
+  unsigned int system_size() const { return values.size(); }
+  template <class RandomNumberGenerator> UniformSumStep propose_step(RandomNumberGenerator* rng);
+  void commit(UniformSumStep& step_to_commit);
+
+  std::vector<double> values;
+
+private:
+  friend class boost::serialization::access;
+  template<class Archive> void serialize(Archive & ar, const unsigned int) { ar & values; }
+};
+//! Step replacing one value of an UniformSumConfiguration by a new random value
+class UniformSumStep
+{
+public:
+  UniformSumStep() : configuration(0), index(0), new_value(0.0) {}
+  UniformSumStep(UniformSumConfiguration* configuration, unsigned int index, double new_value) : configuration(configuration), index(index), new_value(new_value) {}
+
+  double delta_E() const { return new_value - configuration->values[index]; }
+  void execute() { configuration->values[index] = new_value; }
+  bool is_executable() const { return true; }
+  double selection_probability_factor() const { return 1.0; }
+
+private:
+  UniformSumConfiguration* configuration;
+  unsigned int index;
+  double new_value;
+};
+template <class RandomNumberGenerator> UniformSumStep UniformSumConfiguration::propose_step(RandomNumberGenerator* rng)
+{
+  const unsigned int index = rng->random_uint32(0, values.size() - 1);
+  return UniformSumStep(this, index, rng->random_double());
+}
+inline void UniformSumConfiguration::commit(UniformSumStep& step_to_commit) { step_to_commit.execute(); }
+
+typedef WangLandau<UniformSumConfiguration, UniformSumStep, double, Histograms::HistogramAdaptive, Random::Boost_MT19937> UniformSumSimulation;
+
 class TestWangLandau : CppUnit::TestFixture
 {
 private:
@@ -43,6 +95,11 @@ public:
 
   void test_do_wang_landau_steps();
   void test_do_wang_landau_simulation();
+  void test_log_acceptance_probability();
+  void test_warm_start();
+  void test_adaptive_binning();
+  void test_adaptive_binning_warm_start();
+  void test_microcanonical_accumulator();
 
   void test_serialize();
 };